@@ -32,6 +32,8 @@
 #define __TASMANIAN_DREAM_HPP
 
 #include "tsgDreamSamplePosteriorGrid.hpp"
+#include "tsgDreamSampleAsync.hpp"
+#include "tsgDreamSampleTempered.hpp"
 
 //! \file TasmanianDREAM.hpp
 //! \brief DiffeRential Evolution Adaptive Metropolis methods.
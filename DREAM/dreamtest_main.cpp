@@ -44,6 +44,13 @@ using namespace std;
 int main(int argc, const char ** argv){
     //cout << " Phruuuuphrrr " << endl; // this is the sound that the Tasmanian devil makes
 
+    // tests for speed
+    if ((argc > 1) && ((strcmp(argv[1],"-benchmark") == 0) || (strcmp(argv[1],"-bench") == 0))){
+        DreamExternalTester tester;
+        tester.benchmark(argc, argv);
+        return 0;
+    }
+
     bool debug = false;
     TypeDREAMTest test = test_all;
 
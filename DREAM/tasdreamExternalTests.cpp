@@ -176,6 +176,105 @@ bool DreamExternalTester::testGaussian3D(){
 
     if (verbose || !pass) reportPassFail(pass, "Gaussian 3D", "with correlated chains");
 
+    // parallel sampling with counter-based random streams, the result should not depend on the number of threads
+    std::vector<std::vector<double>> parallel_history(2);
+    for(int r=0; r<2; r++){
+        #ifdef _OPENMP
+        int num_threads = omp_get_max_threads();
+        omp_set_num_threads((r == 0) ? 1 : 3);
+        #endif
+        CounterRandom master((unsigned long long) rseed);
+        state = TasmanianDREAM(num_chains, num_dimensions); // reinitialize
+        state.setState(initial_state);
+
+        SampleDREAM(num_burnup, 2*num_iterations,
+            [&](const std::vector<double> &candidates, std::vector<double> &values){
+                auto ix = candidates.begin();
+                for(auto &v : values)
+                    v = getDensity<dist_gaussian>(*ix++, 2.0, 9.0) * getDensity<dist_gaussian>(*ix++, 2.0, 9.0) * getDensity<dist_gaussian>(*ix++, 2.0, 9.0);
+            },
+            lower, upper, // large domain
+            dist_gaussian, 0.5, // Gaussian proposal
+            state,
+            0.5, // differential proposal is weighted by 50%
+            master
+        );
+        #ifdef _OPENMP
+        omp_set_num_threads(num_threads);
+        #endif
+        parallel_history[r] = state.getHistory();
+    }
+
+    pass = compareSamples(lower, upper, 5, tresult, parallel_history[0]) && (parallel_history[0] == parallel_history[1]);
+    passAll = passAll && pass;
+
+    if (verbose || !pass) reportPassFail(pass, "Gaussian 3D", "with parallel chains");
+
+    // asynchronous sampling, some of the evaluations are slow so the chains complete out of order
+    auto gauss3d = [&](const std::vector<double> &x)->double{
+        return getDensity<dist_gaussian>(x[0], 2.0, 9.0) * getDensity<dist_gaussian>(x[1], 2.0, 9.0) * getDensity<dist_gaussian>(x[2], 2.0, 9.0);
+    };
+    std::atomic<int> num_calls(0);
+    DreamWorkerPool pool(4);
+    CounterRandom async_master((unsigned long long) rseed + 1); // separate from the seed of the parallel chains above
+    state = TasmanianDREAM(num_chains, num_dimensions); // reinitialize
+    state.setState(initial_state);
+
+    SampleDREAMAsync(num_burnup, 2*num_iterations,
+        [&](const std::vector<double> &x)->double{
+            if (num_calls++ % 97 == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+            return gauss3d(x);
+        },
+        lower, upper, // large domain
+        dist_gaussian, 0.5, // Gaussian proposal
+        state,
+        0.5, // differential proposal is weighted by 50%
+        async_master, pool
+    );
+
+    pass = compareSamples(lower, upper, 5, tresult, state.getHistory()) && (state.getNumHistory() == (size_t) (2 * num_iterations * num_chains));
+
+    // the model completes immediately inside the start call, one evaluation at a time
+    state = TasmanianDREAM(num_chains, num_dimensions); // reinitialize
+    state.setState(initial_state);
+    SampleDREAMAsync(num_burnup, 2*num_iterations,
+        [&](const std::vector<double> &x, std::function<void(double)> done)->void{ done(gauss3d(x)); },
+        makeHypercudabeLambda(lower, upper),
+        dist_gaussian, 0.5, state, 0.5, async_master, 1
+    );
+    pass = pass && compareSamples(lower, upper, 5, tresult, state.getHistory()) && (state.getAcceptanceRate() > 0.1);
+
+    // exceptions thrown by the model are propagated to the caller
+    try{
+        SampleDREAMAsync(num_burnup, 2*num_iterations,
+            [&](const std::vector<double> &)->double{ throw std::runtime_error("model failure"); },
+            lower, upper, dist_gaussian, 0.5, state, 0.5, async_master, pool);
+        pass = false;
+    }catch(std::runtime_error &){}
+
+    // the sampling stops at the first failure, the history holds only complete snapshots and the state matches the last one
+    state = TasmanianDREAM(num_chains, num_dimensions);
+    state.setState(initial_state);
+    int fail_at = 12 * num_chains; // the first num_chains calls compute the initial values
+    num_calls = 0;
+    try{
+        SampleDREAMAsync(0, 2*num_iterations,
+            [&](const std::vector<double> &x)->double{
+                if (num_calls++ == fail_at) throw std::runtime_error("model failure");
+                return gauss3d(x);
+            },
+            lower, upper, dist_gaussian, 0.5, state, 0.5, async_master, pool);
+        pass = false;
+    }catch(std::runtime_error &){}
+    size_t num_history = state.getNumHistory(), snapshot_size = (size_t) (num_chains * num_dimensions);
+    const std::vector<double> &history = state.getHistory();
+    pass = pass && (num_calls <= fail_at + pool.getNumWorkers()) // no new proposals after the failure, only the in-flight ones
+                && (num_history > 0) && (num_history % (size_t) num_chains == 0) && (num_history < (size_t) (2 * num_iterations * num_chains))
+                && std::equal(history.end() - snapshot_size, history.end(), state.getChainState().begin());
+    passAll = passAll && pass;
+
+    if (verbose || !pass) reportPassFail(pass, "Gaussian 3D", "with asynchronous chains");
+
     reportPassFail(passAll, "Gaussian 3D", "DREAM vs Box-Muller");
 
     return passAll;
@@ -318,8 +417,270 @@ bool DreamExternalTester::testKnownDistributions(){
 
     bool pass1 = testGaussian3D();
     bool pass2 = testGaussian2D();
+    bool pass3 = testHistoryPolicies();
+    bool pass4 = testIndependentDensity();
+    bool pass5 = testTempering();
+
+    return pass1 && pass2 && pass3 && pass4 && pass5;
+}
+
+bool DreamExternalTester::testTempering(){
+    bool passAll = true;
+    int num_dimensions = 2, num_chains = 20, num_burnup = 200, num_collect = 200;
+    int rseed = 42;
+    if (usetimeseed) rseed = getRandomRandomSeed();
+
+    // two well separated modes with equal weight, centered at (-2, -2) and (2, 2)
+    auto bimodal = [&](const std::vector<double> &candidates, std::vector<double> &values)->void{
+        auto ix = candidates.begin();
+        for(auto &v : values){
+            double x = *ix++, y = *ix++;
+            double a = (x + 2.0) * (x + 2.0) + (y + 2.0) * (y + 2.0), b = (x - 2.0) * (x - 2.0) + (y - 2.0) * (y - 2.0);
+            v = std::log(std::exp(-a / 0.18) + std::exp(-b / 0.18)); // standard deviation 0.3
+        }
+    };
+    std::vector<double> lower(num_dimensions, -5.0), upper(num_dimensions, 5.0);
+
+    std::minstd_rand park_miller;
+    park_miller.seed(rseed);
+    std::uniform_real_distribution<double> unif(0.0, 1.0);
+    std::vector<double> initial_state(num_chains * num_dimensions, -2.0); // all chains start in the first mode
+    applyGaussianUpdate(initial_state, 0.3, [&]()->double{ return unif(park_miller); });
+
+    std::vector<double> betas = {1.0, 0.2, 0.05, 0.01};
+    std::vector<TasmanianDREAM> populations(betas.size(), TasmanianDREAM(num_chains, num_dimensions));
+    for(auto &p : populations) p.setState(initial_state);
+
+    CounterRandom master((unsigned long long) rseed);
+    std::vector<double> swap_rates = SampleDREAMTempered<logform>(num_burnup, num_collect, bimodal, lower, upper,
+                                                                  dist_gaussian, 0.3, populations, betas, 1.0, master, 2);
+
+    // the cold population must visit both modes in nearly equal proportion
+    const std::vector<double> &history = populations[0].getHistory();
+    size_t num_second = 0;
+    for(size_t i=0; i<history.size(); i+=2) if (history[i] + history[i+1] > 0.0) num_second++;
+    double fraction = ((double) num_second) / ((double) populations[0].getNumHistory());
+
+    bool pass = (fraction > 0.3) && (fraction < 0.7) && (populations[0].getNumHistory() == (size_t) (num_collect * num_chains))
+                && std::all_of(populations.begin() + 1, populations.end(), [](const TasmanianDREAM &p)->bool{ return (p.getNumHistory() == 0); })
+                && (swap_rates.size() == betas.size() - 1) && std::all_of(swap_rates.begin(), swap_rates.end(), [](double r)->bool{ return (r > 0.05); });
+    passAll = passAll && pass;
+    if (verbose || !pass) reportPassFail(pass, "Tempering", "cold chain visits both modes");
+
+    // without tempering, the chains cannot leave the first mode
+    populations.erase(populations.begin() + 1, populations.end());
+    populations[0] = TasmanianDREAM(num_chains, num_dimensions);
+    populations[0].setState(initial_state);
+    SampleDREAMTempered<logform>(num_burnup, num_collect, bimodal, lower, upper, dist_gaussian, 0.3, populations, {1.0}, 1.0, master);
+    pass = std::all_of(populations[0].getHistory().begin(), populations[0].getHistory().end(), [](double x)->bool{ return (x < 0.0); });
+    passAll = passAll && pass;
+    if (verbose || !pass) reportPassFail(pass, "Tempering", "without tempering");
+
+    reportPassFail(passAll, "Tempering", "DREAM parallel tempering");
+
+    return passAll;
+}
+
+bool DreamExternalTester::testIndependentDensity(){
+    bool pass = true;
+    std::vector<TypeDistribution> dists = {dist_uniform, dist_gaussian, dist_exponential, dist_beta, dist_gamma};
+    std::vector<std::vector<double>> params = {{}, {0.3, 0.5}, {-1.0, 2.0}, {-1.0, 1.0, 2.0, 3.0}, {-1.0, 2.0, 3.0}};
+    std::vector<double> x = { 0.1, 0.2, 0.3, 0.4, 0.5,
+                             -0.7, 1.1, 0.0, 0.9, 2.0,
+                              0.5, 0.3, 0.5, 0.0, 0.0};
+    size_t num_points = x.size() / dists.size();
+
+    std::vector<double> regvals, logvals;
+    IndependentDensity<regform>(dists, params)(x, regvals);
+    IndependentDensity<logform>(dists, params)(x, logvals);
+    for(size_t i=0; i<num_points; i++){
+        const double *p = &x[i * dists.size()];
+        double regref = getDensity<dist_uniform>(p[0]) * getDensity<dist_gaussian>(p[1], 0.3, 0.5) * getDensity<dist_exponential>(p[2], -1.0, 2.0)
+                        * getDensity<dist_beta>(p[3], -1.0, 1.0, 2.0, 3.0) * getDensity<dist_gamma>(p[4], -1.0, 2.0, 3.0);
+        double logref = getDensity<dist_uniform, logform>(p[0]) + getDensity<dist_gaussian, logform>(p[1], 0.3, 0.5) + getDensity<dist_exponential, logform>(p[2], -1.0, 2.0)
+                        + getDensity<dist_beta, logform>(p[3], -1.0, 1.0, 2.0, 3.0) + getDensity<dist_gamma, logform>(p[4], -1.0, 2.0, 3.0);
+        if ((std::abs(regvals[i] - regref) > TSG_NUM_TOL * std::abs(regref)) || (std::abs(logvals[i] - logref) > TSG_NUM_TOL)) pass = false;
+    }
+
+    // normalized densities at single points, compare to known values
+    std::vector<double> normvals;
+    IndependentDensity<regform>({dist_uniform, dist_gaussian, dist_exponential, dist_beta, dist_gamma},
+                                {{-1.0, 3.0}, {0.0, 2.0}, {1.0, 2.0}, {0.0, 1.0, 2.0, 3.0}, {0.0, 2.0, 3.0}}, true)({0.0, 0.0, 1.5, 0.5, 1.0}, normvals);
+    double normref = 0.25 * (1.0 / std::sqrt(4.0 * M_PI)) * (2.0 * std::exp(-1.0)) * 1.5 * (9.0 * std::exp(-3.0));
+    if (std::abs(normvals[0] - normref) > TSG_NUM_TOL) pass = false;
+
+    reportPassFail(pass, "Densities", "batch vs getDensity()");
+    return pass;
+}
+
+bool DreamExternalTester::testHistoryPolicies(){
+    bool passAll = true;
+    int num_dimensions = 2, num_chains = 10;
+    int num_burnup = 20, num_iterations = 53;
+    std::vector<double> lower(num_dimensions, -1.0), upper(num_dimensions, 1.0);
+    std::vector<double> initial_state(num_chains * num_dimensions);
+    for(size_t i=0; i<initial_state.size(); i++) initial_state[i] = -0.9 + 0.09 * (double) i;
+
+    // the parallel sampler with counter-based random streams gives identical chains for every history policy
+    auto sample = [&](TasmanianDREAM &state)->void{
+        CounterRandom master(42);
+        state.setState(initial_state);
+        SampleDREAM(num_burnup, num_iterations,
+            [&](const std::vector<double> &candidates, std::vector<double> &values){
+                auto ix = candidates.begin();
+                for(auto &v : values){
+                    v = getDensity<dist_gaussian>(*ix++, 0.2, 0.09);
+                    v *= getDensity<dist_gaussian>(*ix++, -0.2, 0.04);
+                }
+            },
+            lower, upper, dist_uniform, 0.2, state, 0.5, master);
+    };
+    auto match = [](const std::vector<double> &a, const std::vector<double> &b)->bool{
+        if (a.size() != b.size()) return false;
+        for(size_t i=0; i<a.size(); i++) if (std::abs(a[i] - b[i]) > TSG_NUM_TOL) return false;
+        return true;
+    };
+    size_t snapshot_size = (size_t) (num_chains * num_dimensions);
+
+    TasmanianDREAM full(num_chains, num_dimensions);
+    sample(full);
+    std::vector<double> full_mean, full_var, full_mode;
+    full.getHistoryMeanVariance(full_mean, full_var);
+    full.getApproximateMode(full_mode);
+
+    // thinning, keep every 4-th snapshot
+    TasmanianDREAM thin(num_chains, num_dimensions);
+    thin.setHistoryThinning(4);
+    sample(thin);
+    std::vector<double> expected;
+    for(size_t t=0; t<(size_t) num_iterations; t+=4)
+        expected.insert(expected.end(), full.getHistory().begin() + t * snapshot_size, full.getHistory().begin() + (t + 1) * snapshot_size);
+    bool pass = (thin.getHistory() == expected) && (thin.getNumHistory() == expected.size() / num_dimensions)
+                && (std::abs(thin.getAcceptanceRate() - full.getAcceptanceRate()) < TSG_NUM_TOL);
+    passAll = passAll && pass;
+    if (verbose || !pass) reportPassFail(pass, "History", "thinning");
+
+    // ring buffer, keep the last 5 snapshots (in circular order)
+    TasmanianDREAM ring(num_chains, num_dimensions);
+    ring.setHistoryRingBuffer(5);
+    sample(ring);
+    std::vector<double> ring_mean, ring_var, last_mean, last_var;
+    ring.getHistoryMeanVariance(ring_mean, ring_var);
+    TasmanianDREAM last(num_chains, num_dimensions); // reference with only the last 5 snapshots
+    for(int t=0; t<5; t++){
+        last.setState(std::vector<double>(full.getHistory().end() - (5 - t) * snapshot_size, full.getHistory().end() - (4 - t) * snapshot_size));
+        last.setPDFvalues(std::vector<double>(num_chains, 1.0));
+        last.saveStateHistory(0);
+    }
+    last.getHistoryMeanVariance(last_mean, last_var);
+    pass = (ring.getNumHistory() == (size_t) (5 * num_chains)) && match(ring_mean, last_mean) && match(ring_var, last_var);
+    passAll = passAll && pass;
+    if (verbose || !pass) reportPassFail(pass, "History", "ring buffer");
+
+    // spill to a file in blocks of 7 snapshots, the last block is partial
+    std::vector<double> spill_mean, spill_var, spill_mode;
+    std::string filename = "dreamtest_history.bin";
+    {
+        TasmanianDREAM spill(num_chains, num_dimensions);
+        spill.setHistorySpill(filename, 7);
+        sample(spill);
+        spill.getHistoryMeanVariance(spill_mean, spill_var);
+        spill.getApproximateMode(spill_mode);
+        size_t num_read = 0;
+        bool same = true;
+        spill.readHistory([&](const double x[], const double pdf[], size_t num_chunk)->void{
+            same = same && std::equal(x, x + num_chunk * num_dimensions, full.getHistory().begin() + num_read * num_dimensions)
+                        && std::equal(pdf, pdf + num_chunk, full.getHistoryPDF().begin() + num_read);
+            num_read += num_chunk;
+        });
+        bool copy_throws = false;
+        try{
+            TasmanianDREAM copy = spill;
+        }catch(std::runtime_error &){
+            copy_throws = true;
+        }
+        pass = same && copy_throws && spill.getHistory().empty() && spill.getHistoryPDF().empty() && (num_read == full.getNumHistory()) && (spill.getNumHistory() == full.getNumHistory())
+               && match(spill_mean, full_mean) && match(spill_var, full_var) && (spill_mode == full_mode);
+
+        spill.clearHistory(); // the file is truncated and sampling can continue
+        sample(spill);
+        pass = pass && (spill.getNumHistory() == full.getNumHistory());
+    }
+    std::remove(filename.c_str());
+    passAll = passAll && pass;
+    if (verbose || !pass) reportPassFail(pass, "History", "file spill");
+
+    // online accumulators without history
+    TasmanianDREAM online(num_chains, num_dimensions);
+    AccumulatorMeanVariance meanvar(num_dimensions);
+    AccumulatorCovariance covariance(num_dimensions);
+    AccumulatorMode accmode(num_dimensions);
+    AccumulatorQuantiles quantiles(num_dimensions, {0.1, 0.5, 0.9});
+    online.addHistoryMonitor([&](const double x[], const double pdf[], size_t num_samples)->void{
+        meanvar.update(x, pdf, num_samples);
+        covariance.update(x, pdf, num_samples);
+        accmode.update(x, pdf, num_samples);
+        quantiles.update(x, pdf, num_samples);
+    });
+    online.setKeepHistory(false);
+    sample(online);
+
+    std::vector<double> online_var, online_cov, online_quantiles, exact_cov(num_dimensions * num_dimensions, 0.0), exact_quantiles;
+    meanvar.getVariance(online_var);
+    covariance.getCovariance(online_cov);
+    quantiles.getQuantiles(online_quantiles);
+    size_t num_samples = full.getNumHistory();
+    for(size_t s=0; s<num_samples; s++)
+        for(size_t i=0; i<(size_t) num_dimensions; i++)
+            for(size_t j=0; j<(size_t) num_dimensions; j++)
+                exact_cov[i * num_dimensions + j] += (full.getHistory()[s * num_dimensions + i] - full_mean[i]) * (full.getHistory()[s * num_dimensions + j] - full_mean[j]) / (double) num_samples;
+    for(size_t i=0; i<(size_t) num_dimensions; i++){
+        std::vector<double> marginal(num_samples);
+        for(size_t s=0; s<num_samples; s++) marginal[s] = full.getHistory()[s * num_dimensions + i];
+        std::sort(marginal.begin(), marginal.end());
+        for(auto p : quantiles.getProbabilities()) exact_quantiles.push_back(marginal[(size_t) (p * (double) (num_samples - 1))]);
+    }
+    pass = online.getHistory().empty() && (meanvar.getNumSamples() == num_samples) && (covariance.getNumSamples() == num_samples)
+           && match(meanvar.getMean(), full_mean) && match(online_var, full_var) && match(covariance.getMean(), full_mean) && match(online_cov, exact_cov)
+           && (accmode.getMode() == full_mode) && (std::abs(online.getAcceptanceRate() - full.getAcceptanceRate()) < TSG_NUM_TOL);
+    for(size_t i=0; i<exact_quantiles.size(); i++) pass = pass && (std::abs(online_quantiles[i] - exact_quantiles[i]) < 0.05);
+    if (showvalues){
+        cout << "Quantiles P-square vs exact:" << endl;
+        for(size_t i=0; i<exact_quantiles.size(); i++) cout << setw(15) << online_quantiles[i] << setw(15) << exact_quantiles[i] << endl;
+    }
+    passAll = passAll && pass;
+    if (verbose || !pass) reportPassFail(pass, "History", "online accumulators");
+
+    // early stop, large bounds on the iterations
+    TasmanianDREAM early(num_chains, num_dimensions);
+    early.setEarlyStop(1.05, 500.0);
+    CounterRandom early_master(42);
+    early.setState(initial_state);
+    SampleDREAM(100000, 100000,
+        [&](const std::vector<double> &candidates, std::vector<double> &values){
+            auto ix = candidates.begin();
+            for(auto &v : values){
+                v = getDensity<dist_gaussian>(*ix++, 0.2, 0.09);
+                v *= getDensity<dist_gaussian>(*ix++, -0.2, 0.04);
+            }
+        },
+        lower, upper, dist_uniform, 0.2, early, 0.5, early_master);
+
+    AccumulatorConvergence convergence(num_chains, num_dimensions); // recompute from the history
+    early.readHistory([&](const double x[], const double pdf[], size_t num_chunk)->void{ convergence.update(x, pdf, num_chunk); });
+    std::vector<double> early_mean, early_var;
+    early.getHistoryMeanVariance(early_mean, early_var);
+    pass = (early.getNumHistory() < (size_t) (1000 * num_chains)) && (convergence.getMinESS() >= 500.0) && (convergence.getMaxRhat() < 1.05)
+           && (std::abs(convergence.getMinESS() - early.getConvergenceDiagnostics().getMinESS()) < 1.E-8)
+           && (std::abs(early_mean[0] - 0.2) < 0.1) && (std::abs(early_mean[1] + 0.2) < 0.1);
+    if (showvalues)
+        cout << "Early stop collected " << early.getNumHistory() << " samples, ESS = " << convergence.getMinESS() << ", R-hat = " << convergence.getMaxRhat() << endl;
+    passAll = passAll && pass;
+    if (verbose || !pass) reportPassFail(pass, "History", "early stop");
+
+    reportPassFail(passAll, "History", "policies and accumulators");
 
-    return pass1 && pass2;
+    return passAll;
 }
 
 bool DreamExternalTester::testCustomModel(){
@@ -416,6 +777,105 @@ bool DreamExternalTester::testCustomModel(){
     return passAll;
 }
 
+bool DreamExternalTester::testGaussianLikelihoods(){
+    bool passAll = true;
+    int rseed = 42;
+    size_t num_outputs = 7, num_points = 45; // the correlated likelihood uses blocks of 32 points, test a partial block
+    if (usetimeseed) rseed = getRandomRandomSeed();
+
+    std::minstd_rand park_miller;
+    park_miller.seed(rseed);
+    std::uniform_real_distribution<double> unif(-1.0, 1.0);
+    auto match = [&](const std::vector<double> &a, const std::vector<double> &b)->bool{
+        for(size_t i=0; i<a.size(); i++) if (std::abs(a[i] - b[i]) > 1.E-10 * std::max(1.0, std::abs(a[i]))) return false;
+        return true;
+    };
+
+    std::vector<double> model(num_points * num_outputs), data(num_outputs);
+    for(auto &m : model) m = unif(park_miller);
+    for(auto &d : data) d = unif(park_miller);
+
+    // diagonal covariance, all three likelihoods must match
+    std::vector<double> reference(num_points), result(num_points);
+    LikelihoodGaussIsotropic isotropic(0.3, data, 2.0);
+    isotropic.getLikelihood(logform, model, reference);
+    LikelihoodGaussAnisotropic anisotropic(std::vector<double>(num_outputs, 0.3), data, 2.0);
+    anisotropic.getLikelihood(logform, model, result);
+    bool pass = match(reference, result);
+
+    std::vector<double> variance(num_outputs), covariance(num_outputs * num_outputs, 0.0);
+    for(size_t i=0; i<num_outputs; i++){
+        variance[i] = 0.5 + 0.1 * (double) i;
+        covariance[i * num_outputs + i] = variance[i];
+    }
+    anisotropic.setData(variance, data, 2.0);
+    anisotropic.getLikelihood(logform, model, reference);
+    LikelihoodGaussCorrelated correlated(covariance, data, 2.0);
+    correlated.getLikelihood(logform, model, result);
+    pass = pass && match(reference, result);
+
+    // dense covariance Sigma = L L^T, with data d = L u and model y = L w the likelihood is -0.5 (||w - u||^2 - ||u||^2)
+    std::vector<double> lfactor(num_outputs * num_outputs, 0.0), u(num_outputs), w(model.size());
+    for(size_t i=0; i<num_outputs; i++){
+        for(size_t j=0; j<i; j++) lfactor[i * num_outputs + j] = unif(park_miller);
+        lfactor[i * num_outputs + i] = 2.0 + unif(park_miller);
+    }
+    for(size_t i=0; i<num_outputs; i++)
+        for(size_t j=0; j<num_outputs; j++)
+            covariance[i * num_outputs + j] = std::inner_product(&lfactor[i * num_outputs], &lfactor[i * num_outputs] + std::min(i, j) + 1, &lfactor[j * num_outputs], 0.0);
+    for(auto &v : u) v = unif(park_miller);
+    for(auto &v : w) v = unif(park_miller);
+    for(size_t i=0; i<num_outputs; i++) data[i] = std::inner_product(&lfactor[i * num_outputs], &lfactor[i * num_outputs] + i + 1, u.data(), 0.0);
+    for(size_t p=0; p<num_points; p++){
+        for(size_t i=0; i<num_outputs; i++) model[p * num_outputs + i] = std::inner_product(&lfactor[i * num_outputs], &lfactor[i * num_outputs] + i + 1, &w[p * num_outputs], 0.0);
+        double sum = 0.0;
+        for(size_t i=0; i<num_outputs; i++) sum += (w[p * num_outputs + i] - u[i]) * (w[p * num_outputs + i] - u[i]) - u[i] * u[i];
+        reference[p] = -0.5 * sum;
+    }
+    correlated.setData(covariance, data);
+    correlated.getLikelihood(logform, model, result);
+    pass = pass && match(reference, result);
+
+    correlated.getLikelihood(regform, model, result);
+    for(auto &r : reference) r = exp(r);
+    pass = pass && match(reference, result);
+    passAll = passAll && pass;
+    if (verbose || !pass) reportPassFail(pass, "Likelihood", "dense and diagonal Gaussian");
+
+    // tridiagonal covariance, given as a full matrix and as a band, must match the dense factorization
+    std::fill(covariance.begin(), covariance.end(), 0.0);
+    std::vector<double> band_covariance(2 * num_outputs, 0.0);
+    for(size_t i=0; i<num_outputs; i++){
+        covariance[i * num_outputs + i] = 2.0;
+        band_covariance[2 * i] = 2.0;
+        if (i + 1 < num_outputs){
+            covariance[i * num_outputs + i + 1] = covariance[(i + 1) * num_outputs + i] = -0.9;
+            band_covariance[2 * i + 1] = -0.9;
+        }
+    }
+    correlated.setData(covariance, data, 3.0);
+    correlated.getLikelihood(logform, model, reference);
+    LikelihoodGaussCorrelated banded(covariance, data, 3.0, 1);
+    banded.getLikelihood(logform, model, result);
+    pass = match(reference, result);
+    banded.setData(band_covariance, data, 3.0, 1);
+    banded.getLikelihood(logform, model, result);
+    pass = pass && match(reference, result);
+
+    // not positive definite
+    covariance[0] = -1.0;
+    try{
+        banded.setData(covariance, data, 3.0, 1);
+        pass = false;
+    }catch(std::runtime_error &){}
+    passAll = passAll && pass;
+    if (verbose || !pass) reportPassFail(pass, "Likelihood", "banded Gaussian");
+
+    reportPassFail(passAll, "Likelihood", "Gaussian likelihoods");
+
+    return passAll;
+}
+
 bool DreamExternalTester::testGridModel(){
     bool passAll = true;
     int num_dimensions = 2, num_outputs = 64;
@@ -455,13 +915,67 @@ bool DreamExternalTester::testGridModel(){
     getSinSinModel(2.0, 5.0, 1.0 / ((double) num_outputs), num_outputs, data.data()); // true magnitude 2.0, frequency 5.0
     LikelihoodGaussIsotropic likely(0.01, data);
 
-    // sample using uniform prior
-    SampleDREAMPost<logform>(num_burnup, num_chains, likely, grid, uniform_prior, dist_gaussian, 0.1, state, const_percent<50>, [&]()->double{ return unif(park_miller); });
+    // the fused grid-likelihood evaluations must match the evaluation of the model outputs followed by the likelihood
+    TasGrid::TasmanianSparseGrid coarse; // less points than outputs, uses the precomputed contraction
+    coarse.makeSequenceGrid(num_dimensions, num_outputs, 4, TasGrid::type_iptotal, TasGrid::rule_leja);
+    coarse.setDomainTransform(lower, upper);
+    coarse.getNeededPoints(points);
+    std::vector<double> coarse_values(num_outputs * coarse.getNumPoints());
+    for(int i=0; i<coarse.getNumPoints(); i++) getSinSinModel(points[2*i], points[2*i+1], 1.0 / ((double) num_outputs), num_outputs, &coarse_values[i * num_outputs]);
+    coarse.loadNeededPoints(coarse_values);
+
+    std::vector<double> test_points;
+    genUniformSamples(lower, upper, 70, test_points, [&]()->double{ return unif(park_miller); });
+    bool pass = true;
+    for(auto g : std::vector<TasGrid::TasmanianSparseGrid*>{&coarse, &grid}){
+        FusedGridGaussIsotropic fused(*g, likely);
+        std::vector<double> model_outs, reference(70), result(70);
+        g->evaluateBatch(test_points, model_outs);
+        likely.getLikelihood(logform, model_outs, reference);
+        fused.getGridLikelihood(logform, test_points, result);
+        for(size_t i=0; i<reference.size(); i++)
+            if (std::abs(reference[i] - result[i]) > 1.E-9 * std::max(1.0, std::abs(reference[i]))) pass = false;
+        pass = pass && (fused.usesContraction() == (g == &coarse));
+
+        // changing the data must refresh the precomputed contraction
+        std::vector<double> shifted = data;
+        for(auto &d : shifted) d += 0.5;
+        LikelihoodGaussIsotropic shifted_likely(0.02, shifted, 2.0);
+        LikelihoodGaussIsotropic &gauss_ref = fused; // setData() is virtual, works through a reference to the base class
+        gauss_ref.setData(0.02, shifted, 2.0);
+        shifted_likely.getLikelihood(logform, model_outs, reference);
+        fused.getGridLikelihood(logform, test_points, result);
+        for(size_t i=0; i<reference.size(); i++)
+            if (std::abs(reference[i] - result[i]) > 1.E-9 * std::max(1.0, std::abs(reference[i]))) pass = false;
+    }
+
+    // a class derived from the isotropic likelihood overwrites getLikelihood() and must not be fused
+    struct ScaledGaussIsotropic : public LikelihoodGaussIsotropic{
+        ScaledGaussIsotropic(double variance, const std::vector<double> &data_mean) : LikelihoodGaussIsotropic(variance, data_mean){}
+        void getLikelihood(TypeSamplingForm form, const std::vector<double> &model, std::vector<double> &likely) const{
+            LikelihoodGaussIsotropic::getLikelihood(form, model, likely);
+            for(auto &l : likely) l *= 2.0;
+        }
+    };
+    ScaledGaussIsotropic scaled(0.01, data);
+    auto zero_prior = [](const std::vector<double> &, std::vector<double> &values)->void{ std::fill(values.begin(), values.end(), 0.0); };
+    std::vector<double> model_outs, reference(70), result(70);
+    coarse.evaluateBatch(test_points, model_outs);
+    scaled.getLikelihood(logform, model_outs, reference);
+    makePDFPosteriorGrid<logform>(scaled, coarse, zero_prior)(test_points, result);
+    for(size_t i=0; i<reference.size(); i++)
+        if (std::abs(reference[i] - result[i]) > 1.E-9 * std::max(1.0, std::abs(reference[i]))) pass = false;
+    passAll = passAll && pass;
+    if (verbose || !pass) reportPassFail(pass, "Inference 2D", "fused grid likelihood");
+
+    // sample using uniform prior, reuse the precomputed fused likelihood
+    FusedGridGaussIsotropic fused_likely(grid, likely);
+    SampleDREAMPost<logform>(num_burnup, num_chains, fused_likely, grid, uniform_prior, dist_gaussian, 0.1, state, const_percent<50>, [&]()->double{ return unif(park_miller); });
 
     //printMode(state, "mode");
     std::vector<double> mode;
     state.getApproximateMode(mode);
-    bool pass = ((mode[0] > 1.0) && (mode[0] < 3.0) && (mode[1] > 4.5) && (mode[1] < 5.5));
+    pass = ((mode[0] > 1.0) && (mode[0] < 3.0) && (mode[1] > 4.5) && (mode[1] < 5.5));
     passAll = passAll && pass;
     if (verbose || !pass) reportPassFail(pass, "Inference 2D", "grid frequency model");
 
@@ -473,10 +987,11 @@ bool DreamExternalTester::testGridModel(){
 bool DreamExternalTester::testPosteriorDistributions(){
     // Tests using posteriors constructed from model and prior distributions
 
-    bool pass1 = testCustomModel();
-    bool pass2 = testGridModel();
+    bool pass1 = testGaussianLikelihoods();
+    bool pass2 = testCustomModel();
+    bool pass3 = testGridModel();
 
-    return pass1 && pass2;
+    return pass1 && pass2 && pass3;
 }
 
 bool DreamExternalTester::performTests(TypeDREAMTest test){
@@ -507,6 +1022,140 @@ bool DreamExternalTester::performTests(TypeDREAMTest test){
     return pass;
 }
 
+void DreamExternalTester::benchmark(int argc, const char **argv){
+    if ((argc < 3) || (strcmp(argv[2],"help") == 0)){
+        cout << "Accepted benchmarks:" << endl;
+        cout << "./dreamtest -bench sample <num chains> <num dimensions> <num burnup> <num collect> <optional: parallel>" << endl;
+        cout << "./dreamtest -bench prior <num points> <num dimensions> <num repeats>" << endl;
+        cout << "./dreamtest -bench posterior <num outputs> <grid level> <num candidates> <num repeats>" << endl;
+        return;
+    }
+    if (strcmp(argv[2],"sample") == 0){
+        if (argc < 7){
+            cout << "./dreamtest -bench sample <num chains> <num dimensions> <num burnup> <num collect> <optional: parallel>" << endl;
+            return;
+        }
+        int num_chains = atoi(argv[3]), num_dimensions = atoi(argv[4]), num_burnup = atoi(argv[5]), num_collect = atoi(argv[6]);
+        cout << "Benchmark SampleDREAM() using the standard normal distribution (logform) as a cheap probability distribution" << endl;
+        cout << "chains: " << num_chains << "  dimensions: " << num_dimensions << "  iterations: " << num_burnup + num_collect << endl;
+
+        std::minstd_rand park_miller(42);
+        std::uniform_real_distribution<double> unif(0.0, 1.0);
+        auto random01 = [&]()->double{ return unif(park_miller); };
+
+        TasmanianDREAM state(num_chains, num_dimensions);
+        std::vector<double> initial_state;
+        genGaussianSamples(std::vector<double>(num_dimensions, 0.0), std::vector<double>(num_dimensions, 1.0), num_chains, initial_state, random01);
+        state.setState(initial_state);
+
+        auto log_normal = [&](const std::vector<double> &candidates, std::vector<double> &values)->void{
+            auto ic = candidates.begin();
+            for(auto &v : values){
+                double nrm = 0.0;
+                for(int j=0; j<num_dimensions; j++){ nrm += *ic * *ic; ic++; }
+                v = -0.5 * nrm;
+            }
+        };
+        bool parallel = ((argc > 7) && (strcmp(argv[7],"parallel") == 0));
+        CounterRandom master(42);
+
+        auto start = std::chrono::steady_clock::now();
+        if (parallel){
+            SampleDREAM<logform>(num_burnup, num_collect, log_normal, [&](const std::vector<double> &)->bool{ return true; },
+                                 dist_gaussian, 0.1, state, 0.5, master);
+        }else{
+            SampleDREAM<logform>(num_burnup, num_collect, log_normal, [&](const std::vector<double> &)->bool{ return true; },
+                                 dist_gaussian, 0.1, state, const_percent<50>, random01);
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        cout << "time: " << elapsed << " seconds,  iterations per second: " << ((double) (num_burnup + num_collect)) / elapsed << endl;
+        cout << "acceptance rate: " << state.getAcceptanceRate() << endl;
+    }else if (strcmp(argv[2],"prior") == 0){
+        if (argc < 6){
+            cout << "./dreamtest -bench prior <num points> <num dimensions> <num repeats>" << endl;
+            return;
+        }
+        int num_points = atoi(argv[3]), num_dimensions = atoi(argv[4]), num_repeats = atoi(argv[5]);
+        cout << "Benchmark Gaussian and Beta prior (alternating dimensions), scalar getDensity() vs batched IndependentDensity" << endl;
+
+        std::vector<TypeDistribution> dists(num_dimensions);
+        std::vector<std::vector<double>> params(num_dimensions);
+        for(int i=0; i<num_dimensions; i++){
+            dists[i] = (i % 2 == 0) ? dist_gaussian : dist_beta;
+            params[i] = (i % 2 == 0) ? std::vector<double>{0.0, 0.5} : std::vector<double>{-1.0, 1.0, 2.5, 3.5};
+        }
+        std::vector<double> candidates((size_t) num_points * (size_t) num_dimensions), values((size_t) num_points);
+        std::minstd_rand park_miller(42);
+        std::uniform_real_distribution<double> unif(-0.99, 0.99);
+        for(auto &c : candidates) c = unif(park_miller);
+
+        auto scalar = [&](const std::vector<double> &x, std::vector<double> &vals)->void{
+            auto ix = x.begin();
+            for(auto &v : vals){
+                v = 1.0;
+                for(int i=0; i<num_dimensions; i++){
+                    const std::vector<double> &p = params[i];
+                    v *= (i % 2 == 0) ? getDensity<dist_gaussian>(*ix++, p[0], p[1]) : getDensity<dist_beta>(*ix++, p[0], p[1], p[2], p[3]);
+                }
+            }
+        };
+        IndependentDensity<regform> batched(dists, params);
+
+        double checksum = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        for(int r=0; r<num_repeats; r++){ scalar(candidates, values); checksum += values[0]; }
+        double elapsed_scalar = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        start = std::chrono::steady_clock::now();
+        for(int r=0; r<num_repeats; r++){ batched(candidates, values); checksum += values[0]; }
+        double elapsed_batched = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        cout << "scalar:  " << elapsed_scalar << " seconds" << endl;
+        cout << "batched: " << elapsed_batched << " seconds" << endl;
+        cout << "checksum: " << checksum << endl;
+    }else if (strcmp(argv[2],"posterior") == 0){
+        if (argc < 7){
+            cout << "./dreamtest -bench posterior <num outputs> <grid level> <num candidates> <num repeats>" << endl;
+            return;
+        }
+        int num_outputs = atoi(argv[3]), level = atoi(argv[4]), num_candidates = atoi(argv[5]), num_repeats = atoi(argv[6]);
+        std::vector<double> lower = {0.0, 2.0}, upper = {4.0, 6.0};
+        TasGrid::TasmanianSparseGrid grid;
+        grid.makeSequenceGrid(2, num_outputs, level, TasGrid::type_iptotal, TasGrid::rule_leja);
+        grid.setDomainTransform(lower, upper);
+        std::vector<double> points, values(grid.getNumPoints() * num_outputs);
+        grid.getNeededPoints(points);
+        for(int i=0; i<grid.getNumPoints(); i++) getSinSinModel(points[2*i], points[2*i+1], 1.0 / ((double) num_outputs), num_outputs, &values[i * num_outputs]);
+        grid.loadNeededPoints(values);
+        cout << "Benchmark posterior with Gaussian likelihood, grid points: " << grid.getNumPoints() << "  outputs: " << num_outputs << endl;
+
+        std::vector<double> data(num_outputs);
+        getSinSinModel(2.0, 5.0, 1.0 / ((double) num_outputs), num_outputs, data.data());
+        LikelihoodGaussIsotropic likely(0.01, data);
+
+        std::minstd_rand park_miller(42);
+        std::uniform_real_distribution<double> unif(0.0, 1.0);
+        std::vector<double> candidates;
+        genUniformSamples(lower, upper, num_candidates, candidates, [&]()->double{ return unif(park_miller); });
+        std::vector<double> result(num_candidates);
+
+        auto separate = makePDFPosterior<logform>(likely, makeGridModel(grid), uniform_prior);
+        auto fused = makePDFPosteriorGrid<logform>(likely, grid, uniform_prior);
+
+        double checksum = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        for(int r=0; r<num_repeats; r++){ separate(candidates, result); checksum += result[0]; }
+        double elapsed_separate = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        start = std::chrono::steady_clock::now();
+        for(int r=0; r<num_repeats; r++){ fused(candidates, result); checksum += result[0]; }
+        double elapsed_fused = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        cout << "separate: " << elapsed_separate << " seconds" << endl;
+        cout << "fused:    " << elapsed_fused << " seconds" << endl;
+        cout << "checksum: " << checksum << endl;
+    }
+}
+
 void testDebug(){
     cout << "Debug Test" << endl;
     cout << "Put here testing code and call this with ./dreamtest debug" << endl;
@@ -39,9 +39,16 @@
 #include <vector>
 #include <numeric>
 #include <random>
+#include <chrono>
+#include <atomic>
+#include <thread>
 
 #include "TasmanianDREAM.hpp"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using std::cout;
 using std::cerr;
 using std::endl;
@@ -167,6 +174,9 @@ public:
     //! \brief Main test driver, selects the test to run and writes begin and end information, returns \b false if any test fails.
     bool performTests(TypeDREAMTest test);
 
+    //! \brief Run a benchmark, e.g., the speed of the sampler, see \b ./dreamtest -bench help for the list of benchmarks.
+    void benchmark(int argc, const char **argv);
+
 protected:
     //! \brief Perform test for sampling from known distributions.
     bool testKnownDistributions();
@@ -177,9 +187,21 @@ protected:
     //! \brief Generate 2D Gaussian samples using DREAM and Sparse Grids.
     bool testGaussian2D();
 
+    //! \brief Compare the batched \b IndependentDensity against \b getDensity() and known normalized values.
+    bool testIndependentDensity();
+
+    //! \brief Compare the history saved with thinning, ring buffer, file spill, and the online accumulators against the full history.
+    bool testHistoryPolicies();
+
+    //! \brief Sample a bimodal distribution with parallel tempering, the chains start in one mode and must find the other.
+    bool testTempering();
+
     //! \brief Perform test for sampling from inferred posterior distributions.
     bool testPosteriorDistributions();
 
+    //! \brief Compare the anisotropic and correlated Gaussian likelihoods against the isotropic case and known values.
+    bool testGaussianLikelihoods();
+
     //! \brief Generate samples from custom models.
     bool testCustomModel();
     
@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2017, Miroslav Stoyanov
+ *
+ * This file is part of
+ * Toolkit for Adaptive Stochastic Modeling And Non-Intrusive ApproximatioN: TASMANIAN
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+ *    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * UT-BATTELLE, LLC AND THE UNITED STATES GOVERNMENT MAKE NO REPRESENTATIONS AND DISCLAIM ALL WARRANTIES, BOTH EXPRESSED AND IMPLIED.
+ * THERE ARE NO EXPRESS OR IMPLIED WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT THE USE OF THE SOFTWARE WILL NOT INFRINGE ANY PATENT,
+ * COPYRIGHT, TRADEMARK, OR OTHER PROPRIETARY RIGHTS, OR THAT THE SOFTWARE WILL ACCOMPLISH THE INTENDED RESULTS OR THAT THE SOFTWARE OR ITS USE WILL NOT RESULT IN INJURY OR DAMAGE.
+ * THE USER ASSUMES RESPONSIBILITY FOR ALL LIABILITIES, PENALTIES, FINES, CLAIMS, CAUSES OF ACTION, AND COSTS AND EXPENSES, CAUSED BY, RESULTING FROM OR ARISING OUT OF,
+ * IN WHOLE OR IN PART THE USE, STORAGE OR DISPOSAL OF THE SOFTWARE.
+ */
+
+#ifndef __TASMANIAN_DREAM_ACCUMULATORS_CPP
+#define __TASMANIAN_DREAM_ACCUMULATORS_CPP
+
+#include <array>
+#include <limits>
+
+#include "tsgDreamAccumulators.hpp"
+
+namespace TasDREAM{
+
+void AccumulatorMeanVariance::update(const double x[], const double[], size_t cnum_samples){
+    for(size_t s=0; s<cnum_samples; s++){
+        double n = (double) (++num_samples);
+        for(size_t i=0; i<num_dimensions; i++){
+            double d = *x - mean[i];
+            mean[i] += d / n;
+            square_deviation[i] += d * (*x++ - mean[i]);
+        }
+    }
+}
+void AccumulatorMeanVariance::clear(){
+    num_samples = 0;
+    std::fill(mean.begin(), mean.end(), 0.0);
+    std::fill(square_deviation.begin(), square_deviation.end(), 0.0);
+}
+void AccumulatorMeanVariance::getVariance(std::vector<double> &var) const{
+    var.resize(num_dimensions);
+    double n = (num_samples == 0) ? 1.0 : (double) num_samples;
+    std::transform(square_deviation.begin(), square_deviation.end(), var.begin(), [&](double s)->double{ return s / n; });
+}
+
+void AccumulatorCovariance::update(const double x[], const double[], size_t cnum_samples){
+    for(size_t s=0; s<cnum_samples; s++){
+        double n = (double) (++num_samples);
+        for(size_t i=0; i<num_dimensions; i++){
+            delta[i] = x[i] - mean[i]; // deviation from the old mean
+            mean[i] += delta[i] / n;
+        }
+        auto ic = comoment.begin();
+        for(size_t i=0; i<num_dimensions; i++){
+            double d = x[i] - mean[i]; // deviation from the new mean
+            for(size_t j=0; j<num_dimensions; j++) *ic++ += delta[j] * d;
+        }
+        x += num_dimensions;
+    }
+}
+void AccumulatorCovariance::clear(){
+    num_samples = 0;
+    std::fill(mean.begin(), mean.end(), 0.0);
+    std::fill(comoment.begin(), comoment.end(), 0.0);
+}
+void AccumulatorCovariance::getCovariance(std::vector<double> &cov) const{
+    cov.resize(comoment.size());
+    double n = (num_samples == 0) ? 1.0 : (double) num_samples;
+    std::transform(comoment.begin(), comoment.end(), cov.begin(), [&](double c)->double{ return c / n; });
+}
+
+void AccumulatorMode::update(const double x[], const double pdf[], size_t num_samples){
+    for(size_t s=0; s<num_samples; s++){
+        if (!found || (pdf[s] > best)){
+            found = true;
+            best = pdf[s];
+            std::copy_n(x + s * num_dimensions, num_dimensions, mode.data());
+        }
+    }
+}
+
+AccumulatorQuantiles::AccumulatorQuantiles(int cnum_dimensions, const std::vector<double> &cprobabilities) :
+    num_dimensions((size_t) cnum_dimensions), probabilities(cprobabilities){
+    if (std::any_of(probabilities.begin(), probabilities.end(), [](double p)->bool{ return (p <= 0.0) || (p >= 1.0); }))
+        throw std::invalid_argument("ERROR: the probabilities of the quantiles must be in (0, 1)");
+    markers.resize(num_dimensions * probabilities.size());
+    clear();
+}
+
+void AccumulatorQuantiles::clear(){
+    for(auto &m : markers) m.count = 0;
+}
+
+void AccumulatorQuantiles::update(const double x[], const double[], size_t num_samples){
+    size_t num_probs = probabilities.size();
+    for(size_t s=0; s<num_samples; s++){
+        auto im = markers.begin();
+        for(size_t i=0; i<num_dimensions; i++){
+            for(size_t j=0; j<num_probs; j++) add(*im++, probabilities[j], *x);
+            x++;
+        }
+    }
+}
+
+void AccumulatorQuantiles::add(Markers &m, double p, double x){
+    if (m.count < 5){ // collect the first five samples
+        m.q[m.count++] = x;
+        if (m.count == 5){
+            std::sort(m.q, m.q + 5);
+            for(int i=0; i<5; i++) m.n[i] = (double) (i + 1);
+            m.np[0] = 1.0; m.np[1] = 1.0 + 2.0 * p; m.np[2] = 1.0 + 4.0 * p; m.np[3] = 3.0 + 2.0 * p; m.np[4] = 5.0;
+        }
+        return;
+    }
+
+    int k; // find the cell containing x, adjust the extreme markers
+    if (x < m.q[0]){
+        m.q[0] = x;
+        k = 0;
+    }else if (x >= m.q[4]){
+        m.q[4] = x;
+        k = 3;
+    }else{
+        k = 0;
+        while(x >= m.q[k+1]) k++;
+    }
+
+    for(int i=k+1; i<5; i++) m.n[i] += 1.0;
+    m.np[1] += 0.5 * p; m.np[2] += p; m.np[3] += 0.5 * (1.0 + p); m.np[4] += 1.0;
+    m.count++;
+
+    for(int i=1; i<4; i++){ // adjust the middle markers
+        double d = m.np[i] - m.n[i];
+        if (((d >= 1.0) && (m.n[i+1] - m.n[i] > 1.0)) || ((d <= -1.0) && (m.n[i-1] - m.n[i] < -1.0))){
+            double s = (d >= 0.0) ? 1.0 : -1.0;
+            double qp = m.q[i] + s / (m.n[i+1] - m.n[i-1]) * ((m.n[i] - m.n[i-1] + s) * (m.q[i+1] - m.q[i]) / (m.n[i+1] - m.n[i])
+                                                             + (m.n[i+1] - m.n[i] - s) * (m.q[i] - m.q[i-1]) / (m.n[i] - m.n[i-1]));
+            if ((m.q[i-1] < qp) && (qp < m.q[i+1])){ // parabolic prediction
+                m.q[i] = qp;
+            }else{ // linear prediction
+                int is = (s > 0.0) ? i+1 : i-1;
+                m.q[i] += s * (m.q[is] - m.q[i]) / (m.n[is] - m.n[i]);
+            }
+            m.n[i] += s;
+        }
+    }
+}
+
+double AccumulatorQuantiles::estimate(const Markers &m, double p){
+    if (m.count == 0) return 0.0;
+    if (m.count < 5){ // exact quantile of the few samples
+        // insertion sort with an explicit bound, std::sort() unrolls 16 entries and trips -Warray-bounds
+        size_t num_samples = std::min<size_t>(m.count, 5);
+        std::array<double, 5> q;
+        for(size_t i=0; i<num_samples; i++){
+            size_t j = i;
+            while((j > 0) && (q[j-1] > m.q[i])){
+                q[j] = q[j-1];
+                j--;
+            }
+            q[j] = m.q[i];
+        }
+        return q[std::min<size_t>((size_t) std::floor(p * (double) (num_samples - 1) + 0.5), num_samples - 1)];
+    }
+    return m.q[2];
+}
+
+void AccumulatorQuantiles::getQuantiles(std::vector<double> &quantiles) const{
+    quantiles.resize(markers.size());
+    size_t num_probs = probabilities.size();
+    for(size_t i=0; i<markers.size(); i++) quantiles[i] = estimate(markers[i], probabilities[i % num_probs]);
+}
+
+void AccumulatorConvergence::update(const double x[], const double[], size_t num_samples){
+    size_t num_entries = num_chains * num_dimensions;
+    for(size_t s=0; s<num_samples / num_chains; s++){
+        if (num_snapshots == 0) // shift by the first sample, improves the accuracy of the sums
+            std::copy_n(x, num_entries, shift.data());
+        for(size_t i=0; i<num_entries; i++){
+            double y = x[i] - shift[i];
+            sums[i] += y;
+            squares[i] += y * y;
+            if (num_snapshots > 0) lagged[i] += y * last[i];
+            last[i] = y;
+        }
+        x += num_entries;
+        num_snapshots++;
+    }
+}
+
+void AccumulatorConvergence::clear(){
+    num_snapshots = 0;
+    std::fill(sums.begin(), sums.end(), 0.0);
+    std::fill(squares.begin(), squares.end(), 0.0);
+    std::fill(lagged.begin(), lagged.end(), 0.0);
+}
+
+double AccumulatorConvergence::computeRhat(size_t d) const{
+    double n = (double) num_snapshots, m = (double) num_chains;
+    double within = 0.0, mean = 0.0, mean_square = 0.0;
+    for(size_t c=0; c<num_chains; c++){
+        size_t i = c * num_dimensions + d;
+        double chain_mean = shift[i] + sums[i] / n;
+        within += (squares[i] - sums[i] * sums[i] / n) / (n - 1.0);
+        mean += chain_mean;
+        mean_square += chain_mean * chain_mean;
+    }
+    within /= m;
+    mean /= m;
+    double between = std::max(mean_square / m - mean * mean, 0.0) * m / (m - 1.0); // this is B / n
+    if (within > 0.0){
+        return std::sqrt(((n - 1.0) / n * within + between) / within);
+    }else{
+        return (between > 0.0) ? std::numeric_limits<double>::infinity() : 1.0;
+    }
+}
+
+void AccumulatorConvergence::getRhat(std::vector<double> &rhat) const{
+    rhat.resize(num_dimensions);
+    if ((num_snapshots < 2) || (num_chains < 2)){
+        std::fill(rhat.begin(), rhat.end(), std::numeric_limits<double>::infinity());
+        return;
+    }
+    for(size_t d=0; d<num_dimensions; d++) rhat[d] = computeRhat(d);
+}
+
+double AccumulatorConvergence::getMaxRhat() const{
+    if ((num_snapshots < 2) || (num_chains < 2)) return std::numeric_limits<double>::infinity();
+    double rhat = computeRhat(0);
+    for(size_t d=1; d<num_dimensions; d++) rhat = std::max(rhat, computeRhat(d));
+    return rhat;
+}
+
+double AccumulatorConvergence::computeESS(size_t d) const{
+    double n = (double) num_snapshots, total = (double) (num_snapshots * num_chains);
+    double autocov0 = 0.0, autocov1 = 0.0;
+    for(size_t c=0; c<num_chains; c++){
+        size_t i = c * num_dimensions + d;
+        double ym = sums[i] / n;
+        autocov0 += squares[i] - n * ym * ym;
+        autocov1 += lagged[i] - ym * (2.0 * sums[i] - last[i]) + (n - 1.0) * ym * ym; // the first shifted sample is zero
+    }
+    double rho = (autocov0 > 0.0) ? std::min(std::max(autocov1 / autocov0, 0.0), 1.0) : 0.0;
+    return total * (1.0 - rho) / (1.0 + rho);
+}
+
+void AccumulatorConvergence::getESS(std::vector<double> &ess) const{
+    ess.resize(num_dimensions);
+    if (num_snapshots < 2){
+        std::fill(ess.begin(), ess.end(), (double) (num_snapshots * num_chains));
+        return;
+    }
+    for(size_t d=0; d<num_dimensions; d++) ess[d] = computeESS(d);
+}
+
+double AccumulatorConvergence::getMinESS() const{
+    if (num_snapshots < 2) return (double) (num_snapshots * num_chains);
+    double ess = computeESS(0);
+    for(size_t d=1; d<num_dimensions; d++) ess = std::min(ess, computeESS(d));
+    return ess;
+}
+
+}
+
+#endif
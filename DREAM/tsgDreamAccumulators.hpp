@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2017, Miroslav Stoyanov
+ *
+ * This file is part of
+ * Toolkit for Adaptive Stochastic Modeling And Non-Intrusive ApproximatioN: TASMANIAN
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+ *    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * UT-BATTELLE, LLC AND THE UNITED STATES GOVERNMENT MAKE NO REPRESENTATIONS AND DISCLAIM ALL WARRANTIES, BOTH EXPRESSED AND IMPLIED.
+ * THERE ARE NO EXPRESS OR IMPLIED WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT THE USE OF THE SOFTWARE WILL NOT INFRINGE ANY PATENT,
+ * COPYRIGHT, TRADEMARK, OR OTHER PROPRIETARY RIGHTS, OR THAT THE SOFTWARE WILL ACCOMPLISH THE INTENDED RESULTS OR THAT THE SOFTWARE OR ITS USE WILL NOT RESULT IN INJURY OR DAMAGE.
+ * THE USER ASSUMES RESPONSIBILITY FOR ALL LIABILITIES, PENALTIES, FINES, CLAIMS, CAUSES OF ACTION, AND COSTS AND EXPENSES, CAUSED BY, RESULTING FROM OR ARISING OUT OF,
+ * IN WHOLE OR IN PART THE USE, STORAGE OR DISPOSAL OF THE SOFTWARE.
+ */
+
+#ifndef __TASMANIAN_DREAM_ACCUMULATORS_HPP
+#define __TASMANIAN_DREAM_ACCUMULATORS_HPP
+
+#include "tsgDreamEnumerates.hpp"
+
+//! \file tsgDreamAccumulators.hpp
+//! \brief Online statistics computed from the DREAM samples.
+//! \author Miroslav Stoyanov
+//! \ingroup TasmanianDREAM
+//!
+//! Defines accumulators that update statistics one sample at a time without storing the history.
+
+/*!
+ * \ingroup TasmanianDREAM
+ * \addtogroup DREAMAccumulators Online statistics
+ *
+ * Accumulators compute statistics of the samples one sample at a time, in constant memory.
+ * Each accumulator has an \b update() method with the same signature as the reader used by
+ * \b TasmanianDREAM::readHistory() and the monitor used by \b TasmanianDREAM::addHistoryMonitor(), e.g.,
+ * \code
+ *   AccumulatorMeanVariance meanvar(num_dimensions);
+ *   state.addHistoryMonitor([&](const double x[], const double pdf[], size_t num_samples)->void{
+ *       meanvar.update(x, pdf, num_samples);
+ *   });
+ *   state.setKeepHistory(false); // the statistics do not need the history
+ * \endcode
+ */
+
+namespace TasDREAM{
+
+//! \brief Mean and variance computed with the Welford algorithm.
+//! \ingroup DREAMAccumulators
+
+//! The update cost is O(num_dimensions) per sample, the mean and variance are available at any time.
+class AccumulatorMeanVariance{
+public:
+    //! \brief Constructor for the given number of dimensions.
+    AccumulatorMeanVariance(int cnum_dimensions) : num_dimensions((size_t) cnum_dimensions), num_samples(0),
+        mean(num_dimensions, 0.0), square_deviation(num_dimensions, 0.0){}
+
+    //! \brief Add \b num_samples vectors stored in \b x, the \b pdf values are not used.
+    void update(const double x[], const double pdf[], size_t cnum_samples);
+    //! \brief Forget all samples.
+    void clear();
+
+    //! \brief Return the number of samples.
+    size_t getNumSamples() const{ return num_samples; }
+    //! \brief Return the current mean.
+    const std::vector<double>& getMean() const{ return mean; }
+    //! \brief Return the current (population) variance, i.e., normalized by the number of samples.
+    void getVariance(std::vector<double> &var) const;
+
+private:
+    size_t num_dimensions, num_samples;
+    std::vector<double> mean, square_deviation;
+};
+
+//! \brief Mean and covariance matrix computed with the Welford algorithm.
+//! \ingroup DREAMAccumulators
+
+//! The update cost is O(num_dimensions^2) per sample.
+class AccumulatorCovariance{
+public:
+    //! \brief Constructor for the given number of dimensions.
+    AccumulatorCovariance(int cnum_dimensions) : num_dimensions((size_t) cnum_dimensions), num_samples(0),
+        mean(num_dimensions, 0.0), comoment(num_dimensions * num_dimensions, 0.0), delta(num_dimensions){}
+
+    //! \brief Add \b num_samples vectors stored in \b x, the \b pdf values are not used.
+    void update(const double x[], const double pdf[], size_t cnum_samples);
+    //! \brief Forget all samples.
+    void clear();
+
+    //! \brief Return the number of samples.
+    size_t getNumSamples() const{ return num_samples; }
+    //! \brief Return the current mean.
+    const std::vector<double>& getMean() const{ return mean; }
+    //! \brief Return the current (population) covariance, the matrix is stored in row-major format with size num_dimensions squared.
+    void getCovariance(std::vector<double> &cov) const;
+
+private:
+    size_t num_dimensions, num_samples;
+    std::vector<double> mean, comoment, delta;
+};
+
+//! \brief Keeps the sample with the largest value of the probability distribution.
+//! \ingroup DREAMAccumulators
+
+//! The update cost is O(1) per sample, or O(num_dimensions) when the mode changes.
+class AccumulatorMode{
+public:
+    //! \brief Constructor for the given number of dimensions.
+    AccumulatorMode(int cnum_dimensions) : num_dimensions((size_t) cnum_dimensions), found(false), best(0.0), mode(num_dimensions, 0.0){}
+
+    //! \brief Add \b num_samples vectors stored in \b x with the associated \b pdf values.
+    void update(const double x[], const double pdf[], size_t num_samples);
+    //! \brief Forget all samples.
+    void clear(){ found = false; best = 0.0; std::fill(mode.begin(), mode.end(), 0.0); }
+
+    //! \brief Return the sample with the largest value of the probability distribution (all zeros if no samples have been given).
+    const std::vector<double>& getMode() const{ return mode; }
+    //! \brief Return the value of the probability distribution at the mode.
+    double getModeValue() const{ return best; }
+
+private:
+    size_t num_dimensions;
+    bool found;
+    double best;
+    std::vector<double> mode;
+};
+
+//! \brief Estimates marginal quantiles using the P-square algorithm of Jain and Chlamtac.
+//! \ingroup DREAMAccumulators
+
+//! Each quantile of each dimension is tracked with five markers, updated in O(1) time per sample,
+//! the memory does not depend on the number of samples.
+//! The estimate is exact for the first five samples and approximate afterwards.
+class AccumulatorQuantiles{
+public:
+    //! \brief Constructor for the given number of dimensions and the list of \b probabilities, each in (0, 1).
+    AccumulatorQuantiles(int cnum_dimensions, const std::vector<double> &cprobabilities);
+
+    //! \brief Add \b num_samples vectors stored in \b x, the \b pdf values are not used.
+    void update(const double x[], const double pdf[], size_t num_samples);
+    //! \brief Forget all samples.
+    void clear();
+
+    //! \brief Return the probabilities of the quantiles.
+    const std::vector<double>& getProbabilities() const{ return probabilities; }
+    //! \brief Return the estimated quantiles, the quantiles of the first dimension are followed by the second dimension and so on.
+    void getQuantiles(std::vector<double> &quantiles) const;
+
+protected:
+    //! \internal
+    //! \brief The five markers of the P-square algorithm.
+    struct Markers{
+        //! \brief Heights of the markers.
+        double q[5];
+        //! \brief Actual positions of the markers.
+        double n[5];
+        //! \brief Desired positions of the markers.
+        double np[5];
+        //! \brief Number of samples seen by the markers.
+        size_t count;
+    };
+
+    //! \brief Add the sample \b x to the markers \b m that track probability \b p.
+    static void add(Markers &m, double p, double x);
+    //! \brief Return the estimated quantile \b p from the markers.
+    static double estimate(const Markers &m, double p);
+
+private:
+    size_t num_dimensions;
+    std::vector<double> probabilities;
+    std::vector<Markers> markers;
+};
+
+//! \brief Gelman-Rubin potential scale reduction factor (R-hat) and effective sample size across the chains.
+//! \ingroup DREAMAccumulators
+
+//! The accumulator expects whole snapshots of the chains, i.e., the number of samples in each update must be a multiple
+//! of the number of chains and sample \b s belongs to chain \b s modulo \b num_chains.
+//! For each chain and dimension, the accumulator keeps the shifted sums of the samples, the squares,
+//! and the lag-one products, thus the update cost is O(num_chains times num_dimensions) per snapshot.
+//!
+//! The R-hat uses the classical formula with within-chain variance \f$ W \f$ and between-chain variance \f$ B \f$
+//! \f$ \hat R = \sqrt{ ( (n-1) W / n + B / n ) / W } \f$, where \b n is the number of snapshots.
+//! The effective sample size uses the lag-one autocorrelation \f$ \rho \f$ pooled across the chains (i.e., AR(1) approximation),
+//! \f$ ESS = M n (1 - \rho) / (1 + \rho) \f$, where \b M is the number of chains.
+class AccumulatorConvergence{
+public:
+    //! \brief Constructor for the given number of chains and dimensions.
+    AccumulatorConvergence(int cnum_chains, int cnum_dimensions) : num_chains((size_t) cnum_chains), num_dimensions((size_t) cnum_dimensions),
+        num_snapshots(0), shift(num_chains * num_dimensions, 0.0), last(num_chains * num_dimensions, 0.0), sums(num_chains * num_dimensions, 0.0),
+        squares(num_chains * num_dimensions, 0.0), lagged(num_chains * num_dimensions, 0.0){}
+
+    //! \brief Add the snapshots stored in \b x, \b num_samples must be a multiple of the number of chains, the \b pdf values are not used.
+    void update(const double x[], const double pdf[], size_t num_samples);
+    //! \brief Forget all samples.
+    void clear();
+
+    //! \brief Return the number of snapshots, i.e., the length of each chain.
+    size_t getNumSnapshots() const{ return num_snapshots; }
+
+    //! \brief Return the R-hat for each dimension, the values are infinite if there are less than two snapshots or chains.
+    void getRhat(std::vector<double> &rhat) const;
+    //! \brief Return the largest R-hat over all dimensions, does not allocate memory and can be called after every update.
+    double getMaxRhat() const;
+
+    //! \brief Return the effective sample size for each dimension.
+    void getESS(std::vector<double> &ess) const;
+    //! \brief Return the smallest effective sample size over all dimensions, does not allocate memory and can be called after every update.
+    double getMinESS() const;
+
+protected:
+    //! \brief Return the R-hat for dimension \b d, assumes at least two snapshots and chains.
+    double computeRhat(size_t d) const;
+    //! \brief Return the effective sample size for dimension \b d, assumes at least two snapshots.
+    double computeESS(size_t d) const;
+
+private:
+    size_t num_chains, num_dimensions, num_snapshots;
+    std::vector<double> shift, last, sums, squares, lagged;
+};
+
+}
+
+#endif
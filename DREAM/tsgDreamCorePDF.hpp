@@ -42,6 +42,82 @@
 
 namespace TasDREAM{
 
+//! \internal
+//! \brief Formulas for the unscaled one dimensional densities, specialized for each distribution and form, see \b getDensity().
+//! \ingroup DREAMPDF
+template<TypeDistribution distribution, TypeSamplingForm form> struct DensityKernel{};
+
+//! \internal
+//! \brief Uniform density, regular form.
+//! \ingroup DREAMPDF
+template<> struct DensityKernel<dist_uniform, regform>{
+    //! \brief Returns 1.0, ignores the parameters.
+    template<typename... Params> static constexpr double eval(double, Params...){ return 1.0; }
+};
+//! \internal
+//! \brief Uniform density, log form.
+//! \ingroup DREAMPDF
+template<> struct DensityKernel<dist_uniform, logform>{
+    //! \brief Returns 0.0, ignores the parameters.
+    template<typename... Params> static constexpr double eval(double, Params...){ return 0.0; }
+};
+//! \internal
+//! \brief Gaussian density, regular form.
+//! \ingroup DREAMPDF
+template<> struct DensityKernel<dist_gaussian, regform>{
+    //! \brief Density with the given \b mean and \b variance.
+    static double eval(double x, double mean, double variance){ return std::exp(-0.5 * (x - mean) * (x - mean) / variance); }
+};
+//! \internal
+//! \brief Gaussian density, log form.
+//! \ingroup DREAMPDF
+template<> struct DensityKernel<dist_gaussian, logform>{
+    //! \brief Log of the density with the given \b mean and \b variance.
+    static constexpr double eval(double x, double mean, double variance){ return -0.5 * (x - mean) * (x - mean) / variance; }
+};
+//! \internal
+//! \brief Exponential density, regular form.
+//! \ingroup DREAMPDF
+template<> struct DensityKernel<dist_exponential, regform>{
+    //! \brief Density with the given \b lower bound and \b rate.
+    static double eval(double x, double lower, double rate){ return std::exp(-rate * (x - lower)); }
+};
+//! \internal
+//! \brief Exponential density, log form.
+//! \ingroup DREAMPDF
+template<> struct DensityKernel<dist_exponential, logform>{
+    //! \brief Log of the density with the given \b lower bound and \b rate.
+    static constexpr double eval(double x, double lower, double rate){ return -rate * (x - lower); }
+};
+//! \internal
+//! \brief Beta density, regular form.
+//! \ingroup DREAMPDF
+template<> struct DensityKernel<dist_beta, regform>{
+    //! \brief Density with the given \b lower and \b upper bounds and the shapes \b alpha and \b beta.
+    static double eval(double x, double lower, double upper, double alpha, double beta){ return std::pow(x - lower, alpha - 1.0) * std::pow(upper - x, beta - 1.0); }
+};
+//! \internal
+//! \brief Beta density, log form.
+//! \ingroup DREAMPDF
+template<> struct DensityKernel<dist_beta, logform>{
+    //! \brief Log of the density with the given \b lower and \b upper bounds and the shapes \b alpha and \b beta.
+    static double eval(double x, double lower, double upper, double alpha, double beta){ return std::log(x - lower) * (alpha - 1.0) + std::log(upper - x) * (beta - 1.0); }
+};
+//! \internal
+//! \brief Gamma density, regular form.
+//! \ingroup DREAMPDF
+template<> struct DensityKernel<dist_gamma, regform>{
+    //! \brief Density with the given \b lower bound, \b shape and \b rate.
+    static double eval(double x, double lower, double shape, double rate){ return std::pow(x - lower, shape - 1.0) * std::exp(-rate * (x - lower)); }
+};
+//! \internal
+//! \brief Gamma density, log form.
+//! \ingroup DREAMPDF
+template<> struct DensityKernel<dist_gamma, logform>{
+    //! \brief Log of the density with the given \b lower bound, \b shape and \b rate.
+    static double eval(double x, double lower, double shape, double rate){ return std::log(x - lower) * (shape - 1.0) - rate * (x - lower); }
+};
+
 //! \brief Returns the unscaled probability density of \b distribution (defined by \b params) at the point \b x.
 //! \ingroup DREAMPDF
 
@@ -53,9 +129,11 @@ namespace TasDREAM{
 //! For example, for uniform distribution over (a, b), the function will always return 1.
 //!
 //! Both the regular and log-form of the density can be computed based on \b form.
+//! The formulas are selected at compile time by the specializations of \b DensityKernel,
+//! the call does not allocate memory and passing the wrong number of parameters is a compile time error.
 //!
 //! \par Uniform distribution, dist_uniform,
-//! No additional parameters are needed, always returns 1, e.g.,
+//! No additional parameters are needed (any parameters are ignored), always returns 1, e.g.,
 //! \code double foo = getDensity<dist_uniform>(0.2); // foo will be 1.0 \endcode
 //!
 //! \par Gaussian distribution, dist_gaussian
@@ -69,45 +147,136 @@ namespace TasDREAM{
 //! \code double y = getDensity<dist_exponential>(x, x0, R); \endcode
 //! then \f$ y = \exp(- R * (x - x_0)) \f$.
 //!
-//! \par Beta distribution, dist-beta
+//! \par Beta distribution, dist_beta
 //! Uses four parameters, lower and upper bounds and two shapes, e.g.,
 //! \code double y = getDensity<dist_beta>(x, x0, x1, alpha, beta); \endcode
-//! then \f$ y = (x - x_0)^{\alpha - 1} (x_1 - x_0)^{\beta - 1} \f$.
+//! then \f$ y = (x - x_0)^{\alpha - 1} (x_1 - x)^{\beta - 1} \f$.
 //!
-//! \par Gamma distribution, dist-beta
+//! \par Gamma distribution, dist_gamma
 //! Uses three parameters, lower bounds, shape and rate, e.g.,
 //! \code double y = getDensity<dist_gamma>(x, x0, alpha, beta); \endcode
 //! then \f$ y = (x - x_0)^{\alpha - 1} \exp(-\beta (x - x_0)) \f$.
 //!
 template<TypeDistribution distribution, TypeSamplingForm form = regform, typename... Params>
-double getDensity(double x, Params... params){
-    std::vector<typename std::tuple_element<0, std::tuple<Params...>>::type> ParameterArray = {params...};
-    if (form == regform){
-        if (distribution == dist_gaussian){
-            return exp(-0.5 * (x - ParameterArray[0]) * (x - ParameterArray[0]) / ParameterArray[1]);
-        }else if (distribution == dist_exponential){
-            return exp(-ParameterArray[1] * (x - ParameterArray[0]));
-        }else if (distribution == dist_beta){
-            return pow(x - ParameterArray[0], ParameterArray[2] - 1.0) * pow(ParameterArray[1] - x, ParameterArray[3] - 1.0);
-        }else if (distribution == dist_gamma){
-            return pow(x - ParameterArray[0], ParameterArray[1] - 1.0) * exp(- ParameterArray[2] * (x - ParameterArray[0]));
-        }else{ // uniform
-            return 1.0;
+inline double getDensity(double x, Params... params){
+    return DensityKernel<distribution, form>::eval(x, params...);
+}
+
+//! \brief Product of independent one dimensional densities, evaluated for a batch of candidates.
+//! \ingroup DREAMPDF
+
+//! Each dimension is associated with one of the distributions and parameters used by \b getDensity(),
+//! the constants of the formulas (e.g., the inverse of the variance and the normalizing constants) are computed once by the constructor.
+//! The batch evaluation accumulates the logarithm of the density dimension-by-dimension over all candidates
+//! (simple loops that the compiler can vectorize) and, in \b regform, takes a single exponential per candidate.
+//!
+//! The object can be used directly as a prior or a probability distribution in the \b SampleDREAM() templates, e.g.,
+//! \code
+//! IndependentDensity<logform> prior({dist_gaussian, dist_beta}, {{0.0, 2.0}, {0.0, 1.0, 2.0, 3.0}});
+//! SampleDREAMGrid<logform>(num_burnup, num_collect, grid, prior, ...);
+//! \endcode
+//! If \b normalize is \b true, the densities include the normalizing constants, i.e., the result is the actual probability density;
+//! the uniform distribution is normalized only if the two optional parameters (lower and upper bound) are given.
+template<TypeSamplingForm form = regform>
+class IndependentDensity{
+public:
+    //! \brief Constructor, one distribution per dimension and the associated parameters in the order used by \b getDensity().
+    IndependentDensity(std::vector<TypeDistribution> const &distributions, std::vector<std::vector<double>> const &parameters, bool normalize = false)
+        : log_normalizer(0.0){
+        if (distributions.size() != parameters.size()) throw std::invalid_argument("ERROR: IndependentDensity needs one list of parameters for each distribution.");
+        kernels.reserve(distributions.size());
+        auto ip = parameters.begin();
+        for(auto dist : distributions){
+            Kernel k = {dist, 0.0, 0.0, 0.0, 0.0};
+            const std::vector<double> &p = *ip++;
+            auto check = [&](size_t num_params)->void{
+                if (p.size() != num_params) throw std::invalid_argument("ERROR: IndependentDensity, incorrect number of parameters for the distribution.");
+            };
+            switch(dist){
+                case dist_gaussian:
+                    check(2);
+                    k = {dist, p[0], -0.5 / p[1], 0.0, 0.0};
+                    if (normalize) log_normalizer -= 0.5 * std::log(2.0 * M_PI * p[1]);
+                    break;
+                case dist_exponential:
+                    check(2);
+                    k = {dist, p[0], -p[1], 0.0, 0.0};
+                    if (normalize) log_normalizer += std::log(p[1]);
+                    break;
+                case dist_beta:
+                    check(4);
+                    k = {dist, p[0], p[2] - 1.0, p[1], p[3] - 1.0};
+                    if (normalize) log_normalizer += std::lgamma(p[2] + p[3]) - std::lgamma(p[2]) - std::lgamma(p[3]) - (p[2] + p[3] - 1.0) * std::log(p[1] - p[0]);
+                    break;
+                case dist_gamma:
+                    check(3);
+                    k = {dist, p[0], p[1] - 1.0, 0.0, -p[2]};
+                    if (normalize) log_normalizer += p[1] * std::log(p[2]) - std::lgamma(p[1]);
+                    break;
+                default: // uniform
+                    if (p.size() != 0) check(2);
+                    if (normalize && (p.size() == 2)) log_normalizer -= std::log(p[1] - p[0]);
+                    break;
+            }
+            kernels.push_back(k);
         }
-    }else{
-        if (distribution == dist_gaussian){
-            return -0.5 * (x - ParameterArray[0]) * (x - ParameterArray[0]) / ParameterArray[1];
-        }else if (distribution == dist_exponential){
-            return -ParameterArray[1] * (x - ParameterArray[0]);
-        }else if (distribution == dist_beta){
-            return log(x - ParameterArray[0]) * (ParameterArray[2] - 1.0) + log(ParameterArray[1] - x) * (ParameterArray[3] - 1.0);
-        }else if (distribution == dist_gamma){
-            return log(x - ParameterArray[0]) * (ParameterArray[1] - 1.0) - ParameterArray[2] * (x - ParameterArray[0]);
-        }else{ // uniform
-            return 0.0;
+    }
+
+    //! \brief Return the number of dimensions.
+    int getNumDimensions() const{ return (int) kernels.size(); }
+
+    //! \brief Evaluate the density at \b num_points stored in \b candidates (one point after another) and write the result in \b values.
+    void evaluate(size_t num_points, const double candidates[], double values[]) const{
+        size_t num_dimensions = kernels.size();
+        std::fill_n(values, num_points, log_normalizer);
+        for(size_t i=0; i<num_dimensions; i++){
+            const Kernel &k = kernels[i];
+            const double *x = &candidates[i];
+            switch(k.dist){
+                case dist_gaussian:
+                    for(size_t j=0; j<num_points; j++){
+                        double d = x[j * num_dimensions] - k.shift;
+                        values[j] += k.a * d * d;
+                    }
+                    break;
+                case dist_exponential:
+                    for(size_t j=0; j<num_points; j++) values[j] += k.a * (x[j * num_dimensions] - k.shift);
+                    break;
+                case dist_beta:
+                    if (k.a != 0.0) for(size_t j=0; j<num_points; j++) values[j] += k.a * std::log(x[j * num_dimensions] - k.shift);
+                    if (k.c != 0.0) for(size_t j=0; j<num_points; j++) values[j] += k.c * std::log(k.b - x[j * num_dimensions]);
+                    break;
+                case dist_gamma:
+                    for(size_t j=0; j<num_points; j++){
+                        double d = x[j * num_dimensions] - k.shift;
+                        values[j] += k.c * d;
+                        if (k.a != 0.0) values[j] += k.a * std::log(d);
+                    }
+                    break;
+                default: // uniform
+                    break;
+            }
         }
+        if (form == regform)
+            for(size_t j=0; j<num_points; j++) values[j] = std::exp(values[j]);
     }
-}
+
+    //! \brief Evaluate the density at the \b candidates, matches the signature of the probability distribution and the prior in \b SampleDREAM().
+    void operator()(std::vector<double> const &candidates, std::vector<double> &values) const{
+        values.resize(candidates.size() / kernels.size());
+        evaluate(values.size(), candidates.data(), values.data());
+    }
+
+private:
+    //! \brief Precomputed constants for one dimension, the density is \f$ a \log(x - shift) + c (x - shift) \f$ or \f$ a (x - shift)^2 \f$ and similar.
+    struct Kernel{
+        TypeDistribution dist;
+        double shift, a, b, c;
+    };
+
+    double log_normalizer;
+    std::vector<Kernel> kernels;
+};
 
 }
 
@@ -31,6 +31,11 @@
 #ifndef __TASMANIAN_DREAM_CORE_RANDOM_HPP
 #define __TASMANIAN_DREAM_CORE_RANDOM_HPP
 
+#include <array>
+#include <cstdint>
+
+#include "tsgDreamEnumerates.hpp"
+
 //! \file tsgDreamCoreRandom.hpp
 //! \brief Core random sampling methods
 //! \author Miroslav Stoyanov
@@ -49,6 +54,102 @@
 
 namespace TasDREAM{
 
+//! \brief Counter-based pseudo-random number generator, using the Philox4x32-10 algorithm.
+//! \ingroup DREAMPDF
+
+//! The random numbers are computed as a cryptographic-style hash of a 64-bit \b seed (the key), a 64-bit \b stream
+//! and a 64-bit counter that is incremented after every four 32-bit numbers.
+//! Generators with the same seed and different streams are statistically independent,
+//! thus each chain (or thread) can have its own generator and the results do not depend on the order
+//! in which the generators are used, e.g., the number of OpenMP threads.
+//! See: Salmon, Moraes, Dror, Shaw, "Parallel random numbers: as easy as 1, 2, 3", SC11.
+//!
+//! The class can be used in place of the \b get_random01() functions in the sampling templates,
+//! but the batched methods and the overloads of \b applyUniformUpdate() and \b applyGaussianUpdate() are faster.
+class CounterRandom{
+public:
+    //! \brief Create a generator with the given \b seed and \b stream, the counter starts at zero.
+    CounterRandom(unsigned long long seed = 0, unsigned long long stream = 0) : key{{(uint32_t) seed, (uint32_t) (seed >> 32)}},
+        counter{{0, 0, (uint32_t) stream, (uint32_t) (stream >> 32)}}, num_cached(0){}
+
+    //! \brief Return a uniform random number in the open interval (0, 1).
+    double operator()(){
+        // use the top 52 bits and shift by half of the last bit, the largest value is 1 - 2^-53 (exact) and the smallest is 2^-53
+        return (((double) (getRandom64() >> 12)) + 0.5) * (1.0 / 4503599627370496.0);
+    }
+    //! \brief Return a random 64-bit integer, e.g., to seed other generators, uses all 64 bits of the Philox output.
+    unsigned long long getRandom64(){
+        if (num_cached == 0) generate();
+        return cached[--num_cached];
+    }
+    //! \brief Return a random index in the range 0, ..., \b n - 1.
+    size_t getIndex(size_t n){
+        size_t i = (size_t) ((*this)() * ((double) n));
+        return (i < n) ? i : n - 1;
+    }
+
+    //! \brief Write \b n uniform random numbers in (0, 1) to the array \b x.
+    void getUniform01(size_t n, double x[]){
+        for(size_t i=0; i<n; i++) x[i] = (*this)();
+    }
+    //! \brief Write \b n standard normal random numbers to the array \b x, uses the Box-Muller algorithm.
+    void getGaussian(size_t n, double x[]){
+        for(size_t i=0; i+1<n; i+=2){
+            double r = std::sqrt(-2.0 * std::log((*this)())), t = 2.0 * M_PI * (*this)(); // radius and angle
+            x[i]   = r * std::cos(t);
+            x[i+1] = r * std::sin(t);
+        }
+        if (n % 2 == 1) x[n-1] = std::sqrt(-2.0 * std::log((*this)())) * std::cos(2.0 * M_PI * (*this)());
+    }
+
+private:
+    //! \brief Compute the next block of four 32-bit numbers and combine them into two 64-bit words.
+    void generate(){
+        std::array<uint32_t, 4> c = counter;
+        std::array<uint32_t, 2> k = key;
+        for(int r=0; r<10; r++){
+            uint64_t p0 = ((uint64_t) 0xD2511F53u) * ((uint64_t) c[0]);
+            uint64_t p1 = ((uint64_t) 0xCD9E8D57u) * ((uint64_t) c[2]);
+            c = {{(uint32_t) (p1 >> 32) ^ c[1] ^ k[0], (uint32_t) p1, (uint32_t) (p0 >> 32) ^ c[3] ^ k[1], (uint32_t) p0}};
+            k[0] += 0x9E3779B9u;
+            k[1] += 0xBB67AE85u;
+        }
+        for(int i=0; i<2; i++)
+            cached[i] = (((uint64_t) c[2*i]) << 32) | ((uint64_t) c[2*i+1]);
+        num_cached = 2;
+        if (++counter[0] == 0) ++counter[1];
+    }
+
+    std::array<uint32_t, 2> key;
+    std::array<uint32_t, 4> counter;
+    uint64_t cached[2];
+    int num_cached;
+};
+
+//! \brief Add a correction to every entry in \b x, use uniform samples over (-\b magnitude, \b magnitude) drawn from \b rng.
+//! \ingroup DREAMPDF
+
+//! Batched overload that draws from a counter-based generator (does not use a \b std::function per number).
+inline void applyUniformUpdate(std::vector<double> &x, double magnitude, CounterRandom &rng){
+    if (magnitude == 0.0) return;
+    for(auto &v : x) v += magnitude * (2.0 * rng() - 1.0);
+}
+
+//! \brief Add a correction to every entry in \b x, use Gaussian samples with zero mean and standard deviation \b magnitude drawn from \b rng.
+//! \ingroup DREAMPDF
+
+//! Batched overload that draws from a counter-based generator (does not use a \b std::function per number).
+inline void applyGaussianUpdate(std::vector<double> &x, double magnitude, CounterRandom &rng){
+    if (magnitude == 0.0) return;
+    size_t n = x.size();
+    for(size_t i=0; i+1<n; i+=2){
+        double r = magnitude * std::sqrt(-2.0 * std::log(rng())), t = 2.0 * M_PI * rng(); // radius and angle
+        x[i]   += r * std::cos(t);
+        x[i+1] += r * std::sin(t);
+    }
+    if (n % 2 == 1) x[n-1] += magnitude * std::sqrt(-2.0 * std::log(rng())) * std::cos(2.0 * M_PI * rng());
+}
+
 //! \internal
 //! \brief Default random sampler, using \b rand() divided by \b RAND_MAX
 //! \ingroup DREAMPDF
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2017, Miroslav Stoyanov
+ *
+ * This file is part of
+ * Toolkit for Adaptive Stochastic Modeling And Non-Intrusive ApproximatioN: TASMANIAN
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+ *    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * UT-BATTELLE, LLC AND THE UNITED STATES GOVERNMENT MAKE NO REPRESENTATIONS AND DISCLAIM ALL WARRANTIES, BOTH EXPRESSED AND IMPLIED.
+ * THERE ARE NO EXPRESS OR IMPLIED WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT THE USE OF THE SOFTWARE WILL NOT INFRINGE ANY PATENT,
+ * COPYRIGHT, TRADEMARK, OR OTHER PROPRIETARY RIGHTS, OR THAT THE SOFTWARE WILL ACCOMPLISH THE INTENDED RESULTS OR THAT THE SOFTWARE OR ITS USE WILL NOT RESULT IN INJURY OR DAMAGE.
+ * THE USER ASSUMES RESPONSIBILITY FOR ALL LIABILITIES, PENALTIES, FINES, CLAIMS, CAUSES OF ACTION, AND COSTS AND EXPENSES, CAUSED BY, RESULTING FROM OR ARISING OUT OF,
+ * IN WHOLE OR IN PART THE USE, STORAGE OR DISPOSAL OF THE SOFTWARE.
+ */
+
+#ifndef __TASMANIAN_DREAM_HISTORY_SINK_CPP
+#define __TASMANIAN_DREAM_HISTORY_SINK_CPP
+
+#include "tsgDreamHistorySink.hpp"
+
+namespace TasDREAM{
+
+//! \internal
+//! \brief Identifies the history files, 16 characters including the terminating zero.
+//! \ingroup DREAMState
+constexpr char history_file_tag[16] = "TSGDREAMHISTORY";
+
+HistorySink::HistorySink(const std::string &cfilename, size_t cnum_dimensions, size_t cblock_size) :
+    filename(cfilename), num_dimensions(cnum_dimensions), block_size(cblock_size), num_samples(0),
+    writing(false), stop(false), failed(false){
+    if (block_size == 0) throw std::invalid_argument("ERROR: the history block size must be positive");
+    ofs.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!ofs.good()) throw std::runtime_error(std::string("ERROR: could not open the history file: ") + filename);
+    writeHeader();
+    buffer_x.reserve(block_size * num_dimensions);
+    buffer_pdf.reserve(block_size);
+    writer = std::thread(&HistorySink::writerLoop, this);
+}
+
+HistorySink::~HistorySink(){
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        if (!buffer_pdf.empty()) submitBlock();
+        stop = true;
+    }
+    signal.notify_all();
+    writer.join();
+}
+
+void HistorySink::writeHeader(){
+    ofs.write(history_file_tag, sizeof(history_file_tag));
+    ofs.write((const char*) &num_dimensions, sizeof(size_t));
+}
+
+void HistorySink::append(const double x[], const double pdf[], size_t cnum_samples){
+    std::unique_lock<std::mutex> guard(lock);
+    if (failed) throw std::runtime_error(std::string("ERROR: failed to write to the history file: ") + filename);
+    num_samples += cnum_samples;
+    while(cnum_samples > 0){
+        size_t num_copy = std::min(cnum_samples, block_size - buffer_pdf.size());
+        buffer_x.insert(buffer_x.end(), x, x + num_copy * num_dimensions);
+        buffer_pdf.insert(buffer_pdf.end(), pdf, pdf + num_copy);
+        x += num_copy * num_dimensions;
+        pdf += num_copy;
+        cnum_samples -= num_copy;
+        if (buffer_pdf.size() == block_size){
+            signal.wait(guard, [&]()->bool{ return (pending.size() < 2) || failed; }); // bound the memory used by the pending blocks
+            submitBlock();
+        }
+    }
+}
+
+void HistorySink::submitBlock(){
+    pending.emplace_back(std::move(buffer_x), std::move(buffer_pdf));
+    if (spares.empty()){
+        buffer_x = std::vector<double>();
+        buffer_pdf = std::vector<double>();
+        buffer_x.reserve(block_size * num_dimensions);
+        buffer_pdf.reserve(block_size);
+    }else{
+        std::swap(buffer_x, spares.front().first);
+        std::swap(buffer_pdf, spares.front().second);
+        spares.pop_front();
+        buffer_x.clear();
+        buffer_pdf.clear();
+    }
+    signal.notify_all();
+}
+
+void HistorySink::writerLoop(){
+    std::unique_lock<std::mutex> guard(lock);
+    while(true){
+        signal.wait(guard, [&]()->bool{ return stop || !pending.empty(); });
+        if (pending.empty()) return; // stop and nothing left to write
+
+        auto block = std::move(pending.front());
+        pending.pop_front();
+        writing = true;
+        guard.unlock();
+
+        size_t num_block = block.second.size();
+        ofs.write((const char*) &num_block, sizeof(size_t));
+        ofs.write((const char*) block.first.data(), block.first.size() * sizeof(double));
+        ofs.write((const char*) block.second.data(), num_block * sizeof(double));
+        ofs.flush();
+        bool good = ofs.good();
+
+        guard.lock();
+        writing = false;
+        if (!good) failed = true;
+        spares.push_back(std::move(block));
+        signal.notify_all();
+    }
+}
+
+void HistorySink::waitWriter(std::unique_lock<std::mutex> &guard){
+    signal.wait(guard, [&]()->bool{ return (pending.empty() && !writing) || failed; });
+    if (failed) throw std::runtime_error(std::string("ERROR: failed to write to the history file: ") + filename);
+}
+
+void HistorySink::clear(){
+    std::unique_lock<std::mutex> guard(lock);
+    waitWriter(guard);
+    ofs.close();
+    ofs.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!ofs.good()) throw std::runtime_error(std::string("ERROR: could not open the history file: ") + filename);
+    writeHeader();
+    buffer_x.clear();
+    buffer_pdf.clear();
+    num_samples = 0;
+}
+
+void HistorySink::readChunks(std::function<void(const double x[], const double pdf[], size_t num_samples)> reader){
+    std::unique_lock<std::mutex> guard(lock); // the lock is kept, the sampler cannot append while reading
+    waitWriter(guard);
+
+    std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+    char tag[sizeof(history_file_tag)];
+    size_t file_dimensions = 0;
+    ifs.read(tag, sizeof(tag));
+    ifs.read((char*) &file_dimensions, sizeof(size_t));
+    if (!ifs.good() || !std::equal(tag, tag + sizeof(tag), history_file_tag) || (file_dimensions != num_dimensions))
+        throw std::runtime_error(std::string("ERROR: wrong format of the history file: ") + filename);
+
+    std::vector<double> x, pdf;
+    size_t num_block = 0;
+    while(ifs.read((char*) &num_block, sizeof(size_t))){
+        x.resize(num_block * num_dimensions);
+        pdf.resize(num_block);
+        ifs.read((char*) x.data(), x.size() * sizeof(double));
+        ifs.read((char*) pdf.data(), num_block * sizeof(double));
+        if (!ifs.good()) throw std::runtime_error(std::string("ERROR: incomplete block in the history file: ") + filename);
+        reader(x.data(), pdf.data(), num_block);
+    }
+
+    if (!buffer_pdf.empty()) reader(buffer_x.data(), buffer_pdf.data(), buffer_pdf.size());
+}
+
+}
+
+#endif
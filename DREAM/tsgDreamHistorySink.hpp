@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2017, Miroslav Stoyanov
+ *
+ * This file is part of
+ * Toolkit for Adaptive Stochastic Modeling And Non-Intrusive ApproximatioN: TASMANIAN
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+ *    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * UT-BATTELLE, LLC AND THE UNITED STATES GOVERNMENT MAKE NO REPRESENTATIONS AND DISCLAIM ALL WARRANTIES, BOTH EXPRESSED AND IMPLIED.
+ * THERE ARE NO EXPRESS OR IMPLIED WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT THE USE OF THE SOFTWARE WILL NOT INFRINGE ANY PATENT,
+ * COPYRIGHT, TRADEMARK, OR OTHER PROPRIETARY RIGHTS, OR THAT THE SOFTWARE WILL ACCOMPLISH THE INTENDED RESULTS OR THAT THE SOFTWARE OR ITS USE WILL NOT RESULT IN INJURY OR DAMAGE.
+ * THE USER ASSUMES RESPONSIBILITY FOR ALL LIABILITIES, PENALTIES, FINES, CLAIMS, CAUSES OF ACTION, AND COSTS AND EXPENSES, CAUSED BY, RESULTING FROM OR ARISING OUT OF,
+ * IN WHOLE OR IN PART THE USE, STORAGE OR DISPOSAL OF THE SOFTWARE.
+ */
+
+#ifndef __TASMANIAN_DREAM_HISTORY_SINK_HPP
+#define __TASMANIAN_DREAM_HISTORY_SINK_HPP
+
+#include <fstream>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <memory>
+#include <stdexcept>
+
+#include "tsgDreamEnumerates.hpp"
+
+//! \internal
+//! \file tsgDreamHistorySink.hpp
+//! \brief Binary file storage for the DREAM history.
+//! \author Miroslav Stoyanov
+//! \ingroup TasmanianDREAM
+//!
+//! Defines the HistorySink class that writes the history of the DREAM chains to a file on a background thread.
+
+namespace TasDREAM{
+
+//! \internal
+//! \brief Writes snapshots of the DREAM history to a binary file in large blocks using a background thread.
+//! \ingroup DREAMState
+
+//! The samples are collected in a memory buffer and, once the buffer holds \b block_size samples,
+//! the buffer is handed to a background thread that writes it to the file.
+//! At most two full blocks can wait for the writer, if the writer falls behind the sampler will wait;
+//! thus, the memory used by the sink is bounded by a few blocks regardless of the length of the history.
+//!
+//! The file starts with a header followed by a sequence of blocks, each block holds the number of samples,
+//! then the samples (num_dimensions entries per sample) and finally the values of the probability density.
+//! The file uses the native binary format of the machine, similar to the binary grid files.
+class HistorySink{
+public:
+    //! \brief Open (and truncate) the \b filename and start the writer thread, \b block_size is the number of samples in a block.
+    HistorySink(const std::string &cfilename, size_t cnum_dimensions, size_t cblock_size);
+    //! \brief Write the buffered samples, stop the writer thread and close the file.
+    ~HistorySink();
+
+    //! \brief Append the \b num_samples from \b x (num_dimensions entries per sample) and the associated \b pdf values.
+    void append(const double x[], const double pdf[], size_t num_samples);
+
+    //! \brief Return the total number of samples in the history, both written and buffered.
+    size_t getNumSamples() const{ return num_samples; }
+
+    //! \brief Return the name of the file.
+    const std::string& getFilename() const{ return filename; }
+
+    //! \brief Discard the history and truncate the file.
+    void clear();
+
+    //! \brief Call \b reader for each block of the history, the blocks are read from the file one at a time, the last block comes from the memory buffer.
+    void readChunks(std::function<void(const double x[], const double pdf[], size_t num_samples)> reader);
+
+protected:
+    //! \brief Wait until the writer thread has no pending work.
+    void waitWriter(std::unique_lock<std::mutex> &guard);
+    //! \brief Give the current buffer to the writer thread and take a spare buffer.
+    void submitBlock();
+    //! \brief The main loop of the writer thread.
+    void writerLoop();
+    //! \brief Write the file header.
+    void writeHeader();
+
+private:
+    std::string filename;
+    size_t num_dimensions, block_size, num_samples;
+
+    std::ofstream ofs;
+    std::vector<double> buffer_x, buffer_pdf;
+    std::deque<std::pair<std::vector<double>, std::vector<double>>> pending, spares;
+
+    std::mutex lock;
+    std::condition_variable signal;
+    bool writing, stop, failed;
+    std::thread writer;
+};
+
+//! \internal
+//! \brief Owns the HistorySink of a DREAM state, a state that spills the history to a file cannot be copied.
+//! \ingroup DREAMState
+
+//! Two copies of the state writing into the same file would interleave their histories,
+//! and the copy cannot pick a new file on its own; thus, copying a state with an active sink throws.
+//! States without a sink can be copied freely and all states can be moved.
+class HistorySinkOwner{
+public:
+    //! \brief Default constructor, no sink.
+    HistorySinkOwner(){}
+    //! \brief Copy constructor, throws \b std::runtime_error if \b other has an active sink.
+    HistorySinkOwner(const HistorySinkOwner &other){ checkCopy(other); }
+    //! \brief Move constructor, takes the sink of \b other.
+    HistorySinkOwner(HistorySinkOwner &&) = default;
+    //! \brief Copy assignment, throws \b std::runtime_error if \b other has an active sink, otherwise closes the current sink.
+    HistorySinkOwner& operator =(const HistorySinkOwner &other){
+        checkCopy(other);
+        sink.reset();
+        return *this;
+    }
+    //! \brief Move assignment, closes the current sink and takes the sink of \b other.
+    HistorySinkOwner& operator =(HistorySinkOwner &&) = default;
+
+    //! \brief Close the current sink (if any) and open a new one, see the HistorySink constructor.
+    void open(const std::string &filename, size_t num_dimensions, size_t block_size){
+        sink.reset(); // close the old file before opening the new one, in case the names are the same
+        sink = std::unique_ptr<HistorySink>(new HistorySink(filename, num_dimensions, block_size));
+    }
+    //! \brief Close the sink.
+    void reset(){ sink.reset(); }
+
+    //! \brief Return \b true if there is an active sink.
+    explicit operator bool() const{ return !!sink; }
+    //! \brief Access the sink.
+    HistorySink* operator ->() const{ return sink.get(); }
+
+protected:
+    //! \brief Throws if \b other has an active sink.
+    static void checkCopy(const HistorySinkOwner &other){
+        if (other.sink) throw std::runtime_error("ERROR: cannot copy a DREAM state that spills the history to a file, call setHistorySpill(\"\") first");
+    }
+
+private:
+    std::unique_ptr<HistorySink> sink;
+};
+
+}
+
+#endif
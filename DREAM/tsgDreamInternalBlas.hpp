@@ -56,7 +56,7 @@
 // avoiding including BLAS headers, use the standard to define the functions, only the BLAS library is needed without include directories
 #ifdef Tasmanian_ENABLE_BLAS
 //extern "C" void dtrsv_(const char *uplo, const char *trans, const char *diag, const int *N, const double *A, const int *lda, const double *x, const int *incx);
-//extern "C" void dtrsm_(const char *side, const char *uplo, const char* transa, const char* diag, const int *m, const int *n, const double *alpha, const double *A, const int *lda, const double *B, const int *ldb);
+extern "C" void dtrsm_(const char *side, const char *uplo, const char* transa, const char* diag, const int *m, const int *n, const double *alpha, const double *A, const int *lda, double *B, const int *ldb);
 extern "C" double dnrm2_(const int *N, const double *x, const int *incx);
 extern "C" void dgemv_(const char *transa, const int *M, const int *N, const double *alpha, const double *A, const int *lda, const double *x, const int *incx, const double *beta, const double *y, const int *incy);
 #endif
@@ -84,6 +84,14 @@ inline void dgemtv(int M, int N, const double A[], const double x[], double y[],
     char charT = 'T'; int blas_one = 1;
     dgemv_(&charT, &M, &N, &alpha, A, &M, x, &blas_one, &beta, y, &blas_one);
 }
+
+//! \internal
+//! \brief Wrapper to BLAS triangular solve, overwrites \b B with \b L-inverse * \b B, \b L is lower triangular M by M and \b B is M by N (column major)
+//! \ingroup DREAMBLAS
+inline void dtrsmLower(int M, int N, const double L[], double B[]){
+    char charL = 'L', charN = 'N'; double alpha = 1.0;
+    dtrsm_(&charL, &charL, &charN, &charN, &M, &N, &alpha, L, &M, B, &M);
+}
 #endif
 
 }
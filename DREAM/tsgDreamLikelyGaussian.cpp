@@ -66,6 +66,201 @@ void LikelihoodGaussIsotropic::getLikelihood(TypeSamplingForm form, const std::v
     if (form == regform) for(auto &l : likely) l = exp(l);
 }
 
+void LikelihoodGaussAnisotropic::setData(const std::vector<double> &variance, const std::vector<double> &data_mean, double num_observe){
+    if (num_observe <= 0.0) throw std::runtime_error("ERROR: LikelihoodGaussAnisotropic, should have positive number of observations.");
+    if (data_mean.empty()) throw std::runtime_error("ERROR: LikelihoodGaussAnisotropic, emptry data vector.");
+    if (variance.size() != data_mean.size()) throw std::runtime_error("ERROR: LikelihoodGaussAnisotropic, the size of the variance and data vectors do not match.");
+    for(auto v : variance) if (v <= 0.0) throw std::runtime_error("ERROR: LikelihoodGaussAnisotropic, should have positive varience.");
+
+    noise_scale.resize(variance.size());
+    data_by_scale.resize(variance.size());
+    for(size_t i=0; i<variance.size(); i++){
+        noise_scale[i] = -0.5 * num_observe / variance[i];
+        data_by_scale[i] = -2.0 * noise_scale[i] * data_mean[i];
+    }
+}
+
+void LikelihoodGaussAnisotropic::getLikelihood(TypeSamplingForm form, const std::vector<double> &model, std::vector<double> &likely) const{
+    size_t num_outputs = noise_scale.size();
+    const double *y = model.data();
+    for(auto &l : likely){
+        double sum = 0.0;
+        for(size_t i=0; i<num_outputs; i++) sum += y[i] * (noise_scale[i] * y[i] + data_by_scale[i]);
+        l = sum;
+        y += num_outputs;
+    }
+    if (form == regform) for(auto &l : likely) l = exp(l);
+}
+
+void LikelihoodGaussCorrelated::setData(const std::vector<double> &covariance, const std::vector<double> &data_mean, double num_observe, int bandwidth){
+    if (num_observe <= 0.0) throw std::runtime_error("ERROR: LikelihoodGaussCorrelated, should have positive number of observations.");
+    if (data_mean.empty()) throw std::runtime_error("ERROR: LikelihoodGaussCorrelated, emptry data vector.");
+
+    num_outputs = data_mean.size();
+    dense = (bandwidth < 0 || (size_t) bandwidth + 1 >= num_outputs);
+    band = (dense) ? num_outputs - 1 : (size_t) bandwidth;
+
+    bool full_matrix = (covariance.size() == num_outputs * num_outputs);
+    if (!full_matrix && (bandwidth < 0 || covariance.size() != num_outputs * ((size_t) bandwidth + 1)))
+        throw std::runtime_error("ERROR: LikelihoodGaussCorrelated, the size of the covariance does not match the size of the data and the bandwidth.");
+    size_t input_band = (full_matrix) ? 0 : (size_t) bandwidth + 1;
+    auto cov = [&](size_t i, size_t j)->double{ return (full_matrix) ? covariance[i * num_outputs + j] : covariance[j * input_band + i - j]; };
+
+    // band Cholesky factorization, the factor has the same band structure as the covariance
+    factor = std::vector<double>((dense) ? num_outputs * num_outputs : num_outputs * (band + 1), 0.0);
+    for(size_t k=0; k<num_outputs; k++){
+        size_t first = (k > band) ? k - band : 0;
+        double diag = cov(k, k);
+        for(size_t m=first; m<k; m++) diag -= factor[getIndex(k, m)] * factor[getIndex(k, m)];
+        if (!(diag > 0.0)) throw std::runtime_error("ERROR: LikelihoodGaussCorrelated, the covariance is not positive definite.");
+        diag = std::sqrt(diag);
+        factor[getIndex(k, k)] = diag;
+
+        size_t last = std::min(num_outputs, k + band + 1);
+        for(size_t i=k+1; i<last; i++){
+            double v = cov(i, k);
+            for(size_t m=((i > band) ? i - band : 0); m<k; m++) v -= factor[getIndex(i, m)] * factor[getIndex(k, m)];
+            factor[getIndex(i, k)] = v / diag;
+        }
+    }
+
+    scale = -0.5 * num_observe;
+    whitened_data = data_mean;
+    solveLower(whitened_data.data());
+}
+
+void LikelihoodGaussCorrelated::solveLower(double x[]) const{
+    for(size_t k=0; k<num_outputs; k++){
+        const double *col = &factor[getIndex(k, k)];
+        x[k] /= col[0];
+        size_t last = std::min(num_outputs - k, band + 1);
+        for(size_t i=1; i<last; i++) x[k + i] -= col[i] * x[k];
+    }
+}
+
+//! \internal
+//! \brief Number of candidates processed together by the forward substitution in LikelihoodGaussCorrelated.
+//! \ingroup DREAMLikelihood
+constexpr size_t correlated_block_size = 32;
+
+void LikelihoodGaussCorrelated::getLikelihood(TypeSamplingForm form, const std::vector<double> &model, std::vector<double> &likely) const{
+    size_t num_points = likely.size();
+    #ifdef Tasmanian_ENABLE_BLAS
+    if (dense){ // BLAS level 3 solve, overwrites the right-hand-sides
+        std::vector<double> whitened(model.begin(), model.begin() + num_points * num_outputs);
+        TasBLAS::dtrsmLower((int) num_outputs, (int) num_points, factor.data(), whitened.data());
+
+        // || L^{-1} y - L^{-1} d ||^2 without the constant || L^{-1} d ||^2, consistent with the isotropic case
+        auto iw = whitened.begin();
+        for(auto &l : likely){
+            l = scale * (std::inner_product(iw, iw + num_outputs, iw, 0.0) - 2.0 * std::inner_product(iw, iw + num_outputs, whitened_data.begin(), 0.0));
+            std::advance(iw, num_outputs);
+        }
+        if (form == regform) for(auto &l : likely) l = exp(l);
+        return;
+    }
+    #endif
+
+    // forward substitution for a block of candidates at a time, the model outputs are read in place (never copied)
+    // and only the last band + 1 entries of the solution are kept (circularly) together with the running sums of the likelihood
+    size_t num_rows = band + 1;
+    std::vector<double> rows(num_rows * correlated_block_size);
+    for(size_t b=0; b<num_points; b+=correlated_block_size){
+        size_t num_block = std::min(correlated_block_size, num_points - b);
+        const double *y = &model[b * num_outputs];
+        double *l = &likely[b];
+        std::fill_n(l, num_block, 0.0);
+        for(size_t k=0; k<num_outputs; k++){
+            double *xk = &rows[(k % num_rows) * correlated_block_size];
+            for(size_t j=0; j<num_block; j++) xk[j] = y[j * num_outputs + k];
+            for(size_t m=((k > band) ? k - band : 0); m<k; m++){
+                double lkm = factor[getIndex(k, m)];
+                const double *xm = &rows[(m % num_rows) * correlated_block_size];
+                for(size_t j=0; j<num_block; j++) xk[j] -= lkm * xm[j];
+            }
+            double diag = factor[getIndex(k, k)];
+            double wd = 2.0 * whitened_data[k];
+            for(size_t j=0; j<num_block; j++){
+                xk[j] /= diag;
+                l[j] += xk[j] * (xk[j] - wd); // || L^{-1} y - L^{-1} d ||^2 without the constant || L^{-1} d ||^2
+            }
+        }
+        for(size_t j=0; j<num_block; j++) l[j] *= scale;
+    }
+    if (form == regform) for(auto &l : likely) l = exp(l);
+}
+
+//! \internal
+//! \brief Number of candidates processed together by the FusedGridGaussIsotropic class.
+//! \ingroup DREAMLikelihood
+constexpr size_t fused_block_size = 32;
+
+FusedGridGaussIsotropic::FusedGridGaussIsotropic(const TasGrid::TasmanianSparseGrid &cgrid, const LikelihoodGaussIsotropic &likelihood) :
+    LikelihoodGaussIsotropic(likelihood), grid(cgrid), num_dimensions((size_t) cgrid.getNumDimensions()), num_outputs((size_t) cgrid.getNumOutputs()),
+    num_basis((size_t) cgrid.getNumLoaded()){
+    if (likelihood.getNumOuputs() != grid.getNumOutputs()) throw std::runtime_error("ERROR: mismatch between the number of grid outputs and the size of the likelihood data.");
+    if (num_basis == 0) throw std::runtime_error("ERROR: FusedGridGaussIsotropic requires a grid with loaded values.");
+
+    contract = (!grid.isFourier() && (num_basis < num_outputs));
+    contractData();
+}
+
+void FusedGridGaussIsotropic::setData(double variance, const std::vector<double> &data_mean, double num_observe){
+    if (data_mean.size() != num_outputs) throw std::runtime_error("ERROR: mismatch between the number of grid outputs and the size of the likelihood data.");
+    LikelihoodGaussIsotropic::setData(variance, data_mean, num_observe);
+    contractData();
+}
+
+void FusedGridGaussIsotropic::contractData(){
+    if (contract){
+        const double *coeff = grid.getHierarchicalCoefficients(); // num_basis by num_outputs
+        projected.resize(num_basis);
+        gram.resize(num_basis * num_basis);
+        for(size_t p=0; p<num_basis; p++){
+            const double *sp = &coeff[p * num_outputs];
+            projected[p] = -2.0 * scale * std::inner_product(sp, sp + num_outputs, data.data(), 0.0);
+            for(size_t q=0; q<=p; q++){
+                gram[p * num_basis + q] = scale * std::inner_product(sp, sp + num_outputs, &coeff[q * num_outputs], 0.0);
+                gram[q * num_basis + p] = gram[p * num_basis + q];
+            }
+        }
+    }
+}
+
+void FusedGridGaussIsotropic::getGridLikelihood(TypeSamplingForm form, const std::vector<double> &candidates, std::vector<double> &likely, FusedGridWorkspace &workspace) const{
+    std::vector<double> &basis = workspace.basis, &block_outputs = workspace.block_outputs, &work = workspace.work;
+    if (contract){
+        basis.resize(fused_block_size * num_basis);
+        work.resize(num_basis);
+    }else{
+        block_outputs.resize(fused_block_size * num_outputs);
+    }
+    size_t num_candidates = likely.size();
+    for(size_t b=0; b<num_candidates; b+=fused_block_size){
+        size_t num_block = std::min(fused_block_size, num_candidates - b);
+        const double *x = &candidates[b * num_dimensions];
+        if (contract){
+            grid.evaluateHierarchicalFunctions(x, (int) num_block, basis.data());
+            for(size_t j=0; j<num_block; j++){
+                const double *phi = &basis[j * num_basis];
+                #ifdef Tasmanian_ENABLE_BLAS
+                TasBLAS::dgemtv((int) num_basis, (int) num_basis, gram.data(), phi, work.data()); // the matrix is symmetric
+                #else
+                for(size_t p=0; p<num_basis; p++) work[p] = std::inner_product(phi, phi + num_basis, &gram[p * num_basis], 0.0);
+                #endif
+                likely[b + j] = std::inner_product(phi, phi + num_basis, work.data(), 0.0) + std::inner_product(phi, phi + num_basis, projected.data(), 0.0);
+            }
+        }else{
+            grid.evaluateBatch(x, (int) num_block, block_outputs.data());
+            for(size_t j=0; j<num_block; j++){
+                const double *y = &block_outputs[j * num_outputs];
+                likely[b + j] = scale * (std::inner_product(y, y + num_outputs, y, 0.0) - 2.0 * std::inner_product(y, y + num_outputs, data.data(), 0.0));
+            }
+        }
+    }
+    if (form == regform) for(auto &l : likely) l = exp(l);
+}
+
 }
 
 #endif
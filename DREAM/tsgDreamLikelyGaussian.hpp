@@ -69,7 +69,7 @@ public:
     //! The \b variance must be a positive number, the \b data_mean must have the same size as the number of model outputs.
     //! The \b num_observe defaults to 1.0 and while it is not restircted to integer values (since it just multiplies by the inverse of the variance),
     //! \b num_observe must be positive.
-    void setData(double variance, const std::vector<double> &data_mean, double num_observe = 1.0);
+    virtual void setData(double variance, const std::vector<double> &data_mean, double num_observe = 1.0);
 
     //! \brief Compute the likelihood of a set of model outputs.
     void getLikelihood(TypeSamplingForm form, const std::vector<double> &model, std::vector<double> &likely) const;
@@ -80,6 +80,169 @@ public:
 private:
     std::vector<double> data;
     double scale;
+
+    friend class FusedGridGaussIsotropic;
+};
+
+//! \brief Implements likelihood under the assumption of uncorrelated noise with different magnitude for each output.
+//! \ingroup DREAMLikelihood
+
+//! \par Anisotropic Gaussian
+//! The covariance matrix is diagonal, i.e., the noise has no correlation but each model output has its own variance,
+//! then inverting the covariance matrix reduces to scaling each output by the inverse of the corresponding variance.
+//! As in the isotropic case, the multiple data samples are replaced by scaled operation on the data mean.
+class LikelihoodGaussAnisotropic : public TasmanianLikelihood{
+public:
+    //! \brief Default constructor for convenience, an object constructed with the default cannot be used until \b setData() is called.
+    LikelihoodGaussAnisotropic(){}
+    //! \brief Constructs the class and calls \b setData().
+    LikelihoodGaussAnisotropic(const std::vector<double> &variance, const std::vector<double> &data_mean, double num_observe = 1.0){ setData(variance, data_mean, num_observe); }
+    //! \brief Default destructor.
+    ~LikelihoodGaussAnisotropic(){}
+
+    //! \brief Set the noise magnitude for each output (\b variance), the observed data (\b data_mean) and number of observations (\b num_observe).
+
+    //! The \b variance and \b data_mean must have the same size as the number of model outputs and all variances must be positive,
+    //! \b num_observe must be positive (see \b LikelihoodGaussIsotropic).
+    void setData(const std::vector<double> &variance, const std::vector<double> &data_mean, double num_observe = 1.0);
+
+    //! \brief Compute the likelihood of a set of model outputs.
+    void getLikelihood(TypeSamplingForm form, const std::vector<double> &model, std::vector<double> &likely) const;
+
+    //! \brief Returns the size of the \b data_mean vector (for error checking purposes).
+    int getNumOuputs() const{ return (int) noise_scale.size(); }
+
+private:
+    std::vector<double> noise_scale, data_by_scale;
+};
+
+//! \brief Implements likelihood with a general (dense or banded) noise covariance.
+//! \ingroup DREAMLikelihood
+
+//! \par Correlated Gaussian
+//! The covariance matrix \f$ \Sigma \f$ is symmetric positive definite, the Cholesky factor \f$ \Sigma = L L^T \f$ is computed once in \b setData()
+//! and the likelihood uses \f$ (y - d)^T \Sigma^{-1} (y - d) = \| L^{-1} y - L^{-1} d \|_2^2 \f$.
+//! The model outputs for all candidates are processed together with a single triangular solve with multiple right-hand-sides
+//! (BLAS level 3, if BLAS is enabled and the matrix is dense); otherwise, the forward substitution runs over blocks of candidates
+//! reading the model outputs in place and keeping only the last few entries of the solution.
+//!
+//! \par Banded Covariance
+//! If the noise is correlated only between nearby outputs (e.g., time series), the covariance can be given with a \b bandwidth,
+//! i.e., \f$ \Sigma_{ij} = 0 \f$ for \f$ |i - j| > bandwidth \f$, then the Cholesky factor has the same bandwidth
+//! and both the factorization and the solves are linear in the number of outputs.
+class LikelihoodGaussCorrelated : public TasmanianLikelihood{
+public:
+    //! \brief Default constructor for convenience, an object constructed with the default cannot be used until \b setData() is called.
+    LikelihoodGaussCorrelated() : num_outputs(0), band(0), dense(true), scale(0.0){}
+    //! \brief Constructs the class and calls \b setData().
+    LikelihoodGaussCorrelated(const std::vector<double> &covariance, const std::vector<double> &data_mean, double num_observe = 1.0, int bandwidth = -1){
+        setData(covariance, data_mean, num_observe, bandwidth);
+    }
+    //! \brief Default destructor.
+    ~LikelihoodGaussCorrelated(){}
+
+    //! \brief Set the noise \b covariance, the observed data (\b data_mean), number of observations (\b num_observe) and the optional \b bandwidth.
+
+    //! Let \b n be the size of \b data_mean (i.e., the number of model outputs), then the \b covariance can be given in one of two formats:
+    //! - \b n by \b n symmetric matrix, if the \b bandwidth is non-negative, the entries outside of the band are ignored;
+    //! - only the lower band, the \b bandwidth must be non-negative and the size of \b covariance must be \b n times (\b bandwidth + 1),
+    //!   the entry \f$ \Sigma_{ij} \f$ for \f$ i \geq j \f$ is stored in \b covariance[\b j * (\b bandwidth + 1) + \b i - \b j].
+    //!
+    //! Negative \b bandwidth (default) indicates a dense matrix.
+    //! Throws \b std::runtime_error if the \b covariance is not positive definite, or if the sizes do not match.
+    void setData(const std::vector<double> &covariance, const std::vector<double> &data_mean, double num_observe = 1.0, int bandwidth = -1);
+
+    //! \brief Compute the likelihood of a set of model outputs.
+    void getLikelihood(TypeSamplingForm form, const std::vector<double> &model, std::vector<double> &likely) const;
+
+    //! \brief Returns the size of the \b data_mean vector (for error checking purposes).
+    int getNumOuputs() const{ return (int) num_outputs; }
+
+protected:
+    //! \internal
+    //! \brief Returns the index of \f$ L_{ij} \f$ (with \f$ i \geq j \f$) in the \b factor, columns are stored contiguously.
+    size_t getIndex(size_t i, size_t j) const{ return (dense) ? i + j * num_outputs : i - j + j * (band + 1); }
+    //! \internal
+    //! \brief Overwrites \b x with \f$ L^{-1} x \f$ using the band structure.
+    void solveLower(double x[]) const;
+
+private:
+    size_t num_outputs, band;
+    bool dense;
+    double scale;
+    std::vector<double> factor, whitened_data;
+};
+
+//! \brief Scratch space for \b FusedGridGaussIsotropic, allows repeated calls without allocating memory.
+//! \ingroup DREAMLikelihood
+
+//! The vectors are resized on the first call and reused afterwards; each thread should use a separate workspace.
+struct FusedGridWorkspace{
+    //! \brief The values of the hierarchical functions for a block of candidates.
+    std::vector<double> basis;
+    //! \brief The model outputs for a block of candidates.
+    std::vector<double> block_outputs;
+    //! \brief The product of the Gram matrix and the hierarchical functions for one candidate.
+    std::vector<double> work;
+};
+
+//! \brief Fused evaluation of a sparse grid model and the \b LikelihoodGaussIsotropic.
+//! \ingroup DREAMLikelihood
+
+//! Computes the likelihood of the model outputs given by the \b grid at the candidates,
+//! without forming the array of all model outputs for all candidates.
+//! The grid model is \f$ y(x) = \sum_p \phi_p(x) s_p \f$, where \f$ \phi_p \f$ are the hierarchical functions and \f$ s_p \f$
+//! are the hierarchical coefficients, and the likelihood formula uses only the norm of the model output and the product with the data.
+//! - If the number of grid points is less than the number of outputs (e.g., time series data),
+//!   the data and the variance are contracted with the coefficients once in the constructor,
+//!   i.e., \f$ w_p = -2 c s_p^T d \f$ and \f$ G_{pq} = c s_p^T s_q \f$, where \b c is the scale from the variance;
+//!   then the log-likelihood for each candidate is \f$ \phi^T G \phi + w^T \phi \f$ and the cost does not depend on the number of outputs.
+//! - Otherwise (also for Fourier grids that use complex coefficients), the candidates are processed in small blocks,
+//!   the model outputs for the block are computed with \b evaluateBatch() and reduced immediately into the likelihood,
+//!   so that only a small block of outputs is stored.
+//!
+//! The class is also a \b LikelihoodGaussIsotropic with the same data, thus the object can be given to \b SampleDREAMPost()
+//! together with the same \b grid and the contraction is computed only once for multiple calls to \b SampleDREAMPost().
+//! If the likelihood is a plain \b LikelihoodGaussIsotropic, the fused object is constructed on each call.
+//!
+//! The object keeps a reference to the \b grid, the grid must not be modified while the object is in use.
+//! Calling \b setData() recomputes the contraction with the new data.
+//! The object is not modified by \b getGridLikelihood(), the scratch space is either allocated per call or given by the caller,
+//! hence a single object can be used from multiple threads.
+class FusedGridGaussIsotropic : public LikelihoodGaussIsotropic{
+public:
+    //! \brief Constructor, precomputes the contractions of the \b grid coefficients with the data in \b likelihood.
+    FusedGridGaussIsotropic(const TasGrid::TasmanianSparseGrid &grid, const LikelihoodGaussIsotropic &likelihood);
+    //! \brief Default destructor.
+    ~FusedGridGaussIsotropic(){}
+
+    //! \brief Overwrites \b LikelihoodGaussIsotropic::setData(), changes the data and recomputes the contraction with the grid coefficients.
+
+    //! The size of \b data_mean must match the number of outputs of the grid.
+    void setData(double variance, const std::vector<double> &data_mean, double num_observe = 1.0);
+
+    //! \brief Compute the likelihood for the grid model at the \b candidates, \b likely must have size equal to the number of candidates.
+    void getGridLikelihood(TypeSamplingForm form, const std::vector<double> &candidates, std::vector<double> &likely) const{
+        FusedGridWorkspace workspace;
+        getGridLikelihood(form, candidates, likely, workspace);
+    }
+    //! \brief Overload that uses the scratch space in \b workspace, no memory is allocated after the first call.
+    void getGridLikelihood(TypeSamplingForm form, const std::vector<double> &candidates, std::vector<double> &likely, FusedGridWorkspace &workspace) const;
+
+    //! \brief Returns \b true if the likelihood uses the precomputed contraction, \b false if using blocks of model outputs.
+    bool usesContraction() const{ return contract; }
+
+    //! \brief Returns \b true if the object was constructed for the \b other grid (i.e., the same object).
+    bool isFusedWith(const TasGrid::TasmanianSparseGrid &other) const{ return (&grid == &other); }
+
+private:
+    //! \brief Computes the contraction of the grid coefficients with the current data, if using the contraction.
+    void contractData();
+
+    const TasGrid::TasmanianSparseGrid &grid;
+    size_t num_dimensions, num_outputs, num_basis;
+    bool contract;
+    std::vector<double> projected, gram;
 };
 
 
@@ -146,7 +146,9 @@ inline void uniform_prior(const std::vector<double> &, std::vector<double> &valu
 //!   the random perturbation must have zero mean (e.g., standard normal distribution);
 //!   the perturbation could be deterministic zero, but that may lock the chains into a fixed pattern based on the initial state and thus fail to consider the entire domain.
 //! - \b state has initialized state which will be used as the initial iteration, then the state will be evolved num_burnup + num_collect times
-//!   and the history will be saved for the last \b num_collect iterations.
+//!   and the history will be saved for the last \b num_collect iterations;
+//!   if \b TasmanianDREAM::setEarlyStop() has been called, then \b num_burnup and \b num_collect are only upper bounds
+//!   and the iterations will stop once the convergence criteria are satisfied.
 //! - \b differential_update() returns a random scaling factor for the differential correction, could be a random or deterministic number, e.g., uniform [0,1] or just 1;
 //!   the differential update magnitude defaults to 1.0 and can be set to a constant with the \b const_percent() template;
 //!   negative values are statistically equivalent to the positive ones by symmetry of the selection of the chains;
@@ -174,37 +176,31 @@ void SampleDREAM(int num_burnup, int num_collect,
     size_t num_chains = (size_t) state.getNumChains(), num_dimensions = (size_t) state.getNumDimensions();
     double unitlength = (double) num_chains;
 
+    DreamWorkspace &work = state.getWorkspace(); // persistent work arrays, no allocation inside the loop
+    auto &candidates = work.candidates;
+    auto &values = work.values;
+    auto &propose = work.proposal;
+    auto &valid = work.valid; // keep track whether the samples need to be evaluated
+
     int total_iterations = std::max(num_burnup, 0) + std::max(num_collect, 0);
     for(int t = 0; t < total_iterations; t++){
-        std::vector<double> candidates, values;
-        candidates.reserve(num_chains * num_dimensions);
-        values.reserve(num_chains);
-
-        std::vector<bool> valid(num_chains, true); // keep track whether the samples need to be evaluated
-
+        candidates.clear(); // clear() keeps the capacity
         for(size_t i=0; i<num_chains; i++){
-            std::vector<double> propose(num_dimensions);
-
             size_t jindex = (size_t) (get_random01() * unitlength);
             size_t kindex = (size_t) (get_random01() * unitlength);
             if (jindex >= num_chains) jindex = num_chains - 1; // this is needed in case get_random01() returns 1
-            if (kindex >= num_chains) jindex = num_chains - 1;
+            if (kindex >= num_chains) kindex = num_chains - 1;
 
             state.getIJKdelta(i, jindex, kindex, differential_update(), propose); // propose = s_i + w ( s_k - s_j)
             independent_update(propose); // propose += correction
 
-            if (inside(propose)){
-                candidates.insert(candidates.end(), propose.begin(), propose.end());
-                values.resize(values.size() + 1);
-            }else{
-                valid[i] = false;
-            }
+            valid[i] = inside(propose);
+            if (valid[i]) candidates.insert(candidates.end(), propose.begin(), propose.end());
         }
+        values.resize(candidates.size() / num_dimensions);
 
         probability_distribution(candidates, values);
 
-        std::vector<double> new_state(num_chains * num_dimensions), new_values(num_chains);
-
         auto icand = candidates.begin(); // loop over all candidates and values, accept or reject
         auto ival = values.begin();
 
@@ -221,33 +217,141 @@ void SampleDREAM(int num_burnup, int num_collect,
                     }else{
                         keep_new = (*ival - state.getPDFvalue(i) >= log(get_random01()));
                     }
-                    //std::cout << "Trsh = " << *ival / state.getPDFvalue(i) << "   " << ((keep_new) ? "Accept" : "Reject") << std:: endl;
                 }
+
+                if (keep_new){ // the proposals are already formed, overwrite the state in place
+                    state.setChainState(i, &*icand, *ival);
+                    accepted++; // accepted one more proposal
+                } // else reject and keep the old state
+
+                std::advance(icand, num_dimensions); // kept or rejected, this sample was valid so move to the next one
+                ival++;
             }
+        }
+
+        if (t >= num_burnup){
+            state.saveStateHistory(accepted);
+            if (state.checkCollectStop()) break; // collected the target effective sample size
+        }else if (state.checkBurnupStop(t)){
+            t = num_burnup - 1; // the chains have converged, skip the rest of the burnup
+        }
+    }
+}
 
-            if (keep_new){
-                std::copy_n(icand, num_dimensions, new_state.begin() + i * num_dimensions);
-                new_values[i] = *ival;
-                accepted++; // accepted one more proposal
-            }else{ // reject and reuse the old state
-                state.getChainState((int) i, &*(new_state.begin() + i * num_dimensions));
-                new_values[i] = state.getPDFvalue(i);
+
+//! \brief Parallel variant of \b SampleDREAM() using independent counter-based random streams for each chain.
+//! \ingroup DREAMSampleCore
+
+//! The proposals and the accept/reject tests are computed in parallel over the chains (using OpenMP, if the code calling the template is compiled with OpenMP).
+//! Each chain uses a separate \b CounterRandom stream, the streams are seeded with a random number drawn from the \b master generator;
+//! hence, the result depends only on the state of \b master and not on the number of threads.
+//! The \b master is advanced by the call, so that subsequent calls use different streams.
+//!
+//! The other parameters are the same as in the other overloads, with the following differences:
+//! - \b inside() is called from multiple threads and must be thread-safe (e.g., the hypercube test);
+//! - \b probability_distribution() is called once per iteration from a single thread (and it can use internal parallelism);
+//! - the independent update is one of the internal distributions (uniform or Gaussian) with the given magnitude;
+//! - the differential update uses the constant weight \b differential_update.
+template<TypeSamplingForm form = regform>
+void SampleDREAM(int num_burnup, int num_collect,
+                 std::function<void(const std::vector<double> &candidates, std::vector<double> &values)> probability_distribution,
+                 std::function<bool(const std::vector<double> &x)> inside,
+                 TypeDistribution dist, double magnitude,
+                 TasmanianDREAM &state,
+                 double differential_update,
+                 CounterRandom &master){
+
+    if (!state.isStateReady()) throw std::runtime_error("ERROR: DREAM sampling requires that the setState() has been called first on the TasmanianDREAM.");
+
+    if (!state.isPDFReady()) // initialize probability density (if not initialized already)
+        state.setPDFvalues(probability_distribution);
+
+    if (num_collect > 0) // pre-allocate memory for the new history
+        state.expandHistory(num_collect);
+
+    int num_chains = state.getNumChains();
+    size_t num_dimensions = (size_t) state.getNumDimensions();
+
+    std::vector<CounterRandom> streams;
+    streams.reserve((size_t) num_chains);
+    unsigned long long seed = master.getRandom64();
+    for(int i=0; i<num_chains; i++) streams.emplace_back(seed, (unsigned long long) i);
+
+    DreamWorkspace &work = state.getWorkspace(); // persistent work arrays, no allocation inside the loop
+    auto &candidates = work.candidates;
+    auto &values = work.values;
+    auto &proposals = work.chain_proposals;
+    auto &position = work.position;
+
+    int total_iterations = std::max(num_burnup, 0) + std::max(num_collect, 0);
+    for(int t = 0; t < total_iterations; t++){
+        #pragma omp parallel for schedule(static)
+        for(int i=0; i<num_chains; i++){
+            CounterRandom &rng = streams[(size_t) i];
+            size_t jindex = rng.getIndex((size_t) num_chains);
+            size_t kindex = rng.getIndex((size_t) num_chains);
+
+            state.getIJKdelta((size_t) i, jindex, kindex, differential_update, proposals[(size_t) i]); // propose = s_i + w ( s_k - s_j)
+            if (dist == dist_uniform){
+                applyUniformUpdate(proposals[(size_t) i], magnitude, rng);
+            }else{ // assuming Gaussian
+                applyGaussianUpdate(proposals[(size_t) i], magnitude, rng);
             }
 
-            if (valid[i]){ // kept or rejected, if this sample was valid then move to the next sample in the list
-                std::advance(icand, num_dimensions);
-                ival++;
+            position[(size_t) i] = (inside(proposals[(size_t) i])) ? 0 : -1;
+        }
+
+        candidates.clear(); // clear() keeps the capacity
+        int num_valid = 0;
+        for(int i=0; i<num_chains; i++){
+            if (position[(size_t) i] == 0){
+                candidates.insert(candidates.end(), proposals[(size_t) i].begin(), proposals[(size_t) i].end());
+                position[(size_t) i] = num_valid++;
             }
         }
+        values.resize((size_t) num_valid);
 
-        state.setState(new_state);
-        state.setPDFvalues(new_values);
+        probability_distribution(candidates, values);
 
-        if (t >= num_burnup)
-            state.saveStateHistory(accepted);
+        int accepted = 0;
+        #pragma omp parallel for schedule(static) reduction(+:accepted)
+        for(int i=0; i<num_chains; i++){
+            int p = position[(size_t) i];
+            if (p >= 0){ // if not valid, automatically reject
+                double new_value = values[(size_t) p], old_value = state.getPDFvalue((size_t) i);
+                double u = streams[(size_t) i](); // always draw, so the streams do not depend on the outcome
+                bool keep_new = (new_value > old_value) // if the new value has higher probability, automatically accept
+                                || ((form == regform) ? (new_value / old_value >= u) : (new_value - old_value >= std::log(u)));
+                if (keep_new){
+                    state.setChainState((size_t) i, &candidates[((size_t) p) * num_dimensions], new_value);
+                    accepted++;
+                }
+            }
+        }
+
+        if (t >= num_burnup){
+            state.saveStateHistory((size_t) accepted);
+            if (state.checkCollectStop()) break; // collected the target effective sample size
+        }else if (state.checkBurnupStop(t)){
+            t = num_burnup - 1; // the chains have converged, skip the rest of the burnup
+        }
     }
 }
 
+//! \brief Overload of the parallel \b SampleDREAM() assuming the domain is a hyperbube with min/max values given by \b lower and \b upper.
+//! \ingroup DREAMSampleCore
+template<TypeSamplingForm form = regform>
+void SampleDREAM(int num_burnup, int num_collect,
+                 std::function<void(const std::vector<double> &candidates, std::vector<double> &values)> probability_distribution,
+                 const std::vector<double> &lower, const std::vector<double> &upper,
+                 TypeDistribution dist, double magnitude,
+                 TasmanianDREAM &state,
+                 double differential_update,
+                 CounterRandom &master){
+    checkLowerUpper(lower, upper, state);
+    SampleDREAM<form>(num_burnup, num_collect, probability_distribution, makeHypercudabeLambda(lower, upper), dist, magnitude, state, differential_update, master);
+}
+
 
 //! \brief Overload of \b SampleDREAM() assuming independent update from a list of internals.
 //! \ingroup DREAMSampleCore
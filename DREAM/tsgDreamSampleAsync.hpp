@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2017, Miroslav Stoyanov
+ *
+ * This file is part of
+ * Toolkit for Adaptive Stochastic Modeling And Non-Intrusive ApproximatioN: TASMANIAN
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+ *    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * UT-BATTELLE, LLC AND THE UNITED STATES GOVERNMENT MAKE NO REPRESENTATIONS AND DISCLAIM ALL WARRANTIES, BOTH EXPRESSED AND IMPLIED.
+ * THERE ARE NO EXPRESS OR IMPLIED WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT THE USE OF THE SOFTWARE WILL NOT INFRINGE ANY PATENT,
+ * COPYRIGHT, TRADEMARK, OR OTHER PROPRIETARY RIGHTS, OR THAT THE SOFTWARE WILL ACCOMPLISH THE INTENDED RESULTS OR THAT THE SOFTWARE OR ITS USE WILL NOT RESULT IN INJURY OR DAMAGE.
+ * THE USER ASSUMES RESPONSIBILITY FOR ALL LIABILITIES, PENALTIES, FINES, CLAIMS, CAUSES OF ACTION, AND COSTS AND EXPENSES, CAUSED BY, RESULTING FROM OR ARISING OUT OF,
+ * IN WHOLE OR IN PART THE USE, STORAGE OR DISPOSAL OF THE SOFTWARE.
+ */
+
+#ifndef __TASMANIAN_DREAM_SAMPLE_ASYNC_HPP
+#define __TASMANIAN_DREAM_SAMPLE_ASYNC_HPP
+
+#include <exception>
+
+#include "tsgDreamSample.hpp"
+#include "tsgDreamWorkerPool.hpp"
+
+//! \file tsgDreamSampleAsync.hpp
+//! \brief Asynchronous sampling templates.
+//! \author Miroslav Stoyanov
+//! \ingroup TasmanianDREAM
+//!
+//! Defines the asynchronous variant of the DREAM sampler intended for expensive external models.
+
+namespace TasDREAM{
+
+//! \internal
+//! \brief Maximum number of steps that a chain can advance ahead of the slowest chain in \b SampleDREAMAsync().
+//! \ingroup DREAMSampleCore
+
+//! Bounds the memory used to assemble the snapshots of the history, a chain that gets too far ahead waits
+//! while the in-flight slots are given to the other chains.
+constexpr size_t async_max_lag = 8;
+
+//! \brief Asynchronous variant of \b SampleDREAM(), the chains advance independently as soon as the value at their candidate is available.
+//! \ingroup DREAMSampleCore
+
+//! The synchronous \b SampleDREAM() forms the candidates for all chains, waits for all values and then applies the accept/reject test;
+//! thus, the slowest evaluation in each batch holds all chains.
+//! The asynchronous variant keeps up to \b max_in_flight evaluations running at the same time (capped by the number of chains)
+//! and as soon as an evaluation completes, the corresponding chain is updated and the next candidate for that chain is started.
+//! The differential update uses the latest state of the other chains, i.e., the current population and not the population from a fixed iteration.
+//!
+//! The \b start_evaluation(x, done) should start computing the probability density at the single point \b x and return immediately,
+//! the \b done(value) callback must be called exactly once when the value is available (or before \b start_evaluation() returns).
+//! The \b done() callback can be called from any thread, and the vector \b x will not be modified until \b done() is called.
+//! A failed evaluation can be reported by calling \b done() with 0 for \b regform or negative infinity for \b logform, the candidate will be rejected.
+//!
+//! The history is saved in full snapshots of all chains, the snapshot \b t consists of the state of each chain after the \b t-th step of the chain;
+//! a chain may run ahead of the slowest one by up to a few steps, the state after the call holds the latest value of each chain.
+//! The acceptance rate, the history policies and \b TasmanianDREAM::setEarlyStop() work the same way as in the other samplers.
+//!
+//! The other parameters are the same as in the parallel \b SampleDREAM(), the independent update is one of the internal distributions
+//! and each chain uses a separate \b CounterRandom stream seeded from \b master;
+//! however, the samples depend on the order in which the evaluations complete and thus the result is not reproducible.
+//! If \b max_in_flight is not positive, all chains are evaluated at the same time.
+//!
+//! The optional \b cancel() is checked before each proposal and each time an evaluation completes, once it returns \b true
+//! no new evaluations are started, the values of the evaluations that are in flight are discarded and the call returns
+//! after all of them complete. The \b state and the history are left at the last snapshot assembled from all chains,
+//! i.e., the latest iteration that was completed by every chain.
+template<TypeSamplingForm form = regform>
+void SampleDREAMAsync(int num_burnup, int num_collect,
+                      std::function<void(const std::vector<double> &x, std::function<void(double value)> done)> start_evaluation,
+                      std::function<bool(const std::vector<double> &x)> inside,
+                      TypeDistribution dist, double magnitude,
+                      TasmanianDREAM &state,
+                      double differential_update,
+                      CounterRandom &master,
+                      int max_in_flight,
+                      std::function<bool(void)> cancel = std::function<bool(void)>()){
+
+    if (!state.isStateReady()) throw std::runtime_error("ERROR: DREAM sampling requires that the setState() has been called first on the TasmanianDREAM.");
+
+    size_t num_chains = (size_t) state.getNumChains(), num_dimensions = (size_t) state.getNumDimensions();
+    size_t in_flight_limit = (max_in_flight < 1) ? num_chains : std::min((size_t) max_in_flight, num_chains);
+
+    // the done() callbacks push the results from arbitrary threads, the results are processed here in the calling thread
+    struct AsyncResults{
+        std::mutex lock;
+        std::condition_variable signal;
+        std::vector<std::pair<size_t, double>> results;
+    };
+    auto completions = std::make_shared<AsyncResults>();
+    std::vector<std::pair<size_t, double>> received;
+    size_t in_flight = 0;
+
+    std::vector<std::vector<double>> proposals(num_chains, std::vector<double>(num_dimensions));
+    auto launch = [&](size_t i)->void{
+        in_flight++;
+        auto sync = completions;
+        try{
+            start_evaluation(proposals[i], [sync, i](double value)->void{
+                {
+                    std::lock_guard<std::mutex> guard(sync->lock);
+                    sync->results.emplace_back(i, value);
+                }
+                sync->signal.notify_one();
+            });
+        }catch(...){
+            in_flight--;
+            throw;
+        }
+    };
+    auto wait_results = [&]()->void{
+        received.clear();
+        std::unique_lock<std::mutex> guard(completions->lock);
+        completions->signal.wait(guard, [&]()->bool{ return !completions->results.empty(); });
+        std::swap(received, completions->results);
+        in_flight -= received.size();
+    };
+
+    bool cancelled = false; // once cancelled, stays cancelled
+    auto is_cancelled = [&]()->bool{
+        if (!cancelled && cancel) cancelled = cancel();
+        return cancelled;
+    };
+
+    std::vector<double> live = state.getChainState(), live_pdf(num_chains); // the latest population
+    try{
+        if (state.isPDFReady()){
+            for(size_t i=0; i<num_chains; i++) live_pdf[i] = state.getPDFvalue(i);
+        }else{ // initialize the probability density using the same asynchronous evaluations
+            size_t next = 0, finished = 0;
+            while(finished < num_chains){
+                while((next < num_chains) && (in_flight < in_flight_limit) && !is_cancelled()){
+                    std::copy_n(live.begin() + next * num_dimensions, num_dimensions, proposals[next].begin());
+                    launch(next++);
+                }
+                if (in_flight == 0) break; // cancelled
+                wait_results();
+                for(auto &r : received) live_pdf[r.first] = r.second;
+                finished += received.size();
+            }
+            if (is_cancelled()){ // the state is not modified
+                while(in_flight > 0) wait_results();
+                return;
+            }
+            state.setPDFvalues(live_pdf);
+        }
+
+        if (num_collect > 0) // pre-allocate memory for the new history
+            state.expandHistory(num_collect);
+
+        std::vector<CounterRandom> streams;
+        streams.reserve(num_chains);
+        unsigned long long seed = master.getRandom64();
+        for(size_t i=0; i<num_chains; i++) streams.emplace_back(seed, (unsigned long long) i);
+
+        size_t num_burnup_steps = (size_t) std::max(num_burnup, 0), num_collect_steps = (size_t) std::max(num_collect, 0);
+        size_t total_steps = num_burnup_steps + num_collect_steps;
+        bool stop = (total_steps == 0);
+
+        // the chain states after each step are kept until the same step is completed by all chains and a snapshot is assembled
+        // each entry consists of num_dimensions values, the probability density, and 1 or 0 to indicate an accepted candidate
+        std::vector<std::deque<double>> pending(num_chains);
+        std::vector<size_t> steps(num_chains, 0);
+        std::vector<double> snapshot_x(num_dimensions);
+        size_t num_empty = num_chains; // number of chains without pending steps
+        size_t generation = 0; // number of assembled snapshots
+
+        auto finish_step = [&](size_t i, bool accepted)->void{
+            steps[i]++;
+            if (pending[i].empty()) num_empty--;
+            pending[i].insert(pending[i].end(), live.begin() + i * num_dimensions, live.begin() + (i + 1) * num_dimensions);
+            pending[i].push_back(live_pdf[i]);
+            pending[i].push_back((accepted) ? 1.0 : 0.0);
+
+            while(!stop && (num_empty == 0)){
+                size_t num_accepted = 0;
+                for(size_t c=0; c<num_chains; c++){
+                    std::copy_n(pending[c].begin(), num_dimensions, snapshot_x.begin());
+                    state.setChainState(c, snapshot_x.data(), pending[c][num_dimensions]);
+                    if (pending[c][num_dimensions + 1] > 0.5) num_accepted++;
+                    pending[c].erase(pending[c].begin(), pending[c].begin() + num_dimensions + 2);
+                    if (pending[c].empty()) num_empty++;
+                }
+                if (generation >= num_burnup_steps){
+                    state.saveStateHistory(num_accepted);
+                    if (state.checkCollectStop()) stop = true; // collected the target effective sample size
+                }else if (state.checkBurnupStop((int) generation)){
+                    num_burnup_steps = generation + 1; // the chains have converged, skip the rest of the burnup
+                    total_steps = num_burnup_steps + num_collect_steps;
+                }
+                generation++;
+                if (generation >= total_steps) stop = true;
+            }
+        };
+
+        std::deque<size_t> idle; // chains without evaluation in flight
+        for(size_t i=0; i<num_chains; i++) idle.push_back(i);
+
+        auto dispatch = [&]()->void{
+            bool progress = true;
+            while(progress){
+                progress = false;
+                size_t num_idle = idle.size();
+                for(size_t c=0; (c < num_idle) && !stop && (in_flight < in_flight_limit); c++){
+                    size_t i = idle.front();
+                    idle.pop_front();
+                    bool launched = false;
+                    while(!stop && (steps[i] < total_steps) && (steps[i] < generation + async_max_lag) && !is_cancelled()){
+                        CounterRandom &rng = streams[i];
+                        size_t jindex = rng.getIndex(num_chains);
+                        size_t kindex = rng.getIndex(num_chains);
+                        auto ii = live.begin() + i * num_dimensions;
+                        auto ij = live.begin() + jindex * num_dimensions;
+                        auto ik = live.begin() + kindex * num_dimensions;
+                        for(auto &p : proposals[i]) p = *ii++ + differential_update * (*ik++ - *ij++); // propose = s_i + w ( s_k - s_j)
+                        if (dist == dist_uniform){
+                            applyUniformUpdate(proposals[i], magnitude, rng);
+                        }else{ // assuming Gaussian
+                            applyGaussianUpdate(proposals[i], magnitude, rng);
+                        }
+                        progress = true;
+                        if (inside(proposals[i])){
+                            launch(i);
+                            launched = true;
+                            break;
+                        }else{ // automatic rejection
+                            finish_step(i, false);
+                        }
+                    }
+                    if (!launched) idle.push_back(i);
+                }
+            }
+        };
+
+        dispatch();
+        while(in_flight > 0){
+            wait_results();
+            for(auto &r : received){
+                size_t i = r.first;
+                if (stop || is_cancelled()) continue; // discard the evaluations that complete after the end of the sampling
+                double new_value = r.second, old_value = live_pdf[i];
+                double u = streams[i](); // always draw, so the streams do not depend on the outcome
+                bool keep_new = (new_value > old_value) // if the new value has higher probability, automatically accept
+                                || ((form == regform) ? (new_value / old_value >= u) : (new_value - old_value >= std::log(u)));
+                if (keep_new){
+                    std::copy(proposals[i].begin(), proposals[i].end(), live.begin() + i * num_dimensions);
+                    live_pdf[i] = new_value;
+                }
+                finish_step(i, keep_new);
+                idle.push_back(i);
+            }
+            dispatch();
+        }
+    }catch(...){
+        while(in_flight > 0) wait_results(); // the callbacks reference the local variables
+        throw;
+    }
+
+    if (cancelled) return; // the state holds the last complete snapshot
+
+    for(size_t i=0; i<num_chains; i++) // continue from the latest population
+        state.setChainState(i, &live[i * num_dimensions], live_pdf[i]);
+}
+
+//! \brief Overload of \b SampleDREAMAsync() that calls a blocking \b probability_distribution() at a single point from the threads of the \b pool.
+//! \ingroup DREAMSampleCore
+
+//! The \b probability_distribution(x) returns the value of the density at a single point \b x and is called from the threads of the \b pool,
+//! e.g., it can launch an external simulator and wait for the result.
+//! If \b max_in_flight is not positive, then the number of threads in the \b pool is used.
+//! If \b probability_distribution() throws, no further proposals are made and the exception is re-thrown once the in-flight evaluations complete,
+//! the \b state and the history are left at the last iteration completed by all chains (see the \b cancel() in the other overload).
+template<TypeSamplingForm form = regform>
+void SampleDREAMAsync(int num_burnup, int num_collect,
+                      std::function<double(const std::vector<double> &x)> probability_distribution,
+                      std::function<bool(const std::vector<double> &x)> inside,
+                      TypeDistribution dist, double magnitude,
+                      TasmanianDREAM &state,
+                      double differential_update,
+                      CounterRandom &master,
+                      DreamWorkerPool &pool,
+                      int max_in_flight = 0){
+    struct AsyncFailure{
+        std::mutex lock;
+        std::exception_ptr error;
+    };
+    auto failure = std::make_shared<AsyncFailure>();
+    double reject = (form == regform) ? 0.0 : -std::numeric_limits<double>::infinity();
+
+    SampleDREAMAsync<form>(num_burnup, num_collect,
+        [&, failure, reject](const std::vector<double> &x, std::function<void(double value)> done)->void{
+            pool.submit([&probability_distribution, &x, done, failure, reject]()->void{
+                double value = reject;
+                bool failed;
+                {
+                    std::lock_guard<std::mutex> guard(failure->lock);
+                    failed = (bool) failure->error;
+                }
+                if (!failed){
+                    try{
+                        value = probability_distribution(x);
+                    }catch(...){
+                        std::lock_guard<std::mutex> guard(failure->lock);
+                        if (!failure->error) failure->error = std::current_exception();
+                    }
+                }
+                done(value);
+            });
+        },
+        inside, dist, magnitude, state, differential_update, master,
+        (max_in_flight < 1) ? pool.getNumWorkers() : max_in_flight,
+        [failure]()->bool{
+            std::lock_guard<std::mutex> guard(failure->lock);
+            return (bool) failure->error;
+        });
+
+    if (failure->error) std::rethrow_exception(failure->error);
+}
+
+//! \brief Overload of the pool \b SampleDREAMAsync() assuming the domain is a hyperbube with min/max values given by \b lower and \b upper.
+//! \ingroup DREAMSampleCore
+template<TypeSamplingForm form = regform>
+void SampleDREAMAsync(int num_burnup, int num_collect,
+                      std::function<double(const std::vector<double> &x)> probability_distribution,
+                      const std::vector<double> &lower, const std::vector<double> &upper,
+                      TypeDistribution dist, double magnitude,
+                      TasmanianDREAM &state,
+                      double differential_update,
+                      CounterRandom &master,
+                      DreamWorkerPool &pool,
+                      int max_in_flight = 0){
+    checkLowerUpper(lower, upper, state);
+    SampleDREAMAsync<form>(num_burnup, num_collect, probability_distribution, makeHypercudabeLambda(lower, upper),
+                           dist, magnitude, state, differential_update, master, pool, max_in_flight);
+}
+
+}
+
+#endif
@@ -69,7 +69,7 @@ template<TypeSamplingForm form> std::function<void(const std::vector<double> &ca
 makePDFPosterior(TasmanianLikelihood const &likelihood,
                  std::function<void(std::vector<double> const &candidates, std::vector<double> &values)> model,
                  std::function<void(std::vector<double> const &candidates, std::vector<double> &values)> prior){
-    return [&](const std::vector<double> &candidates, std::vector<double> &values)->void{
+    return [=, &likelihood](const std::vector<double> &candidates, std::vector<double> &values)->void{
         std::vector<double> model_outs(likelihood.getNumOuputs() * values.size());
         model(candidates, model_outs);
         likelihood.getLikelihood(form, model_outs, values);
@@ -31,6 +31,8 @@
 #ifndef __TASMANIAN_DREAM_SAMPLE_POSTERIOR_GRID_HPP
 #define __TASMANIAN_DREAM_SAMPLE_POSTERIOR_GRID_HPP
 
+#include <typeinfo>
+
 #include "tsgDreamSampleGrid.hpp"
 #include "tsgDreamSamplePosterior.hpp"
 
@@ -63,10 +65,57 @@ inline std::function<void(std::vector<double> const &candidates, std::vector<dou
     return [&](const std::vector<double> &candidates, std::vector<double> &values)->void{ grid.evaluateBatch(candidates, values); };
 }
 
+/*!
+ * \internal
+ * \brief Make the posterior lambda for a sparse grid model, uses the fused \b FusedGridGaussIsotropic if possible.
+ * \ingroup DREAMAux
+ *
+ * If the type of the \b likelihood is exactly \b LikelihoodGaussIsotropic, the model outputs are never formed for all candidates,
+ * see \b FusedGridGaussIsotropic; otherwise, the posterior is the same as \b makePDFPosterior() with \b makeGridModel().
+ * If the \b likelihood is already a \b FusedGridGaussIsotropic for the same \b grid, the precomputed contraction is reused.
+ * The work vectors for the fused likelihood and the prior are reused between the calls.
+ * \endinternal
+ */
+template<TypeSamplingForm form>
+std::function<void(const std::vector<double> &candidates, std::vector<double> &values)>
+makePDFPosteriorGrid(TasmanianLikelihood const &likelihood, TasGrid::TasmanianSparseGrid const &grid,
+                     std::function<void(std::vector<double> const &candidates, std::vector<double> &values)> prior){
+    // classes derived from LikelihoodGaussIsotropic may overwrite getLikelihood(), fuse only the exact types
+    bool is_gauss = (typeid(likelihood) == typeid(LikelihoodGaussIsotropic));
+    bool is_fused = (typeid(likelihood) == typeid(FusedGridGaussIsotropic));
+    if (!is_gauss && !is_fused) return makePDFPosterior<form>(likelihood, makeGridModel(grid), prior);
+
+    std::shared_ptr<FusedGridGaussIsotropic> owned; // owns the fused object only if the one in the likelihood cannot be reused
+    const FusedGridGaussIsotropic *fused = (is_fused) ? static_cast<const FusedGridGaussIsotropic*>(&likelihood) : nullptr;
+    if ((fused == nullptr) || !fused->isFusedWith(grid)){
+        owned = std::make_shared<FusedGridGaussIsotropic>(grid, static_cast<const LikelihoodGaussIsotropic&>(likelihood));
+        fused = owned.get();
+    }
+    auto workspace = std::make_shared<FusedGridWorkspace>();
+    auto prior_vals = std::make_shared<std::vector<double>>();
+    return [=](const std::vector<double> &candidates, std::vector<double> &values)->void{
+        fused->getGridLikelihood(form, candidates, values, *workspace);
+
+        prior_vals->resize(values.size());
+        prior(candidates, *prior_vals);
+
+        auto iv = values.begin();
+        if (form == regform){
+            for(auto p : *prior_vals) *iv++ *= p;
+        }else{
+            for(auto p : *prior_vals) *iv++ += p;
+        }
+    };
+}
+
 //! \brief Overloads of \b SampleDREAMPost() which uses a sparse grid as model.
 //! \ingroup DREAMGridModel
 
 //! The \b model variable is replaced by the \b grid, see the other overloads for the rest of the variables.
+//! If the \b likelihood is \b LikelihoodGaussIsotropic, the grid and likelihood are evaluated together
+//! without forming the model outputs for all candidates, see \b FusedGridGaussIsotropic.
+//! Passing a \b FusedGridGaussIsotropic constructed for the same \b grid as the \b likelihood avoids repeating
+//! the precomputation when \b SampleDREAMPost() is called multiple times.
 template<TypeSamplingForm form = regform>
 void SampleDREAMPost(int num_burnup, int num_collect,
                      const TasmanianLikelihood &likelihood,
@@ -78,7 +127,7 @@ void SampleDREAMPost(int num_burnup, int num_collect,
                      std::function<double(void)> differential_update = const_one,
                      std::function<double(void)> get_random01 = tsgCoreUniform01){
     checkGridSTate(grid, state);
-    SampleDREAMPost<form>(num_burnup, num_collect, likelihood, makeGridModel(grid), prior, inside, independent_update, state, differential_update, get_random01);
+    SampleDREAM<form>(num_burnup, num_collect, makePDFPosteriorGrid<form>(likelihood, grid, prior), inside, independent_update, state, differential_update, get_random01);
 }
 
 
@@ -97,7 +146,7 @@ void SampleDREAMPost(int num_burnup, int num_collect,
                      std::function<double(void)> differential_update = const_one,
                      std::function<double(void)> get_random01 = tsgCoreUniform01){
     checkGridSTate(grid, state);
-    SampleDREAMPost<form>(num_burnup, num_collect, likelihood, makeGridModel(grid), prior, lower, upper, independent_update, state, differential_update, get_random01);
+    SampleDREAM<form>(num_burnup, num_collect, makePDFPosteriorGrid<form>(likelihood, grid, prior), lower, upper, independent_update, state, differential_update, get_random01);
 }
 
 
@@ -116,14 +165,14 @@ void SampleDREAMPost(int num_burnup, int num_collect,
                      std::function<double(void)> get_random01 = tsgCoreUniform01){
     __TASDREAM_GRID_EXTRACT_RULE
     if ((rule == TasGrid::rule_gausshermite) || (rule == TasGrid::rule_gausshermiteodd)){ // unbounded domain
-        SampleDREAMPost<form>(num_burnup, num_collect, likelihood, makeGridModel(grid), prior, domainGaussHermite, independent_update, state, differential_update, get_random01);
+        SampleDREAM<form>(num_burnup, num_collect, makePDFPosteriorGrid<form>(likelihood, grid, prior), domainGaussHermite, independent_update, state, differential_update, get_random01);
     }else if ((rule == TasGrid::rule_gausslaguerre) || (rule == TasGrid::rule_gausslaguerreodd)){ // bounded from below
-        SampleDREAMPost<form>(num_burnup, num_collect, likelihood,
-                              makeGridModel(grid), prior, __TASDREAM_GRID_DOMAIN_GLLAMBDA, independent_update, state, differential_update, get_random01);
+        SampleDREAM<form>(num_burnup, num_collect,
+                          makePDFPosteriorGrid<form>(likelihood, grid, prior), __TASDREAM_GRID_DOMAIN_GLLAMBDA, independent_update, state, differential_update, get_random01);
     }else{
         __TASDREAM_GRID_DOMAIN_DEFAULTS
-        SampleDREAMPost<form>(num_burnup, num_collect, likelihood,
-                              makeGridModel(grid), prior, transform_a, transform_b, independent_update, state, differential_update, get_random01);
+        SampleDREAM<form>(num_burnup, num_collect,
+                          makePDFPosteriorGrid<form>(likelihood, grid, prior), transform_a, transform_b, independent_update, state, differential_update, get_random01);
     }
 }
 
@@ -142,8 +191,8 @@ void SampleDREAMPost(int num_burnup, int num_collect,
                      TasmanianDREAM &state,
                      std::function<double(void)> differential_update = const_one,
                      std::function<double(void)> get_random01 = tsgCoreUniform01){
-    SampleDREAMPost<form>(num_burnup, num_collect, likelihood,
-                          makeGridModel(grid), prior, inside, independent_dist, independent_magnitude, state, differential_update, get_random01);
+    SampleDREAM<form>(num_burnup, num_collect,
+                      makePDFPosteriorGrid<form>(likelihood, grid, prior), inside, independent_dist, independent_magnitude, state, differential_update, get_random01);
 }
 
 
@@ -161,8 +210,8 @@ void SampleDREAMPost(int num_burnup, int num_collect,
                      TasmanianDREAM &state,
                      std::function<double(void)> differential_update = const_one,
                      std::function<double(void)> get_random01 = tsgCoreUniform01){
-    SampleDREAMPost<form>(num_burnup, num_collect, likelihood,
-                          makeGridModel(grid), prior, lower, upper, independent_dist, independent_magnitude, state, differential_update, get_random01);
+    SampleDREAM<form>(num_burnup, num_collect,
+                      makePDFPosteriorGrid<form>(likelihood, grid, prior), lower, upper, independent_dist, independent_magnitude, state, differential_update, get_random01);
 }
 
 
@@ -181,14 +230,14 @@ void SampleDREAMPost(int num_burnup, int num_collect,
                      std::function<double(void)> get_random01 = tsgCoreUniform01){
     __TASDREAM_GRID_EXTRACT_RULE
     if ((rule == TasGrid::rule_gausshermite) || (rule == TasGrid::rule_gausshermiteodd)){ // unbounded domain
-        SampleDREAMPost<form>(num_burnup, num_collect, likelihood, makeGridModel(grid), prior, domainGaussHermite,
+        SampleDREAM<form>(num_burnup, num_collect, makePDFPosteriorGrid<form>(likelihood, grid, prior), domainGaussHermite,
                               independent_dist, independent_magnitude, state, differential_update, get_random01);
     }else if ((rule == TasGrid::rule_gausslaguerre) || (rule == TasGrid::rule_gausslaguerreodd)){ // bounded from below
-        SampleDREAMPost<form>(num_burnup, num_collect, likelihood, makeGridModel(grid), prior, __TASDREAM_GRID_DOMAIN_GLLAMBDA,
+        SampleDREAM<form>(num_burnup, num_collect, makePDFPosteriorGrid<form>(likelihood, grid, prior), __TASDREAM_GRID_DOMAIN_GLLAMBDA,
                               independent_dist, independent_magnitude, state, differential_update, get_random01);
     }else{
         __TASDREAM_GRID_DOMAIN_DEFAULTS
-        SampleDREAMPost<form>(num_burnup, num_collect, likelihood, makeGridModel(grid), prior, transform_a, transform_b,
+        SampleDREAM<form>(num_burnup, num_collect, makePDFPosteriorGrid<form>(likelihood, grid, prior), transform_a, transform_b,
                               independent_dist, independent_magnitude, state, differential_update, get_random01);
     }
 }
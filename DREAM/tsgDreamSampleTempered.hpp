@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2017, Miroslav Stoyanov
+ *
+ * This file is part of
+ * Toolkit for Adaptive Stochastic Modeling And Non-Intrusive ApproximatioN: TASMANIAN
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+ *    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * UT-BATTELLE, LLC AND THE UNITED STATES GOVERNMENT MAKE NO REPRESENTATIONS AND DISCLAIM ALL WARRANTIES, BOTH EXPRESSED AND IMPLIED.
+ * THERE ARE NO EXPRESS OR IMPLIED WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT THE USE OF THE SOFTWARE WILL NOT INFRINGE ANY PATENT,
+ * COPYRIGHT, TRADEMARK, OR OTHER PROPRIETARY RIGHTS, OR THAT THE SOFTWARE WILL ACCOMPLISH THE INTENDED RESULTS OR THAT THE SOFTWARE OR ITS USE WILL NOT RESULT IN INJURY OR DAMAGE.
+ * THE USER ASSUMES RESPONSIBILITY FOR ALL LIABILITIES, PENALTIES, FINES, CLAIMS, CAUSES OF ACTION, AND COSTS AND EXPENSES, CAUSED BY, RESULTING FROM OR ARISING OUT OF,
+ * IN WHOLE OR IN PART THE USE, STORAGE OR DISPOSAL OF THE SOFTWARE.
+ */
+
+#ifndef __TASMANIAN_DREAM_SAMPLE_TEMPERED_HPP
+#define __TASMANIAN_DREAM_SAMPLE_TEMPERED_HPP
+
+#include "tsgDreamSampleGrid.hpp"
+
+//! \file tsgDreamSampleTempered.hpp
+//! \brief Parallel tempering templates.
+//! \author Miroslav Stoyanov
+//! \ingroup TasmanianDREAM
+//!
+//! Defines the sampler that evolves multiple DREAM populations at different temperatures and exchanges states between them.
+
+namespace TasDREAM{
+
+//! \brief Parallel tempering variant of \b SampleDREAM(), evolves several populations each sampling a tempered distribution.
+//! \ingroup DREAMSampleCore
+
+//! Population \b k samples from the probability distribution raised to the power \b inverse_temperatures[k],
+//! values less than 1 flatten the distribution so that the hot populations can move between the modes of a multimodal distribution.
+//! Every \b swap_frequency iterations the neighboring populations (\b k and \b k + 1) propose to exchange the states of each chain,
+//! the exchange is accepted with probability \f$ \min\left(1, (p(x_{k+1}) / p(x_k))^{\beta_k - \beta_{k+1}} \right) \f$;
+//! the pairs alternate between even and odd \b k on consecutive exchanges.
+//!
+//! The first population (i.e., \b populations[0]) is the cold one, usually the corresponding inverse temperature is 1.0,
+//! only the cold population saves history and is used to check the early stop criteria;
+//! the other populations carry only the current state and can be reused to continue the sampling in a subsequent call.
+//! All populations must have the same number of chains and dimensions.
+//!
+//! The candidates of all populations are evaluated with a single call to \b probability_distribution(), thus a sparse grid model
+//! (see the overload) sees one large batch per iteration. The proposals and the accept/reject tests are computed in parallel
+//! (using OpenMP, if the code calling the template is compiled with OpenMP) with a separate \b CounterRandom stream for each chain of each population;
+//! the result depends only on the state of \b master and not on the number of threads.
+//! The remaining inputs are the same as in the parallel \b SampleDREAM().
+//!
+//! Returns the acceptance rate of the exchanges between each pair of neighboring populations (the vector has size \b populations.size() - 1).
+template<TypeSamplingForm form = regform>
+std::vector<double> SampleDREAMTempered(int num_burnup, int num_collect,
+                                        std::function<void(const std::vector<double> &candidates, std::vector<double> &values)> probability_distribution,
+                                        std::function<bool(const std::vector<double> &x)> inside,
+                                        TypeDistribution dist, double magnitude,
+                                        std::vector<TasmanianDREAM> &populations,
+                                        const std::vector<double> &inverse_temperatures,
+                                        double differential_update,
+                                        CounterRandom &master,
+                                        int swap_frequency = 1){
+
+    if (populations.empty()) throw std::runtime_error("ERROR: tempered DREAM sampling requires at least one population.");
+    if (populations.size() != inverse_temperatures.size()) throw std::runtime_error("ERROR: tempered DREAM sampling requires one inverse temperature for each population.");
+    if (swap_frequency < 1) throw std::runtime_error("ERROR: tempered DREAM sampling requires positive swap_frequency.");
+    size_t num_populations = populations.size();
+    int num_chains = populations[0].getNumChains();
+    size_t num_dimensions = (size_t) populations[0].getNumDimensions();
+    for(size_t k=0; k<num_populations; k++){
+        if ((populations[k].getNumChains() != num_chains) || (populations[k].getNumDimensions() != (int) num_dimensions))
+            throw std::runtime_error("ERROR: tempered DREAM sampling requires populations with the same number of chains and dimensions.");
+        if (!populations[k].isStateReady()) throw std::runtime_error("ERROR: DREAM sampling requires that the setState() has been called first on the TasmanianDREAM.");
+        if (inverse_temperatures[k] < 0.0) throw std::runtime_error("ERROR: tempered DREAM sampling requires non-negative inverse temperatures.");
+        if (!populations[k].isPDFReady()) // initialize probability density (if not initialized already)
+            populations[k].setPDFvalues(probability_distribution);
+    }
+
+    TasmanianDREAM &cold = populations[0];
+    if (num_collect > 0) // pre-allocate memory for the new history
+        cold.expandHistory(num_collect);
+
+    int num_total = (int) num_populations * num_chains; // chains across all populations
+    std::vector<CounterRandom> streams;
+    streams.reserve((size_t) num_total + 1);
+    unsigned long long seed = master.getRandom64();
+    for(int m=0; m<=num_total; m++) streams.emplace_back(seed, (unsigned long long) m);
+    CounterRandom &swap_rng = streams.back();
+
+    // work arrays, allocated once for all iterations
+    std::vector<std::vector<double>> proposals((size_t) num_total, std::vector<double>(num_dimensions));
+    std::vector<int> position((size_t) num_total);
+    std::vector<double> candidates, values, swap_x(num_dimensions), swap_y(num_dimensions);
+    candidates.reserve((size_t) num_total * num_dimensions);
+    values.reserve((size_t) num_total);
+    std::vector<double> swap_accepted(num_populations - 1, 0.0), swap_attempted(num_populations - 1, 0.0);
+
+    int total_iterations = std::max(num_burnup, 0) + std::max(num_collect, 0);
+    for(int t = 0; t < total_iterations; t++){
+        #pragma omp parallel for schedule(static)
+        for(int m=0; m<num_total; m++){
+            const TasmanianDREAM &state = populations[(size_t) (m / num_chains)];
+            size_t i = (size_t) (m % num_chains);
+            CounterRandom &rng = streams[(size_t) m];
+            size_t jindex = rng.getIndex((size_t) num_chains);
+            size_t kindex = rng.getIndex((size_t) num_chains);
+
+            state.getIJKdelta(i, jindex, kindex, differential_update, proposals[(size_t) m]); // propose = s_i + w ( s_k - s_j)
+            if (dist == dist_uniform){
+                applyUniformUpdate(proposals[(size_t) m], magnitude, rng);
+            }else{ // assuming Gaussian
+                applyGaussianUpdate(proposals[(size_t) m], magnitude, rng);
+            }
+
+            position[(size_t) m] = (inside(proposals[(size_t) m])) ? 0 : -1;
+        }
+
+        candidates.clear(); // all populations are evaluated together in one batch
+        int num_valid = 0;
+        for(int m=0; m<num_total; m++){
+            if (position[(size_t) m] == 0){
+                candidates.insert(candidates.end(), proposals[(size_t) m].begin(), proposals[(size_t) m].end());
+                position[(size_t) m] = num_valid++;
+            }
+        }
+        values.resize((size_t) num_valid);
+
+        probability_distribution(candidates, values);
+
+        int accepted = 0; // counts only the cold population
+        #pragma omp parallel for schedule(static) reduction(+:accepted)
+        for(int m=0; m<num_total; m++){
+            int p = position[(size_t) m];
+            if (p >= 0){ // if not valid, automatically reject
+                size_t k = (size_t) (m / num_chains), i = (size_t) (m % num_chains);
+                double beta = inverse_temperatures[k];
+                double new_value = values[(size_t) p], old_value = populations[k].getPDFvalue(i);
+                double u = streams[(size_t) m](); // always draw, so the streams do not depend on the outcome
+                bool keep_new = (new_value > old_value) // if the new value has higher probability, automatically accept
+                                || ((form == regform) ? (std::pow(new_value / old_value, beta) >= u) : (beta * (new_value - old_value) >= std::log(u)));
+                if (keep_new){
+                    populations[k].setChainState(i, &candidates[((size_t) p) * num_dimensions], new_value);
+                    if (k == 0) accepted++;
+                }
+            }
+        }
+
+        if ((t + 1) % swap_frequency == 0){ // exchange states between neighboring temperatures
+            for(size_t k = (size_t) ((t / swap_frequency) % 2); k + 1 < num_populations; k += 2){
+                double dbeta = inverse_temperatures[k] - inverse_temperatures[k+1];
+                for(size_t i=0; i<(size_t) num_chains; i++){
+                    double vk = populations[k].getPDFvalue(i), vn = populations[k+1].getPDFvalue(i);
+                    double u = swap_rng();
+                    bool swap = (form == regform) ? ((vk == 0.0) || (std::pow(vn / vk, dbeta) >= u)) : (dbeta * (vn - vk) >= std::log(u));
+                    swap_attempted[k] += 1.0;
+                    if (swap){
+                        populations[k].getChainState(i, swap_x.data());
+                        populations[k+1].getChainState(i, swap_y.data());
+                        populations[k].setChainState(i, swap_y.data(), vn);
+                        populations[k+1].setChainState(i, swap_x.data(), vk);
+                        swap_accepted[k] += 1.0;
+                    }
+                }
+            }
+        }
+
+        if (t >= num_burnup){
+            cold.saveStateHistory((size_t) accepted);
+            if (cold.checkCollectStop()) break; // collected the target effective sample size
+        }else if (cold.checkBurnupStop(t)){
+            t = num_burnup - 1; // the chains have converged, skip the rest of the burnup
+        }
+    }
+
+    for(size_t k=0; k+1<num_populations; k++) swap_accepted[k] = (swap_attempted[k] > 0.0) ? swap_accepted[k] / swap_attempted[k] : 0.0;
+    return swap_accepted;
+}
+
+//! \brief Overload of \b SampleDREAMTempered() assuming the domain is a hyperbube with min/max values given by \b lower and \b upper.
+//! \ingroup DREAMSampleCore
+template<TypeSamplingForm form = regform>
+std::vector<double> SampleDREAMTempered(int num_burnup, int num_collect,
+                                        std::function<void(const std::vector<double> &candidates, std::vector<double> &values)> probability_distribution,
+                                        const std::vector<double> &lower, const std::vector<double> &upper,
+                                        TypeDistribution dist, double magnitude,
+                                        std::vector<TasmanianDREAM> &populations,
+                                        const std::vector<double> &inverse_temperatures,
+                                        double differential_update,
+                                        CounterRandom &master,
+                                        int swap_frequency = 1){
+    if (populations.empty()) throw std::runtime_error("ERROR: tempered DREAM sampling requires at least one population.");
+    checkLowerUpper(lower, upper, populations[0]);
+    return SampleDREAMTempered<form>(num_burnup, num_collect, probability_distribution, makeHypercudabeLambda(lower, upper),
+                                     dist, magnitude, populations, inverse_temperatures, differential_update, master, swap_frequency);
+}
+
+//! \brief Overload of \b SampleDREAMTempered() with probability distribution defined by a sparse \b grid and a \b prior (see \b SampleDREAMGrid()).
+//! \ingroup DREAMSampleGrid
+
+//! The candidates of all populations are evaluated with a single call to \b grid.evaluateBatch() per iteration.
+template<TypeSamplingForm form = regform>
+std::vector<double> SampleDREAMTempered(int num_burnup, int num_collect,
+                                        const TasGrid::TasmanianSparseGrid &grid,
+                                        std::function<void(const std::vector<double> &candidates, std::vector<double> &values)> prior,
+                                        const std::vector<double> &lower, const std::vector<double> &upper,
+                                        TypeDistribution dist, double magnitude,
+                                        std::vector<TasmanianDREAM> &populations,
+                                        const std::vector<double> &inverse_temperatures,
+                                        double differential_update,
+                                        CounterRandom &master,
+                                        int swap_frequency = 1){
+    if (populations.empty()) throw std::runtime_error("ERROR: tempered DREAM sampling requires at least one population.");
+    checkGridSTate(grid, populations[0]);
+    return SampleDREAMTempered<form>(num_burnup, num_collect, makePDFGridPrior<form>(grid, prior), lower, upper,
+                                     dist, magnitude, populations, inverse_temperatures, differential_update, master, swap_frequency);
+}
+
+}
+
+#endif
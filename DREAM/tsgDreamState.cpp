@@ -36,12 +36,15 @@
 namespace TasDREAM{
 
 TasmanianDREAM::TasmanianDREAM(int cnum_chains, int cnum_dimensions) :
-num_chains(cnum_chains), num_dimensions(cnum_dimensions), init_state(false), init_values(false), accepted(0){
+num_chains(cnum_chains), num_dimensions(cnum_dimensions), init_state(false), init_values(false), accepted(0), num_snapshots(0), thinning(1), ring_size(0), ring_next(0), keep_history(true),
+    early_rhat(0.0), early_ess(0.0), burnup_diagnostics(std::max(cnum_chains, 1), std::max(cnum_dimensions, 1)), collect_diagnostics(std::max(cnum_chains, 1), std::max(cnum_dimensions, 1)){
     if (cnum_chains < 1) throw std::invalid_argument("ERROR: num_chains must be positive");
     if (cnum_dimensions < 1) throw std::invalid_argument("ERROR: num_dimensions must be positive");
 }
 TasmanianDREAM::TasmanianDREAM(int cnum_chains, const TasGrid::TasmanianSparseGrid &grid) :
-num_chains(cnum_chains), num_dimensions(grid.getNumDimensions()), init_state(false), init_values(false), accepted(0){
+num_chains(cnum_chains), num_dimensions(grid.getNumDimensions()), init_state(false), init_values(false), accepted(0), num_snapshots(0), thinning(1), ring_size(0), ring_next(0), keep_history(true),
+    early_rhat(0.0), early_ess(0.0), burnup_diagnostics(std::max(cnum_chains, 1), std::max(grid.getNumDimensions(), 1)),
+    collect_diagnostics(std::max(cnum_chains, 1), std::max(grid.getNumDimensions(), 1)){
     if (cnum_chains < 1) throw std::invalid_argument("ERROR: num_chains must be positive");
     if (grid.getNumDimensions() < 1) throw std::invalid_argument("ERROR: num_dimensions must be positive");
 }
@@ -90,54 +93,118 @@ void TasmanianDREAM::getIJKdelta(size_t i, size_t j, size_t k, double w, std::ve
     }
 }
 
-void TasmanianDREAM::expandHistory(int num_snapshots){
-    history.reserve(history.size() + num_snapshots * num_dimensions * num_chains);
-    pdf_history.reserve(pdf_history.size() + num_snapshots * num_chains);
+DreamWorkspace& TasmanianDREAM::getWorkspace(){
+    if (workspace.proposal.size() != num_dimensions){
+        workspace.candidates.reserve(num_chains * num_dimensions);
+        workspace.values.reserve(num_chains);
+        workspace.proposal.resize(num_dimensions);
+        workspace.valid.resize(num_chains);
+        workspace.chain_proposals.resize(num_chains, std::vector<double>(num_dimensions));
+        workspace.position.resize(num_chains);
+    }
+    return workspace;
+}
+
+void TasmanianDREAM::expandHistory(int num_snapshots_expand){
+    if (sink || !keep_history) return; // the history is not kept in memory
+    size_t num_new = ((size_t) num_snapshots_expand + thinning - 1) / thinning;
+    size_t num_total = pdf_history.size() / num_chains + num_new;
+    if (ring_size > 0) num_total = std::min(num_total, ring_size);
+    history.reserve(num_total * num_dimensions * num_chains);
+    pdf_history.reserve(num_total * num_chains);
 }
 
 void TasmanianDREAM::saveStateHistory(size_t num_accepted){
-    history.insert(history.end(), state.begin(), state.end());
-    pdf_history.insert(pdf_history.end(), pdf_values.begin(), pdf_values.end());
     accepted += num_accepted;
+    for(auto &monitor : monitors) monitor(state.data(), pdf_values.data(), num_chains);
+    if (early_ess > 0.0) collect_diagnostics.update(state.data(), pdf_values.data(), num_chains);
+    bool save_snapshot = keep_history && (num_snapshots % thinning == 0);
+    num_snapshots++;
+    if (!save_snapshot) return;
+
+    if (sink){
+        sink->append(state.data(), pdf_values.data(), num_chains);
+    }else if ((ring_size > 0) && (pdf_history.size() == ring_size * num_chains)){ // ring buffer is full, overwrite the oldest snapshot
+        std::copy(state.begin(), state.end(), history.begin() + ring_next * num_chains * num_dimensions);
+        std::copy(pdf_values.begin(), pdf_values.end(), pdf_history.begin() + ring_next * num_chains);
+        ring_next = (ring_next + 1) % ring_size;
+    }else{
+        history.insert(history.end(), state.begin(), state.end());
+        pdf_history.insert(pdf_history.end(), pdf_values.begin(), pdf_values.end());
+    }
 }
 
-void TasmanianDREAM::getHistoryMeanVariance(std::vector<double> &mean, std::vector<double> &var) const{
-    mean.resize(num_dimensions);
-    var.resize(num_dimensions);
-    std::fill(mean.begin(), mean.end(), 0.0);
-    std::fill(var.begin(), var.end(), 0.0);
-
-    auto ih = history.begin();
-    while(ih != history.end()){
-        auto im = mean.begin();
-        auto iv = var.begin();
-        for(size_t i=0; i<num_dimensions; i++){
-            *iv++ += *ih * *ih;
-            *im++ += *ih++;
-        }
-    }
+void TasmanianDREAM::readHistory(std::function<void(const double x[], const double pdf[], size_t num_samples)> reader) const{
+    if (!pdf_history.empty()) reader(history.data(), pdf_history.data(), pdf_history.size());
+    if (sink) sink->readChunks(reader);
+}
 
-    double n = (double) (history.size() / num_dimensions);
-    for(auto &m : mean) m /= n;
+void TasmanianDREAM::setHistoryThinning(int every){
+    if (every < 1) throw std::invalid_argument("ERROR: history thinning must be positive");
+    if (num_snapshots > 0) throw std::runtime_error("ERROR: the history policy can be changed only before collecting history or after clearHistory()");
+    thinning = (size_t) every;
+}
+
+void TasmanianDREAM::setHistoryRingBuffer(int num_ring_snapshots){
+    if (num_ring_snapshots < 0) throw std::invalid_argument("ERROR: the size of the history ring buffer cannot be negative");
+    if (num_snapshots > 0) throw std::runtime_error("ERROR: the history policy can be changed only before collecting history or after clearHistory()");
+    if (sink && (num_ring_snapshots > 0)) throw std::runtime_error("ERROR: the history ring buffer cannot be combined with spilling the history to a file");
+    ring_size = (size_t) num_ring_snapshots;
+    ring_next = 0;
+}
 
-    auto im = mean.begin();
-    for(auto &v : var){
-        v /= n;
-        v -= *im * *im;
-        im++;
+void TasmanianDREAM::setHistorySpill(const std::string &filename, int block_snapshots){
+    if (num_snapshots > 0) throw std::runtime_error("ERROR: the history policy can be changed only before collecting history or after clearHistory()");
+    if (filename.empty()){
+        sink.reset();
+        return;
     }
+    if (block_snapshots < 1) throw std::invalid_argument("ERROR: the history block size must be positive");
+    if (ring_size > 0) throw std::runtime_error("ERROR: the history ring buffer cannot be combined with spilling the history to a file");
+    sink.open(filename, num_dimensions, ((size_t) block_snapshots) * num_chains);
+}
+
+void TasmanianDREAM::setKeepHistory(bool keep){
+    if (num_snapshots > 0) throw std::runtime_error("ERROR: the history policy can be changed only before collecting history or after clearHistory()");
+    keep_history = keep;
+}
+
+void TasmanianDREAM::setEarlyStop(double max_rhat, double target_ess){
+    early_rhat = max_rhat;
+    early_ess = target_ess;
+}
+
+bool TasmanianDREAM::checkBurnupStop(int iteration){
+    if (early_rhat <= 0.0) return false;
+    if ((iteration & (iteration - 1)) == 0) burnup_diagnostics.clear(); // restart the window at powers of two (and zero)
+    burnup_diagnostics.update(state.data(), pdf_values.data(), num_chains);
+    // use the window only if it covers at least a third of the iterations, and at least 10 snapshots
+    size_t window = burnup_diagnostics.getNumSnapshots();
+    if ((window < 10) || (3 * window < (size_t) iteration + 1)) return false;
+    return (burnup_diagnostics.getMaxRhat() < early_rhat);
+}
+
+void TasmanianDREAM::getHistoryMeanVariance(std::vector<double> &mean, std::vector<double> &var) const{
+    AccumulatorMeanVariance meanvar((int) num_dimensions);
+    readHistory([&](const double x[], const double pdf[], size_t num_samples)->void{ meanvar.update(x, pdf, num_samples); });
+    mean = meanvar.getMean();
+    meanvar.getVariance(var);
 }
 
 void TasmanianDREAM::getApproximateMode(std::vector<double> &mode) const{
-    auto imax = std::max_element(pdf_history.begin(), pdf_history.end());
-    mode.resize(num_dimensions);
-    std::copy_n(history.begin() + std::distance(pdf_history.begin(), imax) * num_dimensions, num_dimensions, mode.data());
+    AccumulatorMode accmode((int) num_dimensions);
+    readHistory([&](const double x[], const double pdf[], size_t num_samples)->void{ accmode.update(x, pdf, num_samples); });
+    mode = accmode.getMode();
 }
 
 void TasmanianDREAM::clearHistory(){
     history = std::vector<double>();
     pdf_history = std::vector<double>();
     accepted = 0;
+    num_snapshots = 0;
+    ring_next = 0;
+    if (sink) sink->clear();
+    collect_diagnostics.clear();
 }
 
 }
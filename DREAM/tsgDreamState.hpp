@@ -31,7 +31,8 @@
 #ifndef __TASMANIAN_DREAM_STATE_HPP
 #define __TASMANIAN_DREAM_STATE_HPP
 
-#include "tsgDreamEnumerates.hpp"
+#include "tsgDreamHistorySink.hpp"
+#include "tsgDreamAccumulators.hpp"
 
 //! \internal
 //! \file tsgDreamState.hpp
@@ -51,6 +52,27 @@
 
 namespace TasDREAM{
 
+//! \internal
+//! \brief Work arrays used by the \b DREAM sampler, kept in the TasmanianDREAM class so that they persist between iterations.
+//! \ingroup DREAMState
+
+//! The arrays are allocated once with capacity for all chains and reused by every iteration of every sampling call,
+//! thus the sampling loop does not allocate memory.
+struct DreamWorkspace{
+    //! \brief The candidates that pass the \b inside() test, one after another.
+    std::vector<double> candidates;
+    //! \brief The values of the probability distribution at the candidates.
+    std::vector<double> values;
+    //! \brief The proposal for the current chain, written in place by getIJKdelta() and the independent update.
+    std::vector<double> proposal;
+    //! \brief Indicates whether the proposal for each chain has passed the \b inside() test.
+    std::vector<bool> valid;
+    //! \brief Separate proposal for each chain, used when the proposals are formed in parallel.
+    std::vector<std::vector<double>> chain_proposals;
+    //! \brief The index of the chain candidate within \b values (or -1 if the proposal is not valid), used in parallel sampling.
+    std::vector<int> position;
+};
+
 //! \brief Contains the current state and the history of the DREAM chains.
 //! \ingroup DREAMState
 
@@ -67,6 +89,19 @@ namespace TasDREAM{
 //! where the vectors are stored using std::vector data structures.
 //! Methods are provided for file I/O, direct access to the data and
 //! several handy queries for inference or optimization problems.
+//!
+//! \par History policies
+//! By default, all snapshots are kept in memory, which can be prohibitive for long runs
+//! with many chains and dimensions. The memory can be bounded with:
+//! - \b setHistoryThinning() keeps only every k-th snapshot;
+//! - \b setHistoryRingBuffer() keeps only the most recent snapshots in a fixed size buffer;
+//! - \b setHistorySpill() writes the snapshots to a binary file (in large blocks using a background thread).
+//!
+//! Thinning can be combined with either of the other two policies.
+//! Alternatively, \b setKeepHistory() can disable the history altogether and the statistics can be
+//! computed on-the-fly with the accumulators in \ref DREAMAccumulators, see \b addHistoryMonitor().
+//! The analysis methods, e.g., \b getHistoryMeanVariance() and \b getApproximateMode(), work with all policies
+//! and read the spilled history from the file one block at a time, see also \b readHistory().
 class TasmanianDREAM{
 public:
     //! \brief Constructor for a DREAM state with the number of chains and dimensions.
@@ -89,8 +124,8 @@ public:
     int getNumDimensions() const{ return (int) num_dimensions; }
     //! \brief Return the number of chains.
     int getNumChains() const{ return (int) num_chains; }
-    //! \brief Return the number of saved vectors in the history.
-    size_t getNumHistory() const{ return pdf_history.size(); }
+    //! \brief Return the number of saved vectors in the history, including the vectors spilled to a file.
+    size_t getNumHistory() const{ return pdf_history.size() + ((sink) ? sink->getNumSamples() : 0); }
 
     //! \brief Return \b true if the state has already been initialized with \b setState().
     bool isStateReady() const{ return init_state; }
@@ -147,6 +182,20 @@ public:
     //! \brief Return a const reference to the internal state vector.
     const std::vector<double>& getChainState() const{ return state; }
 
+    //! \brief Overwrite the state of the \b i-th chain with the array \b x and set the value of the probability distribution to \b pdf_value.
+
+    //! Used by the \b DREAM sampler to accept a candidate and probably should not be called by the user.
+    //! Since all proposals are formed before the state is updated, the new state is written in place.
+    void setChainState(size_t i, const double x[], double pdf_value){
+        std::copy_n(x, num_dimensions, state.begin() + i * num_dimensions);
+        pdf_values[i] = pdf_value;
+    }
+
+    //! \brief Return the work arrays for the sampler, the arrays are allocated (with capacity for all chains) only on the first call.
+
+    //! Used by the \b DREAM sampler and probably should not be called by the user.
+    DreamWorkspace& getWorkspace();
+
     //! \brief Return the value of the probability_distribution of the \b i-th chain.
 
     //! Used by the \b DREAM sampler and probably should not be called by the user.
@@ -155,40 +204,126 @@ public:
     //! \brief Allocate (expand) internal storage for the history snapshots, avoids reallocating data when saving a snapshot.
 
     //! Used by the \b DREAM sampler and probably should not be called by the user.
-    void expandHistory(int num_snapshots);
+    void expandHistory(int num_snapshots_expand);
 
     //! \brief Appends the current state to the history.
 
     //! Used by the \b DREAM sampler and probably should not be called by the user; \b num_accepted is the number of new chains in the state.
     void saveStateHistory(size_t num_accepted);
 
-    //! \brief Return a const reference to the internal state vector.
+    //! \brief Return a const reference to the history stored in memory.
+
+    //! If the history is spilled to a file, the snapshots are not kept in memory and the vector is empty, use \b readHistory() instead.
+    //! If using a ring buffer, the snapshots are stored circularly, i.e., once the buffer is full
+    //! the oldest snapshot is overwritten by the newest one.
     const std::vector<double>& getHistory() const{ return history; }
 
-    //! \brief Return a const reference to the internal state vector.
+    //! \brief Return a const reference to the values of the probability distribution associated with the history in memory.
+
+    //! Same as \b getHistory(), the vector is empty if the history is spilled to a file.
     const std::vector<double>& getHistoryPDF() const{ return pdf_history; }
 
+    //! \brief Call \b reader with consecutive chunks of the history, works with the memory and the spilled history.
+
+    //! The \b reader is given arrays with \b num_samples vectors (num_dimensions entries each) and
+    //! the associated values of the probability distribution. The history in memory is given as a single chunk,
+    //! the history spilled to a file is read one block at a time.
+    void readHistory(std::function<void(const double x[], const double pdf[], size_t num_samples)> reader) const;
+
+    //! \brief Keep only every \b every-th snapshot in the history, the default is 1 (keep all).
+
+    //! Must be called before collecting history or after \b clearHistory().
+    void setHistoryThinning(int every);
+
+    //! \brief Keep only the last \b num_snapshots in the history, 0 means unbounded history (the default).
+
+    //! Must be called before collecting history or after \b clearHistory(), cannot be combined with \b setHistorySpill().
+    void setHistoryRingBuffer(int num_snapshots);
+
+    //! \brief Write the history to the binary \b filename (the file is truncated), data is written in blocks of \b block_snapshots snapshots.
+
+    //! The data is written by a background thread while the sampling continues, at most few blocks are kept in memory.
+    //! An empty \b filename closes the file and returns to storing the history in memory.
+    //! A state that spills the history cannot be copied, the copy constructor and assignment throw \b std::runtime_error;
+    //! the state can still be moved.
+    //! Must be called before collecting history or after \b clearHistory(), cannot be combined with \b setHistoryRingBuffer().
+    void setHistorySpill(const std::string &filename, int block_snapshots = 256);
+
+    //! \brief Enable (default) or disable storing the history, e.g., when only the statistics from history monitors are needed.
+
+    //! Must be called before collecting history or after \b clearHistory().
+    void setKeepHistory(bool keep);
+
+    //! \brief Add a \b monitor that is called by \b saveStateHistory() with every collected snapshot.
+
+    //! The \b monitor is given the current state of the chains and the associated values of the probability distribution,
+    //! using the same signature as \b readHistory(). The monitors see all snapshots regardless of the history policy
+    //! (e.g., thinning) and can be used to update the online accumulators defined in \ref DREAMAccumulators.
+    //! Copies of the TasmanianDREAM object share the monitors.
+    void addHistoryMonitor(std::function<void(const double x[], const double pdf[], size_t num_samples)> monitor){ monitors.push_back(monitor); }
+
+    //! \brief Enable early termination of the sampling, \b SampleDREAM() will stop the burnup and collection iterations early.
+
+    //! The burnup iterations stop once the R-hat (see \b AccumulatorConvergence) computed over the most recent
+    //! burnup iterations drops below \b max_rhat; the window is restarted whenever the iteration count reaches a power of two,
+    //! so that the initial transient is discarded.
+    //! The collection iterations stop once the effective sample size of the collected snapshots (the smallest over all dimensions)
+    //! reaches \b target_ess and the R-hat of the collected snapshots is below \b max_rhat.
+    //! The number of burnup and collection iterations given to \b SampleDREAM() become upper bounds.
+    //! A non-positive \b max_rhat disables the burnup criteria and a non-positive \b target_ess disables the collection criteria.
+    void setEarlyStop(double max_rhat, double target_ess);
+
+    //! \brief Disable early termination of the sampling.
+    void clearEarlyStop(){ setEarlyStop(0.0, 0.0); }
+
+    //! \brief Return the convergence diagnostics for the collected history, updated only if early stop has been set.
+    const AccumulatorConvergence& getConvergenceDiagnostics() const{ return collect_diagnostics; }
+
+    //! \brief Used by the \b DREAM sampler, returns \b true if the burnup can stop at the \b iteration (counted from zero).
+
+    //! Used by the \b DREAM sampler and probably should not be called by the user.
+    bool checkBurnupStop(int iteration);
+
+    //! \brief Used by the \b DREAM sampler, returns \b true if enough samples have been collected.
+
+    //! Used by the \b DREAM sampler and probably should not be called by the user.
+    bool checkCollectStop() const{
+        return (early_ess > 0.0) && (collect_diagnostics.getMinESS() >= early_ess) && ((early_rhat <= 0.0) || (collect_diagnostics.getMaxRhat() < early_rhat));
+    }
+
+    //! \brief Remove all history monitors.
+    void clearHistoryMonitors(){ monitors = std::vector<std::function<void(const double x[], const double pdf[], size_t num_samples)>>(); }
+
     //! \brief Compute the means and variance of the saved history.
     void getHistoryMeanVariance(std::vector<double> &mean, std::vector<double> &var) const;
 
     //! \brief Return the sample with highest probability, searchers within the history.
     void getApproximateMode(std::vector<double> &mode) const;
 
-    //! \brief Clear the stored history (does not touch the state).
+    //! \brief Clear the stored history (does not touch the state), the history policies are not changed.
     void clearHistory();
 
-    //! \brief Returns the acceptance rate of the current history.
-    double getAcceptanceRate() const{ return ((pdf_history.empty()) ? 0 : ((double) accepted) / ((double) pdf_history.size())); }
+    //! \brief Returns the acceptance rate of the current history (counts all snapshots, including the ones discarded by the history policy).
+    double getAcceptanceRate() const{ return ((num_snapshots == 0) ? 0 : ((double) accepted) / ((double) (num_snapshots * num_chains))); }
 
-    // file I/O
 private:
     size_t num_chains, num_dimensions;
     bool init_state, init_values;
 
-    size_t accepted;
+    size_t accepted, num_snapshots;
+    size_t thinning, ring_size, ring_next;
+    bool keep_history;
 
     std::vector<double> state, history;
     std::vector<double> pdf_values, pdf_history;
+
+    HistorySinkOwner sink;
+    std::vector<std::function<void(const double x[], const double pdf[], size_t num_samples)>> monitors;
+
+    double early_rhat, early_ess;
+    AccumulatorConvergence burnup_diagnostics, collect_diagnostics;
+
+    DreamWorkspace workspace;
 };
 
 }
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2017, Miroslav Stoyanov
+ *
+ * This file is part of
+ * Toolkit for Adaptive Stochastic Modeling And Non-Intrusive ApproximatioN: TASMANIAN
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+ *    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * UT-BATTELLE, LLC AND THE UNITED STATES GOVERNMENT MAKE NO REPRESENTATIONS AND DISCLAIM ALL WARRANTIES, BOTH EXPRESSED AND IMPLIED.
+ * THERE ARE NO EXPRESS OR IMPLIED WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT THE USE OF THE SOFTWARE WILL NOT INFRINGE ANY PATENT,
+ * COPYRIGHT, TRADEMARK, OR OTHER PROPRIETARY RIGHTS, OR THAT THE SOFTWARE WILL ACCOMPLISH THE INTENDED RESULTS OR THAT THE SOFTWARE OR ITS USE WILL NOT RESULT IN INJURY OR DAMAGE.
+ * THE USER ASSUMES RESPONSIBILITY FOR ALL LIABILITIES, PENALTIES, FINES, CLAIMS, CAUSES OF ACTION, AND COSTS AND EXPENSES, CAUSED BY, RESULTING FROM OR ARISING OUT OF,
+ * IN WHOLE OR IN PART THE USE, STORAGE OR DISPOSAL OF THE SOFTWARE.
+ */
+
+#ifndef __TASMANIAN_DREAM_WORKER_POOL_CPP
+#define __TASMANIAN_DREAM_WORKER_POOL_CPP
+
+#include "tsgDreamWorkerPool.hpp"
+
+namespace TasDREAM{
+
+DreamWorkerPool::DreamWorkerPool(int num_workers) : stop(false){
+    if (num_workers < 1) num_workers = std::max((int) std::thread::hardware_concurrency(), 1);
+    workers.reserve((size_t) num_workers);
+    for(int i=0; i<num_workers; i++) workers.emplace_back(&DreamWorkerPool::workerLoop, this);
+}
+
+DreamWorkerPool::~DreamWorkerPool(){
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        stop = true;
+    }
+    signal.notify_all();
+    for(auto &w : workers) w.join();
+}
+
+void DreamWorkerPool::submit(std::function<void()> task){
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        tasks.push_back(std::move(task));
+    }
+    signal.notify_one();
+}
+
+void DreamWorkerPool::workerLoop(){
+    std::unique_lock<std::mutex> guard(lock);
+    while(true){
+        signal.wait(guard, [&]()->bool{ return stop || !tasks.empty(); });
+        if (tasks.empty()) return; // stop and no more work
+        auto task = std::move(tasks.front());
+        tasks.pop_front();
+        guard.unlock();
+        task();
+        guard.lock();
+    }
+}
+
+}
+
+#endif
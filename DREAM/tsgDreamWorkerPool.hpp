@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2017, Miroslav Stoyanov
+ *
+ * This file is part of
+ * Toolkit for Adaptive Stochastic Modeling And Non-Intrusive ApproximatioN: TASMANIAN
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+ *    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * UT-BATTELLE, LLC AND THE UNITED STATES GOVERNMENT MAKE NO REPRESENTATIONS AND DISCLAIM ALL WARRANTIES, BOTH EXPRESSED AND IMPLIED.
+ * THERE ARE NO EXPRESS OR IMPLIED WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT THE USE OF THE SOFTWARE WILL NOT INFRINGE ANY PATENT,
+ * COPYRIGHT, TRADEMARK, OR OTHER PROPRIETARY RIGHTS, OR THAT THE SOFTWARE WILL ACCOMPLISH THE INTENDED RESULTS OR THAT THE SOFTWARE OR ITS USE WILL NOT RESULT IN INJURY OR DAMAGE.
+ * THE USER ASSUMES RESPONSIBILITY FOR ALL LIABILITIES, PENALTIES, FINES, CLAIMS, CAUSES OF ACTION, AND COSTS AND EXPENSES, CAUSED BY, RESULTING FROM OR ARISING OUT OF,
+ * IN WHOLE OR IN PART THE USE, STORAGE OR DISPOSAL OF THE SOFTWARE.
+ */
+
+#ifndef __TASMANIAN_DREAM_WORKER_POOL_HPP
+#define __TASMANIAN_DREAM_WORKER_POOL_HPP
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "tsgDreamEnumerates.hpp"
+
+//! \file tsgDreamWorkerPool.hpp
+//! \brief Pool of threads used by the asynchronous DREAM sampler.
+//! \author Miroslav Stoyanov
+//! \ingroup TasmanianDREAM
+//!
+//! Defines the DreamWorkerPool class that executes tasks on a fixed set of background threads.
+
+namespace TasDREAM{
+
+//! \brief Fixed set of threads that execute tasks in the order of submission.
+//! \ingroup DREAMSampleCore
+
+//! The pool is used by the asynchronous \b SampleDREAMAsync() to call a (blocking) model for several candidates at the same time,
+//! e.g., when each model evaluation launches an external simulator.
+//! The threads are started in the constructor and live until the pool is destroyed,
+//! hence, the same pool can be reused by multiple sampling calls without the overhead of creating threads.
+//!
+//! The tasks must not throw, an exception escaping a task will call \b std::terminate()
+//! (the asynchronous sampler catches the model exceptions and reports them in the calling thread).
+class DreamWorkerPool{
+public:
+    //! \brief Start \b num_workers threads, if \b num_workers is not positive then use \b std::thread::hardware_concurrency().
+    DreamWorkerPool(int num_workers = 0);
+    //! \brief Finish all submitted tasks and stop the threads.
+    ~DreamWorkerPool();
+
+    //! \brief Add the \b task to the queue, the call returns immediately and the \b task will be executed by the first available thread.
+    void submit(std::function<void()> task);
+
+    //! \brief Returns the number of threads in the pool.
+    int getNumWorkers() const{ return (int) workers.size(); }
+
+protected:
+    //! \brief The main loop of the worker threads.
+    void workerLoop();
+
+private:
+    std::deque<std::function<void()>> tasks;
+    std::mutex lock;
+    std::condition_variable signal;
+    bool stop;
+    std::vector<std::thread> workers;
+};
+
+}
+
+#endif
@@ -71,6 +71,7 @@ PUBLIC :: tsgClearAll,          &
           tsgGetQuadratureWeightsStatic,    &
           tsgGetInterpolationWeights,       &
           tsgGetInterpolationWeightsStatic, &
+          tsgGetInterpolationWeightsBatch,  &
           tsgLoadNeededPoints, &
           tsgEvaluate,         &
           tsgEvaluateFast,     &
@@ -80,6 +81,7 @@ PUBLIC :: tsgClearAll,          &
           tsgEvaluateSparseHierarchicalFunctions,  &
           tsgGetHierarchicalCoefficients,          &
           tsgGetHierarchicalCoefficientsStatic,    &
+          tsgGetHierarchicalCoefficientsView,      &
           tsgGetComplexHierarchicalCoefficients,   &
           tsgGetComplexHierarchicalCoefficientsStatic, &
           tsgSetHierarchicalCoefficients, &
@@ -580,6 +582,12 @@ subroutine tsgGetInterpolationWeightsStatic(gridID, x, weights)
   call tsggiw(gridID, x, weights)
 end subroutine tsgGetInterpolationWeightsStatic
 !=======================================================================
+subroutine tsgGetInterpolationWeightsBatch(gridID, x, numX, weights)
+  integer :: gridID, numX
+  double precision :: x(:,:), weights(:,:)
+  call tsgiwb(gridID, x, numX, weights)
+end subroutine tsgGetInterpolationWeightsBatch
+!=======================================================================
 subroutine tsgLoadNeededPoints(gridID, values)
   integer :: gridID
   double precision :: values(:,:)
@@ -675,6 +683,25 @@ subroutine tsgGetHierarchicalCoefficientsStatic(gridID, c)
   endif
 end subroutine tsgGetHierarchicalCoefficientsStatic
 !=======================================================================
+! returns a read-only view (no copy) of the coefficients, c(k,i) is the coefficient of output k and point i
+! the view is valid until the grid is modified (e.g., new values are loaded) or freed, do NOT deallocate it
+function tsgGetHierarchicalCoefficientsView(gridID) result(c)
+  use, intrinsic :: iso_c_binding, only: c_ptr, c_f_pointer, c_associated
+  integer :: gridID, numC
+  double precision, pointer :: c(:,:)
+  type(c_ptr) :: cptr
+  c => null()
+  if ( .not. tsgIsFourier(gridID) ) then
+    call tsgghp(gridID, cptr, numC)
+    if ( c_associated(cptr) ) then
+      call c_f_pointer(cptr, c, (/ tsgGetNumOutputs(gridID), tsgGetNumPoints(gridID) /))
+    endif
+  else
+    write(*,*) "ERROR: called tsgGetHierarchicalCoefficientsView() on a Fourier grid, "
+    write(*,*) "       use tsgGetComplexHierarchicalCoefficients() instead"
+  endif
+end function tsgGetHierarchicalCoefficientsView
+!=======================================================================
 function tsgGetComplexHierarchicalCoefficients(gridID) result(c)
   integer :: gridID
   double complex, pointer       :: c(:)
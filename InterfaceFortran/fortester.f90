@@ -1389,6 +1389,63 @@ write(*,*) "Refinement functions:     PASS"
 
 
 
+!=======================================================================
+!       tsgGetInterpolationWeightsBatch(), tsgGetHierarchicalCoefficientsView(), OpenMP
+!=======================================================================
+call tsgMakeLocalPolynomialGrid(gridID, 2, 2, 4, 2, tsg_localp)
+call tsgSetDomainTransform(gridID, transformA=(/ -1.0d0, 1.0d0 /), transformB=(/ 2.0d0, 3.0d0 /))
+points => tsgGetPoints(gridID);  i_b = tsgGetNumPoints(gridID)
+allocate( double_2d_a(2,i_b) )
+double_2d_a(1,:) = exp( points(1,:) + points(2,:) )
+double_2d_a(2,:) = cos( points(1,:) - points(2,:) )
+call tsgLoadNeededPoints(gridID, double_2d_a)
+deallocate(points)
+
+i_a = 40
+allocate( pointsb(2,i_a), double_2d_b(2,i_a), double_2d_c(2,i_a), double_2d_d(i_b,i_a) )
+rnd => random(2,i_a)
+pointsb(1,:) = -1.d0 + 3.d0 * rnd(1,:)
+pointsb(2,:) =  1.d0 + 2.d0 * rnd(2,:)
+call tsgEvaluateBatch(gridID, pointsb, i_a, double_2d_b)
+call tsgGetInterpolationWeightsBatch(gridID, pointsb, i_a, double_2d_d)
+if ( norm2d(matmul(double_2d_a, double_2d_d) - double_2d_b) > 1.d-11 ) then
+  write(*,*) "Mismatch in tsgGetInterpolationWeightsBatch()"
+  stop 1
+endif
+
+! evaluate one point at a time from an OpenMP region
+!$omp parallel do
+do i = 1, i_a
+  call tsgEvaluate(gridID, pointsb(:,i), double_2d_c(:,i))
+enddo
+!$omp end parallel do
+if ( norm2d(double_2d_b - double_2d_c) > 1.d-11 ) then
+  write(*,*) "Mismatch in tsgEvaluate() called from OpenMP"
+  stop 1
+endif
+
+double_pnt_1d_a => tsgGetHierarchicalCoefficients(gridID)
+points => tsgGetHierarchicalCoefficientsView(gridID)
+if ( (size(points,1) .ne. 2) .or. (size(points,2) .ne. i_b) ) then
+  write(*,*) "Mismatch in tsgGetHierarchicalCoefficientsView(): wrong shape"
+  stop 1
+endif
+if ( norm1d(reshape(points, (/ 2*i_b /)) - double_pnt_1d_a) > 1.d-14 ) then
+  write(*,*) "Mismatch in tsgGetHierarchicalCoefficientsView(): wrong values"
+  stop 1
+endif
+call tsgMakeLocalPolynomialGrid(gridID, 2, 2, 4, 2, tsg_localp)
+if ( associated(tsgGetHierarchicalCoefficientsView(gridID)) ) then
+  write(*,*) "Mismatch in tsgGetHierarchicalCoefficientsView(): grid without values"
+  stop 1
+endif
+deallocate(rnd, pointsb, double_2d_a, double_2d_b, double_2d_c, double_2d_d, double_pnt_1d_a)
+
+write(*,*) "Batch and thread-safety:  PASS"
+
+
+
+
 call tsgFreeGridID(gridID)
 call tsgFreeGridID(gridID_II)
 
@@ -31,6 +31,9 @@
 #ifndef __TSG_C2FORT_CPP
 #define __TSG_C2FORT_CPP
 
+#include <atomic>
+#include <mutex>
+
 #include "TasmanianSparseGrid.hpp"
 
 using std::cerr;
@@ -42,57 +45,77 @@ extern "C" void tsgc2fstr_(int *length, const char *str);
 extern "C" void tsgc2fvec_(int *length, double *vect);
 extern "C" void tsgc2fmat_(int *rows, int *cols, double *mat);
 
-TasmanianSparseGrid **_tsg_grid_list;
-int _tsg_num_grids;
+// The grids are stored in blocks of slots that are never moved, resized or freed before the process exits,
+// thus looking up a grid requires no lock and Fortran codes can call the interface from OpenMP regions.
+// Creating and freeing grids is serialized with _tsg_grid_lock, freeing a grid only clears its slot.
+constexpr int _tsg_block_size = 64;
+constexpr int _tsg_max_blocks = 1024;
+std::atomic<std::atomic<TasmanianSparseGrid*>*> _tsg_grid_blocks[_tsg_max_blocks];
+std::mutex _tsg_grid_lock;
+
+// releases the blocks when the process exits, the grids are released by tsgend_() or tsgfre_()
+struct _TsgGridBlocksRelease{
+    ~_TsgGridBlocksRelease(){
+        for(int b=0; b<_tsg_max_blocks; b++){
+            std::atomic<TasmanianSparseGrid*> *block = _tsg_grid_blocks[b].exchange(nullptr);
+            if (block == nullptr) break;
+            for(int i=0; i<_tsg_block_size; i++) delete block[i].load();
+            delete[] block;
+        }
+    }
+} _tsg_grid_blocks_release;
+
+// scratch space for the domain transforms, one per thread
+thread_local Data2D<double> _tsg_workspace;
+
+inline TasmanianSparseGrid* _tsg_grid(const int *id){
+    return _tsg_grid_blocks[*id / _tsg_block_size].load()[*id % _tsg_block_size].load();
+}
 
 extern "C"{
 
 void tsggag_(int *num_active){
+    std::lock_guard<std::mutex> lock(_tsg_grid_lock);
     *num_active = 0;
-    for (int i = 0; i < _tsg_num_grids; i++ )
-        if ( _tsg_grid_list[i] != 0 ) (*num_active)++;
+    for(int b=0; b<_tsg_max_blocks; b++){
+        std::atomic<TasmanianSparseGrid*> *block = _tsg_grid_blocks[b].load();
+        if (block == nullptr) break;
+        for(int i=0; i<_tsg_block_size; i++) if (block[i].load() != nullptr) (*num_active)++;
+    }
 }
 void tsgend_(){
-    if (_tsg_grid_list != 0){
-        for(int i=0; i<_tsg_num_grids; i++){
-            if (_tsg_grid_list[i] != 0) delete _tsg_grid_list[i];
-        }
-        delete[] _tsg_grid_list;
-        _tsg_grid_list = 0;
-        _tsg_num_grids = 0;
+    std::lock_guard<std::mutex> lock(_tsg_grid_lock);
+    for(int b=0; b<_tsg_max_blocks; b++){
+        std::atomic<TasmanianSparseGrid*> *block = _tsg_grid_blocks[b].load();
+        if (block == nullptr) break;
+        for(int i=0; i<_tsg_block_size; i++) delete block[i].exchange(nullptr);
     }
 }
 void tsgnew_(int *returnID){
-    if ( _tsg_grid_list == 0 ){
-        _tsg_num_grids = 4; // assume we are working with 4 grids
-        _tsg_grid_list = new TasmanianSparseGrid*[_tsg_num_grids];
-        for(int i=0; i<_tsg_num_grids; i++) _tsg_grid_list[i] = 0;
-    }
-    int id = 0;
-    while((id < _tsg_num_grids) && (_tsg_grid_list[id] != 0)) id++;
-    // double the number of grids if the assumed number was too small
-    if (id == _tsg_num_grids){
-        TasmanianSparseGrid **_tsg_grid_list_old = _tsg_grid_list;
-        _tsg_num_grids *= 2;
-        _tsg_grid_list = new TasmanianSparseGrid*[_tsg_num_grids];
-        for(int i=0; i<_tsg_num_grids/2; i++) _tsg_grid_list[i] = _tsg_grid_list_old[i];
-        for(int i=_tsg_num_grids/2; i<_tsg_num_grids; i++) _tsg_grid_list[i] = 0;
-        delete[] _tsg_grid_list_old;
-        _tsg_grid_list_old = 0;
+    std::lock_guard<std::mutex> lock(_tsg_grid_lock);
+    for(int b=0; b<_tsg_max_blocks; b++){
+        std::atomic<TasmanianSparseGrid*> *block = _tsg_grid_blocks[b].load();
+        if (block == nullptr){ // all blocks are full, add a new one
+            block = new std::atomic<TasmanianSparseGrid*>[_tsg_block_size];
+            for(int i=0; i<_tsg_block_size; i++) block[i].store(nullptr);
+            _tsg_grid_blocks[b].store(block);
+        }
+        for(int i=0; i<_tsg_block_size; i++){
+            if (block[i].load() == nullptr){
+                block[i].store(new TasmanianSparseGrid());
+                *returnID = b * _tsg_block_size + i;
+                return;
+            }
+        }
     }
-    _tsg_grid_list[id] = new TasmanianSparseGrid();
-    *returnID = id;
+    cerr << "ERROR: exceeded the maximum number of Tasmanian grids in Fortran, " << _tsg_block_size * _tsg_max_blocks << endl;
+    *returnID = -1;
 }
 void tsgfre_(int *id){
-    if (*id < _tsg_num_grids){
-        if (_tsg_grid_list[*id] != 0){
-            delete _tsg_grid_list[*id];
-            _tsg_grid_list[*id] = 0;
-        }
+    std::lock_guard<std::mutex> lock(_tsg_grid_lock);
+    if ((*id >= 0) && (*id < _tsg_block_size * _tsg_max_blocks) && (_tsg_grid_blocks[*id / _tsg_block_size].load() != nullptr)){
+        delete _tsg_grid_blocks[*id / _tsg_block_size].load()[*id % _tsg_block_size].exchange(nullptr);
     }
-    for (int i = 0; i < _tsg_num_grids; i++ )
-        if ( _tsg_grid_list[i] != 0 ) return;
-    tsgend_();
 }
 ////////////////////////////////////////////////////////////////////////
 //   MAIN INTERFACE
@@ -109,10 +132,10 @@ void tsggli_(){
 }
 
 // read/write
-void tsgwri_(int *id, const char *filename, int *binary){ _tsg_grid_list[*id]->write(filename, (*binary != 0)); }
+void tsgwri_(int *id, const char *filename, int *binary){ _tsg_grid(id)->write(filename, (*binary != 0)); }
 void tsgrea_(int *id, const char *filename, int *status){
     try{
-        _tsg_grid_list[*id]->read(filename);
+        _tsg_grid(id)->read(filename);
         *status = 1;
     }catch(std::runtime_error &e){
         cerr << e.what() << endl;
@@ -133,7 +156,7 @@ void tsgmg_(int *id, int *dimensions, int *outputs, int *depth, int *type, int *
     cfn = (opt_flags[3] != 0 ) ? customRuleFilename : 0;
     ll  = (opt_flags[4] != 0 ) ? llimits            : 0;
 
-    _tsg_grid_list[*id]->makeGlobalGrid(*dimensions, *outputs, *depth,
+    _tsg_grid(id)->makeGlobalGrid(*dimensions, *outputs, *depth,
         OneDimensionalMeta::getIOTypeInt(*type), OneDimensionalMeta::getIORuleInt(*rule),
         aw, al, be, cfn, ll);
 }
@@ -144,7 +167,7 @@ void tsgms_(int *id, int *dimensions, int *outputs, int *depth, int *type, int *
     aw  = (opt_flags[0] != 0 ) ? aniso_weights      : 0;
     ll  = (opt_flags[1] != 0 ) ? llimits            : 0;
 
-    _tsg_grid_list[*id]->makeSequenceGrid(*dimensions, *outputs, *depth,
+    _tsg_grid(id)->makeSequenceGrid(*dimensions, *outputs, *depth,
         OneDimensionalMeta::getIOTypeInt(*type), OneDimensionalMeta::getIORuleInt(*rule), aw, ll);
 }
 void tsgml_(int *id, int *dimensions, int *outputs, int *depth, int *opt_flags,
@@ -156,7 +179,7 @@ void tsgml_(int *id, int *dimensions, int *outputs, int *depth, int *opt_flags,
     ord = (opt_flags[1] != 0) ? *order  : 1;
     ll  = (opt_flags[2] != 0) ? llimits : 0;
 
-    _tsg_grid_list[*id]->makeLocalPolynomialGrid(*dimensions, *outputs, *depth, ord, OneDimensionalMeta::getIORuleInt(ru), ll);
+    _tsg_grid(id)->makeLocalPolynomialGrid(*dimensions, *outputs, *depth, ord, OneDimensionalMeta::getIORuleInt(ru), ll);
 }
 void tsgmw_(int *id, int *dimensions, int *outputs, int *depth, int *opt_flags, int *order, const int *llimits){
     int ord;
@@ -165,7 +188,7 @@ void tsgmw_(int *id, int *dimensions, int *outputs, int *depth, int *opt_flags,
     ord = (opt_flags[0] != 0) ? *order  : 1;
     ll  = (opt_flags[1] != 0) ? llimits : 0;
 
-    _tsg_grid_list[*id]->makeWaveletGrid(*dimensions, *outputs, *depth, ord, ll);
+    _tsg_grid(id)->makeWaveletGrid(*dimensions, *outputs, *depth, ord, ll);
 }
 void tsgmf_(int *id, int *dimensions, int *outputs, int *depth, int *type, int *opt_flags, const int *aniso_weights, const int *llimits){
     const int *ll, *aw;
@@ -173,83 +196,88 @@ void tsgmf_(int *id, int *dimensions, int *outputs, int *depth, int *type, int *
     aw = (opt_flags[0] != 0 ) ? aniso_weights : 0;
     ll = (opt_flags[1] != 0 ) ? llimits       : 0;
 
-    _tsg_grid_list[*id]->makeFourierGrid(*dimensions, *outputs, *depth, OneDimensionalMeta::getIOTypeInt(*type), aw, ll);
+    _tsg_grid(id)->makeFourierGrid(*dimensions, *outputs, *depth, OneDimensionalMeta::getIOTypeInt(*type), aw, ll);
 }
 
 // copy/updare
-void tsgcp_(int *id, int *source){ _tsg_grid_list[*id]->copyGrid(_tsg_grid_list[*source]); }
+void tsgcp_(int *id, int *source){ _tsg_grid(id)->copyGrid(_tsg_grid(source)); }
 
 void tsgug_(int *id, int *depth, int *type, int *opt_flags, const int *anisotropic_weights){
     const int *aw;
     aw = (opt_flags[0] != 0) ? anisotropic_weights : 0;
-    _tsg_grid_list[*id]->updateGlobalGrid(*depth, OneDimensionalMeta::getIOTypeInt(*type), aw);
+    _tsg_grid(id)->updateGlobalGrid(*depth, OneDimensionalMeta::getIOTypeInt(*type), aw);
 }
 void tsgus_(int *id, int *depth, int *type, int *opt_flags, const int *anisotropic_weights){
     const int *aw;
     aw = (opt_flags[0] != 0) ? anisotropic_weights : 0;
-    _tsg_grid_list[*id]->updateSequenceGrid(*depth, OneDimensionalMeta::getIOTypeInt(*type), aw);
+    _tsg_grid(id)->updateSequenceGrid(*depth, OneDimensionalMeta::getIOTypeInt(*type), aw);
 }
 
 // getAlpha/Beta/Order/Dims/Outs/Rule //
-void tsggal_(int *id, double *alpha){ *alpha = _tsg_grid_list[*id]->getAlpha(); }
-void tsggbe_(int *id, double *beta){ *beta = _tsg_grid_list[*id]->getBeta(); }
-void tsggor_(int *id, int *order){ *order = _tsg_grid_list[*id]->getOrder(); }
-void tsggnd_(int *id, int *dims){ *dims = _tsg_grid_list[*id]->getNumDimensions(); }
-void tsggno_(int *id, int *outs){ *outs = _tsg_grid_list[*id]->getNumOutputs(); }
-void tsggru_(int *id, int *rule){ *rule = OneDimensionalMeta::getIORuleInt(_tsg_grid_list[*id]->getRule()); }
+void tsggal_(int *id, double *alpha){ *alpha = _tsg_grid(id)->getAlpha(); }
+void tsggbe_(int *id, double *beta){ *beta = _tsg_grid(id)->getBeta(); }
+void tsggor_(int *id, int *order){ *order = _tsg_grid(id)->getOrder(); }
+void tsggnd_(int *id, int *dims){ *dims = _tsg_grid(id)->getNumDimensions(); }
+void tsggno_(int *id, int *outs){ *outs = _tsg_grid(id)->getNumOutputs(); }
+void tsggru_(int *id, int *rule){ *rule = OneDimensionalMeta::getIORuleInt(_tsg_grid(id)->getRule()); }
 
 // getNumNeeded/Loaded/Points
-void tsggnn_(int *id, int *num_points){ *num_points = _tsg_grid_list[*id]->getNumNeeded(); }
-void tsggnl_(int *id, int *num_points){ *num_points = _tsg_grid_list[*id]->getNumLoaded(); }
-void tsggnp_(int *id, int *num_points){ *num_points = _tsg_grid_list[*id]->getNumPoints(); }
+void tsggnn_(int *id, int *num_points){ *num_points = _tsg_grid(id)->getNumNeeded(); }
+void tsggnl_(int *id, int *num_points){ *num_points = _tsg_grid(id)->getNumLoaded(); }
+void tsggnp_(int *id, int *num_points){ *num_points = _tsg_grid(id)->getNumPoints(); }
 
 // getLoaded/Needed/Points
-void tsgglp_(int *id, double *points){ _tsg_grid_list[*id]->getLoadedPoints(points); }
-void tsggdp_(int *id, double *points){ _tsg_grid_list[*id]->getNeededPoints(points); }
-void tsggpp_(int *id, double *points){ _tsg_grid_list[*id]->getPoints(points); }
+void tsgglp_(int *id, double *points){ _tsg_grid(id)->getLoadedPoints(points); }
+void tsggdp_(int *id, double *points){ _tsg_grid(id)->getNeededPoints(points); }
+void tsggpp_(int *id, double *points){ _tsg_grid(id)->getPoints(points); }
 
 // getQuadrature/InterpolationWeights
-void tsggqw_(int *id, double *weights){ _tsg_grid_list[*id]->getQuadratureWeights(weights); }
-void tsggiw_(int *id, const double *x, double *weights){ _tsg_grid_list[*id]->getInterpolationWeights(x,weights); }
+void tsggqw_(int *id, double *weights){ _tsg_grid(id)->getQuadratureWeights(weights); }
+void tsggiw_(int *id, const double *x, double *weights){ _tsg_grid(id)->getInterpolationWeights(x,weights); }
 
 // set/is/clear/getDomainTransform
-void tsgsdt_(int *id, const double *transform_a, const double *transform_b){ _tsg_grid_list[*id]->setDomainTransform(transform_a, transform_b); }
-void tsgidt_(int *id, int *result){ *result = (_tsg_grid_list[*id]->isSetDomainTransfrom()) ? 1 : 0; }
-void tsgcdt_(int *id){ _tsg_grid_list[*id]->clearDomainTransform(); }
-void tsggdt_(int *id, double *transform_a, double *transform_b){ _tsg_grid_list[*id]->getDomainTransform(transform_a, transform_b); }
+void tsgsdt_(int *id, const double *transform_a, const double *transform_b){ _tsg_grid(id)->setDomainTransform(transform_a, transform_b); }
+void tsgidt_(int *id, int *result){ *result = (_tsg_grid(id)->isSetDomainTransfrom()) ? 1 : 0; }
+void tsgcdt_(int *id){ _tsg_grid(id)->clearDomainTransform(); }
+void tsggdt_(int *id, double *transform_a, double *transform_b){ _tsg_grid(id)->getDomainTransform(transform_a, transform_b); }
 
 // loadNeededPoints
-void tsglnp_(int *id, const double *vals){ _tsg_grid_list[*id]->loadNeededPoints(vals); }
+void tsglnp_(int *id, const double *vals){ _tsg_grid(id)->loadNeededPoints(vals); }
 
 // evaluate/Fast/Batch/integrate
-void tsgeva_(int *id, const double *x, double *y){ _tsg_grid_list[*id]->evaluate(x, y); }
-void tsgevf_(int *id, const double *x, double *y){ _tsg_grid_list[*id]->evaluateFast(x, y); }
-void tsgevb_(int *id, const double *x, int *num_x, double *y){ _tsg_grid_list[*id]->evaluateBatch(x, (*num_x), y); }
-void tsgint_(int *id, double *q){ _tsg_grid_list[*id]->integrate(q); }
+void tsgeva_(int *id, const double *x, double *y){ _tsg_grid(id)->evaluate(x, y); }
+void tsgevf_(int *id, const double *x, double *y){ _tsg_grid(id)->evaluateFast(x, y); }
+void tsgevb_(int *id, const double *x, int *num_x, double *y){ _tsg_grid(id)->evaluateBatch(x, (*num_x), y, _tsg_workspace); }
+void tsgint_(int *id, double *q){ _tsg_grid(id)->integrate(q); }
+void tsgiwb_(int *id, const double *x, int *num_x, double *weights){ _tsg_grid(id)->getInterpolationWeightsBatch(x, (*num_x), weights, _tsg_workspace); }
 
 // hierarchical functions/coefficients
 void tsgehf_(int *id, const double *x, int *num_x, double *y){
-    _tsg_grid_list[*id]->evaluateHierarchicalFunctions(x, (*num_x), y);}
+    _tsg_grid(id)->evaluateHierarchicalFunctions(x, (*num_x), y, _tsg_workspace);}
 void tsgehs_(int *id, const double *x, int *num_x, int *pntr, int *indx, double *vals){
-    _tsg_grid_list[*id]->evaluateSparseHierarchicalFunctionsStatic(x, *num_x, pntr, indx, vals);}
+    _tsg_grid(id)->evaluateSparseHierarchicalFunctionsStatic(x, *num_x, pntr, indx, vals);}
 void tsgehz_(int *id, const double *x, int *num_x, int *num_nz){
-    *num_nz = _tsg_grid_list[*id]->evaluateSparseHierarchicalFunctionsGetNZ(x, *num_x);}
+    *num_nz = _tsg_grid(id)->evaluateSparseHierarchicalFunctionsGetNZ(x, *num_x);}
 void tsgghc_(int *id, double *c){
-    const double *cc = _tsg_grid_list[*id]->getHierarchicalCoefficients();
-    _tsg_grid_list[*id]->isFourier() ? std::copy(cc, cc + 2 * _tsg_grid_list[*id]->getNumPoints() * _tsg_grid_list[*id]->getNumOutputs(), c)
-                                     : std::copy(cc, cc + _tsg_grid_list[*id]->getNumPoints() * _tsg_grid_list[*id]->getNumOutputs(), c);
+    const double *cc = _tsg_grid(id)->getHierarchicalCoefficients();
+    _tsg_grid(id)->isFourier() ? std::copy(cc, cc + 2 * _tsg_grid(id)->getNumPoints() * _tsg_grid(id)->getNumOutputs(), c)
+                                     : std::copy(cc, cc + _tsg_grid(id)->getNumPoints() * _tsg_grid(id)->getNumOutputs(), c);
+}
+void tsgghp_(int *id, const double **c, int *num_c){ // pointer to the internal coefficients, used by the Fortran views
+    *c = (_tsg_grid(id)->getNumLoaded() > 0) ? _tsg_grid(id)->getHierarchicalCoefficients() : nullptr;
+    *num_c = (*c == nullptr) ? 0 : ((_tsg_grid(id)->isFourier()) ? 2 : 1) * _tsg_grid(id)->getNumPoints() * _tsg_grid(id)->getNumOutputs();
 }
-void tsgshc_(int *id, double *c){_tsg_grid_list[*id]->setHierarchicalCoefficients(c);}
+void tsgshc_(int *id, double *c){_tsg_grid(id)->setHierarchicalCoefficients(c);}
 
 // setAnisotropic/Surplus/Refinement
 void tsgsar_(int *id, int *type, int *min_growth, int *output, int *opt_flags, const int *llimits){
     const int *ll;
     ll = (opt_flags[0] != 0) ? llimits : 0;
-    _tsg_grid_list[*id]->setAnisotropicRefinement(OneDimensionalMeta::getIOTypeInt(*type), *min_growth, *output, ll);
+    _tsg_grid(id)->setAnisotropicRefinement(OneDimensionalMeta::getIOTypeInt(*type), *min_growth, *output, ll);
 }
 void tsgeac_(int *id, int *type, int *output, int *result){
-    int *coeff = _tsg_grid_list[*id]->estimateAnisotropicCoefficients(OneDimensionalMeta::getIOTypeInt(*type), *output);
-    int num_coeff = _tsg_grid_list[*id]->getNumDimensions();
+    int *coeff = _tsg_grid(id)->estimateAnisotropicCoefficients(OneDimensionalMeta::getIOTypeInt(*type), *output);
+    int num_coeff = _tsg_grid(id)->getNumDimensions();
     if ((*type == 2) || (*type == 4) || (*type == 6)) num_coeff *= 2;
     for(int i=0; i<num_coeff; i++) result[i] = coeff[i];
     delete[] coeff;
@@ -257,7 +285,7 @@ void tsgeac_(int *id, int *type, int *output, int *result){
 void tsgssr_(int *id, double *tol, int *output, int *opt_flags, const int *llimits){
     const int *ll;
     ll = (opt_flags[0] != 0) ? llimits : 0;
-    _tsg_grid_list[*id]->setSurplusRefinement(*tol, *output, ll); }
+    _tsg_grid(id)->setSurplusRefinement(*tol, *output, ll); }
 void tsgshr_(int *id, double *tol, int *type, int *opt_flags, int *output, const int *llimits){
     int theout;
     const int *ll;
@@ -265,37 +293,37 @@ void tsgshr_(int *id, double *tol, int *type, int *opt_flags, int *output, const
     theout = (opt_flags[0] != 0) ? *output : -1;
     ll     = (opt_flags[1] != 0) ? llimits : 0;
 
-    _tsg_grid_list[*id]->setSurplusRefinement(*tol, OneDimensionalMeta::getIOTypeRefinementInt(*type), theout, ll);
+    _tsg_grid(id)->setSurplusRefinement(*tol, OneDimensionalMeta::getIOTypeRefinementInt(*type), theout, ll);
 }
-void tsgcre_(int *id){ _tsg_grid_list[*id]->clearRefinement(); }
-void tsgmre_(int *id){ _tsg_grid_list[*id]->mergeRefinement(); }
+void tsgcre_(int *id){ _tsg_grid(id)->clearRefinement(); }
+void tsgmre_(int *id){ _tsg_grid(id)->mergeRefinement(); }
 
 // set/is/clear/getConformalTransform
-void tsgsca_(int *id, int *trunc){ _tsg_grid_list[*id]->setConformalTransformASIN(trunc); }
-void tsgica_(int *id, int *result){ *result = (_tsg_grid_list[*id]->isSetConformalTransformASIN()) ? 1 : 0; }
-void tsgcct_(int *id){ _tsg_grid_list[*id]->clearConformalTransform(); }
-void tsggca_(int *id, int *trunc){ _tsg_grid_list[*id]->getConformalTransformASIN(trunc); }
+void tsgsca_(int *id, int *trunc){ _tsg_grid(id)->setConformalTransformASIN(trunc); }
+void tsgica_(int *id, int *result){ *result = (_tsg_grid(id)->isSetConformalTransformASIN()) ? 1 : 0; }
+void tsgcct_(int *id){ _tsg_grid(id)->clearConformalTransform(); }
+void tsggca_(int *id, int *trunc){ _tsg_grid(id)->getConformalTransformASIN(trunc); }
 
 // isGlobal/Sequence/LocalPolynomial/Wavelet/Fourier
-void tsgisg_(int *id, int *status){*status = (_tsg_grid_list[*id]->isGlobal()) ? 1 : 0;}
-void tsgiss_(int *id, int *status){*status = (_tsg_grid_list[*id]->isSequence()) ? 1 : 0;}
-void tsgisl_(int *id, int *status){*status = (_tsg_grid_list[*id]->isLocalPolynomial()) ? 1 : 0;}
-void tsgisw_(int *id, int *status){*status = (_tsg_grid_list[*id]->isWavelet()) ? 1 : 0;}
-void tsgisf_(int *id, int *status){*status = (_tsg_grid_list[*id]->isFourier()) ? 1 : 0;}
+void tsgisg_(int *id, int *status){*status = (_tsg_grid(id)->isGlobal()) ? 1 : 0;}
+void tsgiss_(int *id, int *status){*status = (_tsg_grid(id)->isSequence()) ? 1 : 0;}
+void tsgisl_(int *id, int *status){*status = (_tsg_grid(id)->isLocalPolynomial()) ? 1 : 0;}
+void tsgisw_(int *id, int *status){*status = (_tsg_grid(id)->isWavelet()) ? 1 : 0;}
+void tsgisf_(int *id, int *status){*status = (_tsg_grid(id)->isFourier()) ? 1 : 0;}
 
 // print stats
-void tsgpri_(int *id){ _tsg_grid_list[*id]->printStats(); }
+void tsgpri_(int *id){ _tsg_grid(id)->printStats(); }
 
 // get/enableAcceleration
 void tsgacc_(int *id, int *acc){
-    _tsg_grid_list[*id]->enableAcceleration(AccelerationMeta::getIOIntAcceleration(*acc));
+    _tsg_grid(id)->enableAcceleration(AccelerationMeta::getIOIntAcceleration(*acc));
 }
 void tsggac_(int *id, int *acc){
-    TypeAcceleration accel = _tsg_grid_list[*id]->getAccelerationType();
+    TypeAcceleration accel = _tsg_grid(id)->getAccelerationType();
     *acc = AccelerationMeta::getIOAccelerationInt(accel);
 }
-void tsgsgi_(int *id, int *gpuID){ _tsg_grid_list[*id]->setGPUID(*gpuID); }
-void tsgggi_(int *id, int *gpuID){ *gpuID = _tsg_grid_list[*id]->getGPUID(); }
+void tsgsgi_(int *id, int *gpuID){ _tsg_grid(id)->setGPUID(*gpuID); }
+void tsgggi_(int *id, int *gpuID){ *gpuID = _tsg_grid(id)->getGPUID(); }
 void tsggng_(int *gpus){ *gpus = TasmanianSparseGrid::getNumGPUs(); }
 void tsgggm_(int *gpuID, int *mem){ *mem = TasmanianSparseGrid::getGPUMemory(*gpuID); }
 
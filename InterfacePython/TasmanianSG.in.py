@@ -91,6 +91,44 @@ class TasmanianSimpleSparseMatrix:
         return aMat
 
 
+def tsgAsDoubleArray(aArray):
+    '''
+    returns a C-contiguous numpy.ndarray of float64 with the same data
+
+    aArray: numpy.ndarray or any object with the buffer protocol,
+            e.g., memoryview or array.array
+
+    no copy is made if aArray is already C-contiguous float64,
+    otherwise (e.g., strided, Fortran ordered or float32 input)
+    the data is copied once, since the library works only with
+    contiguous arrays of doubles
+    '''
+    return np.ascontiguousarray(aArray, dtype=np.float64)
+
+def tsgCheckOutput(aOut, lShape, sType = np.float64):
+    '''
+    returns aOut if it can hold the result of a library call,
+    or a new array if aOut is None
+
+    aOut: None or a writeable C-contiguous numpy.ndarray
+          with shape lShape and dtype sType
+
+    '''
+    if (aOut is None):
+        return np.empty(lShape, sType)
+    if ((not isinstance(aOut, np.ndarray)) or (aOut.dtype != sType) or (tuple(aOut.shape) != tuple(lShape))
+        or (not aOut.flags['C_CONTIGUOUS']) or (not aOut.flags['WRITEABLE'])):
+        raise TasmanianInputError("out", "ERROR: out should be a writeable C-contiguous numpy.ndarray with dtype {0:s} and shape {1:s}".format(np.dtype(sType).name, str(tuple(lShape))))
+    return aOut
+
+def tsgPointer(aArray):
+    '''
+    returns a ctypes double pointer to the data of a contiguous array,
+    unlike numpy.ctypeslib.as_ctypes() no new ctypes type is created
+    '''
+    return aArray.ctypes.data_as(POINTER(c_double))
+
+
 class TasmanianSparseGrid:
     def __init__(self, tasmanian_library=0):
         '''
@@ -978,29 +1016,35 @@ class TasmanianSparseGrid:
         self.pLibTSG.tsgGetQuadratureWeightsStatic(self.pGrid, np.ctypeslib.as_ctypes(aWeights))
         return aWeights
 
-    def getInterpolationWeights(self, lfX):
+    def getInterpolationWeights(self, lfX, out = None):
         '''
         returns the interpolation weights associated with the points
         in getPoints()
 
         lfX: a 1-D numpy.ndarray with length iDimensions
              the entries indicate the points for evaluating the weights
+             (any float buffer, see tsgAsDoubleArray())
+
+        out: optional 1-D float64 numpy.ndarray of length getNumPoints()
+             if given, the weights are written in out and no memory is
+             allocated
 
         output: a 1-D numpy.ndarray of length getNumPoints()
             the order of the weights matches the order in getPoints()
 
         '''
+        lfX = tsgAsDoubleArray(lfX)
         iNumX = len(lfX)
         if (iNumX != self.getNumDimensions()):
             raise TasmanianInputError("lfX", "ERROR: len(lfX) should equal {0:1d} instead it equals {1:1d}".format(self.getNumDimensions(), iNumX))
         iNumPoints = self.getNumPoints()
+        aWeights = tsgCheckOutput(out, [iNumPoints])
         if (iNumPoints == 0):
-            return np.empty([0], np.float64)
-        aWeights = np.empty([iNumPoints], np.float64)
-        self.pLibTSG.tsgGetInterpolationWeightsStatic(self.pGrid, np.ctypeslib.as_ctypes(lfX), np.ctypeslib.as_ctypes(aWeights))
+            return aWeights
+        self.pLibTSG.tsgGetInterpolationWeightsStatic(self.pGrid, tsgPointer(lfX), tsgPointer(aWeights))
         return aWeights
 
-    def getInterpolationWeightsBatch(self, llfX):
+    def getInterpolationWeightsBatch(self, llfX, out = None):
         '''
         returns the interpolation weights associated with the points
         in getPoints()
@@ -1010,27 +1054,33 @@ class TasmanianSparseGrid:
 
         llfX: a 2-D numpy.ndarray with second dimension iDimensions
               each row in the array is a single requested point
+              (any float buffer, see tsgAsDoubleArray())
+
+        out: optional 2-D float64 numpy.ndarray
+             with dimensions llfX.shape[0] X getNumPoints()
+             if given, the weights are written in out
 
         output: a 2-D numpy.ndarray
                 with dimensions llfX.shape[0] X getNumPoints()
                 each row corresponds to the weight for one row of llfX
 
         '''
+        llfX = tsgAsDoubleArray(llfX)
         if (len(llfX.shape) != 2):
             raise TasmanianInputError("llfX", "ERROR: llfX should be a 2-D numpy.ndarray instread it has dimension {0:1d}".format(len(llfX.shape)))
         iNumX = llfX.shape[0]
-        if (iNumX == 0):
+        if ((iNumX == 0) and (out is None)):
             return np.empty([0, self.getNumPoints()], np.float64)
         iNumDim = llfX.shape[1]
         if (iNumDim != self.getNumDimensions()):
             raise TasmanianInputError("llfX", "ERROR: llfX.shape[1] should equal {0:1d} instead it equals {1:1d}".format(self.getNumDimensions(), iNumDim))
         iNumPoints = self.getNumPoints()
-        if (iNumPoints == 0):
+        if ((iNumPoints == 0) and (out is None)):
             return np.empty([0, 0], np.float64)
-        aWeights = np.empty([iNumX, iNumPoints], np.float64)
-        self.pLibTSG.tsgBatchGetInterpolationWeightsStatic(self.pGrid,
-            np.ctypeslib.as_ctypes(llfX.reshape([iNumX * iNumDim])), iNumX,
-            np.ctypeslib.as_ctypes(aWeights.reshape([iNumX * iNumPoints])))
+        aWeights = tsgCheckOutput(out, [iNumX, iNumPoints])
+        if ((iNumX == 0) or (iNumPoints == 0)):
+            return aWeights
+        self.pLibTSG.tsgBatchGetInterpolationWeightsStatic(self.pGrid, tsgPointer(llfX), iNumX, tsgPointer(aWeights))
         return aWeights
 
     def loadNeededPoints(self, llfVals):
@@ -1056,11 +1106,10 @@ class TasmanianSparseGrid:
             raise TasmanianInputError("llfVals", "ERROR: leading dimension of llfVals is {0:1d} but the number of needed points is {1:1d}".format(llfVals.shape[0], self.getNumNeeded()))
         if (llfVals.shape[1] != self.getNumOutputs()):
             raise TasmanianInputError("llfVals", "ERROR: second dimension of llfVals is {0:1d} but the number of outputs is set to {1:1d}".format(llfVals.shape[1], self.getNumOutputs()))
-        iNumPoints = llfVals.shape[0]
-        iNumDims = llfVals.shape[1]
-        self.pLibTSG.tsgLoadNeededPoints(self.pGrid, np.ctypeslib.as_ctypes(llfVals.reshape([iNumPoints * iNumDims])))
+        llfVals = tsgAsDoubleArray(llfVals)
+        self.pLibTSG.tsgLoadNeededPoints(self.pGrid, tsgPointer(llfVals))
 
-    def evaluateThreadSafe(self, lfX):
+    def evaluateThreadSafe(self, lfX, out = None):
         '''
         evaluates the intepolant at a single points of interest and
         returns the result
@@ -1072,6 +1121,10 @@ class TasmanianSparseGrid:
 
         lfX: a 1-D numpy.ndarray with length iDimensions
              the entries indicate the points for evaluating the weights
+             (any float buffer, see tsgAsDoubleArray())
+
+        out: optional 1-D float64 numpy.ndarray of length iOutputs
+             if given, the result is written in out
 
         output: returns a 1-D numpy.ndarray of length iOutputs
             the values of the interpolant at lfX
@@ -1079,17 +1132,18 @@ class TasmanianSparseGrid:
         '''
         if (self.getNumLoaded() == 0):
             raise TasmanianInputError("evaluateThreadSafe", "ERROR: cannot call evaluate for a grid before any points are loaded, i.e., call loadNeededPoints first!")
+        lfX = tsgAsDoubleArray(lfX)
         if (len(lfX.shape) != 1):
             raise TasmanianInputError("lfX", "ERROR: lfX should be 1D numpy array")
         iNumX = lfX.shape[0]
         if (iNumX != self.getNumDimensions()):
             raise TasmanianInputError("lfX", "ERROR: lfX should have lenth {0:1d} instead it has length {1:1d}".format(self.getNumDimensions(),iNumX))
         iNumOutputs = self.getNumOutputs()
-        aY = np.empty([iNumOutputs], np.float64)
-        self.pLibTSG.tsgEvaluate(self.pGrid, np.ctypeslib.as_ctypes(lfX), np.ctypeslib.as_ctypes(aY))
+        aY = tsgCheckOutput(out, [iNumOutputs])
+        self.pLibTSG.tsgEvaluate(self.pGrid, tsgPointer(lfX), tsgPointer(aY))
         return aY
 
-    def evaluate(self, lfX):
+    def evaluate(self, lfX, out = None):
         '''
         evaluates the intepolant at a single points of interest and
         returns the result
@@ -1101,6 +1155,10 @@ class TasmanianSparseGrid:
 
         lfX: a 1-D numpy.ndarray with length iDimensions
              the entries indicate the points for evaluating the weights
+             (any float buffer, see tsgAsDoubleArray())
+
+        out: optional 1-D float64 numpy.ndarray of length iOutputs
+             if given, the result is written in out
 
         output: returns a 1-D numpy.ndarray of length iOutputs
             the values of the interpolant at lfX
@@ -1108,17 +1166,18 @@ class TasmanianSparseGrid:
         '''
         if (self.getNumLoaded() == 0):
             raise TasmanianInputError("evaluate", "ERROR: cannot call evaluate for a grid before any points are loaded, i.e., call loadNeededPoints first!")
+        lfX = tsgAsDoubleArray(lfX)
         if (len(lfX.shape) != 1):
             raise TasmanianInputError("lfX", "ERROR: lfX should be 1D numpy array")
         iNumX = lfX.shape[0]
         if (iNumX != self.getNumDimensions()):
             raise TasmanianInputError("lfX", "ERROR: lfX should have lenth {0:1d} instead it has length {1:1d}".format(self.getNumDimensions(),iNumX))
         iNumOutputs = self.getNumOutputs()
-        aY = np.empty([iNumOutputs], np.float64)
-        self.pLibTSG.tsgEvaluateFast(self.pGrid, np.ctypeslib.as_ctypes(lfX), np.ctypeslib.as_ctypes(aY))
+        aY = tsgCheckOutput(out, [iNumOutputs])
+        self.pLibTSG.tsgEvaluateFast(self.pGrid, tsgPointer(lfX), tsgPointer(aY))
         return aY
 
-    def evaluateBatch(self, llfX):
+    def evaluateBatch(self, llfX, out = None):
         '''
         evaluates the intepolant at the points of interest and returns
         the result
@@ -1129,6 +1188,14 @@ class TasmanianSparseGrid:
         llfX: a 2-D numpy.ndarray
               with second dimension equal to iDimensions
               each row in the array is a single requested point
+              C-contiguous float64 arrays are passed to the library
+              without a copy, other float buffers are converted once
+              (see tsgAsDoubleArray())
+
+        out: optional 2-D float64 C-contiguous numpy.ndarray
+             with dimensions llfX.shape[0] X iOutputs
+             if given, the result is written in out and no memory
+             is allocated, e.g., when evaluating many small batches
 
         output: a 2-D numpy.ndarray
                 with dimensions llfX.shape[0] X iOutputs
@@ -1138,19 +1205,17 @@ class TasmanianSparseGrid:
         '''
         if (self.getNumLoaded() == 0):
             raise TasmanianInputError("evaluateBatch", "ERROR: cannot call evaluateBatch for a grid before any points are loaded, i.e., call loadNeededPoints first!")
+        llfX = tsgAsDoubleArray(llfX)
         if (len(llfX.shape) != 2):
             raise TasmanianInputError("llfX", "ERROR: llfX should be a 2-D numpy.ndarray instread it has dimension {0:1d}".format(len(llfX.shape)))
         iNumX = llfX.shape[0]
-        if (iNumX == 0):
-            return np.empty([0, self.getNumOutputs()], np.float64)
         iNumDim = llfX.shape[1]
-        if (iNumDim != self.getNumDimensions()):
+        if ((iNumX > 0) and (iNumDim != self.getNumDimensions())):
             raise TasmanianInputError("llfX", "ERROR: llfX.shape[1] should equal {0:1d} instead it equals {1:1d}".format(self.getNumDimensions(), iNumDim))
-        iNumOutputs = self.getNumOutputs()
-        aY = np.empty([iNumX, iNumOutputs], np.float64)
-        # np.ctypeslib.as_ctypes(llfX.reshape([iNumX*iNumDim,])) messes up, the first 4 entries randomly get set to machine eps (10^-310) and 0
-        lfX = llfX.reshape([iNumX*iNumDim,])
-        self.pLibTSG.tsgEvaluateBatch(self.pGrid, np.ctypeslib.as_ctypes(lfX), iNumX, np.ctypeslib.as_ctypes(aY.reshape([iNumX*iNumOutputs,])))
+        aY = tsgCheckOutput(out, [iNumX, self.getNumOutputs()])
+        if (iNumX == 0):
+            return aY
+        self.pLibTSG.tsgEvaluateBatch(self.pGrid, tsgPointer(llfX), iNumX, tsgPointer(aY))
         return aY
 
     def integrate(self):
@@ -1738,35 +1803,36 @@ class TasmanianSparseGrid:
 
         return aSurp.reshape([iNumPoints, iNumOuts])
 
-    def evaluateHierarchicalFunctions(self, llfX):
+    def evaluateHierarchicalFunctions(self, llfX, out = None):
         '''
         evaluates the hierarchical functions at a set of points in the
         domain and return a 2-D numpy.ndarray with the result
 
         llfX: a 2-D numpy.ndarray with llfX.shape[1] == iDimensions
               the entries indicate the points for evaluating the weights
+              (any float buffer, see tsgAsDoubleArray())
+
+        out: optional C-contiguous numpy.ndarray
+             with shape [llfX.shape[0], getNumPoints()]
+             and dtype float64 (complex128 for Fourier grids)
+             if given, the result is written in out
 
         output: returns a 2-D numpy.ndarray of
                 shape == [llfX.shape[0], getNumPoints()]
                 the values of the basis functions at the points
         '''
+        llfX = tsgAsDoubleArray(llfX)
         if (len(llfX.shape) != 2):
             raise TasmanianInputError("llfX", "ERROR: calling evaluateHierarchicalFunctions llfX should be a 2-D numpy array")
         if (llfX.shape[1] != self.getNumDimensions()):
             raise TasmanianInputError("llfX", "ERROR: calling evaluateHierarchicalFunctions llfX.shape[1] is not equal to getNumDimensions()")
         iNumX = llfX.shape[0]
-        # see evaluateBatch()
-        lfX = llfX.reshape([llfX.shape[0] * llfX.shape[1]])
 
-        if not self.isFourier():
-            aResult = np.empty([iNumX * self.getNumPoints()], np.float64)
-            self.pLibTSG.tsgEvaluateHierarchicalFunctions(self.pGrid, np.ctypeslib.as_ctypes(lfX), iNumX, np.ctypeslib.as_ctypes(aResult))
-        else:
-            aResult = np.empty([2 * iNumX * self.getNumPoints()], np.float64)
-            self.pLibTSG.tsgEvaluateHierarchicalFunctions(self.pGrid, np.ctypeslib.as_ctypes(lfX), iNumX, np.ctypeslib.as_ctypes(aResult))
-            aResult = aResult[0::2] + 1j * aResult[1::2]
-
-        return aResult.reshape([iNumX, self.getNumPoints()])
+        # complex128 stores the real and imaginary parts interleaved, which matches the output of the library
+        aResult = tsgCheckOutput(out, [iNumX, self.getNumPoints()], np.complex128 if self.isFourier() else np.float64)
+        if (aResult.size > 0):
+            self.pLibTSG.tsgEvaluateHierarchicalFunctions(self.pGrid, tsgPointer(llfX), iNumX, tsgPointer(aResult))
+        return aResult
 
     def evaluateSparseHierarchicalFunctions(self, llfX):
         '''
@@ -1791,24 +1857,21 @@ class TasmanianSparseGrid:
                 The sparse matrix is compressed along the llfX.shape[0]
                 dimension, i.e., using column compressed format
         '''
+        llfX = tsgAsDoubleArray(llfX)
         if (len(llfX.shape) != 2):
             raise TasmanianInputError("llfX", "ERROR: calling evaluateSparseHierarchicalFunctions(), llfX should be a 2-D numpy array")
         if (llfX.shape[1] != self.getNumDimensions()):
             raise TasmanianInputError("llfX", "ERROR: calling evaluateSparseHierarchicalFunctions(), llfX.shape[1] is not equal to getNumDimensions()")
         iNumX = llfX.shape[0]
         pMat = TasmanianSimpleSparseMatrix()
-        iNumNZ = self.pLibTSG.tsgEvaluateSparseHierarchicalFunctionsGetNZ(self.pGrid, np.ctypeslib.as_ctypes(llfX.reshape([llfX.shape[0] * llfX.shape[1]])), iNumX)
+        iNumNZ = self.pLibTSG.tsgEvaluateSparseHierarchicalFunctionsGetNZ(self.pGrid, tsgPointer(llfX), iNumX)
         pMat.aPntr = np.empty([iNumX+1,], np.int32)
         pMat.aIndx = np.empty([iNumNZ,], np.int32)
-        pMat.aVals = np.empty([iNumNZ if not self.isFourier() else 2 * iNumNZ,], np.float64)
+        pMat.aVals = np.empty([iNumNZ,], np.float64 if not self.isFourier() else np.complex128)
         pMat.iNumRows = iNumX
         pMat.iNumCols = self.getNumPoints()
-        # see evaluateBatch()
-        lfX = llfX.reshape([llfX.shape[0] * llfX.shape[1]])
-        self.pLibTSG.tsgEvaluateSparseHierarchicalFunctionsStatic(self.pGrid, np.ctypeslib.as_ctypes(lfX), iNumX,
-                                                        np.ctypeslib.as_ctypes(pMat.aPntr), np.ctypeslib.as_ctypes(pMat.aIndx), np.ctypeslib.as_ctypes(pMat.aVals))
-        if self.isFourier():
-            pMat.aVals = pMat.aVals[0::2] + 1j * pMat.aVals[1::2]
+        self.pLibTSG.tsgEvaluateSparseHierarchicalFunctionsStatic(self.pGrid, tsgPointer(llfX), iNumX,
+                                                        np.ctypeslib.as_ctypes(pMat.aPntr), np.ctypeslib.as_ctypes(pMat.aIndx), tsgPointer(pMat.aVals))
 
         return pMat
 
@@ -1911,9 +1974,9 @@ class TasmanianSparseGrid:
 
           'cpu-blas'
               uses BLAS dgemm function for acceleration of batch
-              evaluations
-              requires Tasmanian_ENABLE_BLAS switched ON
-              if enabled, this is the default mode
+              evaluations, this is the default mode
+              if Tasmanian_ENABLE_BLAS is OFF, uses the internal
+              cache-blocked and multi-threaded (OpenMP) kernels
 
           'gpu-fullmem' -> same as gpu_default
           'gpu-default'
@@ -33,6 +33,17 @@
 
 #include <stdexcept>
 #include <string>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 #include "TasmanianSparseGrid.hpp"
 
@@ -56,33 +67,87 @@ bool TasmanianSparseGrid::isOpenMPEnabled(){
     #endif // _OPENMP
 }
 
-TasmanianSparseGrid::TasmanianSparseGrid() : acceleration(accel_none), gpuID(0), usingDynamicConstruction(false){
-#ifdef Tasmanian_ENABLE_BLAS
-    acceleration = accel_cpu_blas;
-#endif // Tasmanian_ENABLE_BLAS
-}
-TasmanianSparseGrid::TasmanianSparseGrid(const TasmanianSparseGrid &source) : acceleration(accel_none), gpuID(0), usingDynamicConstruction(false)
+TasmanianSparseGrid::TasmanianSparseGrid() : acceleration(accel_cpu_blas), gpuID(0), usingDynamicConstruction(false), frozen(false){}
+TasmanianSparseGrid::TasmanianSparseGrid(const TasmanianSparseGrid &source) : acceleration(accel_cpu_blas), gpuID(0), usingDynamicConstruction(false), frozen(false)
 {
     copyGrid(&source);
-#ifdef Tasmanian_ENABLE_BLAS
     acceleration = accel_cpu_blas;
-#endif // Tasmanian_ENABLE_BLAS
+}
+TasmanianSparseGrid::TasmanianSparseGrid(TasmanianSparseGrid &&source) : acceleration(accel_cpu_blas), gpuID(0), usingDynamicConstruction(false), frozen(false)
+{
+    *this = std::move(source);
 }
 TasmanianSparseGrid::~TasmanianSparseGrid(){
     clear();
 }
 
+TasmanianSparseGrid& TasmanianSparseGrid::operator=(const TasmanianSparseGrid &source){
+    if (this != &source) copyGrid(&source);
+    return *this;
+}
+TasmanianSparseGrid& TasmanianSparseGrid::operator=(TasmanianSparseGrid &&source){
+    if (this == &source) return *this;
+    clear();
+    base = std::move(source.base);
+    domain_transform_a = std::move(source.domain_transform_a);
+    domain_transform_b = std::move(source.domain_transform_b);
+    conformal_asin_power = std::move(source.conformal_asin_power);
+    llimits = std::move(source.llimits);
+    acceleration = source.acceleration;
+    gpuID = source.gpuID;
+    usingDynamicConstruction = source.usingDynamicConstruction;
+    frozen = source.frozen;
+    #ifdef Tasmanian_ENABLE_CUDA
+    engine = std::move(source.engine); // acc_domain is a cache and will be reloaded on the next GPU call
+    #endif
+    source.clear();
+    source.llimits.clear();
+    return *this;
+}
+
+// copy of the canonical grid, used by copy-on-write
+// the index sets and loaded values are shared with the source until either grid modifies them
+template<class GridType> std::unique_ptr<BaseCanonicalGrid> copyCanonicalGridType(const BaseCanonicalGrid *source){
+    return std::unique_ptr<BaseCanonicalGrid>(new GridType(*((const GridType*) source)));
+}
+std::unique_ptr<BaseCanonicalGrid> copyCanonicalGrid(const BaseCanonicalGrid *source){
+    if (source->isGlobal()){
+        return copyCanonicalGridType<GridGlobal>(source);
+    }else if (source->isLocalPolynomial()){
+        return copyCanonicalGridType<GridLocalPolynomial>(source);
+    }else if (source->isSequence()){
+        return copyCanonicalGridType<GridSequence>(source);
+    }else if (source->isFourier()){
+        return copyCanonicalGridType<GridFourier>(source);
+    }else{
+        return copyCanonicalGridType<GridWavelet>(source);
+    }
+}
+
+void TasmanianSparseGrid::detach(){
+    if (frozen) throw std::runtime_error("ERROR: the grid is frozen for evaluation and cannot be modified, see freezeForEvaluation()");
+    unshare();
+}
+void TasmanianSparseGrid::unshare(){
+    if (base && (base.use_count() > 1)) base = copyCanonicalGrid(base.get());
+}
+void TasmanianSparseGrid::clearGPUCaches(){
+    if (!base) return;
+    if (base.use_count() > 1){
+        base = copyCanonicalGrid(base.get()); // the copy holds no GPU data, the shared grid is left intact
+    }else{
+        base->clearAccelerationData();
+    }
+}
+
 void TasmanianSparseGrid::clear(){
     base = std::unique_ptr<BaseCanonicalGrid>();
     domain_transform_a.resize(0);
     domain_transform_b.resize(0);
     conformal_asin_power.clear();
     usingDynamicConstruction = false;
-#ifdef Tasmanian_ENABLE_BLAS
+    frozen = false;
     acceleration = accel_cpu_blas;
-#else
-    acceleration = accel_none;
-#endif // Tasmanian_ENABLE_BLAS
 #ifdef Tasmanian_ENABLE_CUDA
     gpuID = 0;
     if (!acc_domain.empty()) acc_domain.clear();
@@ -119,19 +184,145 @@ void TasmanianSparseGrid::read(const char *filename){
     ifs.close();
 }
 
-void TasmanianSparseGrid::write(std::ofstream &ofs, bool binary) const{
+void TasmanianSparseGrid::write(std::ostream &ofs, bool binary) const{
     if (binary){
         writeBinary(ofs);
     }else{
         writeAscii(ofs);
     }
 }
-void TasmanianSparseGrid::read(std::ifstream &ifs, bool binary){
+void TasmanianSparseGrid::read(std::istream &ifs, bool binary){
+    TasmanianSparseGrid grid; // if the read fails, this grid is not modified
     if (binary){
-        readBinary(ifs);
+        grid.readBinary(ifs);
     }else{
-        readAscii(ifs);
+        grid.readAscii(ifs);
     }
+    *this = std::move(grid);
+}
+
+void TasmanianSparseGrid::serialize(std::vector<char> &data) const{
+    data.clear();
+    IO::MemoryWriteBuffer buffer(data);
+    std::ostream os(&buffer);
+    writeBinary(os);
+}
+void TasmanianSparseGrid::deserialize(const char *data, size_t size){
+    bool binary_format = ((size >= 3) && (data[0] == 'T') && (data[1] == 'S') && (data[2] == 'G'));
+    IO::MemoryReadBuffer buffer(data, size);
+    std::istream is(&buffer);
+    is.exceptions(std::ios::failbit | std::ios::badbit); // a truncated buffer must not load partial data
+    try{
+        read(is, binary_format);
+    }catch(std::ios_base::failure &){
+        throw std::runtime_error("ERROR: deserialize() the buffer does not hold a complete grid");
+    }
+}
+
+#ifndef _WIN32
+// the shared memory segment holds the header, the binary image of a frozen grid and the data section with the large arrays
+// the image references the arrays by their offsets in the data section, see IO::SharedWriteBuffer
+// the tag is written last, a segment without the tag is either incomplete or not a Tasmanian grid
+struct SharedGridHeader{
+    char tag[8];
+    unsigned long long image_size; // the image starts right after the header
+    unsigned long long data_offset, data_size; // offset of the data section from the start of the segment, aligned to IO::shared_alignment
+};
+static const char shared_grid_tag[8] = {'T', 'S', 'G', 'S', 'H', 'M', '2', '\0'};
+#endif
+
+void TasmanianSparseGrid::publishShared(const char *name) const{
+    #ifndef _WIN32
+    if (empty()) throw std::runtime_error("ERROR: publishShared() called for an empty grid");
+    std::vector<char> image, data;
+    IO::SharedWriteBuffer buffer(image, data);
+    std::ostream os(&buffer);
+    if (frozen){
+        writeBinary(os);
+    }else{
+        TasmanianSparseGrid frozen_copy(*this);
+        frozen_copy.freezeForEvaluation();
+        frozen_copy.writeBinary(os);
+    }
+    size_t data_offset = IO::shared_alignment * ((sizeof(SharedGridHeader) + image.size() + IO::shared_alignment - 1) / IO::shared_alignment);
+    size_t total = data_offset + data.size();
+
+    // never modify an existing segment, other processes may be reading it
+    // unlink the old name (attached processes keep the old segment) and create a new one
+    // shm segments cannot be renamed, an attachShared() between the unlink and the shm_open() fails with ENOENT
+    if ((shm_unlink(name) != 0) && (errno != ENOENT))
+        throw std::runtime_error(std::string("ERROR: publishShared() could not replace the existing shared memory segment, ") + std::strerror(errno));
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) throw std::runtime_error(std::string("ERROR: publishShared() could not create the shared memory segment, ") + std::strerror(errno));
+    void *segment = (ftruncate(fd, (off_t) total) == 0) ? mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    int err = errno;
+    close(fd);
+    if (segment == MAP_FAILED){
+        shm_unlink(name);
+        throw std::runtime_error(std::string("ERROR: publishShared() could not map the shared memory segment, ") + std::strerror(err));
+    }
+
+    SharedGridHeader *header = (SharedGridHeader*) segment;
+    std::copy_n(image.data(), image.size(), ((char*) segment) + sizeof(SharedGridHeader));
+    std::copy_n(data.data(), data.size(), ((char*) segment) + data_offset);
+    header->image_size = (unsigned long long) image.size();
+    header->data_offset = (unsigned long long) data_offset;
+    header->data_size = (unsigned long long) data.size();
+    std::atomic_thread_fence(std::memory_order_release);
+    std::copy_n(shared_grid_tag, 8, header->tag);
+    munmap(segment, total);
+    #else
+    (void) name;
+    throw std::runtime_error("ERROR: publishShared() requires POSIX shared memory, not available on this platform");
+    #endif
+}
+
+void TasmanianSparseGrid::attachShared(const char *name){
+    #ifndef _WIN32
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) throw std::runtime_error(std::string("ERROR: attachShared() could not open the shared memory segment, ") + std::strerror(errno));
+    struct stat info;
+    size_t total = 0;
+    void *mapping = MAP_FAILED;
+    if ((fstat(fd, &info) == 0) && ((size_t) info.st_size >= sizeof(SharedGridHeader))){
+        total = (size_t) info.st_size;
+        mapping = mmap(nullptr, total, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) throw std::runtime_error("ERROR: attachShared() could not map the shared memory segment");
+
+    // the mapping is released when the last view of the segment is gone, i.e., when the grid is cleared or destroyed
+    std::shared_ptr<const char> segment((const char*) mapping, [=](const char*){ munmap(mapping, total); });
+
+    const SharedGridHeader *header = (const SharedGridHeader*) segment.get();
+    if ((std::memcmp(header->tag, shared_grid_tag, 8) != 0)
+        || (header->image_size > total - sizeof(SharedGridHeader))
+        || (header->data_offset < sizeof(SharedGridHeader) + header->image_size) || (header->data_offset % IO::shared_alignment != 0)
+        || (header->data_offset > total) || (header->data_size > total - header->data_offset))
+        throw std::runtime_error("ERROR: attachShared() the shared memory segment does not hold a complete Tasmanian grid");
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    IO::SharedReadBuffer buffer(segment.get() + sizeof(SharedGridHeader), (size_t) header->image_size,
+                                std::shared_ptr<const char>(segment, segment.get() + header->data_offset), (size_t) header->data_size);
+    std::istream is(&buffer);
+    is.exceptions(std::ios::failbit | std::ios::badbit); // a corrupt image must not load partial data
+
+    TasmanianSparseGrid attached;
+    attached.readBinary(is);
+    *this = std::move(attached);
+    #else
+    (void) name;
+    throw std::runtime_error("ERROR: attachShared() requires POSIX shared memory, not available on this platform");
+    #endif
+}
+
+void TasmanianSparseGrid::unlinkShared(const char *name){
+    #ifndef _WIN32
+    if (shm_unlink(name) != 0) throw std::runtime_error(std::string("ERROR: unlinkShared() could not remove the shared memory segment, ") + std::strerror(errno));
+    #else
+    (void) name;
+    throw std::runtime_error("ERROR: unlinkShared() requires POSIX shared memory, not available on this platform");
+    #endif
 }
 
 void TasmanianSparseGrid::makeGlobalGrid(int dimensions, int outputs, int depth, TypeDepth type, TypeOneDRule rule, const int *anisotropic_weights, double alpha, double beta, const char* custom_filename, const int *level_limits){
@@ -269,23 +460,14 @@ void TasmanianSparseGrid::makeFourierGrid(int dimensions, int outputs, int depth
 }
 
 void TasmanianSparseGrid::copyGrid(const TasmanianSparseGrid *source){
+    if (source == this) return;
     clear();
     if (!source->empty()){
-        if (source->isGlobal()){
-            base = make_unique_ptr<GridGlobal>();
-            getGridGlobal()->copyGrid((GridGlobal*) source->base.get());
-        }else if (source->isLocalPolynomial()){
-            base = make_unique_ptr<GridLocalPolynomial>();
-            getGridLocalPolynomial()->copyGrid((GridLocalPolynomial*) source->base.get());
-        }else if (source->isSequence()){
-            base = make_unique_ptr<GridSequence>();
-            getGridSequence()->copyGrid((GridSequence*) source->base.get());
-        }else if (source->isFourier()){
-            base = make_unique_ptr<GridFourier>();
-            getGridFourier()->copyGrid((GridFourier*) source->base.get());
-        }else if (source->isWavelet()){
-            base = make_unique_ptr<GridWavelet>();
-            getGridWavelet()->copyGrid((GridWavelet*) source->base.get());
+        if (source->usingDynamicConstruction || AccelerationMeta::isAccTypeGPU(source->acceleration)){
+            // the construction data and the GPU caches are not shared, make a copy of the grid only
+            base = copyCanonicalGrid(source->base.get());
+        }else{
+            base = source->base;
         }
     }
     if (source->domain_transform_a.size() > 0){
@@ -293,6 +475,7 @@ void TasmanianSparseGrid::copyGrid(const TasmanianSparseGrid *source){
     }
     conformal_asin_power = source->conformal_asin_power;
     llimits = source->llimits;
+    frozen = source->frozen;
 }
 
 void TasmanianSparseGrid::updateGlobalGrid(int depth, TypeDepth type, const int *anisotropic_weights, const int *level_limits){
@@ -460,6 +643,7 @@ void TasmanianSparseGrid::getInterpolationWeights(const std::vector<double> &x,
 }
 
 void TasmanianSparseGrid::loadNeededPoints(const double *vals){
+    detach();
     #ifdef Tasmanian_ENABLE_CUDA
     if (engine){
         engine->setDevice();
@@ -484,7 +668,10 @@ void TasmanianSparseGrid::evaluate(const double x[], double y[]) const{
 
 void TasmanianSparseGrid::evaluateBatch(const double x[], int num_x, double y[]) const{
     Data2D<double> x_tmp;
-    const double *x_canonical = formCanonicalPoints(x, x_tmp, num_x);
+    evaluateBatch(x, num_x, y, x_tmp);
+}
+void TasmanianSparseGrid::evaluateBatch(const double x[], int num_x, double y[], Data2D<double> &x_temp) const{
+    const double *x_canonical = formCanonicalPoints(x, x_temp, num_x);
     #ifdef Tasmanian_ENABLE_CUDA
     if (engine){
         engine->setDevice();
@@ -496,14 +683,20 @@ void TasmanianSparseGrid::evaluateBatch(const double x[], int num_x, double y[])
         return;
     }
     #endif
-    #ifdef Tasmanian_ENABLE_BLAS
     if (acceleration == accel_cpu_blas){
         base->evaluateBlas(x_canonical, num_x, y);
         return;
     }
-    #endif
     base->evaluateBatch(x_canonical, num_x, y);
 }
+void TasmanianSparseGrid::getInterpolationWeightsBatch(const double x[], int num_x, double weights[], Data2D<double> &x_temp) const{
+    const double *x_canonical = formCanonicalPoints(x, x_temp, num_x);
+    int num_dimensions = base->getNumDimensions(), num_points = base->getNumPoints();
+    #pragma omp parallel for
+    for(int i=0; i<num_x; i++){
+        base->getInterpolationWeights(&(x_canonical[((size_t) i) * ((size_t) num_dimensions)]), &(weights[((size_t) i) * ((size_t) num_points)]));
+    }
+}
 void TasmanianSparseGrid::integrate(double q[]) const{
     if (conformal_asin_power.size() != 0){
         int num_points = base->getNumPoints();
@@ -543,6 +736,7 @@ bool TasmanianSparseGrid::isWavelet() const{         return (empty()) ? false :
 bool TasmanianSparseGrid::isFourier() const{         return (empty()) ? false : base->isFourier(); }
 
 void TasmanianSparseGrid::setDomainTransform(const double a[], const double b[]){
+    if (frozen) throw std::runtime_error("ERROR: cannot call setDomainTransform() for a grid that is frozen for evaluation");
     if (empty() || (base->getNumDimensions() == 0)){
         throw std::runtime_error("ERROR: cannot call setDomainTransform on uninitialized grid!");
     }
@@ -557,6 +751,7 @@ bool TasmanianSparseGrid::isSetDomainTransfrom() const{
     return (domain_transform_a.size() != 0);
 }
 void TasmanianSparseGrid::clearDomainTransform(){
+    if (frozen) throw std::runtime_error("ERROR: cannot call clearDomainTransform() for a grid that is frozen for evaluation");
     domain_transform_a.resize(0);
     domain_transform_b.resize(0);
     #ifdef Tasmanian_ENABLE_CUDA
@@ -571,6 +766,7 @@ void TasmanianSparseGrid::getDomainTransform(double a[], double b[]) const{
     std::copy(domain_transform_b.begin(), domain_transform_b.end(), b);
 }
 void TasmanianSparseGrid::setDomainTransform(const std::vector<double> &a, const std::vector<double> &b){
+    if (frozen) throw std::runtime_error("ERROR: cannot call setDomainTransform() for a grid that is frozen for evaluation");
     if (empty() || (base->getNumDimensions() == 0)){
         throw std::runtime_error("ERROR: cannot call setDomainTransform on uninitialized grid!");
     }
@@ -689,6 +885,7 @@ double TasmanianSparseGrid::getQuadratureScale(int num_dimensions, TypeOneDRule
 }
 
 void TasmanianSparseGrid::setConformalTransformASIN(const int truncation[]){
+    if (frozen) throw std::runtime_error("ERROR: cannot call setConformalTransformASIN() for a grid that is frozen for evaluation");
     if (empty() || (base->getNumDimensions() == 0)){
         throw std::runtime_error("ERROR: cannot call setConformalTransformASIN on uninitialized grid!");
     }
@@ -699,6 +896,7 @@ void TasmanianSparseGrid::setConformalTransformASIN(const int truncation[]){
 }
 bool TasmanianSparseGrid::isSetConformalTransformASIN() const{ return (conformal_asin_power.size() != 0); }
 void TasmanianSparseGrid::clearConformalTransform(){
+    if (frozen) throw std::runtime_error("ERROR: cannot call clearConformalTransform() for a grid that is frozen for evaluation");
     conformal_asin_power.clear();
 }
 void TasmanianSparseGrid::getConformalTransformASIN(int truncation[]) const{
@@ -923,14 +1121,14 @@ void TasmanianSparseGrid::setAnisotropicRefinement(TypeDepth type, int min_growt
     }
 }
 
-int* TasmanianSparseGrid::estimateAnisotropicCoefficients(TypeDepth type, int output){
+int* TasmanianSparseGrid::estimateAnisotropicCoefficients(TypeDepth type, int output) const{
     std::vector<int> weights;
     estimateAnisotropicCoefficients(type, output, weights);
     int *w = new int[weights.size()];
     std::copy(weights.begin(), weights.end(), w);
     return w;
 }
-void TasmanianSparseGrid::estimateAnisotropicCoefficients(TypeDepth type, int output, std::vector<int> &weights){
+void TasmanianSparseGrid::estimateAnisotropicCoefficients(TypeDepth type, int output, std::vector<int> &weights) const{
     if (empty()) throw std::runtime_error("ERROR: calling estimateAnisotropicCoefficients() for a grid that has not been initialized");
     int outs = base->getNumOutputs();
     if (outs == 0) throw std::runtime_error("ERROR: calling estimateAnisotropicCoefficients() for a grid that has no outputs");
@@ -1024,9 +1222,11 @@ void TasmanianSparseGrid::setSurplusRefinement(double tolerance, TypeRefinement
 }
 
 void TasmanianSparseGrid::clearRefinement(){
+    detach();
     if (!empty()) base->clearRefinement();
 }
 void TasmanianSparseGrid::mergeRefinement(){
+    detach();
     if (!empty()) base->mergeRefinement();
 }
 
@@ -1035,6 +1235,7 @@ void TasmanianSparseGrid::beginConstruction(){
     if (!usingDynamicConstruction){
         if (getNumLoaded() > 0) clearRefinement();
         usingDynamicConstruction = true;
+        detach();
         base->beginConstruction();
     }
 }
@@ -1091,6 +1292,7 @@ void TasmanianSparseGrid::loadConstructedPoint(const std::vector<double> &x, con
     if (y.size() != (size_t) getNumOutputs()) throw std::runtime_error("ERROR: loadConstructedPoint() called with incorrect size for y");
     Data2D<double> x_tmp;
     const double *x_canonical = formCanonicalPoints(x.data(), x_tmp, 1);
+    detach();
     base->loadConstructedPoint(x_canonical, y);
 }
 void TasmanianSparseGrid::loadConstructedPoint(const double x[], const double y[]){
@@ -1099,10 +1301,26 @@ void TasmanianSparseGrid::loadConstructedPoint(const double x[], const double y[
     loadConstructedPoint(vecx, vecy);
 }
 void TasmanianSparseGrid::finishConstruction(){
-    if (usingDynamicConstruction) base->finishConstruction();
+    if (usingDynamicConstruction){
+        detach();
+        base->finishConstruction();
+    }
     usingDynamicConstruction = false;
 }
 
+void TasmanianSparseGrid::freezeForEvaluation(){
+    if (empty()) throw std::runtime_error("ERROR: freezeForEvaluation() called for an empty grid");
+    if (frozen) return;
+    if ((base->getNumOutputs() > 0) && (base->getNumLoaded() == 0))
+        throw std::runtime_error("ERROR: freezeForEvaluation() called before loading the values of the model");
+    finishConstruction();
+    detach(); // other copies of the grid keep the construction and refinement data
+    base->freezeForEvaluation(!conformal_asin_power.empty()); // only the conformal integrals read the loaded values
+    llimits.clear();
+    llimits.shrink_to_fit();
+    frozen = true;
+}
+
 void TasmanianSparseGrid::removePointsByHierarchicalCoefficient(double tolerance, int output, const double *scale_correction){
     if (!isLocalPolynomial()){
         throw std::runtime_error("ERROR: removePointsBySurplus() called for a grid that is not Local Polynomial.");
@@ -1115,7 +1333,10 @@ void TasmanianSparseGrid::removePointsByHierarchicalCoefficient(double tolerance
 
 void TasmanianSparseGrid::evaluateHierarchicalFunctions(const double x[], int num_x, double y[]) const{
     Data2D<double> x_tmp;
-    base->evaluateHierarchicalFunctions(formCanonicalPoints(x, x_tmp, num_x), num_x, y);
+    evaluateHierarchicalFunctions(x, num_x, y, x_tmp);
+}
+void TasmanianSparseGrid::evaluateHierarchicalFunctions(const double x[], int num_x, double y[], Data2D<double> &x_temp) const{
+    base->evaluateHierarchicalFunctions(formCanonicalPoints(x, x_temp, num_x), num_x, y);
 }
 void TasmanianSparseGrid::evaluateHierarchicalFunctions(const std::vector<double> &x, std::vector<double> &y) const{
     int num_points = getNumPoints();
@@ -1287,6 +1508,7 @@ void TasmanianSparseGrid::evaluateSparseHierarchicalFunctionsStatic(const double
 }
 
 void TasmanianSparseGrid::setHierarchicalCoefficients(const double c[]){
+    detach();
     base->setHierarchicalCoefficients(c, acceleration);
 }
 void TasmanianSparseGrid::setHierarchicalCoefficients(const std::vector<double> &c){ setHierarchicalCoefficients(c.data()); }
@@ -1396,7 +1618,7 @@ void TasmanianSparseGrid::printStats(std::ostream &os) const{
     os << endl;
 }
 
-void TasmanianSparseGrid::writeAscii(std::ofstream &ofs) const{
+void TasmanianSparseGrid::writeAscii(std::ostream &ofs) const{
     using std::endl;
 
     ofs << "TASMANIAN SG " << getVersion() << endl;
@@ -1449,12 +1671,14 @@ void TasmanianSparseGrid::writeAscii(std::ofstream &ofs) const{
     if (usingDynamicConstruction){
         ofs << "constructing" << endl;
         base->writeConstructionData(ofs);
+    }else if (frozen){
+        ofs << "frozen" << endl;
     }else{
         ofs << "static" << endl;
     }
     ofs << "TASMANIAN SG end" << endl;
 }
-void TasmanianSparseGrid::writeBinary(std::ofstream &ofs) const{
+void TasmanianSparseGrid::writeBinary(std::ostream &ofs) const{
     const char *TSG = "TSG5"; // last char indicates version (update only if necessary, no need to sync with getVersionMajor())
     ofs.write(TSG, 4 * sizeof(char)); // mark Tasmanian files
     char flag;
@@ -1501,12 +1725,14 @@ void TasmanianSparseGrid::writeBinary(std::ofstream &ofs) const{
     if (usingDynamicConstruction){
         flag = 'c'; ofs.write(&flag, sizeof(char));
         base->writeConstructionDataBinary(ofs);
+    }else if (frozen){
+        flag = 'f'; ofs.write(&flag, sizeof(char));
     }else{
         flag = 's'; ofs.write(&flag, sizeof(char));
     }
     flag = 'e'; ofs.write(&flag, sizeof(char)); // E stands for END
 }
-void TasmanianSparseGrid::readAscii(std::ifstream &ifs){
+void TasmanianSparseGrid::readAscii(std::istream &ifs){
     std::string T;
     std::string message = ""; // used in case there is an exception
     ifs >> T;  if (!(T.compare("TASMANIAN") == 0)){ throw std::runtime_error("ERROR: wrong file format, first word in not 'TASMANIAN'"); }
@@ -1600,6 +1826,8 @@ void TasmanianSparseGrid::readAscii(std::ifstream &ifs){
             usingDynamicConstruction = true;
             base->readConstructionData(ifs);
             getline(ifs, T); // clear the final std::endl after reading the block
+        }else if (T.compare("frozen") == 0){ // the file holds only the data needed for evaluations
+            frozen = true;
         }else if (T.compare("TASMANIAN SG end") == 0){
             reached_eof = true;
         }else if (T.compare("static") != 0){ // static construction requires no additional work
@@ -1613,7 +1841,7 @@ void TasmanianSparseGrid::readAscii(std::ifstream &ifs){
         }
     }
 }
-void TasmanianSparseGrid::readBinary(std::ifstream &ifs){
+void TasmanianSparseGrid::readBinary(std::istream &ifs){
     std::vector<char>  TSG(4);
     ifs.read(TSG.data(), 4*sizeof(char));
     if ((TSG[0] != 'T') || (TSG[1] != 'S') || (TSG[2] != 'G')){
@@ -1672,6 +1900,8 @@ void TasmanianSparseGrid::readBinary(std::ifstream &ifs){
     if (TSG[0] == 'c'){ // handles additional data for dynamic construction, added in version 7.0 (development 6.1)
         usingDynamicConstruction = true;
         base->readConstructionDataBinary(ifs);
+    }else if (TSG[0] == 'f'){ // the file holds only the data needed for evaluations
+        frozen = true;
     }else if (TSG[0] == 'e'){
         reached_eof = true;
     }else if (TSG[0] != 's'){
@@ -1688,15 +1918,19 @@ void TasmanianSparseGrid::readBinary(std::ifstream &ifs){
 void TasmanianSparseGrid::enableAcceleration(TypeAcceleration acc){
     TypeAcceleration effective_acc = AccelerationMeta::getAvailableFallback(acc);
     if (effective_acc != acceleration){
+        #ifdef Tasmanian_ENABLE_CUDA
+        bool was_gpu = AccelerationMeta::isAccTypeGPU(acceleration);
+        #endif
         acceleration = effective_acc;
         #ifdef Tasmanian_ENABLE_CUDA
         if (AccelerationMeta::isAccTypeGPU(acceleration)){ // using CUDA
+            unshare(); // the GPU caches are held by base, a grid on the GPU never shares base with other grids
             if (!engine) engine = std::unique_ptr<CudaEngine>(new CudaEngine(gpuID));
             engine->setBackendMAGMA((acceleration == accel_gpu_magma));
         }else{ // using not CUDA, clear any loaded data
             if (engine) engine.reset();
             if (!acc_domain.empty()) acc_domain.clear();
-            if (!empty()) base->clearAccelerationData();
+            if (was_gpu) clearGPUCaches();
         }
         #endif
     }
@@ -1710,11 +1944,7 @@ TypeAcceleration TasmanianSparseGrid::getAccelerationType() const{
 bool TasmanianSparseGrid::isAccelerationAvailable(TypeAcceleration acc){
     switch (acc){
         case accel_none:   return true;
-        #ifdef Tasmanian_ENABLE_BLAS
-        case accel_cpu_blas:   return true;
-        #else
-        case accel_cpu_blas:   return false;
-        #endif // Tasmanian_ENABLE_BLAS
+        case accel_cpu_blas:   return true; // uses the internal kernels if BLAS is disabled
 
         #ifdef Tasmanian_ENABLE_CUDA
         case accel_gpu_cublas: return true;
@@ -1742,7 +1972,7 @@ bool TasmanianSparseGrid::isAccelerationAvailable(TypeAcceleration acc){
 void TasmanianSparseGrid::setGPUID(int new_gpuID){
     if (new_gpuID != gpuID){
         #ifdef Tasmanian_ENABLE_CUDA
-        if (!empty()) base->clearAccelerationData();
+        if (AccelerationMeta::isAccTypeGPU(acceleration)) clearGPUCaches(); // a grid on the CPU has no GPU data
         if (!acc_domain.empty()) acc_domain.clear();
         gpuID = new_gpuID;
         if (engine){
@@ -1784,6 +2014,43 @@ char* TasmanianSparseGrid::getGPUName(int){
 using std::cerr;
 using std::endl;
 
+extern "C" {
+#include "TasmanianSparseGrid.h"
+}
+
+// scratch memory associated with a tsgWorkspace handle of the reentrant C interface
+// holds only the domain transform of the points, the grid classes (and the GPU kernels) allocate their own scratch memory in each call
+struct TasmanianWorkspace{
+    Data2D<double> x_temp;
+};
+
+// the GPU engine of a grid is shared by all callers, the reentrant C interface serializes the calls on the same GPU device
+// while calls on different devices (and all CPU calls) run concurrently
+std::mutex& getReentrantGPULock(int gpu){
+    static std::vector<std::mutex> gpu_locks((size_t) std::max(TasmanianSparseGrid::getNumGPUs(), 1));
+    return gpu_locks[((gpu < 0) || ((size_t) gpu >= gpu_locks.size())) ? 0 : (size_t) gpu];
+}
+
+// calls f(grid, x_temp) with the scratch space of the workspace (or a temporary one) and converts exceptions into error codes
+template<class Operation>
+int tsgRunReentrant(void *grid, void *workspace, Operation f){
+    if ((grid == nullptr) || ((TasmanianSparseGrid*) grid)->empty()) return TSG_ERROR_NULL_GRID;
+    try{
+        const TasmanianSparseGrid *tsg = (const TasmanianSparseGrid*) grid;
+        Data2D<double> local_temp;
+        Data2D<double> &x_temp = (workspace == nullptr) ? local_temp : ((TasmanianWorkspace*) workspace)->x_temp;
+        if (AccelerationMeta::isAccTypeGPU(tsg->getAccelerationType())){
+            std::lock_guard<std::mutex> lock(getReentrantGPULock(tsg->getGPUID()));
+            return f(tsg, x_temp);
+        }
+        return f(tsg, x_temp);
+    }catch(std::bad_alloc &){
+        return TSG_ERROR_EXCEPTION;
+    }catch(std::exception &){
+        return TSG_ERROR_EXCEPTION;
+    }
+}
+
 extern "C" {
 void* tsgConstructTasmanianSparseGrid(){ return (void*) new TasmanianSparseGrid(); }
 void tsgDestructTasmanianSparseGrid(void *grid){ delete ((TasmanianSparseGrid*) grid); }
@@ -2171,6 +2438,83 @@ void tsgGetGPUName(int gpu, int num_buffer, char *buffer, int *num_actual){
 
 void tsgDeleteInts(int *p){ delete[] p; }
 
+int tsgGetCApiVersion(){ return TSG_C_API_VERSION; }
+const char* tsgGetErrorString(int error_code){
+    switch(error_code){
+        case TSG_SUCCESS:             return "success";
+        case TSG_ERROR_NULL_GRID:     return "the grid is null or empty";
+        case TSG_ERROR_BUFFER_SIZE:   return "the output buffer is too small";
+        case TSG_ERROR_INVALID_INPUT: return "invalid input, e.g., negative number of points or null pointer";
+        case TSG_ERROR_EXCEPTION:     return "the library encountered an error (exception) during the call";
+        default:
+            return "unknown error code";
+    }
+}
+void* tsgCreateWorkspace(){ return (void*) new TasmanianWorkspace(); }
+void tsgDestroyWorkspace(void *workspace){ delete ((TasmanianWorkspace*) workspace); }
+
+int tsgEvaluateBatchV1(void *grid, const double *x, int num_x, double *y, long long y_size, void *workspace){
+    return tsgRunReentrant(grid, workspace, [&](const TasmanianSparseGrid *tsg, Data2D<double> &x_temp)->int{
+        if ((num_x < 0) || ((num_x > 0) && ((x == nullptr) || (y == nullptr)))) return TSG_ERROR_INVALID_INPUT;
+        if (y_size < ((long long) num_x) * ((long long) tsg->getNumOutputs())) return TSG_ERROR_BUFFER_SIZE;
+        if (tsg->getNumLoaded() == 0) return TSG_ERROR_INVALID_INPUT;
+        if (num_x > 0) tsg->evaluateBatch(x, num_x, y, x_temp);
+        return TSG_SUCCESS;
+    });
+}
+int tsgGetInterpolationWeightsBatchV1(void *grid, const double *x, int num_x, double *weights, long long weights_size, void *workspace){
+    return tsgRunReentrant(grid, workspace, [&](const TasmanianSparseGrid *tsg, Data2D<double> &x_temp)->int{
+        if ((num_x < 0) || ((num_x > 0) && ((x == nullptr) || (weights == nullptr)))) return TSG_ERROR_INVALID_INPUT;
+        if (weights_size < ((long long) num_x) * ((long long) tsg->getNumPoints())) return TSG_ERROR_BUFFER_SIZE;
+        if (num_x > 0) tsg->getInterpolationWeightsBatch(x, num_x, weights, x_temp);
+        return TSG_SUCCESS;
+    });
+}
+int tsgEvaluateHierarchicalFunctionsV1(void *grid, const double *x, int num_x, double *y, long long y_size, void *workspace){
+    return tsgRunReentrant(grid, workspace, [&](const TasmanianSparseGrid *tsg, Data2D<double> &x_temp)->int{
+        if ((num_x < 0) || ((num_x > 0) && ((x == nullptr) || (y == nullptr)))) return TSG_ERROR_INVALID_INPUT;
+        if (y_size < ((long long) num_x) * ((long long) tsg->getNumPoints()) * ((tsg->isFourier()) ? 2 : 1)) return TSG_ERROR_BUFFER_SIZE;
+        if (num_x > 0) tsg->evaluateHierarchicalFunctions(x, num_x, y, x_temp);
+        return TSG_SUCCESS;
+    });
+}
+int tsgEvaluateSparseHierarchicalFunctionsV1(void *grid, const double *x, int num_x, int *pntr, long long pntr_size,
+                                             int *indx, double *vals, long long nz_size, int *num_nz){
+    return tsgRunReentrant(grid, nullptr, [&](const TasmanianSparseGrid *tsg, Data2D<double> &)->int{
+        if ((num_x < 0) || (num_nz == nullptr) || ((num_x > 0) && (x == nullptr))) return TSG_ERROR_INVALID_INPUT;
+        *num_nz = tsg->evaluateSparseHierarchicalFunctionsGetNZ(x, num_x);
+        if ((pntr_size < ((long long) num_x) + 1) || (nz_size < (long long) *num_nz)) return TSG_ERROR_BUFFER_SIZE;
+        if ((pntr == nullptr) || ((*num_nz > 0) && ((indx == nullptr) || (vals == nullptr)))) return TSG_ERROR_INVALID_INPUT;
+        tsg->evaluateSparseHierarchicalFunctionsStatic(x, num_x, pntr, indx, vals);
+        return TSG_SUCCESS;
+    });
+}
+int tsgIntegrateV1(void *grid, double *q, long long q_size){
+    return tsgRunReentrant(grid, nullptr, [&](const TasmanianSparseGrid *tsg, Data2D<double> &)->int{
+        if (q == nullptr) return TSG_ERROR_INVALID_INPUT;
+        if (q_size < (long long) tsg->getNumOutputs()) return TSG_ERROR_BUFFER_SIZE;
+        if (tsg->getNumLoaded() == 0) return TSG_ERROR_INVALID_INPUT;
+        tsg->integrate(q);
+        return TSG_SUCCESS;
+    });
+}
+int tsgGetPointsV1(void *grid, double *x, long long x_size){
+    return tsgRunReentrant(grid, nullptr, [&](const TasmanianSparseGrid *tsg, Data2D<double> &)->int{
+        if (x == nullptr) return TSG_ERROR_INVALID_INPUT;
+        if (x_size < ((long long) tsg->getNumPoints()) * ((long long) tsg->getNumDimensions())) return TSG_ERROR_BUFFER_SIZE;
+        tsg->getPoints(x);
+        return TSG_SUCCESS;
+    });
+}
+int tsgGetQuadratureWeightsV1(void *grid, double *weights, long long weights_size){
+    return tsgRunReentrant(grid, nullptr, [&](const TasmanianSparseGrid *tsg, Data2D<double> &)->int{
+        if (weights == nullptr) return TSG_ERROR_INVALID_INPUT;
+        if (weights_size < (long long) tsg->getNumPoints()) return TSG_ERROR_BUFFER_SIZE;
+        tsg->getQuadratureWeights(weights);
+        return TSG_SUCCESS;
+    });
+}
+
 }
 }
 
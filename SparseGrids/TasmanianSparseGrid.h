@@ -126,4 +126,39 @@ int tsgIsAccelerationAvailable(const char *accel);
 void tsgGetGPUName(int gpu, int num_buffer, char *buffer, int *num_actual);
 void tsgDeleteInts(int *p);
 
+// ------------ Reentrant C Interface (version 1) -------------- //
+// all outputs are written into caller provided buffers, the size of each buffer (number of doubles or ints) is given explicitly
+// the functions return TSG_SUCCESS or one of the error codes below, they never allocate the output or let C++ exceptions escape
+// a workspace (tsgCreateWorkspace()) keeps the scratch memory used to apply the domain transforms between calls
+// passing a null workspace is allowed, then the transformed points are allocated within the call
+// note: the workspace does not make the evaluations allocation free, the grid algorithms still use internal temporary memory
+// thread safety: many threads can call the functions below on the same grid at the same time, provided that
+//                each thread uses its own workspace (or null) and no thread modifies the grid during the calls
+//                (i.e., make, update, load, refine, set-transform, enable-acceleration, read, copy)
+//                calls to grids with GPU acceleration on the same device are serialized internally, since the GPU data is shared
+#define TSG_C_API_VERSION 1
+
+#define TSG_SUCCESS             0
+#define TSG_ERROR_NULL_GRID     1 // the grid is null or empty
+#define TSG_ERROR_BUFFER_SIZE   2 // the output buffer is too small, nothing was written
+#define TSG_ERROR_INVALID_INPUT 3 // negative number of points, null pointer, or evaluating a grid without loaded values
+#define TSG_ERROR_EXCEPTION     4 // the C++ library threw an exception, e.g., out of memory
+
+int tsgGetCApiVersion();
+const char* tsgGetErrorString(int error_code);
+
+void* tsgCreateWorkspace();
+void tsgDestroyWorkspace(void *workspace);
+
+// y has size num_outputs X num_x, weights and y (non-Fourier) have size num_points X num_x, Fourier grids use 2 X num_points X num_x (complex)
+int tsgEvaluateBatchV1(void *grid, const double *x, int num_x, double *y, long long y_size, void *workspace);
+int tsgGetInterpolationWeightsBatchV1(void *grid, const double *x, int num_x, double *weights, long long weights_size, void *workspace);
+int tsgEvaluateHierarchicalFunctionsV1(void *grid, const double *x, int num_x, double *y, long long y_size, void *workspace);
+// pntr has size num_x + 1, indx and vals have size nz_size, num_nz returns the number of non-zeros even when the buffers are too small
+int tsgEvaluateSparseHierarchicalFunctionsV1(void *grid, const double *x, int num_x, int *pntr, long long pntr_size,
+                                             int *indx, double *vals, long long nz_size, int *num_nz);
+int tsgIntegrateV1(void *grid, double *q, long long q_size);
+int tsgGetPointsV1(void *grid, double *x, long long x_size);
+int tsgGetQuadratureWeightsV1(void *grid, double *weights, long long weights_size);
+
 #endif
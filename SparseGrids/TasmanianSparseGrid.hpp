@@ -64,9 +64,13 @@ namespace TasGrid{
 class TasmanianSparseGrid{
 public:
     TasmanianSparseGrid();
-    TasmanianSparseGrid(const TasmanianSparseGrid &source);
+    TasmanianSparseGrid(const TasmanianSparseGrid &source); // O(1), the data is shared until one of the grids is modified (copy-on-write)
+    TasmanianSparseGrid(TasmanianSparseGrid &&source); // source is left empty
     ~TasmanianSparseGrid();
 
+    TasmanianSparseGrid& operator=(const TasmanianSparseGrid &source); // same as copyGrid()
+    TasmanianSparseGrid& operator=(TasmanianSparseGrid &&source);
+
     static const char* getVersion(); // human readable
     static int getVersionMajor();
     static int getVersionMinor();
@@ -78,8 +82,48 @@ public:
     void write(const char *filename, bool binary = false) const;
     void read(const char *filename); // auto-check if format is binary or ascii
 
-    void write(std::ofstream &ofs, bool binary = false) const;
-    void read(std::ifstream &ifs, bool binary = false);
+    void write(std::ostream &ofs, bool binary = false) const;
+    void read(std::istream &ifs, bool binary = false); // the grid is replaced only if the read succeeds
+
+    //! \brief Write the grid in binary format to the \b data vector (the old content is discarded), same as \b write() with \b binary set to \b true.
+    void serialize(std::vector<char> &data) const;
+    /*!
+     * \brief Read a grid from the \b size bytes starting at \b data, e.g., the result of \b serialize() or the content of a grid file.
+     *
+     * The bytes are parsed in place without an intermediate copy, both binary and ascii formats are accepted.
+     * Throws \b std::runtime_error if the buffer does not hold a complete grid, in which case this grid is not modified.
+     */
+    void deserialize(const char *data, size_t size);
+    //! \brief Overload that reads the result of \b serialize().
+    void deserialize(const std::vector<char> &data){ deserialize(data.data(), data.size()); }
+
+    /*!
+     * \brief Publish a frozen copy of the grid into the named POSIX shared memory segment (see shm_open()).
+     *
+     * The segment holds the binary image of the grid, see \b freezeForEvaluation(), followed by the hierarchical coefficients
+     * and the loaded values placed at aligned offsets, so that every attached process can use them in-place.
+     * An existing segment with the same \b name is unlinked and replaced by a new one,
+     * processes that have attached to the old segment keep using it.
+     * POSIX shared memory cannot be renamed, hence the replacement is not atomic and
+     * \b attachShared() called by another process during the republish can fail to find the segment,
+     * the caller should retry or synchronize the publishing and attaching processes.
+     * The segment persists until \b unlinkShared() is called or the machine is restarted.
+     * Throws \b std::runtime_error if the grid is empty, the values have not been loaded, or the segment cannot be created.
+     */
+    void publishShared(const char *name) const;
+    /*!
+     * \brief Replace this grid with the frozen grid published under \b name by another process (or this one).
+     *
+     * The segment is mapped read-only and the grid is loaded directly from the mapped memory without going through the file system.
+     * The hierarchical coefficients and the loaded values are not copied, the grid reads them from the segment
+     * and all processes attached to the same segment share one physical copy; the segment stays mapped until the grid is cleared or destroyed.
+     * The multi-index sets and the other small arrays are copied into the grid.
+     * Throws \b std::runtime_error if the segment does not exist or does not hold a complete grid,
+     * which can also happen transiently while another process republishes under the same \b name, see \b publishShared().
+     */
+    void attachShared(const char *name);
+    //! \brief Remove the named segment, processes that have already attached keep their grids.
+    static void unlinkShared(const char *name);
 
     void makeGlobalGrid(int dimensions, int outputs, int depth, TypeDepth type, TypeOneDRule rule, const int *anisotropic_weights = 0, double alpha = 0.0, double beta = 0.0, const char* custom_filename = 0, const int *level_limits = 0);
     void makeGlobalGrid(int dimensions, int outputs, int depth, TypeDepth type, TypeOneDRule rule, const std::vector<int> &anisotropic_weights, double alpha = 0.0, double beta = 0.0, const char* custom_filename = 0, const std::vector<int> &level_limits = std::vector<int>());
@@ -96,7 +140,7 @@ public:
     void makeFourierGrid(int dimensions, int outputs, int depth, TypeDepth type, const int* anisotropic_weights = 0, const int* level_limits = 0);
     void makeFourierGrid(int dimensions, int outputs, int depth, TypeDepth type, const std::vector<int> &anisotropic_weights, const std::vector<int> &level_limits = std::vector<int>());
 
-    void copyGrid(const TasmanianSparseGrid *source);
+    void copyGrid(const TasmanianSparseGrid *source); // copy-on-write, the data is copied when either grid is modified
 
     void updateGlobalGrid(int depth, TypeDepth type, const int *anisotropic_weights = 0, const int *level_limits = 0);
     void updateGlobalGrid(int depth, TypeDepth type, const std::vector<int> &anisotropic_weights, const std::vector<int> &level_limits = std::vector<int>());
@@ -152,6 +196,13 @@ public:
     void evaluateBatch(const std::vector<double> &x, std::vector<double> &y) const;
     void integrate(std::vector<double> &q) const;
 
+    // same as above, but x_temp is scratch space for the domain transforms (if any), reusing x_temp avoids reallocating the transformed points
+    // (the algorithms of the individual grids still allocate their own temporary memory)
+    // the methods are reentrant (as long as the grid is not modified) and can be called from multiple threads with different x_temp
+    void evaluateBatch(const double x[], int num_x, double y[], Data2D<double> &x_temp) const;
+    void getInterpolationWeightsBatch(const double x[], int num_x, double weights[], Data2D<double> &x_temp) const; // weights is getNumPoints() X num_x
+    void evaluateHierarchicalFunctions(const double x[], int num_x, double y[], Data2D<double> &x_temp) const;
+
     bool isGlobal() const;
     bool isSequence() const;
     bool isLocalPolynomial() const;
@@ -178,8 +229,8 @@ public:
     void setAnisotropicRefinement(TypeDepth type, int min_growth, int output, const int *level_limits = 0);
     void setAnisotropicRefinement(TypeDepth type, int min_growth, int output, const std::vector<int> &level_limits);
 
-    int* estimateAnisotropicCoefficients(TypeDepth type, int output);
-    void estimateAnisotropicCoefficients(TypeDepth type, int output, std::vector<int> &weights);
+    int* estimateAnisotropicCoefficients(TypeDepth type, int output) const;
+    void estimateAnisotropicCoefficients(TypeDepth type, int output, std::vector<int> &weights) const;
 
     void setSurplusRefinement(double tolerance, int output, const int *level_limits = 0);
     void setSurplusRefinement(double tolerance, int output, const std::vector<int> &level_limits);
@@ -234,6 +285,19 @@ public:
 
     void printStats(std::ostream &os = std::cout) const;
 
+    /*!
+     * \brief Drops all data that is not needed by the evaluate, integrate and get-weights methods and marks the grid as read-only.
+     *
+     * Clears any pending refinement, finishes dynamic construction and discards the level limits and refinement tensors,
+     * the local polynomial parents and, unless a conformal transform is set, the loaded values of the grids that evaluate
+     * from hierarchical coefficients (local polynomial, wavelet and Fourier); the remaining arrays are compacted to their actual size. Methods that modify the grid will throw \b std::runtime_error,
+     * while \b write() saves only the frozen data and \b read() restores a frozen grid.
+     * Making a new grid or reading from a file resets the frozen state, copies of a frozen grid are also frozen.
+     */
+    void freezeForEvaluation();
+    //! \brief Returns \b true if the grid has been frozen with \b freezeForEvaluation().
+    bool isFrozen() const{ return frozen; }
+
     void enableAcceleration(TypeAcceleration acc);
     void favorSparseAcceleration(bool favor);
     TypeAcceleration getAccelerationType() const;
@@ -267,11 +331,12 @@ public:
     const int* getNeededIndexes() const;
 
     // make these protected for a release
-    inline GridGlobal*          getGridGlobal(){          return (GridGlobal*)          base.get(); }
-    inline GridSequence*        getGridSequence(){        return (GridSequence*)        base.get(); }
-    inline GridLocalPolynomial* getGridLocalPolynomial(){ return (GridLocalPolynomial*) base.get(); }
-    inline GridFourier*         getGridFourier(){         return (GridFourier*)         base.get(); }
-    inline GridWavelet*         getGridWavelet(){         return (GridWavelet*)         base.get(); }
+    // the non-const versions give write access, which forces a copy of data shared with other grids (if any)
+    inline GridGlobal*          getGridGlobal(){          detach(); return (GridGlobal*)          base.get(); }
+    inline GridSequence*        getGridSequence(){        detach(); return (GridSequence*)        base.get(); }
+    inline GridLocalPolynomial* getGridLocalPolynomial(){ detach(); return (GridLocalPolynomial*) base.get(); }
+    inline GridFourier*         getGridFourier(){         detach(); return (GridFourier*)         base.get(); }
+    inline GridWavelet*         getGridWavelet(){         detach(); return (GridWavelet*)         base.get(); }
     inline const GridGlobal*          getGridGlobal() const{          return (const GridGlobal*)          base.get(); }
     inline const GridSequence*        getGridSequence() const{        return (const GridSequence*)        base.get(); }
     inline const GridLocalPolynomial* getGridLocalPolynomial() const{ return (const GridLocalPolynomial*) base.get(); }
@@ -280,6 +345,9 @@ public:
 
 protected:
     void clear();
+    void detach(); // copy-on-write, makes a private copy of base if it is shared with other grids
+    void unshare(); // same as detach() but allowed for frozen grids, the copy of base holds no GPU caches
+    void clearGPUCaches(); // drops the GPU data of this grid, a base shared with other grids is never cleared in place
 
     void mapCanonicalToTransformed(int num_dimensions, int num_points, TypeOneDRule rule, double x[]) const;
     void mapTransformedToCanonical(int num_dimensions, int num_points, TypeOneDRule rule, double x[]) const;
@@ -295,14 +363,15 @@ protected:
     #endif
     void formTransformedPoints(int num_points, double x[]) const; // when calling get***Points()
 
-    void writeAscii(std::ofstream &ofs) const;
-    void readAscii(std::ifstream &ifs);
+    void writeAscii(std::ostream &ofs) const;
+    void readAscii(std::istream &ifs);
 
-    void writeBinary(std::ofstream &ofs) const;
-    void readBinary(std::ifstream &ifs);
+    void writeBinary(std::ostream &ofs) const;
+    void readBinary(std::istream &ifs);
 
 private:
-    std::unique_ptr<BaseCanonicalGrid> base;
+    // copies of a grid share the same base until one of them is modified, const methods never modify base
+    std::shared_ptr<BaseCanonicalGrid> base;
 
     std::vector<double> domain_transform_a, domain_transform_b;
     std::vector<int> conformal_asin_power;
@@ -312,6 +381,7 @@ private:
     int gpuID;
 
     bool usingDynamicConstruction;
+    bool frozen;
 
     #ifdef Tasmanian_ENABLE_CUDA
     mutable std::unique_ptr<CudaEngine> engine;
@@ -66,6 +66,7 @@ int main(int argc, const char ** argv){
     UnitTests utest = unit_none;
 
     int gpuid = -1;
+    const char *tasgrid_exe = nullptr;
     int k = 1;
     while (k < argc){
         if ((strcmp(argv[k],"debug") == 0)) debug = true;
@@ -86,6 +87,8 @@ int main(int argc, const char ** argv){
         else if ((strcmp(argv[k],"api") == 0)) utest = unit_api;
         else if ((strcmp(argv[k],"c") == 0)) utest = unit_c;
         else if ((strcmp(argv[k],"cover") == 0)) utest = unit_cover;
+        else if ((strcmp(argv[k],"server") == 0)) utest = unit_server;
+        else if ((strcmp(argv[k],"cli") == 0)) utest = unit_cli;
         else if ((strcmp(argv[k],"-gpuid") == 0)){
             if (k+1 >= argc){
                 cerr << "ERROR: -gpuid requires a valid number!" << endl;
@@ -98,6 +101,8 @@ int main(int argc, const char ** argv){
                 cerr << "      see ./tasgrid -v for a list of detected GPUs." << endl;
                 return 1;
             }
+        }else if ((strcmp(argv[k],"-tasgrid") == 0) && (k+1 < argc)){
+            tasgrid_exe = argv[++k];
         }else{
             cerr << "ERROR: unknown option " << argv[k] << endl;
             return 1;
@@ -108,6 +113,7 @@ int main(int argc, const char ** argv){
     ExternalTester tester(1000);
     GridUnitTester utester;
     tester.setGPUID(gpuid);
+    if (tasgrid_exe != nullptr) utester.setTasgridExecutable(tasgrid_exe);
     bool pass = true;
     if (debug){
         tester.debugTest();
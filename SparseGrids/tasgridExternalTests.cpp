@@ -751,6 +751,54 @@ bool ExternalTester::testAllGlobal() const{
         }
         delete[] indx; delete[] pntr; delete[] vals; delete[] pnts; delete[] y;
     }
+    { // large Gauss-Legendre rules use the Glaser-Liu-Rokhlin algorithm, check the exactness of the quadrature
+        for(int level : {TSG_GAUSS_LEGENDRE_GLR, 200, 401}){
+            TasGrid::TasmanianSparseGrid grid;
+            grid.makeGlobalGrid(1, 0, level, TasGrid::type_level, TasGrid::rule_gausslegendre);
+            std::vector<double> points, weights;
+            grid.getPoints(points);
+            grid.getQuadratureWeights(weights);
+            for(int p : {0, 2, 50, 2 * level}){
+                double integral = 0.0;
+                for(size_t i=0; i<points.size(); i++) integral += weights[i] * std::pow(points[i], p);
+                if (fabs(integral - 2.0 / ((double) (p + 1))) > 1.E-13){
+                    cout << "Error in Gauss-Legendre quadrature with " << level + 1 << " points, integral of x^" << p << endl;
+                    pass = false;
+                }
+            }
+        }
+    }
+    { // the Glaser-Liu-Rokhlin rules replace the tridiagonal solver above TSG_GAUSS_LEGENDRE_GLR points, the change must be at round-off level
+        for(int num_points : {TSG_GAUSS_LEGENDRE_GLR + 1, 100}){
+            std::vector<double> wglr, xglr, wtri, xtri;
+            TasGrid::OneDimensionalNodes::getGaussLegendreGLR(num_points, wglr, xglr);
+            TasGrid::OneDimensionalNodes::getGaussLegendreTridiagonal(num_points, wtri, xtri);
+            for(int i=0; i<num_points; i++){
+                if ((fabs(xglr[i] - xtri[i]) > 1.E-13) || (fabs(wglr[i] - wtri[i]) > 1.E-10)){
+                    cout << "Error in Gauss-Legendre rule with " << num_points << " points, mismatch at node " << i << endl;
+                    pass = false;
+                }
+            }
+        }
+    }
+    for(auto rule : {TasGrid::rule_clenshawcurtis, TasGrid::rule_gausslegendreodd, TasGrid::rule_leja}){ // the one dimensional tables are shared between grids
+        TasGrid::TasmanianSparseGrid shallow, deep, shared;
+        shallow.makeGlobalGrid(2, 1, 4, TasGrid::type_qptotal, rule);
+        deep.makeGlobalGrid(2, 1, 8, TasGrid::type_qptotal, rule); // extends the shared tables
+        shared.makeGlobalGrid(2, 1, 4, TasGrid::type_qptotal, rule); // uses the deeper tables
+        std::vector<double> shallow_points, shallow_weights, shared_points, shared_weights;
+        shallow.getPoints(shallow_points);
+        shallow.getQuadratureWeights(shallow_weights);
+        shared.getPoints(shared_points);
+        shared.getQuadratureWeights(shared_weights);
+        double err = 0.0;
+        for(size_t i=0; i<shallow_points.size(); i++) err = std::max(err, fabs(shallow_points[i] - shared_points[i]));
+        for(size_t i=0; i<shallow_weights.size(); i++) err = std::max(err, fabs(shallow_weights[i] - shared_weights[i]));
+        if ((shallow_points.size() != shared_points.size()) || (err > TSG_NUM_TOL)){
+            cout << "Error in the one dimensional tables shared between grids, rule: " << TasGrid::OneDimensionalMeta::getIORuleString(rule) << endl;
+            pass = false;
+        }
+    }
     int wfirst = 11, wsecond = 34, wthird = 15;
     if (pass){
         cout << setw(wfirst) << "Rules" << setw(wsecond) << "global/sequence" << setw(wthird) << "Pass" << endl;
@@ -2020,6 +2068,71 @@ bool ExternalTester::testAcceleratedLoadValues(TasGrid::TypeOneDRule rule) const
     return pass;
 }
 
+bool ExternalTester::testSharedGridsGPU(TasGrid::TypeOneDRule rule) const{
+    // copies of a grid share the canonical grid, the GPU caches must not be shared
+    const BaseFunction *f = &f21expsincos;
+    TasmanianSparseGrid grid;
+    if (OneDimensionalMeta::isLocalPolynomial(rule)){
+        grid.makeLocalPolynomialGrid(f->getNumInputs(), f->getNumOutputs(), 5, 1, rule);
+    }else{
+        grid.makeGlobalGrid(f->getNumInputs(), f->getNumOutputs(), 6, type_iptotal, rule);
+    }
+    loadValues(f, grid);
+
+    int nump = 100;
+    std::vector<double> x(f->getNumInputs() * nump);
+    setRandomX((int) x.size(), x.data());
+    std::vector<double> y_ref;
+    grid.evaluateBatch(x, y_ref);
+
+    auto check = [&](TasmanianSparseGrid const &copy, int g)->bool{
+        std::vector<double> y;
+        copy.evaluateBatch(x, y);
+        double err = 0.0;
+        for(size_t i=0; i<y_ref.size(); i++) err = std::max(err, std::abs(y[i] - y_ref[i]));
+        if (err >= TSG_NUM_TOL){
+            cout << "ERROR: GPU evaluations of a copied grid failed for rule: " << OneDimensionalMeta::getHumanString(rule) << " at gpu: " << g << " with error: " << err << endl;
+            return false;
+        }
+        return true;
+    };
+
+    bool pass = true;
+    int gstart = (gpuid == -1) ? 0 : gpuid;
+    int gend   = (gpuid == -1) ? TasmanianSparseGrid::getNumGPUs() : gpuid + 1;
+    for(int g = gstart; g < gend; g++){
+        int gother = (gpuid == -1) ? (g + 1) % TasmanianSparseGrid::getNumGPUs() : gpuid;
+        TasmanianSparseGrid first(grid), second(grid);
+        first.enableAcceleration(accel_gpu_cuda);
+        first.setGPUID(g);
+        pass = pass && check(first, g); // loads the GPU cache of first
+        second.enableAcceleration(accel_gpu_cublas);
+        second.setGPUID(gother);
+        pass = pass && check(second, gother);
+        pass = pass && check(first, g);
+
+        TasmanianSparseGrid third(first); // copy of a grid that has loaded GPU data
+        third.enableAcceleration(accel_gpu_cuda);
+        third.setGPUID(gother);
+        pass = pass && check(third, gother);
+        first.enableAcceleration(accel_cpu_blas); // clears the cache of first only
+        pass = pass && check(third, gother) && check(second, gother) && check(first, g);
+
+        TasmanianSparseGrid frozen_first(grid);
+        frozen_first.freezeForEvaluation();
+        TasmanianSparseGrid frozen_second(frozen_first); // frozen copies share the canonical grid too
+        frozen_first.enableAcceleration(accel_gpu_cuda);
+        frozen_first.setGPUID(g);
+        frozen_second.enableAcceleration(accel_gpu_cuda);
+        frozen_second.setGPUID(g);
+        pass = pass && check(frozen_first, g) && check(frozen_second, g);
+        frozen_second.setGPUID(gother);
+        frozen_first.enableAcceleration(accel_none);
+        pass = pass && check(frozen_second, gother) && check(frozen_first, g);
+    }
+    return pass;
+}
+
 bool ExternalTester::testAllAcceleration() const{
     const BaseFunction *f = &f23Kexpsincos;
     const BaseFunction *f1out = &f21expsincos;
@@ -2101,6 +2214,17 @@ bool ExternalTester::testAllAcceleration() const{
     if (verbose) cout << "      Accelerated" << setw(wsecond) << "load-values" << setw(wthird) << "Skipped (needs Tasmanian_ENABLE_CUDA=ON)" << endl;
     #endif
 
+    #ifdef Tasmanian_ENABLE_CUDA
+    pass = pass && testSharedGridsGPU(rule_clenshawcurtis) && testSharedGridsGPU(rule_localp);
+    if (pass){
+        if (verbose) cout << "      Accelerated" << setw(wsecond) << "shared-grids" << setw(wthird) << "Pass" << endl;
+    }else{
+        cout << "      Accelerated" << setw(wsecond) << "shared-grids" << setw(wthird) << "FAIL" << endl;
+    }
+    #else
+    if (verbose) cout << "      Accelerated" << setw(wsecond) << "shared-grids" << setw(wthird) << "Skipped (needs Tasmanian_ENABLE_CUDA=ON)" << endl;
+    #endif
+
     cout << "      Acceleration                        all" << setw(15) << ((pass) ? "Pass" : "FAIL") << endl;
 
     return pass;
@@ -88,6 +88,7 @@ public:
     bool testAcceleration(const BaseFunction *f, TasmanianSparseGrid *grid) const;
     bool testGPU2GPUevaluations() const;
     bool testAcceleratedLoadValues(TasGrid::TypeOneDRule rule) const;
+    bool testSharedGridsGPU(TasGrid::TypeOneDRule rule) const;
 
     TestResults getError(const BaseFunction *f, TasGrid::TasmanianSparseGrid *grid, TestType type, const double *x = 0) const;
 
@@ -0,0 +1,431 @@
+/*
+ * Copyright (c) 2017, Miroslav Stoyanov
+ *
+ * This file is part of
+ * Toolkit for Adaptive Stochastic Modeling And Non-Intrusive ApproximatioN: TASMANIAN
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+ *    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * UT-BATTELLE, LLC AND THE UNITED STATES GOVERNMENT MAKE NO REPRESENTATIONS AND DISCLAIM ALL WARRANTIES, BOTH EXPRESSED AND IMPLIED.
+ * THERE ARE NO EXPRESS OR IMPLIED WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT THE USE OF THE SOFTWARE WILL NOT INFRINGE ANY PATENT,
+ * COPYRIGHT, TRADEMARK, OR OTHER PROPRIETARY RIGHTS, OR THAT THE SOFTWARE WILL ACCOMPLISH THE INTENDED RESULTS OR THAT THE SOFTWARE OR ITS USE WILL NOT RESULT IN INJURY OR DAMAGE.
+ * THE USER ASSUMES RESPONSIBILITY FOR ALL LIABILITIES, PENALTIES, FINES, CLAIMS, CAUSES OF ACTION, AND COSTS AND EXPENSES, CAUSED BY, RESULTING FROM OR ARISING OUT OF,
+ * IN WHOLE OR IN PART THE USE, STORAGE OR DISPOSAL OF THE SOFTWARE.
+ */
+
+#ifndef __TASGRID_SERVER_CPP
+#define __TASGRID_SERVER_CPP
+
+#include "tasgridServer.hpp"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+static bool socketReadAll(int fd, void *buffer, size_t num_bytes){
+    char *p = (char*) buffer;
+    while(num_bytes > 0){
+        ssize_t r = ::read(fd, p, num_bytes);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r;
+        num_bytes -= (size_t) r;
+    }
+    return true;
+}
+
+static bool socketWriteAll(int fd, const void *buffer, size_t num_bytes){
+    const char *p = (const char*) buffer;
+    while(num_bytes > 0){
+        ssize_t r = ::write(fd, p, num_bytes);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r;
+        num_bytes -= (size_t) r;
+    }
+    return true;
+}
+
+static bool socketWriteError(int fd, const std::string &message){
+    TasgridServerHeader header = {1, 0, (long long) message.size(), 0};
+    return socketWriteAll(fd, &header, sizeof(header)) && socketWriteAll(fd, message.c_str(), message.size());
+}
+
+static void setSocketAddress(const char *socket_path, sockaddr_un &addr){
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) throw std::invalid_argument(std::string("ERROR: socket path is too long: ") + socket_path);
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+}
+#endif
+
+TasgridServer::TasgridServer() : stopping(false), listen_fd(-1){ wakeup_fd[0] = -1; wakeup_fd[1] = -1; }
+TasgridServer::~TasgridServer(){}
+
+int TasgridServer::addGrid(const char *filename){
+    std::unique_ptr<TasmanianSparseGrid> grid(new TasmanianSparseGrid());
+    grid->read(filename);
+    char tsg[3] = {'A', 'A', 'A'};
+    std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+    ifs.read(tsg, 3 * sizeof(char));
+    grids.push_back(std::move(grid));
+    filenames.push_back(filename);
+    binary_formats.push_back((tsg[0] == 'T') && (tsg[1] == 'S') && (tsg[2] == 'G'));
+    grid_locks.push_back(std::unique_ptr<std::mutex>(new std::mutex()));
+    return (int) grids.size() - 1;
+}
+
+#ifdef _WIN32
+void TasgridServer::serve(const char*, int){
+    throw std::runtime_error("ERROR: tasgrid -serve requires UNIX domain sockets, which are not available on this platform");
+}
+void TasgridServer::stop(){}
+void TasgridServer::connectionLoop(int){}
+TasgridClient::TasgridClient(const char*) : fd(-1){
+    throw std::runtime_error("ERROR: the tasgrid client requires UNIX domain sockets, which are not available on this platform");
+}
+TasgridClient::~TasgridClient(){}
+void TasgridClient::request(int, int, long long, long long, const double[], std::vector<double> &){}
+#else
+void TasgridServer::serve(const char *socket_path, int num_threads){
+    if (grids.empty()) throw std::invalid_argument("ERROR: the server requires at least one grid");
+    if (num_threads < 1) num_threads = std::max((int) std::thread::hardware_concurrency(), 1);
+    ::signal(SIGPIPE, SIG_IGN); // closed connections are reported by write()
+
+    sockaddr_un addr;
+    setSocketAddress(socket_path, addr);
+    listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) throw std::runtime_error("ERROR: could not create a socket");
+    struct stat existing;
+    if (::lstat(socket_path, &existing) == 0){ // remove a stale socket from a previous run, but never any other file
+        if (!S_ISSOCK(existing.st_mode) || (::unlink(socket_path) != 0)){
+            ::close(listen_fd);
+            throw std::runtime_error(std::string("ERROR: the socket path exists and is not a socket that can be removed: ") + socket_path);
+        }
+    }else if (errno != ENOENT){
+        ::close(listen_fd);
+        throw std::runtime_error(std::string("ERROR: could not check the socket path: ") + socket_path);
+    }
+    if ((::bind(listen_fd, (sockaddr*) &addr, sizeof(addr)) != 0) || (::listen(listen_fd, 16) != 0) || (::pipe(wakeup_fd) != 0)){
+        ::close(listen_fd);
+        throw std::runtime_error(std::string("ERROR: could not listen on socket: ") + socket_path);
+    }
+
+    std::vector<std::thread> workers, readers;
+    for(int i=0; i<num_threads; i++) workers.emplace_back(&TasgridServer::workerLoop, this);
+
+    pollfd watch[2] = {{listen_fd, POLLIN, 0}, {wakeup_fd[0], POLLIN, 0}};
+    while(true){
+        if (::poll(watch, 2, -1) < 0){
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (watch[1].revents != 0) break; // stop() was called
+        if (watch[0].revents & POLLIN){
+            int fd = ::accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) continue;
+            std::vector<std::thread::id> finished;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                if (stopping){
+                    ::close(fd);
+                    break;
+                }
+                connections.push_back(fd);
+                readers.emplace_back(&TasgridServer::connectionLoop, this, fd);
+                std::swap(finished, finished_readers);
+            }
+            // join the readers of closed connections, they have already left (or are about to leave) connectionLoop()
+            for(auto id : finished){
+                auto ir = std::find_if(readers.begin(), readers.end(), [&](const std::thread &r)->bool{ return (r.get_id() == id); });
+                ir->join();
+                readers.erase(ir);
+            }
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        stopping = true;
+        for(auto fd : connections) ::shutdown(fd, SHUT_RDWR); // wake up the readers
+    }
+    signal.notify_all();
+    for(auto &r : readers) r.join(); // each reader closes its own connection
+    for(auto &w : workers) w.join();
+    finished_readers.clear();
+    ::close(listen_fd);
+    ::close(wakeup_fd[0]);
+    ::close(wakeup_fd[1]);
+    ::unlink(socket_path);
+    listen_fd = -1;
+}
+
+void TasgridServer::stop(){
+    std::unique_lock<std::mutex> guard(lock);
+    if (!stopping && (wakeup_fd[1] >= 0)){
+        stopping = true;
+        char c = 1;
+        if (::write(wakeup_fd[1], &c, 1) != 1) ::shutdown(listen_fd, SHUT_RDWR);
+    }
+}
+
+void TasgridServer::connectionLoop(int fd){
+    TasgridServerHeader header;
+    while(socketReadAll(fd, &header, sizeof(header))){
+        std::string size_error = checkRequestSize(header);
+        if (!size_error.empty()){ // the data cannot be skipped safely, report the error and close the connection
+            socketWriteError(fd, size_error);
+            break;
+        }
+        std::unique_ptr<ServerRequest> request(new ServerRequest());
+        request->header = header;
+        try{
+            request->data.resize((size_t) (header.rows * header.cols));
+        }catch(std::bad_alloc &){
+            socketWriteError(fd, "ERROR: the server could not allocate memory for the request");
+            break;
+        }
+        if (!socketReadAll(fd, request->data.data(), request->data.size() * sizeof(double))) break;
+
+        auto future_response = request->response.get_future();
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            if (stopping) break;
+            queue.push_back(std::move(request));
+        }
+        signal.notify_one();
+
+        ServerResponse response = future_response.get();
+        bool written = socketWriteAll(fd, &response.header, sizeof(response.header));
+        if (response.header.command_or_status == 0){
+            written = written && socketWriteAll(fd, response.data.data(), response.data.size() * sizeof(double));
+        }else{
+            written = written && socketWriteAll(fd, response.message.c_str(), response.message.size());
+        }
+        if (header.command_or_status == server_shutdown) stop();
+        if (!written) break;
+    }
+
+    std::unique_lock<std::mutex> guard(lock);
+    connections.erase(std::find(connections.begin(), connections.end(), fd));
+    ::close(fd);
+    finished_readers.push_back(std::this_thread::get_id());
+}
+
+std::string TasgridServer::checkRequestSize(const TasgridServerHeader &header){
+    // the sizes come from the client, check in 64-bit arithmetic before allocating, the content is checked later by processRequest()
+    if ((header.rows < 0) || (header.cols < 0)) return "ERROR: request with negative size";
+    if ((header.cols > 0) && (header.rows > server_max_request_doubles / header.cols)) return "ERROR: request data exceeds the maximum size accepted by the server";
+    return std::string();
+}
+
+TasgridClient::TasgridClient(const char *socket_path){
+    sockaddr_un addr;
+    setSocketAddress(socket_path, addr);
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) throw std::runtime_error("ERROR: could not create a socket");
+    if (::connect(fd, (sockaddr*) &addr, sizeof(addr)) != 0){
+        ::close(fd);
+        throw std::runtime_error(std::string("ERROR: could not connect to a tasgrid server at: ") + socket_path);
+    }
+}
+TasgridClient::~TasgridClient(){ ::close(fd); }
+
+void TasgridClient::request(int command, int grid_id, long long rows, long long cols, const double data[], std::vector<double> &result){
+    TasgridServerHeader header = {command, grid_id, rows, cols};
+    if (!socketWriteAll(fd, &header, sizeof(header)) || !socketWriteAll(fd, data, (size_t) (rows * cols) * sizeof(double)))
+        throw std::runtime_error("ERROR: lost connection to the tasgrid server");
+    if (!socketReadAll(fd, &header, sizeof(header))) throw std::runtime_error("ERROR: lost connection to the tasgrid server");
+    if (header.command_or_status != 0){
+        std::string message((size_t) header.rows, ' ');
+        if (!socketReadAll(fd, &message[0], message.size())) throw std::runtime_error("ERROR: lost connection to the tasgrid server");
+        throw std::runtime_error(message);
+    }
+    result.resize((size_t) (header.rows * header.cols));
+    if (!socketReadAll(fd, result.data(), result.size() * sizeof(double))) throw std::runtime_error("ERROR: lost connection to the tasgrid server");
+}
+#endif
+
+void TasgridServer::workerLoop(){
+    std::unique_lock<std::mutex> guard(lock);
+    while(true){
+        signal.wait(guard, [&]()->bool{ return stopping || !queue.empty(); });
+        if (queue.empty()) return; // stopping and no more work
+
+        std::vector<std::unique_ptr<ServerRequest>> batch;
+        batch.push_back(std::move(queue.front()));
+        queue.pop_front();
+        const TasgridServerHeader &first = batch.front()->header;
+        if (first.command_or_status == server_evaluate){ // merge other evaluations on the same grid
+            long long num_points = first.rows;
+            auto ir = queue.begin();
+            while((ir != queue.end()) && (batch.size() < server_max_batch_requests)){
+                const TasgridServerHeader &h = (*ir)->header;
+                if ((h.command_or_status == server_evaluate) && (h.grid_id == first.grid_id) && (h.cols == first.cols)
+                    && (num_points + h.rows <= server_max_batch_points)){
+                    num_points += h.rows;
+                    batch.push_back(std::move(*ir));
+                    ir = queue.erase(ir);
+                }else{
+                    ir++;
+                }
+            }
+        }
+
+        guard.unlock();
+        processBatch(batch);
+        guard.lock();
+    }
+}
+
+void TasgridServer::processBatch(std::vector<std::unique_ptr<ServerRequest>> &batch){
+    const TasgridServerHeader &first = batch.front()->header;
+    if ((batch.size() == 1) || (first.grid_id < 0) || (first.grid_id >= (int) grids.size())){
+        for(auto &r : batch){
+            ServerResponse response;
+            processRequest(*r, response);
+            r->response.set_value(std::move(response));
+        }
+        return;
+    }
+
+    // evaluate all points with one call, then split the result
+    TasmanianSparseGrid &grid = *grids[(size_t) first.grid_id];
+    std::vector<double> x, y;
+    for(auto &r : batch) x.insert(x.end(), r->data.begin(), r->data.end());
+    std::string message;
+    try{
+        std::lock_guard<std::mutex> grid_guard(*grid_locks[(size_t) first.grid_id]);
+        if (first.cols != grid.getNumDimensions()) throw std::invalid_argument("ERROR: evaluate called with x of incorrect number of dimensions");
+        if (grid.getNumLoaded() == 0) throw std::runtime_error("ERROR: evaluate called for a grid with no loaded values");
+        grid.evaluateBatch(x, y);
+    }catch(std::exception &e){
+        message = e.what();
+    }
+    size_t num_outputs = (size_t) grid.getNumOutputs();
+    auto iy = y.begin();
+    for(auto &r : batch){
+        ServerResponse response;
+        response.header = {0, 0, r->header.rows, (long long) num_outputs};
+        if (message.empty()){
+            response.data.insert(response.data.end(), iy, iy + (size_t) r->header.rows * num_outputs);
+            std::advance(iy, (size_t) r->header.rows * num_outputs);
+        }else{
+            response.header = {1, 0, (long long) message.size(), 0};
+            response.message = message;
+        }
+        r->response.set_value(std::move(response));
+    }
+}
+
+void TasgridServer::processRequest(const ServerRequest &request, ServerResponse &response){
+    const TasgridServerHeader &h = request.header;
+    response.header = {0, 0, 0, 0};
+    try{
+        if ((h.grid_id < 0) || (h.grid_id >= (int) grids.size())) throw std::invalid_argument("ERROR: invalid grid id");
+        TasmanianSparseGrid &grid = *grids[(size_t) h.grid_id];
+        std::lock_guard<std::mutex> grid_guard(*grid_locks[(size_t) h.grid_id]);
+        long long num_dimensions = grid.getNumDimensions(), num_outputs = grid.getNumOutputs();
+        switch(h.command_or_status){
+            case server_evaluate:
+                if (h.cols != num_dimensions) throw std::invalid_argument("ERROR: evaluate called with x of incorrect number of dimensions");
+                if (grid.getNumLoaded() == 0) throw std::runtime_error("ERROR: evaluate called for a grid with no loaded values");
+                grid.evaluateBatch(request.data, response.data);
+                response.header.rows = h.rows;
+                response.header.cols = num_outputs;
+                break;
+            case server_integrate:
+                if (grid.getNumLoaded() == 0) throw std::runtime_error("ERROR: integrate called for a grid with no loaded values");
+                grid.integrate(response.data);
+                response.header.rows = 1;
+                response.header.cols = num_outputs;
+                break;
+            case server_interweights:{
+                if (h.cols != num_dimensions) throw std::invalid_argument("ERROR: getInterpolationWeights called with x of incorrect number of dimensions");
+                size_t num_points = (size_t) grid.getNumPoints();
+                response.data.resize((size_t) h.rows * num_points);
+                for(long long i=0; i<h.rows; i++)
+                    grid.getInterpolationWeights(&request.data[(size_t) (i * num_dimensions)], &response.data[(size_t) i * num_points]);
+                response.header.rows = h.rows;
+                response.header.cols = (long long) num_points;
+                break;
+            }
+            case server_loadvalues:{
+                long long num_points = (grid.getNumNeeded() > 0) ? grid.getNumNeeded() : grid.getNumLoaded();
+                if ((h.rows != num_points) || (h.cols != num_outputs)) throw std::invalid_argument("ERROR: loadValues called with values of incorrect size");
+                grid.loadNeededPoints(request.data);
+                break;
+            }
+            case server_info:
+                response.data = {(double) num_dimensions, (double) num_outputs, (double) grid.getNumLoaded(), (double) grid.getNumNeeded()};
+                response.header.rows = 1;
+                response.header.cols = 4;
+                break;
+            case server_write:{
+                // write to a temporary file and rename it, the file never holds a partially written grid
+                const std::string &filename = filenames[(size_t) h.grid_id];
+                std::string temp_filename = filename + ".tmp";
+                bool binary = binary_formats[(size_t) h.grid_id];
+                std::ofstream ofs(temp_filename, (binary) ? (std::ios::out | std::ios::binary) : std::ios::out);
+                grid.write(ofs, binary);
+                ofs.close();
+                if (!ofs || (std::rename(temp_filename.c_str(), filename.c_str()) != 0)){
+                    std::remove(temp_filename.c_str());
+                    throw std::runtime_error(std::string("ERROR: could not write the grid to file ") + filename);
+                }
+                break;
+            }
+            case server_shutdown:
+                break;
+            default:
+                throw std::invalid_argument("ERROR: unknown server command");
+        }
+    }catch(std::exception &e){
+        response.data.clear();
+        response.message = e.what();
+        response.header = {1, 0, (long long) response.message.size(), 0};
+    }
+}
+
+void TasgridClient::evaluate(int grid_id, int num_x, const double x[], int num_dimensions, std::vector<double> &y){
+    request(server_evaluate, grid_id, num_x, num_dimensions, x, y);
+}
+void TasgridClient::integrate(int grid_id, std::vector<double> &q){ request(server_integrate, grid_id, 0, 0, nullptr, q); }
+void TasgridClient::getInterpolationWeights(int grid_id, int num_x, const double x[], int num_dimensions, std::vector<double> &weights){
+    request(server_interweights, grid_id, num_x, num_dimensions, x, weights);
+}
+void TasgridClient::loadValues(int grid_id, int num_points, int num_outputs, const double values[]){
+    std::vector<double> empty;
+    request(server_loadvalues, grid_id, num_points, num_outputs, values, empty);
+}
+void TasgridClient::getInfo(int grid_id, std::vector<double> &info){ request(server_info, grid_id, 0, 0, nullptr, info); }
+void TasgridClient::write(int grid_id){
+    std::vector<double> empty;
+    request(server_write, grid_id, 0, 0, nullptr, empty);
+}
+void TasgridClient::shutdown(){
+    std::vector<double> empty;
+    request(server_shutdown, 0, 0, 0, nullptr, empty);
+}
+
+#endif
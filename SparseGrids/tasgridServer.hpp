@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2017, Miroslav Stoyanov
+ *
+ * This file is part of
+ * Toolkit for Adaptive Stochastic Modeling And Non-Intrusive ApproximatioN: TASMANIAN
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+ *    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ * OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * UT-BATTELLE, LLC AND THE UNITED STATES GOVERNMENT MAKE NO REPRESENTATIONS AND DISCLAIM ALL WARRANTIES, BOTH EXPRESSED AND IMPLIED.
+ * THERE ARE NO EXPRESS OR IMPLIED WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, OR THAT THE USE OF THE SOFTWARE WILL NOT INFRINGE ANY PATENT,
+ * COPYRIGHT, TRADEMARK, OR OTHER PROPRIETARY RIGHTS, OR THAT THE SOFTWARE WILL ACCOMPLISH THE INTENDED RESULTS OR THAT THE SOFTWARE OR ITS USE WILL NOT RESULT IN INJURY OR DAMAGE.
+ * THE USER ASSUMES RESPONSIBILITY FOR ALL LIABILITIES, PENALTIES, FINES, CLAIMS, CAUSES OF ACTION, AND COSTS AND EXPENSES, CAUSED BY, RESULTING FROM OR ARISING OUT OF,
+ * IN WHOLE OR IN PART THE USE, STORAGE OR DISPOSAL OF THE SOFTWARE.
+ */
+
+#ifndef __TASGRID_SERVER_HPP
+#define __TASGRID_SERVER_HPP
+
+#include <deque>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <future>
+#include <condition_variable>
+
+#include "TasmanianSparseGrid.hpp"
+
+using namespace TasGrid;
+
+// Binary protocol used by "tasgrid -serve" over a local (UNIX domain) socket, all numbers use the native format of the machine.
+// Each request starts with a header of two 32-bit and two 64-bit integers: command, grid id, rows and cols,
+// followed by rows x cols doubles (row major). The grid id is the index of the grid in the order of the -gridfile options.
+// Each response starts with the same type of header: status, 0, rows and cols,
+// if status is 0 then the header is followed by rows x cols doubles with the result,
+// otherwise, rows is the length of the error message and the header is followed by the characters of the message.
+// The requests on one connection are answered in order, multiple connections are served concurrently.
+enum TypeServerRequest{
+    server_evaluate    = 1, // x is num_points by num_dimensions, returns num_points by num_outputs
+    server_integrate   = 2, // no data, returns 1 by num_outputs
+    server_interweights = 3, // x is num_x by num_dimensions, returns num_x by num_points
+    server_loadvalues  = 4, // values are num_points by num_outputs, returns 0 by 0
+    server_info        = 5, // no data, returns 1 by 4: dimensions, outputs, loaded points, needed points
+    server_write       = 6, // no data, writes the grid back to the file it was read from (same format, replaced atomically), returns 0 by 0
+    server_shutdown    = 7  // no data, stops the server after answering, returns 0 by 0
+};
+
+struct TasgridServerHeader{
+    int command_or_status;
+    int grid_id;
+    long long rows, cols;
+};
+
+// Maximum number of evaluate requests (and total number of points) merged into a single evaluateBatch() call.
+constexpr size_t server_max_batch_requests = 64;
+constexpr long long server_max_batch_points = 65536;
+// Maximum number of doubles in the data of a single request (1GB), larger requests are rejected and the connection is closed.
+constexpr long long server_max_request_doubles = 134217728;
+
+class TasgridServer{
+public:
+    TasgridServer();
+    ~TasgridServer();
+
+    // read the grid from the file (binary or ASCII, the format is kept when writing back), returns the id of the grid
+    int addGrid(const char *filename);
+    int getNumGrids() const{ return (int) grids.size(); }
+
+    // listen on the socket_path and answer requests using num_threads workers, returns after a shutdown request or stop()
+    // a stale socket at socket_path is removed, any other type of file causes an error
+    void serve(const char *socket_path, int num_threads);
+    // stop a running serve() call, can be called from any thread
+    void stop();
+
+protected:
+    struct ServerResponse{
+        TasgridServerHeader header;
+        std::vector<double> data;
+        std::string message;
+    };
+    struct ServerRequest{
+        TasgridServerHeader header;
+        std::vector<double> data;
+        std::promise<ServerResponse> response;
+    };
+
+    void connectionLoop(int fd);
+    // returns an empty string if the header describes a valid size of the data, otherwise returns the error message
+    static std::string checkRequestSize(const TasgridServerHeader &header);
+    void workerLoop();
+    void processBatch(std::vector<std::unique_ptr<ServerRequest>> &batch);
+    void processRequest(const ServerRequest &request, ServerResponse &response);
+
+private:
+    std::vector<std::unique_ptr<TasmanianSparseGrid>> grids;
+    std::vector<std::string> filenames;
+    std::vector<bool> binary_formats;
+    std::vector<std::unique_ptr<std::mutex>> grid_locks;
+
+    std::deque<std::unique_ptr<ServerRequest>> queue;
+    std::mutex lock;
+    std::condition_variable signal;
+    bool stopping;
+    int listen_fd, wakeup_fd[2];
+    std::vector<int> connections;
+    std::vector<std::thread::id> finished_readers; // readers that have closed their connection and can be joined
+};
+
+// Reference client for the protocol, used by the tests and by C++ codes that share grids with a running server.
+class TasgridClient{
+public:
+    TasgridClient(const char *socket_path);
+    ~TasgridClient();
+
+    void evaluate(int grid_id, int num_x, const double x[], int num_dimensions, std::vector<double> &y);
+    void integrate(int grid_id, std::vector<double> &q);
+    void getInterpolationWeights(int grid_id, int num_x, const double x[], int num_dimensions, std::vector<double> &weights);
+    void loadValues(int grid_id, int num_points, int num_outputs, const double values[]);
+    void getInfo(int grid_id, std::vector<double> &info);
+    void write(int grid_id);
+    void shutdown();
+
+protected:
+    void request(int command, int grid_id, long long rows, long long cols, const double data[], std::vector<double> &result);
+
+private:
+    int fd;
+};
+
+#endif
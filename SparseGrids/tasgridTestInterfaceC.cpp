@@ -35,6 +35,98 @@ extern "C"{
 #include "math.h"
 #include "TasmanianSparseGrid.h"
 
+// test the reentrant interface with caller provided buffers and workspaces
+int testInterfaceReentrantC(){
+    if (tsgGetCApiVersion() != TSG_C_API_VERSION){ printf("ERROR: mismatch in the version of the reentrant C interface\n"); return 0; }
+
+    void *grid = tsgConstructTasmanianSparseGrid();
+    double y[8];
+    if (tsgEvaluateBatchV1(grid, y, 1, y, 8, 0) != TSG_ERROR_NULL_GRID){ printf("ERROR: empty grid did not return TSG_ERROR_NULL_GRID\n"); return 0; }
+
+    tsgMakeLocalPolynomialGrid(grid, 2, 2, 4, 2, "localp", 0);
+    double a[2] = {-1.0, 1.0}, b[2] = {2.0, 3.0};
+    tsgSetDomainTransform(grid, a, b);
+    int i, j, nump = tsgGetNumPoints(grid);
+    if (tsgGetPointsV1(grid, y, 8) != TSG_ERROR_BUFFER_SIZE){ printf("ERROR: small buffer did not return TSG_ERROR_BUFFER_SIZE\n"); return 0; }
+    double *pnts = (double*) malloc(2 * nump * sizeof(double));
+    if (tsgGetPointsV1(grid, pnts, 2 * nump) != TSG_SUCCESS){ printf("ERROR: could not get the points using tsgGetPointsV1()\n"); return 0; }
+    if (tsgEvaluateBatchV1(grid, pnts, 1, y, 8, 0) != TSG_ERROR_INVALID_INPUT){ printf("ERROR: evaluate without loaded values did not return TSG_ERROR_INVALID_INPUT\n"); return 0; }
+    double *model = (double*) malloc(2 * nump * sizeof(double));
+    for(i=0; i<nump; i++){
+        model[2*i]   = exp(pnts[2*i] + pnts[2*i+1]);
+        model[2*i+1] = cos(pnts[2*i] - pnts[2*i+1]);
+    }
+    tsgLoadNeededPoints(grid, model);
+
+    int numx = 64;
+    double *x = (double*) malloc(2 * numx * sizeof(double));
+    for(i=0; i<numx; i++){
+        x[2*i]   = -1.0 + 3.0 * ((double) i) / ((double) numx);
+        x[2*i+1] =  1.0 + 2.0 * ((double) (i % 7)) / 7.0;
+    }
+    double *reference = (double*) malloc(2 * numx * sizeof(double));
+    tsgEvaluateBatch(grid, x, numx, reference);
+
+    if (tsgEvaluateBatchV1(grid, x, numx, y, 8, 0) != TSG_ERROR_BUFFER_SIZE){ printf("ERROR: small output buffer did not return TSG_ERROR_BUFFER_SIZE\n"); return 0; }
+    if (tsgEvaluateBatchV1(grid, x, -1, y, 8, 0) != TSG_ERROR_INVALID_INPUT){ printf("ERROR: negative num_x did not return TSG_ERROR_INVALID_INPUT\n"); return 0; }
+
+    // evaluate one point at a time from many threads, each thread with its own workspace
+    double *result = (double*) malloc(2 * numx * sizeof(double));
+    int num_failed = 0;
+    #pragma omp parallel
+    {
+        void *workspace = tsgCreateWorkspace();
+        #pragma omp for reduction(+:num_failed)
+        for(i=0; i<numx; i++){
+            if (tsgEvaluateBatchV1(grid, &(x[2*i]), 1, &(result[2*i]), 2, workspace) != TSG_SUCCESS) num_failed++;
+        }
+        tsgDestroyWorkspace(workspace);
+    }
+    if (num_failed > 0){ printf("ERROR: tsgEvaluateBatchV1() failed in parallel\n"); return 0; }
+    for(i=0; i<2*numx; i++) if (fabs(result[i] - reference[i]) > 1.E-14){ printf("ERROR: mismatch in tsgEvaluateBatchV1() i = %d, expected = %1.16e, actual = %1.16e\n",i,reference[i],result[i]); return 0; }
+
+    double *weights = (double*) malloc(numx * nump * sizeof(double));
+    void *workspace = tsgCreateWorkspace();
+    if (tsgGetInterpolationWeightsBatchV1(grid, x, numx, weights, numx * nump, workspace) != TSG_SUCCESS){ printf("ERROR: tsgGetInterpolationWeightsBatchV1() failed\n"); return 0; }
+    for(i=0; i<numx; i++){
+        double sum = 0.0;
+        for(j=0; j<nump; j++) sum += weights[i*nump + j] * model[2*j];
+        if (fabs(sum - reference[2*i]) > 1.E-12){ printf("ERROR: mismatch in tsgGetInterpolationWeightsBatchV1() i = %d\n",i); return 0; }
+    }
+
+    int num_nz = 0;
+    if (tsgEvaluateSparseHierarchicalFunctionsV1(grid, x, numx, 0, 0, 0, 0, 0, &num_nz) != TSG_ERROR_BUFFER_SIZE){ printf("ERROR: tsgEvaluateSparseHierarchicalFunctionsV1() did not report small buffers\n"); return 0; }
+    if (num_nz != tsgEvaluateSparseHierarchicalFunctionsGetNZ(grid, x, numx)){ printf("ERROR: tsgEvaluateSparseHierarchicalFunctionsV1() returned wrong number of non-zeros\n"); return 0; }
+    int *pntr = (int*) malloc((numx + 1) * sizeof(int));
+    int *indx = (int*) malloc(num_nz * sizeof(int));
+    double *vals = (double*) malloc(num_nz * sizeof(double));
+    if (tsgEvaluateSparseHierarchicalFunctionsV1(grid, x, numx, pntr, numx + 1, indx, vals, num_nz, &num_nz) != TSG_SUCCESS){ printf("ERROR: tsgEvaluateSparseHierarchicalFunctionsV1() failed\n"); return 0; }
+    if (tsgEvaluateHierarchicalFunctionsV1(grid, x, numx, weights, numx * nump, workspace) != TSG_SUCCESS){ printf("ERROR: tsgEvaluateHierarchicalFunctionsV1() failed\n"); return 0; }
+    for(i=0; i<numx; i++){
+        for(j=pntr[i]; j<pntr[i+1]; j++){
+            if (fabs(vals[j] - weights[i*nump + indx[j]]) > 1.E-14){ printf("ERROR: mismatch between dense and sparse hierarchical functions\n"); return 0; }
+        }
+    }
+
+    double q[2];
+    tsgIntegrate(grid, y);
+    if ((tsgIntegrateV1(grid, q, 2) != TSG_SUCCESS) || (fabs(q[0] - y[0]) > 1.E-14) || (fabs(q[1] - y[1]) > 1.E-14)){ printf("ERROR: mismatch in tsgIntegrateV1()\n"); return 0; }
+    if (tsgGetQuadratureWeightsV1(grid, weights, nump) != TSG_SUCCESS){ printf("ERROR: tsgGetQuadratureWeightsV1() failed\n"); return 0; }
+
+    tsgDestroyWorkspace(workspace);
+    free(vals);
+    free(indx);
+    free(pntr);
+    free(weights);
+    free(result);
+    free(reference);
+    free(x);
+    free(model);
+    free(pnts);
+    tsgDestructTasmanianSparseGrid(grid);
+    return 1;
+}
+
 // The bulk of the C interface is tested through the Python wrapper
 // The purpose of this function is to test the C header and the few untested functions
 int testInterfaceC(){
@@ -160,6 +252,8 @@ int testInterfaceC(){
     free(pspace);
     tsgDestructTasmanianSparseGrid(grid);
 
+    if (testInterfaceReentrantC() == 0) return 0;
+
     return 1;
 }
 
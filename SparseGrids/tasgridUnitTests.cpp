@@ -33,11 +33,17 @@
 
 #include "tasgridUnitTests.hpp"
 #include "tasgridExternalTests.hpp"
+#include "tasgridServer.hpp"
 
-GridUnitTester::GridUnitTester() : verbose(false){}
+#ifndef _WIN32
+#include <unistd.h> // getpid(), the shared memory segments of concurrent test runs need distinct names
+#endif
+
+GridUnitTester::GridUnitTester() : verbose(false), tasgrid_exe("./tasgrid"){}
 GridUnitTester::~GridUnitTester(){}
 
 void GridUnitTester::setVerbose(bool new_verbose){ verbose = new_verbose; }
+void GridUnitTester::setTasgridExecutable(const char *executable){ tasgrid_exe = executable; }
 
 bool GridUnitTester::Test(UnitTests test){
     cout << endl << endl;
@@ -49,13 +55,17 @@ bool GridUnitTester::Test(UnitTests test){
     bool testExceptions = true;
     bool testAPI = true;
     bool testC = true;
+    bool testServ = true;
+    bool testCLI = true;
 
     if ((test == unit_all) || (test == unit_cover)) testCover = testCoverUnimportant();
     if ((test == unit_all) || (test == unit_except)) testExceptions = testAllException();
     if ((test == unit_all) || (test == unit_api)) testAPI = testAPIconsistency();
     if ((test == unit_all) || (test == unit_c)) testC = testCInterface();
+    if ((test == unit_all) || (test == unit_server)) testServ = testServer();
+    if ((test == unit_all) || (test == unit_cli)) testCLI = testCommandLine();
 
-    bool pass = testCover && testExceptions && testAPI && testC;
+    bool pass = testCover && testExceptions && testAPI && testC && testServ && testCLI;
     //bool pass = true;
 
     cout << endl;
@@ -425,6 +435,208 @@ bool GridUnitTester::testAPIconsistency(){
     if (verbose) cout << setw(wfirst) << "API variation" << setw(wsecond) << "wavelet sparse basis" << setw(wthird) << ((pass) ? "Pass" : "FAIL") << endl;
     passAll = pass && passAll;
 
+    // test copy-on-write and move semantics
+    pass = true;
+    grid.makeLocalPolynomialGrid(2, 1, 4, 2, rule_localp);
+    gridLoadEN2(&grid);
+    x = {0.33, -0.44, 0.1, 0.7};
+    std::vector<double> yref, ytest;
+    grid.evaluateBatch(x, yref);
+    {
+        TasmanianSparseGrid grid_copy(grid);
+        if (grid_copy.getHierarchicalCoefficients() != grid.getHierarchicalCoefficients()) pass = false; // shared, no deep copy
+        grid_copy.setSurplusRefinement(1.E-4, refine_classic);
+        if (grid_copy.getHierarchicalCoefficients() == grid.getHierarchicalCoefficients()) pass = false; // the copy was detached
+        if ((grid.getNumNeeded() != 0) || (grid_copy.getNumNeeded() == 0)) pass = false; // the original was not modified
+        grid.evaluateBatch(x, ytest);
+        pass = pass && doesMatch(yref, ytest);
+
+        TasmanianSparseGrid grid_moved(std::move(grid_copy));
+        if (!grid_copy.empty() || (grid_moved.getNumNeeded() == 0)) pass = false;
+        grid_moved.clearRefinement();
+        grid_moved.evaluateBatch(x, ytest);
+        pass = pass && doesMatch(yref, ytest);
+
+        std::vector<TasmanianSparseGrid> grids;
+        grids.push_back(grid);
+        grids.push_back(std::move(grid_moved));
+        grids[0] = grids[1];
+        grids[1].makeSequenceGrid(2, 1, 2, type_level, rule_leja);
+        grids[0].evaluateBatch(x, ytest);
+        pass = pass && doesMatch(yref, ytest) && grids[1].isSequence() && grids[0].isLocalPolynomial();
+    }
+
+    if (verbose) cout << setw(wfirst) << "API variation" << setw(wsecond) << "copy-on-write/move" << setw(wthird) << ((pass) ? "Pass" : "FAIL") << endl;
+    passAll = pass && passAll;
+
+    // test frozen grids, evaluations must match and modifications must throw
+    pass = true;
+    for(int t=0; t<5; t++){
+        TasmanianSparseGrid fgrid;
+        if (t == 0) fgrid.makeGlobalGrid(2, 1, 5, type_iptotal, rule_clenshawcurtis);
+        if (t == 1) fgrid.makeSequenceGrid(2, 1, 5, type_iptotal, rule_leja);
+        if (t == 2) fgrid.makeLocalPolynomialGrid(2, 1, 4, 2, rule_localp);
+        if (t == 3) fgrid.makeWaveletGrid(2, 1, 3, 1);
+        if (t == 4) fgrid.makeFourierGrid(2, 1, 3, type_level);
+        gridLoadEN2(&fgrid);
+        if (t < 2) fgrid.setAnisotropicRefinement(type_iptotal, 10, 0);
+        std::vector<double> qref, qtest, wref, wtest;
+        fgrid.evaluateBatch(x, yref);
+        fgrid.integrate(qref);
+        fgrid.getQuadratureWeights(wref);
+
+        TasmanianSparseGrid fcopy = fgrid;
+        fgrid.freezeForEvaluation();
+        if (!fgrid.isFrozen() || fcopy.isFrozen() || (fgrid.getNumNeeded() != 0)) pass = false;
+        if ((t < 2) && (fcopy.getNumNeeded() == 0)) pass = false; // the copy keeps the refinement
+        fgrid.evaluateBatch(x, ytest);
+        fgrid.integrate(qtest);
+        fgrid.getQuadratureWeights(wtest);
+        pass = pass && doesMatch(yref, ytest) && doesMatch(qref, qtest) && doesMatch(wref, wtest);
+
+        try{
+            fgrid.loadNeededPoints(yref.data());
+            pass = false;
+        }catch(std::runtime_error &){}
+        try{
+            fgrid.setDomainTransform(std::vector<double>(2, -2.0), std::vector<double>(2, 2.0));
+            pass = false;
+        }catch(std::runtime_error &){}
+
+        for(int binary=0; binary<2; binary++){
+            fgrid.write("tasgridFrozenTest.grid", (binary == 1));
+            fcopy.read("tasgridFrozenTest.grid");
+            if (!fcopy.isFrozen()) pass = false;
+            fcopy.evaluateBatch(x, ytest);
+            fcopy.integrate(qtest);
+            pass = pass && doesMatch(yref, ytest) && doesMatch(qref, qtest);
+        }
+        fcopy.makeSequenceGrid(2, 1, 2, type_level, rule_leja); // making a new grid resets the frozen state
+        if (fcopy.isFrozen()) pass = false;
+    }
+    { // the conformal integrals use the loaded values, the frozen grid must keep them
+        TasmanianSparseGrid fgrid;
+        fgrid.makeLocalPolynomialGrid(2, 1, 4, 2, rule_localp);
+        std::vector<int> truncation = {4, 4};
+        fgrid.setConformalTransformASIN(truncation.data());
+        gridLoadEN2(&fgrid);
+        std::vector<double> qref, qtest;
+        fgrid.integrate(qref);
+        fgrid.freezeForEvaluation();
+        fgrid.integrate(qtest);
+        pass = pass && doesMatch(qref, qtest);
+    }
+
+    if (verbose) cout << setw(wfirst) << "API variation" << setw(wsecond) << "frozen grids" << setw(wthird) << ((pass) ? "Pass" : "FAIL") << endl;
+    passAll = pass && passAll;
+
+    #ifndef _WIN32
+    // test publishing to and attaching from shared memory
+    pass = true;
+    {
+        std::string shared_name_str = "/tasgridSharedTest" + std::to_string((long long) getpid());
+        const char *shared_name = shared_name_str.c_str();
+        TasmanianSparseGrid publisher, attached;
+        publisher.makeLocalPolynomialGrid(2, 1, 4, 2, rule_localp);
+        gridLoadEN2(&publisher);
+        publisher.evaluateBatch(x, yref);
+        publisher.publishShared(shared_name);
+        if (publisher.isFrozen()) pass = false; // publishing uses a frozen copy
+
+        attached.attachShared(shared_name);
+        if (!attached.isFrozen() || !attached.isLocalPolynomial()) pass = false;
+        attached.evaluateBatch(x, ytest);
+        pass = pass && doesMatch(yref, ytest);
+
+        for(int t=0; t<4; t++){ // republishing replaces the segment, grids attached to the old one must not be affected
+            TasmanianSparseGrid source, reattached;
+            if (t == 0) source.makeGlobalGrid(2, 1, 4, type_iptotal, rule_clenshawcurtis);
+            if (t == 1) source.makeSequenceGrid(2, 1, 4, type_iptotal, rule_leja);
+            if (t == 2) source.makeWaveletGrid(2, 1, 3, 1);
+            if (t == 3) source.makeFourierGrid(2, 1, 3, type_level);
+            gridLoadEN2(&source);
+            std::vector<double> ysource;
+            source.evaluateBatch(x, ysource);
+            source.publishShared(shared_name);
+            reattached.attachShared(shared_name);
+            reattached.evaluateBatch(x, ytest);
+            pass = pass && doesMatch(ysource, ytest);
+
+            std::vector<char> image; // writing an attached grid copies the data out of the segment
+            reattached.serialize(image);
+            source.deserialize(image);
+            source.evaluateBatch(x, ytest);
+            pass = pass && doesMatch(ysource, ytest);
+
+            attached.evaluateBatch(x, ytest);
+            pass = pass && doesMatch(yref, ytest);
+        }
+
+        TasmanianSparseGrid::unlinkShared(shared_name);
+        attached.evaluateBatch(x, ytest); // the attached grid outlives the segment
+        pass = pass && doesMatch(yref, ytest);
+        try{
+            attached.attachShared(shared_name);
+            pass = false;
+        }catch(std::runtime_error &){}
+    }
+
+    if (verbose) cout << setw(wfirst) << "API variation" << setw(wsecond) << "shared memory" << setw(wthird) << ((pass) ? "Pass" : "FAIL") << endl;
+    passAll = pass && passAll;
+    #endif
+
+    // test in-memory serialization, including a grid in the middle of dynamic construction
+    pass = true;
+    {
+        TasmanianSparseGrid source, target;
+        std::vector<char> image;
+        source.makeGlobalGrid(2, 1, 4, type_iptotal, rule_rleja);
+        gridLoadEN2(&source);
+        source.evaluateBatch(x, yref);
+        source.serialize(image);
+        target.deserialize(image);
+        target.evaluateBatch(x, ytest);
+        pass = pass && doesMatch(yref, ytest) && target.isGlobal();
+
+        std::ostringstream ascii_image;
+        source.write(ascii_image, false);
+        std::string ascii_data = ascii_image.str();
+        target.deserialize(ascii_data.c_str(), ascii_data.size());
+        target.evaluateBatch(x, ytest);
+        pass = pass && doesMatch(yref, ytest);
+
+        source.makeSequenceGrid(2, 1, 2, type_level, rule_leja);
+        gridLoadEN2(&source);
+        source.beginConstruction();
+        std::vector<double> candidates;
+        source.getCandidateConstructionPoints(type_level, candidates, std::vector<int>(2, 1));
+        source.loadConstructedPoint(&candidates[0], std::vector<double>(1, 1.0).data()); // one point, stays in the construction data
+        source.serialize(image);
+        target.deserialize(image);
+        if (!target.isUsingConstruction() || (target.getNumLoaded() != source.getNumLoaded())) pass = false;
+        std::vector<char> second_image;
+        target.serialize(second_image);
+        if (second_image != image) pass = false;
+
+        target.makeLocalPolynomialGrid(2, 1, 4, 2, rule_localp); // failed reads must not modify the target grid
+        gridLoadEN2(&target);
+        target.evaluateBatch(x, yref);
+        try{
+            target.deserialize(image.data(), image.size() / 2); // truncated image
+            pass = false;
+        }catch(std::runtime_error &){}
+        try{
+            target.deserialize(ascii_data.c_str(), ascii_data.size() / 2); // truncated ascii image
+            pass = false;
+        }catch(std::runtime_error &){}
+        if (!target.isLocalPolynomial()) pass = false;
+        target.evaluateBatch(x, ytest);
+        pass = pass && doesMatch(yref, ytest);
+    }
+
+    if (verbose) cout << setw(wfirst) << "API variation" << setw(wsecond) << "serialize/deserialize" << setw(wthird) << ((pass) ? "Pass" : "FAIL") << endl;
+    passAll = pass && passAll;
+
     // test integer-to-enumerate and string-to-enumerate conversion
     pass = true;
     std::vector<TypeAcceleration> allacc = {accel_none, accel_cpu_blas, accel_gpu_default, accel_gpu_cublas, accel_gpu_cuda, accel_gpu_magma};
@@ -450,6 +662,339 @@ bool GridUnitTester::testCInterface(){
     return pass;
 }
 
+bool GridUnitTester::testServer(){
+    int wfirst = 15, wsecond = 30, wthird = 15;
+    #ifdef _WIN32
+    cout << setw(wfirst+1) << "Grid server" << setw(wsecond-1) << "" << setw(wthird) << "Skip" << endl;
+    return true;
+    #else
+    bool pass = true;
+    const char *socket_path = "tasgridServerTest.socket";
+
+    TasmanianSparseGrid grid, pending;
+    grid.makeGlobalGrid(2, 1, 5, type_iptotal, rule_clenshawcurtis);
+    gridLoadEN2(&grid);
+    pending.makeLocalPolynomialGrid(2, 2, 3, 2, rule_localp); // no values yet, loaded through the server
+    grid.write("tasgridServerTest0.grid", true);
+    pending.write("tasgridServerTest1.grid", false); // the server must keep the format when writing back
+    auto remove_files = []()->void{
+        std::remove("tasgridServerTest0.grid");
+        std::remove("tasgridServerTest1.grid");
+        std::remove("tasgridServerTest.notsocket");
+    };
+
+    { // the server must not remove a file that is not a socket
+        std::ofstream("tasgridServerTest.notsocket") << "not a socket" << endl;
+        TasgridServer bad_path;
+        bad_path.addGrid("tasgridServerTest0.grid");
+        try{
+            bad_path.serve("tasgridServerTest.notsocket", 1);
+            cout << "ERROR: server did not reject a socket path that is a regular file" << endl;
+            pass = false;
+        }catch(std::runtime_error &){}
+        pass = pass && std::ifstream("tasgridServerTest.notsocket").good();
+    }
+
+    TasgridServer server;
+    server.addGrid("tasgridServerTest0.grid");
+    server.addGrid("tasgridServerTest1.grid");
+    std::thread server_thread([&]()->void{ server.serve(socket_path, 3); });
+
+    std::unique_ptr<TasgridClient> client;
+    for(int attempt=0; (attempt < 500) && !client; attempt++){ // wait for the server to start listening
+        try{
+            client = std::unique_ptr<TasgridClient>(new TasgridClient(socket_path));
+        }catch(std::runtime_error &){
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    if (!client){
+        cout << "ERROR: could not connect to the tasgrid server" << endl;
+        server.stop();
+        server_thread.join();
+        remove_files();
+        return false;
+    }
+
+    std::vector<double> x = {0.33, -0.2, 0.1, 0.7, -0.9, 0.0, 0.25, 0.25, -0.5, 0.6};
+    std::vector<double> y, yref;
+    client->evaluate(0, 5, x.data(), 2, y);
+    grid.evaluateBatch(x, yref);
+    pass = pass && doesMatch(y, yref);
+
+    client->integrate(0, y);
+    grid.integrate(yref);
+    pass = pass && doesMatch(y, yref);
+
+    client->getInterpolationWeights(0, 5, x.data(), 2, y);
+    yref.resize(5 * (size_t) grid.getNumPoints());
+    for(size_t i=0; i<5; i++) grid.getInterpolationWeights(&x[2*i], &yref[i * (size_t) grid.getNumPoints()]);
+    pass = pass && doesMatch(y, yref);
+
+    try{ // wrong number of dimensions, the connection should survive the error
+        client->evaluate(0, 2, x.data(), 5, y);
+        cout << "ERROR: server did not report invalid dimensions" << endl;
+        pass = false;
+    }catch(std::runtime_error &){}
+
+    std::vector<double> info;
+    client->getInfo(1, info);
+    pass = pass && (info.size() == 4) && (info[0] == 2.0) && (info[1] == 2.0) && (info[2] == 0.0) && (info[3] == (double) pending.getNumNeeded());
+
+    std::vector<double> points, values;
+    pending.getNeededPoints(points);
+    for(size_t i=0; i<points.size() / 2; i++){
+        values.push_back(exp(points[2*i] + points[2*i+1]));
+        values.push_back(points[2*i] * points[2*i+1]);
+    }
+    client->loadValues(1, pending.getNumNeeded(), 2, values.data());
+    pending.loadNeededPoints(values);
+    client->evaluate(1, 5, x.data(), 2, y);
+    pending.evaluateBatch(x, yref);
+    pass = pass && doesMatch(y, yref);
+
+    // write back both grids, the formats are kept and no temporary files are left behind
+    client->write(0);
+    client->write(1);
+    auto is_binary = [](const char *filename)->bool{
+        char tsg[3] = {'A', 'A', 'A'};
+        std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+        ifs.read(tsg, 3);
+        return ((tsg[0] == 'T') && (tsg[1] == 'S') && (tsg[2] == 'G'));
+    };
+    pass = pass && is_binary("tasgridServerTest0.grid") && !is_binary("tasgridServerTest1.grid")
+                && !std::ifstream("tasgridServerTest0.grid.tmp").good() && !std::ifstream("tasgridServerTest1.grid.tmp").good();
+    TasmanianSparseGrid written;
+    written.read("tasgridServerTest1.grid");
+    written.evaluateBatch(x, y);
+    pass = pass && doesMatch(y, yref);
+
+    if (verbose) cout << setw(wfirst) << "Grid server" << setw(wsecond) << "single client" << setw(wthird) << ((pass) ? "Pass" : "FAIL") << endl;
+
+    // several clients at once, concurrent evaluations are merged into batches
+    std::vector<int> num_failed(4, 0);
+    std::vector<std::thread> clients;
+    for(int c=0; c<4; c++){
+        clients.emplace_back([&, c]()->void{
+            TasgridClient local_client(socket_path);
+            TasmanianSparseGrid &reference = (c % 2 == 0) ? grid : pending;
+            std::vector<double> local_x(2 * 7), local_y, local_ref;
+            for(int i=0; i<20; i++){
+                for(size_t j=0; j<local_x.size(); j++) local_x[j] = -1.0 + 2.0 * (double) ((c * 131 + i * 17 + (int) j * 7) % 97) / 96.0;
+                local_client.evaluate(c % 2, 7, local_x.data(), 2, local_y);
+                reference.evaluateBatch(local_x, local_ref);
+                if (!doesMatch(local_y, local_ref)) num_failed[c]++;
+            }
+        });
+    }
+    for(auto &t : clients) t.join();
+    bool pass_concurrent = true;
+    for(auto f : num_failed) if (f != 0) pass_concurrent = false;
+
+    if (verbose) cout << setw(wfirst) << "Grid server" << setw(wsecond) << "concurrent clients" << setw(wthird) << ((pass_concurrent) ? "Pass" : "FAIL") << endl;
+
+    client->shutdown();
+    server_thread.join();
+    client.reset();
+    remove_files();
+
+    pass = pass && pass_concurrent;
+    cout << setw(wfirst+1) << "Grid server" << setw(wsecond-1) << "" << setw(wthird) << ((pass) ? "Pass" : "FAIL") << endl;
+    return pass;
+    #endif
+}
+
+bool GridUnitTester::runTasgrid(const std::string &args) const{
+    std::string command = "\"" + tasgrid_exe + "\" " + args;
+    if (!verbose) command += " > tasgridCLITest.log 2>&1";
+    return (std::system(command.c_str()) == 0);
+}
+
+std::vector<double> GridUnitTester::readMatrixFile(const char *filename, int &rows, int &cols){
+    std::vector<double> mat;
+    rows = 0;
+    cols = 0;
+    std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+    char tsg[3] = {'A', 'A', 'A'};
+    ifs.read(tsg, 3);
+    if (!ifs) return mat;
+    if ((tsg[0] == 'T') && (tsg[1] == 'S') && (tsg[2] == 'G')){
+        ifs.read((char*) &rows, sizeof(int));
+        ifs.read((char*) &cols, sizeof(int));
+        mat.resize((size_t) rows * (size_t) cols);
+        ifs.read((char*) mat.data(), mat.size() * sizeof(double));
+    }else{
+        ifs.close();
+        ifs.open(filename);
+        ifs >> rows >> cols;
+        mat.resize((size_t) rows * (size_t) cols);
+        for(auto &m : mat) ifs >> m;
+    }
+    if (!ifs) mat.clear();
+    return mat;
+}
+
+bool GridUnitTester::testCommandLine(){
+    int wfirst = 15, wsecond = 30, wthird = 15;
+    if (!std::ifstream(tasgrid_exe).good()){ // gridtest called from a folder without tasgrid, use the -tasgrid option
+        cout << setw(wfirst+1) << "Command line" << setw(wsecond-1) << "" << setw(wthird) << "Skip" << endl;
+        return true;
+    }
+
+    bool pass = testScript();
+    pass = testChunkedEvaluations() && pass;
+    std::remove("tasgridCLITest.log");
+
+    cout << setw(wfirst+1) << "Command line" << setw(wsecond-1) << "" << setw(wthird) << ((pass) ? "Pass" : "FAIL") << endl;
+    return pass;
+}
+
+bool GridUnitTester::testScript(){
+    int wfirst = 15, wsecond = 30, wthird = 15;
+    bool pass = true;
+    // the name of the first grid has a space and must be quoted in the script
+    const char *gridname = "tasgridCLITest grid.grid";
+    const std::vector<const char*> files = {gridname, "tasgridCLITestValues.matrix", "tasgridCLITestPoints.matrix", "tasgridCLITest.script",
+                                            "tasgridCLITestEval.matrix", "tasgridCLITestNew.grid", "tasgridCLITestQuad.matrix", "tasgridCLITestBad.script"};
+
+    TasmanianSparseGrid grid;
+    grid.makeGlobalGrid(2, 1, 4, type_iptotal, rule_clenshawcurtis);
+    grid.write(gridname, true); // the file has no values, the values are loaded by the script
+    std::vector<double> points;
+    grid.getNeededPoints(points);
+    std::ofstream vals("tasgridCLITestValues.matrix");
+    vals << grid.getNumNeeded() << " 1" << endl;
+    vals.precision(17);
+    for(size_t i=0; i<points.size() / 2; i++) vals << std::scientific << exp(-points[2*i] * points[2*i] - points[2*i+1]) << endl;
+    vals.close();
+    std::vector<double> values; // the reference grid has the same values
+    for(size_t i=0; i<points.size() / 2; i++) values.push_back(exp(-points[2*i] * points[2*i] - points[2*i+1]));
+    grid.loadNeededPoints(values);
+
+    std::vector<double> x = {0.33, -0.2, 0.1, 0.7, -0.9, 0.0, 0.25, 0.25, -0.5, 0.6};
+    std::ofstream xfile("tasgridCLITestPoints.matrix");
+    xfile << "5 2" << endl;
+    xfile.precision(17);
+    for(size_t i=0; i<5; i++) xfile << std::scientific << x[2*i] << " " << x[2*i+1] << endl;
+    xfile.close();
+
+    // loadvalues changes the grid in memory and the evaluate must use the values without reading the file again,
+    // the grid made by the script is never written to a file and the loaded grid is written back only by -write
+    std::ofstream script("tasgridCLITest.script");
+    script << "# comments and empty lines are ignored" << endl << endl;
+    script << "   # -makeglobal -dimensions 2 -outputs 1 -depth 1 -type level -onedim clenshaw-curtis -gridfile \"" << gridname << "\"" << endl;
+    script << "-loadvalues -gridfile \"" << gridname << "\" -valsfile tasgridCLITestValues.matrix" << endl;
+    script << "-evaluate   -gridfile \"" << gridname << "\" -xfile tasgridCLITestPoints.matrix -outputfile tasgridCLITestEval.matrix" << endl;
+    script << "-makeglobal -dimensions 2 -outputs 0 -depth 3 -type level -onedim clenshaw-curtis -gridfile tasgridCLITestNew.grid" << endl;
+    script << "-getquadrature -gridfile tasgridCLITestNew.grid -outputfile tasgridCLITestQuad.matrix -ascii" << endl;
+    script << "-write -gridfile \"" << gridname << "\"" << endl;
+    script.close();
+
+    pass = runTasgrid("-script tasgridCLITest.script");
+
+    int rows, cols;
+    std::vector<double> result = readMatrixFile("tasgridCLITestEval.matrix", rows, cols), reference;
+    grid.evaluateBatch(x, reference);
+    pass = pass && (rows == 5) && (cols == 1) && doesMatch(result, reference);
+
+    TasmanianSparseGrid quad;
+    quad.makeGlobalGrid(2, 0, 3, type_level, rule_clenshawcurtis);
+    std::vector<double> quad_points, quad_weights;
+    quad.getPoints(quad_points);
+    quad.getQuadratureWeights(quad_weights);
+    result = readMatrixFile("tasgridCLITestQuad.matrix", rows, cols);
+    reference.clear();
+    for(size_t i=0; i<quad_weights.size(); i++){
+        reference.push_back(quad_weights[i]);
+        reference.push_back(quad_points[2*i]);
+        reference.push_back(quad_points[2*i+1]);
+    }
+    pass = pass && (rows == quad.getNumPoints()) && (cols == 3) && doesMatch(result, reference);
+
+    pass = pass && !std::ifstream("tasgridCLITestNew.grid").good(); // never written
+
+    TasmanianSparseGrid written; // the -write must store the values loaded by the script
+    written.read(gridname);
+    written.evaluateBatch(x, result);
+    grid.evaluateBatch(x, reference);
+    pass = pass && (written.getNumLoaded() == grid.getNumPoints()) && doesMatch(result, reference);
+
+    // a failing command must stop the script and report an error
+    script.open("tasgridCLITestBad.script");
+    script << "-makeglobal -dimensions 2 -outputs 1 -depth 2 -type level -onedim clenshaw-curtis -gridfile tasgridCLITestNew.grid" << endl;
+    script << "-evaluate -gridfile tasgridCLITestNew.grid -xfile tasgridCLITestMissing.matrix -outputfile tasgridCLITestEval.matrix" << endl;
+    script.close();
+    pass = pass && !runTasgrid("-script tasgridCLITestBad.script") && !runTasgrid("-script tasgridCLITestMissing.script");
+
+    for(auto f : files) std::remove(f);
+
+    if (verbose) cout << setw(wfirst) << "Command line" << setw(wsecond) << "script" << setw(wthird) << ((pass) ? "Pass" : "FAIL") << endl;
+    return pass;
+}
+
+bool GridUnitTester::testChunkedEvaluations(){
+    int wfirst = 15, wsecond = 30, wthird = 15;
+    bool pass = true;
+    const std::vector<const char*> files = {"tasgridCLITestChunk.grid", "tasgridCLITestX.matrix", "tasgridCLITestXa.matrix",
+                                            "tasgridCLITestFull.matrix", "tasgridCLITestChunk.matrix"};
+
+    TasmanianSparseGrid grid;
+    grid.makeLocalPolynomialGrid(2, 2, 4, 2, rule_localp);
+    gridLoadEN2(&grid);
+    grid.write("tasgridCLITestChunk.grid", true);
+
+    // 23 points in chunks of 5, the last chunk is partial, the points are given in both binary and ASCII format
+    int num_x = 23;
+    std::vector<double> x(2 * (size_t) num_x);
+    for(size_t i=0; i<x.size(); i++) x[i] = -1.0 + 2.0 * (double) ((i * 37 + 11) % 101) / 100.0;
+    std::ofstream ofs("tasgridCLITestX.matrix", std::ios::out | std::ios::binary);
+    int dims[2] = {num_x, 2};
+    ofs.write("TSG", 3);
+    ofs.write((char*) dims, 2 * sizeof(int));
+    ofs.write((char*) x.data(), x.size() * sizeof(double));
+    ofs.close();
+    ofs.open("tasgridCLITestXa.matrix");
+    ofs << num_x << " 2" << endl;
+    ofs.precision(17);
+    for(int i=0; i<num_x; i++) ofs << std::scientific << x[2*i] << " " << x[2*i+1] << endl;
+    ofs.close();
+
+    auto read_bytes = [](const char *filename)->std::string{
+        std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    };
+
+    // the dense outputs must match the library and the output without -chunk (binary, or ASCII that ignores -chunk)
+    std::vector<double> reference;
+    grid.evaluateBatch(x, reference);
+    for(auto xfile : {"tasgridCLITestX.matrix", "tasgridCLITestXa.matrix"}){
+        for(auto format : {"", " -ascii"}){
+            std::string common = std::string(" -gridfile tasgridCLITestChunk.grid -xfile ") + xfile + format;
+            bool pass_run = runTasgrid("-evaluate" + common + " -outputfile tasgridCLITestFull.matrix")
+                         && runTasgrid("-evaluate" + common + " -outputfile tasgridCLITestChunk.matrix -chunk 5");
+            int rows_full, cols_full, rows_chunk, cols_chunk;
+            std::vector<double> full = readMatrixFile("tasgridCLITestFull.matrix", rows_full, cols_full);
+            std::vector<double> chunked = readMatrixFile("tasgridCLITestChunk.matrix", rows_chunk, cols_chunk);
+            pass = pass && pass_run && (rows_full == num_x) && (cols_full == 2) && (rows_chunk == num_x) && (cols_chunk == 2)
+                        && doesMatch(full, reference) && doesMatch(chunked, full);
+        }
+    }
+
+    // the other streaming commands, the binary files must be identical
+    for(auto command : {"-getinterweights", "-evalhierarchyd", "-evalhierarchys"}){
+        std::string common = std::string(command) + " -gridfile tasgridCLITestChunk.grid -xfile tasgridCLITestX.matrix";
+        bool pass_run = runTasgrid(common + " -outputfile tasgridCLITestFull.matrix")
+                     && runTasgrid(common + " -outputfile tasgridCLITestChunk.matrix -chunk 5");
+        std::string full = read_bytes("tasgridCLITestFull.matrix");
+        pass = pass && pass_run && !full.empty() && (full == read_bytes("tasgridCLITestChunk.matrix"));
+    }
+
+    for(auto f : files) std::remove(f);
+
+    if (verbose) cout << setw(wfirst) << "Command line" << setw(wsecond) << "chunked evaluations" << setw(wthird) << ((pass) ? "Pass" : "FAIL") << endl;
+    return pass;
+}
+
 bool GridUnitTester::testCoverUnimportant(){
     // some code is hard/impractical to test automatically, but untested code shows in coverage reports
     // this function gives coverage to such special cases to avoid confusion in the report
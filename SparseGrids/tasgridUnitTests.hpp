@@ -35,10 +35,13 @@
 #include <cstdio>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <iomanip>
+#include <iterator>
 #include <string.h>
 #include <math.h>
+#include <chrono>
 
 #include "TasmanianSparseGrid.hpp"
 
@@ -51,7 +54,7 @@ using std::setw;
 using namespace TasGrid;
 
 enum UnitTests{
-    unit_none, unit_all, unit_cover, unit_except, unit_api, unit_c
+    unit_none, unit_all, unit_cover, unit_except, unit_api, unit_c, unit_server, unit_cli
 };
 
 class GridUnitTester{
@@ -60,12 +63,15 @@ public:
     ~GridUnitTester();
 
     void setVerbose(bool new_verbose);
+    void setTasgridExecutable(const char *executable); // used by the command line tests, defaults to ./tasgrid
 
     bool Test(UnitTests test);
 
     bool testAllException();
     bool testAPIconsistency();
     bool testCInterface();
+    bool testServer();
+    bool testCommandLine();
     bool testCoverUnimportant();
 
 protected:
@@ -79,8 +85,17 @@ protected:
     bool doesMatch(const std::vector<int> &a, const int b[]) const;
     bool doesMatch(size_t n, double a[], const double b[], double prec = 1.E-12) const;
 
+    // run the tasgrid executable with the given arguments, returns true if the exit code is zero
+    bool runTasgrid(const std::string &args) const;
+    // read a matrix written by tasgrid in either ASCII or binary format, returns an empty vector on failure
+    static std::vector<double> readMatrixFile(const char *filename, int &rows, int &cols);
+
+    bool testScript();
+    bool testChunkedEvaluations();
+
 private:
     bool verbose;
+    std::string tasgrid_exe;
 };
 
 extern "C" int testInterfaceC();
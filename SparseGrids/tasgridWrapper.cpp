@@ -33,13 +33,14 @@
 
 #include "tasgridWrapper.hpp"
 
-TasgridWrapper::TasgridWrapper() : command(command_none), num_dimensions(0), num_outputs(-1), depth(-1), order(1),
+TasgridWrapper::TasgridWrapper(TasmanianSparseGrid *in_memory_grid) : grid((in_memory_grid != nullptr) ? *in_memory_grid : own_grid),
+    in_memory(in_memory_grid != nullptr), command(command_none), num_dimensions(0), num_outputs(-1), depth(-1), order(1),
     depth_type(type_none), rule(rule_none),
     conformal(conformal_none), alpha(0.0), beta(0.0), set_alpha(false), set_beta(false), tolerance(0.0), set_tolerance(false),
     ref_output(-1), min_growth(-1), tref(refine_fds), set_tref(false),
     gridfilename(0), outfilename(0), valsfilename(0), xfilename(0), anisofilename(0), transformfilename(0), conformalfilename(0), customfilename(0),
     levellimitfilename(0),
-    printCout(false), useASCII(false), set_gpuid(-1)
+    printCout(false), useASCII(false), set_gpuid(-1), chunk_size(0)
 {}
 TasgridWrapper::~TasgridWrapper(){}
 
@@ -55,6 +56,23 @@ bool TasgridWrapper::isCreateCommand(TypeCommand com){
     return ( (com == command_makeglobal) || (com == command_makesequence) || (com == command_makelocalp) || (com == command_makewavelet) || (com == command_makefourier) || (com == command_makequadrature) );
 }
 
+const char* TasgridWrapper::getGridFilename() const{ return gridfilename; }
+bool TasgridWrapper::isModifyingGrid() const{
+    return (isCreateCommand(command) || (command == command_update) || (command == command_setconformal) || (command == command_loadvalues)
+            || (command == command_refine_surp) || (command == command_refine_aniso) || (command == command_refine)
+            || (command == command_refine_clear) || (command == command_refine_merge) || (command == command_setcoefficients)
+            || ((command == command_evaluate) && (set_gpuid > -1))); // evaluate can change the acceleration
+}
+void TasgridWrapper::getFileDependencies(std::vector<std::string> &inputs, std::vector<std::string> &outputs) const{
+    inputs.clear();
+    outputs.clear();
+    for(auto f : {valsfilename, xfilename, anisofilename, transformfilename, conformalfilename, customfilename, levellimitfilename})
+        if (f != 0) inputs.push_back(f);
+    if (outfilename != 0) outputs.push_back(outfilename);
+    if ((command == command_write) && (outfilename == 0)) outputs.push_back(gridfilename);
+    if (printCout || (command == command_summary)) outputs.push_back(""); // the empty name stands for the console
+}
+
 void TasgridWrapper::setCommand(TypeCommand com){ command = com; }
 TypeCommand TasgridWrapper::getCommand() const{ return command; }
 void TasgridWrapper::setNumDimensions(int dim){ num_dimensions = dim; }
@@ -83,6 +101,7 @@ void TasgridWrapper::setLevelLimitsFilename(const char *filename){ levellimitfil
 void TasgridWrapper::setPrintPoints(bool pp){ printCout = pp; }
 void TasgridWrapper::setUseASCII(bool ascii){ useASCII = ascii; }
 void TasgridWrapper::setGPID(int gpuid){ set_gpuid = gpuid; }
+void TasgridWrapper::setChunkSize(int size){ chunk_size = size; }
 
 bool TasgridWrapper::checkSane() const{
     bool pass = true;
@@ -274,6 +293,11 @@ bool TasgridWrapper::checkSane() const{
         if (gridfilename == 0){ cerr << "ERROR: must specify valid -gridfile" << endl; pass = false; }
     }else if (command == command_getcoefficients){
         if (gridfilename == 0){ cerr << "ERROR: must specify valid -gridfile" << endl; pass = false; }
+    }else if (command == command_write){
+        if (gridfilename == 0){ cerr << "ERROR: must specify valid -gridfile" << endl; pass = false; }
+    }
+    if ((chunk_size > 0) && !isStreaming()){
+        cerr << "WARNING: ignoring -chunk, streaming works with -evaluate, -getinterweights, -evalhierarchyd, -evalhierarchys and a binary -outputfile without -print" << endl;
     }
 
     return pass;
@@ -390,8 +414,9 @@ bool TasgridWrapper::updateGrid(){
     }
     return true;
 }
-void TasgridWrapper::writeGrid() const{ grid.write(gridfilename, !useASCII); }
+void TasgridWrapper::writeGrid() const{ if (!in_memory) grid.write(gridfilename, !useASCII); }
 bool TasgridWrapper::readGrid(){
+    if (in_memory) return true;
     try{
         grid.read(gridfilename);
         return true;
@@ -513,6 +538,7 @@ bool TasgridWrapper::loadValues(){
     return true;
 }
 bool TasgridWrapper::getInterWeights(){
+    if (isStreaming()) return streamEvaluations();
     size_t rows, cols;
     double *x = 0, *res;
     readMatrix(xfilename, rows, cols, x);
@@ -551,6 +577,7 @@ bool TasgridWrapper::getEvaluate(){
         cerr << "ERROR: no outputs set for the grid, nothing to evaluate!" << endl;
         return false;
     }
+    if (isStreaming()) return streamEvaluations();
     size_t rows, cols;
     double *x = 0, *res;
     readMatrix(xfilename, rows, cols, x);
@@ -565,15 +592,7 @@ bool TasgridWrapper::getEvaluate(){
     int num_out = grid.getNumOutputs();
     res = new double[((size_t) num_out) * rows];
 
-    if (set_gpuid > -1){
-        if (set_gpuid < grid.getNumGPUs()){
-            grid.enableAcceleration(accel_gpu_cuda);
-            grid.setGPUID(set_gpuid);
-        }else{
-            cerr << "WARNING: invalud GPU specified " << set_gpuid << endl;
-        }
-    }
-
+    setGPUAcceleration();
     grid.evaluateBatch(x, (int) rows, res);
 
     if (outfilename != 0){
@@ -812,6 +831,7 @@ bool TasgridWrapper::getSurpluses(){
 }
 
 bool TasgridWrapper::getEvalHierarchyDense(){
+    if (isStreaming()) return streamEvaluations();
     size_t rows, cols;
     double *x = 0, *res;
     readMatrix(xfilename, rows, cols, x);
@@ -837,6 +857,7 @@ bool TasgridWrapper::getEvalHierarchyDense(){
     return true;
 }
 bool TasgridWrapper::getEvalHierarchySparse(){
+    if (isStreaming()) return streamEvaluations();
     size_t rows, cols;
     double *x = 0;
     readMatrix(xfilename, rows, cols, x);
@@ -910,6 +931,165 @@ bool TasgridWrapper::getEvalHierarchySparse(){
     delete[] x;
     return true;
 }
+bool TasgridWrapper::isStreaming() const{
+    return ((chunk_size > 0) && (outfilename != 0) && !useASCII && !printCout
+            && ((command == command_evaluate) || (command == command_getinterweights)
+                || (command == command_evalhierarchical_dense) || (command == command_evalhierarchical_sparse)));
+}
+void TasgridWrapper::setGPUAcceleration(){
+    if (set_gpuid > -1){
+        if (set_gpuid < grid.getNumGPUs()){
+            grid.enableAcceleration(accel_gpu_cuda);
+            grid.setGPUID(set_gpuid);
+        }else{
+            cerr << "WARNING: invalud GPU specified " << set_gpuid << endl;
+        }
+    }
+}
+bool TasgridWrapper::streamEvaluations(){
+    std::ifstream ifs;
+    size_t rows, cols;
+    bool binary;
+    if (!openMatrix(xfilename, ifs, rows, cols, binary)) return false;
+    if (cols != (size_t) grid.getNumDimensions()){
+        cerr << "ERROR: grid is set for " << grid.getNumDimensions() << " dimensions, but " << xfilename << " specifies " << cols << endl;
+        return false;
+    }
+    if (rows < 1){
+        cerr << "ERROR: no points specified in " << xfilename << endl;
+        return false;
+    }
+    if (command == command_evaluate) setGPUAcceleration();
+
+    bool sparse = (command == command_evalhierarchical_sparse);
+    size_t num_points = (size_t) grid.getNumPoints();
+    size_t num_real = (grid.isFourier()) ? 2 : 1; // the Fourier basis is complex
+    size_t out_cols = (command == command_evaluate) ? (size_t) grid.getNumOutputs() : num_points;
+    if (command == command_evalhierarchical_dense) out_cols *= num_real;
+    size_t chunk = (size_t) chunk_size;
+    size_t num_chunks = (rows + chunk - 1) / chunk;
+
+    // the matrix header is written first, the sparse format needs the number of non-zeros which is set at the end
+    // the sparse indexes and values are buffered in temporary files and appended after the last row pointer
+    std::ofstream ofs, ofs_indx, ofs_vals;
+    std::string indx_filename = std::string(outfilename) + ".indx", vals_filename = std::string(outfilename) + ".vals";
+    ofs.open(outfilename, std::ios::out | std::ios::binary);
+    if (!ofs.good()){
+        cerr << "ERROR: could not open file " << outfilename << " for writing" << endl;
+        return false;
+    }
+    char tsg[3] = {'T', 'S', 'G'};
+    ofs.write(tsg, 3*sizeof(char));
+    int matrix_dims[3] = {(int) rows, (int) ((sparse) ? num_points : out_cols), 0};
+    ofs.write((char*) matrix_dims, ((sparse) ? 3 : 2) * sizeof(int));
+    if (sparse){
+        ofs_indx.open(indx_filename, std::ios::out | std::ios::binary);
+        ofs_vals.open(vals_filename, std::ios::out | std::ios::binary);
+        int zero = 0;
+        ofs.write((char*) &zero, sizeof(int)); // first row pointer
+    }
+
+    // double buffered pipeline, chunk c+1 is read and chunk c-1 is written while chunk c is computed
+    std::vector<double> x[2], y[2];
+    std::vector<int> pntr[2], indx[2];
+    long long num_nz = 0;
+    bool read_failed = false, nz_overflow = false; // read_failed is set by the reading thread and checked after the future is done
+
+    auto read_chunk = [&](size_t c, int b)->void{
+        size_t n = std::min(chunk, rows - c * chunk);
+        x[b].resize(n * cols);
+        if (!readMatrixRows(ifs, binary, n, cols, x[b].data())) read_failed = true;
+    };
+    auto compute_chunk = [&](int b)->void{
+        int n = (int) (x[b].size() / cols);
+        if (command == command_evaluate){
+            y[b].resize(((size_t) n) * out_cols);
+            grid.evaluateBatch(x[b].data(), n, y[b].data());
+        }else if (command == command_getinterweights){
+            y[b].resize(((size_t) n) * out_cols);
+            #pragma omp parallel for
+            for(int i=0; i<n; i++) grid.getInterpolationWeights(&(x[b][i*cols]), &(y[b][i*out_cols]));
+        }else if (command == command_evalhierarchical_dense){
+            y[b].resize(((size_t) n) * out_cols);
+            grid.evaluateHierarchicalFunctions(x[b].data(), n, y[b].data());
+        }else{
+            int *p = 0, *ind = 0;
+            double *vals = 0;
+            grid.evaluateSparseHierarchicalFunctions(x[b].data(), n, p, ind, vals);
+            if (num_nz + p[n] > (long long) std::numeric_limits<int>::max()){ // the row pointers in the file are 32-bit
+                nz_overflow = true;
+                n = 0; // nothing is added to the output
+            }
+            pntr[b].resize((size_t) n);
+            for(int i=0; i<n; i++) pntr[b][i] = (int) (num_nz + p[i+1]);
+            indx[b] = std::vector<int>(ind, ind + p[n]);
+            y[b] = std::vector<double>(vals, vals + num_real * p[n]);
+            num_nz += p[n];
+            delete[] p;
+            delete[] ind;
+            delete[] vals;
+        }
+    };
+    auto write_chunk = [&](int b)->void{
+        if (sparse){
+            ofs.write((char*) pntr[b].data(), pntr[b].size() * sizeof(int));
+            ofs_indx.write((char*) indx[b].data(), indx[b].size() * sizeof(int));
+            ofs_vals.write((char*) y[b].data(), y[b].size() * sizeof(double));
+        }else{
+            ofs.write((char*) y[b].data(), y[b].size() * sizeof(double));
+        }
+    };
+
+    read_chunk(0, 0);
+    std::future<void> reading, writing;
+    for(size_t c=0; (c<num_chunks) && !read_failed && !nz_overflow; c++){
+        int b = (int) (c % 2);
+        if (c + 1 < num_chunks) reading = std::async(std::launch::async, read_chunk, c + 1, 1 - b);
+        compute_chunk(b);
+        if (writing.valid()) writing.get(); // chunk c-1 is written and y[1-b] can be reused
+        if (!nz_overflow) writing = std::async(std::launch::async, write_chunk, b);
+        if (reading.valid()) reading.get();
+    }
+    if (writing.valid()) writing.get();
+    if (reading.valid()) reading.get();
+    ifs.close();
+
+    bool write_failed = ofs.fail() || (sparse && (ofs_indx.fail() || ofs_vals.fail()));
+    if (read_failed || nz_overflow || write_failed){
+        if (read_failed) cerr << "ERROR: file " << xfilename << " is truncated or corrupted, expected " << rows << " by " << cols << " matrix" << endl;
+        if (nz_overflow) cerr << "ERROR: the number of non-zeros exceeds the limit of the sparse matrix format, use smaller -xf file" << endl;
+        if (write_failed) cerr << "ERROR: could not write to file " << outfilename << endl;
+        ofs.close();
+        std::remove(outfilename);
+        if (sparse){
+            ofs_indx.close();
+            ofs_vals.close();
+            std::remove(indx_filename.c_str());
+            std::remove(vals_filename.c_str());
+        }
+        return false;
+    }
+
+    if (sparse){
+        ofs_indx.close();
+        ofs_vals.close();
+        std::ifstream ifs_indx(indx_filename, std::ios::in | std::ios::binary), ifs_vals(vals_filename, std::ios::in | std::ios::binary);
+        if (num_nz > 0) ofs << ifs_indx.rdbuf() << ifs_vals.rdbuf();
+        ifs_indx.close();
+        ifs_vals.close();
+        std::remove(indx_filename.c_str());
+        std::remove(vals_filename.c_str());
+        matrix_dims[2] = (int) num_nz;
+        ofs.seekp(3*sizeof(char) + 2*sizeof(int));
+        ofs.write((char*) &(matrix_dims[2]), sizeof(int));
+    }
+    ofs.close();
+    if (ofs.fail()){
+        cerr << "ERROR: could not write to file " << outfilename << endl;
+        return false;
+    }
+    return true;
+}
 bool TasgridWrapper::setHierarchy(){
     size_t rows, cols;
     double *vals = 0;
@@ -1069,6 +1249,40 @@ void TasgridWrapper::readMatrix(const char *filename, size_t &rows_t, size_t &co
     }
     ifs.close();
 }
+bool TasgridWrapper::openMatrix(const char *filename, std::ifstream &ifs, size_t &rows, size_t &cols, bool &binary){
+    ifs.open(filename, std::ios::in | std::ios::binary);
+    if (!(ifs.good())){
+        cerr << "ERROR: could not open file " << filename << endl;
+        return false;
+    }
+    int r = 0, c = 0;
+    char tsg[3] = {'A', 'A', 'A'};
+    ifs.read(tsg, 3*sizeof(char));
+    binary = ((tsg[0] == 'T') && (tsg[1] == 'S') && (tsg[2] == 'G'));
+    if (binary){
+        ifs.read((char*) &r, sizeof(int));
+        ifs.read((char*) &c, sizeof(int));
+    }else{
+        ifs.close();
+        ifs.open(filename);
+        ifs >> r >> c;
+    }
+    if (!ifs || (r < 0) || (c < 0)){
+        cerr << "ERROR: could not read the matrix size from file " << filename << endl;
+        return false;
+    }
+    rows = (size_t) r;
+    cols = (size_t) c;
+    return true;
+}
+bool TasgridWrapper::readMatrixRows(std::ifstream &ifs, bool binary, size_t rows, size_t cols, double mat[]){
+    if (binary){
+        ifs.read((char*) mat, rows * cols * sizeof(double));
+    }else{
+        for(size_t i=0; i<rows * cols; i++) ifs >> mat[i];
+    }
+    return !ifs.fail();
+}
 void TasgridWrapper::writeMatrix(const char *filename, int rows, int cols, const double mat[], bool ascii){
     size_t rows_t = (size_t) rows;
     size_t cols_t = (size_t) cols;
@@ -1232,6 +1446,8 @@ bool TasgridWrapper::executeCommand(){
         if (!getNeededIndexes()){
             cerr << "ERROR: could not get the indexes" << endl;
         }
+    }else if (command == command_write){
+        grid.write((outfilename != 0) ? outfilename : gridfilename, !useASCII);
     }
 
     return true;
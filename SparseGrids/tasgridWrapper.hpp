@@ -39,6 +39,8 @@
 #include <iomanip>
 #include <string.h>
 #include <math.h>
+#include <future>
+#include <limits>
 
 #include "TasmanianSparseGrid.hpp"
 
@@ -89,7 +91,9 @@ enum TypeCommand{
     command_evalhierarchical_dense, // ML section
 
     command_getpointsindex,
-    command_getneededindex
+    command_getneededindex,
+
+    command_write
 };
 
 enum TypeConformalMap{
@@ -99,7 +103,8 @@ enum TypeConformalMap{
 
 class TasgridWrapper{
 public:
-    TasgridWrapper();
+    // if in_memory_grid is not null, the commands work on the given grid and never read or write -gridfile (used by -script)
+    TasgridWrapper(TasmanianSparseGrid *in_memory_grid = nullptr);
     ~TasgridWrapper();
 
     static TypeConformalMap getConfromalType(const char* name);
@@ -136,11 +141,17 @@ public:
     void setPrintPoints(bool pp);
     void setUseASCII(bool ascii);
     void setGPID(int gpuid);
+    void setChunkSize(int size);
 
     bool executeCommand();
 
     static bool isCreateCommand(TypeCommand com);
 
+    // used by -script to find the dependencies between commands
+    const char* getGridFilename() const;
+    bool isModifyingGrid() const;
+    void getFileDependencies(std::vector<std::string> &inputs, std::vector<std::string> &outputs) const;
+
 protected:
     bool checkSane() const;
 
@@ -174,6 +185,11 @@ protected:
     bool getEvalHierarchyDense();
     bool getEvalHierarchySparse();
 
+    // evaluations that read the -xfile in chunks of chunk_size rows, reading, computing and writing run concurrently
+    bool isStreaming() const;
+    bool streamEvaluations();
+    void setGPUAcceleration();
+
     bool getPoly();
 
     bool getSummary();
@@ -187,11 +203,15 @@ protected:
     int* readLevelLimits(int num_weights) const;
 
     static void readMatrix(const char *filename, size_t &rows, size_t &cols, double* &mat);
+    static bool openMatrix(const char *filename, std::ifstream &ifs, size_t &rows, size_t &cols, bool &binary);
+    static bool readMatrixRows(std::ifstream &ifs, bool binary, size_t rows, size_t cols, double mat[]);
     static void writeMatrix(const char *filename, int rows, int cols, const double mat[], bool ascii);
     static void printMatrix(int rows, int cols, const double mat[], bool isComplex = false);
 
 private:
-    TasmanianSparseGrid grid;
+    TasmanianSparseGrid own_grid;
+    TasmanianSparseGrid &grid;
+    bool in_memory;
 
     TypeCommand command;
 
@@ -223,6 +243,7 @@ private:
     bool printCout;
     bool useASCII;
     int set_gpuid;
+    int chunk_size;
 };
 
 #endif
@@ -36,10 +36,14 @@
 #include <iomanip>
 #include <string.h>
 #include <math.h>
+#include <map>
+#include <set>
+#include <cctype>
 
 #include "TasmanianSparseGrid.hpp"
 #include "tasgridExternalTests.hpp"
 #include "tasgridWrapper.hpp"
+#include "tasgridServer.hpp"
 
 using namespace std;
 using namespace TasGrid;
@@ -52,6 +56,10 @@ enum TypeHelp{
 
 void printHelp(TypeHelp ht = help_generic, TypeCommand com = command_none);
 
+bool parseCommand(int argc, const char **argv, TasgridWrapper &wrap, bool &commandHelp);
+
+bool runScript(const char *filename);
+
 int main(int argc, const char ** argv){
 
     //cout << " Phruuuuphrrr " << endl; // this is the sound that the Tasmanian devil makes
@@ -197,9 +205,66 @@ int main(int argc, const char ** argv){
         return (pass) ? 0 : 1;
     }
 
+    // keep grids in memory and answer requests over a local socket
+    if (strcmp(argv[1],"-serve") == 0){
+        TasgridServer server;
+        const char *socket_path = nullptr;
+        int num_threads = 0;
+        int k = 2;
+        try{
+            while (k < argc){
+                if ((strcmp(argv[k],"-socket") == 0) && (k+1 < argc)){
+                    socket_path = argv[++k];
+                }else if (((strcmp(argv[k],"-gridfile") == 0) || (strcmp(argv[k],"-gf") == 0)) && (k+1 < argc)){
+                    server.addGrid(argv[++k]);
+                }else if ((strcmp(argv[k],"-threads") == 0) && (k+1 < argc)){
+                    num_threads = atoi(argv[++k]);
+                }else{
+                    cerr << "ERROR: unknown or incomplete option " << argv[k] << " for -serve, see ./tasgrid -help" << endl;
+                    return 1;
+                }
+                k++;
+            }
+            if ((socket_path == nullptr) || (server.getNumGrids() == 0)){
+                cerr << "ERROR: -serve requires -socket <path> and at least one -gridfile <filename>" << endl;
+                return 1;
+            }
+            server.serve(socket_path, num_threads);
+        }catch(std::exception &e){
+            cerr << e.what() << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // run a sequence of commands on grids kept in memory
+    if (strcmp(argv[1],"-script") == 0){
+        if (argc < 3){
+            cerr << "ERROR: -script requires a file with a list of commands" << endl;
+            return 1;
+        }
+        return (runScript(argv[2])) ? 0 : 1;
+    }
+
     // doing actual work with a grid
-    // get the command
     TasgridWrapper wrap;
+    bool commandHelp = false;
+    if (!parseCommand(argc, argv, wrap, commandHelp)) return 1;
+
+    if (commandHelp){
+        printHelp(help_command, wrap.getCommand());
+        return 0;
+    }
+
+    if (!wrap.executeCommand()){
+        return 1;
+    }
+
+    return 0;
+}
+
+bool parseCommand(int argc, const char **argv, TasgridWrapper &wrap, bool &commandHelp){
+    // get the command
     if ((strcmp(argv[1],"-makeglobal") == 0) || (strcmp(argv[1],"-mg") == 0)){
         wrap.setCommand(command_makeglobal);
     }else if ((strcmp(argv[1],"-makesequence") == 0) || (strcmp(argv[1],"-ms") == 0)){
@@ -261,15 +326,17 @@ int main(int argc, const char ** argv){
         wrap.setCommand(command_getpointsindex);
     }else if (strcmp(argv[1],"-getneededindexes") == 0){
         wrap.setCommand(command_getneededindex);
+    }else if (strcmp(argv[1],"-write") == 0){
+        wrap.setCommand(command_write);
     }else{
         cout << "ERROR: unknown command " << argv[1] << endl;
         printHelp();
-        return 1;
+        return false;
     }
 
     // parse the parameters
     int k = 2;
-    bool commandHelp = false;
+    commandHelp = false;
     while(k < argc){
         if ((strcmp(argv[k],"--help") == 0)||(strcmp(argv[k],"-help") == 0)||(strcmp(argv[k],"-h") == 0)||(strcmp(argv[k],"help") == 0)){
             commandHelp = true;
@@ -288,35 +355,35 @@ int main(int argc, const char ** argv){
             }else{
                 cerr << "WARNING: -inputfile is a deprecated, see ./tasgrid -help for correct use in the future" << endl;
                 cerr << "ERROR: must provide input filename!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-xf") == 0)||(strcmp(argv[k],"-xfile") == 0)){
             if (k+1 < argc){
                 wrap.setXFilename(argv[++k]);
             }else{
                 cerr << "ERROR: must provide file name with x values!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-vf") == 0)||(strcmp(argv[k],"-valsfile") == 0)){
             if (k+1 < argc){
                 wrap.setValsFilename(argv[++k]);
             }else{
                 cerr << "ERROR: must provide values file name!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-of") == 0)||(strcmp(argv[k],"-outputfile") == 0)){
             if (k+1 < argc){
                 wrap.setOutFilename(argv[++k]);
             }else{
                 cerr << "ERROR: must provide output file name!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-gf") == 0)||(strcmp(argv[k],"-gridfile") == 0)){
             if (k+1 < argc){
                 wrap.setGridFilename(argv[++k]);
             }else{
                 cerr << "ERROR: must provide grid file name!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if (strcmp(argv[k],"-ascii") == 0){
             wrap.setUseASCII(true);
@@ -325,35 +392,35 @@ int main(int argc, const char ** argv){
                 wrap.setAnisoFilename(argv[++k]);
             }else{
                 cerr << "ERROR: must provide anisotropy file name!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-tf") == 0)||(strcmp(argv[k],"-transformfile") == 0)){
             if (k+1 < argc){
                 wrap.setTransformFilename(argv[++k]);
             }else{
                 cerr << "ERROR: must provide transform file name!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if (strcmp(argv[k],"-conformalfile") == 0){
             if (k+1 < argc){
                 wrap.setConformalFilename(argv[++k]);
             }else{
                 cerr << "ERROR: must provide conformal transform file name!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-levellimitsfile") == 0) || (strcmp(argv[k],"-lf") == 0)){
             if (k+1 < argc){
                 wrap.setLevelLimitsFilename(argv[++k]);
             }else{
                 cerr << "ERROR: must provide conformal transform file name!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-cf") == 0)||(strcmp(argv[k],"-customfile") == 0)){
             if (k+1 < argc){
                 wrap.setCustomFilename(argv[++k]);
             }else{
                 cerr << "ERROR: must provide custom file name!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-p") == 0)||(strcmp(argv[k],"-print") == 0)){
             wrap.setPrintPoints(true);
@@ -362,36 +429,36 @@ int main(int argc, const char ** argv){
                 int n = atoi(argv[++k]);
                 if (n < 1){
                     cerr << "ERROR: -dimensions takes a positive integer" << endl << endl;
-                    return 1;
+                    return false;
                 }
                 wrap.setNumDimensions(n);
             }else{
                 cerr << "ERROR: must provide number of dimensions!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-out") == 0)||(strcmp(argv[k],"-outputs") == 0)){
             if (k+1 < argc){
                 int n = atoi(argv[++k]);
                 if (n < 0){
                     cerr << "ERROR: -outputs takes a non-negative integer" << endl << endl;
-                    return 1;
+                    return false;
                 }
                 wrap.setNumOutputs(n);
             }else{
                 cerr << "ERROR: must provide number of outputs!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-dt") == 0)||(strcmp(argv[k],"-depth") == 0)){
             if (k+1 < argc){
                 int n = atoi(argv[++k]);
                 if (n < 0){
                     cerr << "ERROR: -depth takes a non-negative integer" << endl << endl;
-                    return 1;
+                    return false;
                 }
                 wrap.setNumDepth(n);
             }else{
                 cerr << "ERROR: must provide valid depth!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-tt") == 0)||(strcmp(argv[k],"-type") == 0)){
             if (k+1 < argc){
@@ -399,12 +466,12 @@ int main(int argc, const char ** argv){
                 TypeDepth d = OneDimensionalMeta::getIOTypeString(argv[k]);
                 if (d == type_none){
                     cerr << "ERROR: " << argv[k] << " is not a valid type!!!  For help see: ./tasgrid -help" << endl << endl;
-                    return 1;
+                    return false;
                 }
                 wrap.setDepthType(d);
             }else{
                 cerr << "ERROR: must provide valid -type!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-ct") == 0)||(strcmp(argv[k],"-conformaltype") == 0)){
             if (k+1 < argc){
@@ -412,12 +479,12 @@ int main(int argc, const char ** argv){
                 TypeConformalMap c = TasgridWrapper::getConfromalType(argv[k]);
                 if (c == conformal_none){
                     cerr << "ERROR: " << argv[k] << " is not a valid type!!!  For help see: ./tasgrid -help" << endl << endl;
-                    return 1;
+                    return false;
                 }
                 wrap.setConformalType(c);
             }else{
                 cerr << "ERROR: must provide valid -conformaltype!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-onedim") == 0)||(strcmp(argv[k],"-1d") == 0)){
             if (k+1 < argc){
@@ -425,12 +492,12 @@ int main(int argc, const char ** argv){
                 TypeOneDRule r = OneDimensionalMeta::getIORuleString(argv[k]);
                 if (r == rule_none){
                     cerr << "ERROR: unrecognized rule: " << argv[k] << endl << endl;
-                    return 1;
+                    return false;
                 }
                 wrap.setRule(r);
             }else{
                 cerr << "ERROR: must provide valid -onedim!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-order") == 0)||(strcmp(argv[k],"-or") == 0)){
             if (k+1 < argc){
@@ -438,12 +505,12 @@ int main(int argc, const char ** argv){
                 int n = atoi(argv[k]);
                 if (n < -1){
                     cerr << "ERROR: invalid order: " << n << "  order should be at least -1" << endl << endl;
-                    return 1;
+                    return false;
                 }
                 wrap.setOrder(n);
             }else{
                 cerr << "ERROR: must provide valid -order!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if (strcmp(argv[k],"-alpha") == 0){
             if (k+1 < argc){
@@ -452,7 +519,7 @@ int main(int argc, const char ** argv){
                 wrap.setAlpha(alpha);
             }else{
                 cerr << "ERROR: must provide valid -alpha!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if (strcmp(argv[k],"-beta") == 0){
             if (k+1 < argc){
@@ -461,7 +528,7 @@ int main(int argc, const char ** argv){
                 wrap.setBeta(beta);
             }else{
                 cerr << "ERROR: must provide valid -beta!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-tolerance") == 0)||(strcmp(argv[k],"-tol") == 0)){
             if (k+1 < argc){
@@ -473,7 +540,7 @@ int main(int argc, const char ** argv){
                 wrap.setTolerance(tol);
             }else{
                 cerr << "ERROR: must provide valid -tolerance!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-refout") == 0)||(strcmp(argv[k],"-rout") == 0)){
             if (k+1 < argc){
@@ -481,12 +548,12 @@ int main(int argc, const char ** argv){
                 int rout = atoi(argv[k]);
                 if (rout < 0){
                     cerr << "ERROR: the refinement output -refout/-rout must be non-negative!!!  For help see: ./tasgrid -help" << endl << endl;
-                    return 1;
+                    return false;
                 }
                 wrap.setRefOutput(rout);
             }else{
                 cerr << "ERROR: must provide valid -refout!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-mingrowth") == 0)||(strcmp(argv[k],"-ming") == 0)){
             if (k+1 < argc){
@@ -494,12 +561,12 @@ int main(int argc, const char ** argv){
                 int mg = atoi(argv[k]);
                 if (mg < 1){
                     cerr << "ERROR: the minimum growth must be positive!!!  For help see: ./tasgrid -help" << endl << endl;
-                    return 1;
+                    return false;
                 }
                 wrap.setMinGrowth(mg);
             }else{
                 cerr << "ERROR: must provide valid -mingrowth!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else if ((strcmp(argv[k],"-reftype") == 0)||(strcmp(argv[k],"-rt") == 0)){
             if (k+1 < argc){
@@ -507,12 +574,24 @@ int main(int argc, const char ** argv){
                 TypeRefinement r = OneDimensionalMeta::getIOTypeRefinementString(argv[k]);
                 if (r == refine_none){
                     cerr << "ERROR: " << argv[k] << " is not a valid refinement type!!!  For help see: ./tasgrid -help" << endl << endl;
-                    return 1;
+                    return false;
                 }
                 wrap.setTypeRefinement(r);
             }else{
                 cerr << "ERROR: must provide valid -reftype!!!  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
+            }
+        }else if (strcmp(argv[k],"-chunk") == 0){
+            if (k+1 < argc){
+                int n = atoi(argv[++k]);
+                if (n < 1){
+                    cerr << "ERROR: -chunk takes a positive integer" << endl << endl;
+                    return false;
+                }
+                wrap.setChunkSize(n);
+            }else{
+                cerr << "ERROR: must provide valid -chunk  For help see: ./tasgrid -help" << endl << endl;
+                return false;
             }
         }else if (strcmp(argv[k],"-gpuid") == 0){
             if (k+1 < argc){
@@ -521,7 +600,7 @@ int main(int argc, const char ** argv){
                 wrap.setGPID(g);
             }else{
                 cerr << "ERROR: must provide valid -gpuid  For help see: ./tasgrid -help" << endl << endl;
-                return 1;
+                return false;
             }
         }else{
             cout << "WARNING: ignoring unknown option: " << argv[k] << "\n";
@@ -529,16 +608,138 @@ int main(int argc, const char ** argv){
         k++;
     }
 
-    if (commandHelp){
-        printHelp(help_command, wrap.getCommand());
-        return 0;
+    return true;
+}
+
+// One line of a -script, or an implicit task that reads a grid from a file the first time the grid is used.
+struct ScriptTask{
+    int line;
+    std::vector<std::string> args;
+    std::unique_ptr<TasgridWrapper> wrap;
+    TasmanianSparseGrid *load_grid; // not null for the implicit read tasks
+    std::string load_filename;
+    std::set<std::string> reads, writes; // grids and files touched by the task
+};
+
+bool runScript(const char *filename){
+    std::ifstream ifs(filename);
+    if (!ifs.good()){
+        cerr << "ERROR: could not open the script file: " << filename << endl;
+        return false;
     }
 
-    if (!wrap.executeCommand()){
-        return 1;
+    // the grids are identified by the -gridfile name and stay in memory for the entire script
+    std::map<std::string, std::unique_ptr<TasmanianSparseGrid>> grids;
+    std::vector<std::unique_ptr<ScriptTask>> tasks;
+
+    std::string text;
+    int line = 0;
+    while(std::getline(ifs, text)){
+        line++;
+        std::vector<std::string> args(1, "tasgrid");
+        size_t c = 0;
+        while(c < text.size()){ // split on white spaces, double quotes allow for spaces in file names
+            if (isspace(text[c])){
+                c++;
+            }else if (text[c] == '"'){
+                size_t e = text.find('"', c + 1);
+                if (e == std::string::npos) e = text.size();
+                args.push_back(text.substr(c + 1, e - c - 1));
+                c = e + 1;
+            }else{
+                size_t e = c;
+                while((e < text.size()) && !isspace(text[e])) e++;
+                args.push_back(text.substr(c, e - c));
+                c = e;
+            }
+        }
+        if ((args.size() == 1) || (args[1][0] == '#')) continue; // empty line or comment
+
+        std::string grid_name;
+        for(size_t i=1; i+1<args.size(); i++)
+            if ((args[i] == "-gridfile") || (args[i] == "-gf")) grid_name = args[i+1];
+
+        std::unique_ptr<ScriptTask> task(new ScriptTask());
+        task->line = line;
+        task->args = std::move(args);
+        task->load_grid = nullptr;
+        bool new_grid = (!grid_name.empty() && (grids.find(grid_name) == grids.end()));
+        if (new_grid) grids[grid_name] = std::unique_ptr<TasmanianSparseGrid>(new TasmanianSparseGrid());
+        task->wrap = std::unique_ptr<TasgridWrapper>(new TasgridWrapper((grid_name.empty()) ? nullptr : grids[grid_name].get()));
+
+        std::vector<const char*> argv;
+        for(auto const &a : task->args) argv.push_back(a.c_str());
+        bool commandHelp = false;
+        if (!parseCommand((int) argv.size(), argv.data(), *task->wrap, commandHelp) || commandHelp){
+            cerr << "ERROR: could not parse line " << line << " of " << filename << endl;
+            return false;
+        }
+
+        if (new_grid && !TasgridWrapper::isCreateCommand(task->wrap->getCommand())){
+            std::unique_ptr<ScriptTask> load(new ScriptTask());
+            load->line = line;
+            load->load_grid = grids[grid_name].get();
+            load->load_filename = grid_name;
+            load->reads.insert("file:" + grid_name);
+            load->writes.insert("grid:" + grid_name);
+            tasks.push_back(std::move(load));
+        }
+        std::vector<std::string> inputs, outputs;
+        task->wrap->getFileDependencies(inputs, outputs);
+        for(auto const &f : inputs) task->reads.insert("file:" + f);
+        for(auto const &f : outputs) task->writes.insert("file:" + f);
+        if (!grid_name.empty()){
+            if (task->wrap->isModifyingGrid()){
+                task->writes.insert("grid:" + grid_name);
+            }else{
+                task->reads.insert("grid:" + grid_name);
+            }
+        }
+        tasks.push_back(std::move(task));
     }
 
-    return 0;
+    // a task depends on an earlier task if one writes something that the other reads or writes
+    // the tasks are split into stages so that all tasks in a stage depend only on tasks from the previous stages
+    auto conflict = [](const std::set<std::string> &a, const std::set<std::string> &b)->bool{
+        for(auto const &r : a) if (b.count(r) > 0) return true;
+        return false;
+    };
+    std::vector<int> stage(tasks.size(), 0);
+    int num_stages = (tasks.empty()) ? 0 : 1;
+    for(size_t j=0; j<tasks.size(); j++){
+        for(size_t i=0; i<j; i++){
+            if (conflict(tasks[i]->writes, tasks[j]->reads) || conflict(tasks[i]->writes, tasks[j]->writes) || conflict(tasks[i]->reads, tasks[j]->writes))
+                stage[j] = std::max(stage[j], stage[i] + 1);
+        }
+        num_stages = std::max(num_stages, stage[j] + 1);
+    }
+
+    for(int s=0; s<num_stages; s++){
+        std::vector<ScriptTask*> active;
+        for(size_t i=0; i<tasks.size(); i++) if (stage[i] == s) active.push_back(tasks[i].get());
+        std::vector<int> failed(active.size(), 0);
+        #pragma omp parallel for schedule(dynamic)
+        for(int i=0; i<(int) active.size(); i++){
+            ScriptTask *task = active[i];
+            try{
+                if (task->load_grid != nullptr){
+                    task->load_grid->read(task->load_filename.c_str());
+                }else if (!task->wrap->executeCommand()){
+                    failed[i] = 1;
+                }
+            }catch(std::exception &e){
+                cerr << e.what() << endl;
+                failed[i] = 1;
+            }
+        }
+        for(size_t i=0; i<active.size(); i++){
+            if (failed[i] != 0){
+                cerr << "ERROR: command on line " << active[i]->line << " of " << filename << " failed" << endl;
+                return false;
+            }
+        }
+    }
+    return true;
 }
 
 
@@ -580,7 +781,11 @@ void printHelp(TypeHelp ht, TypeCommand com){
         cout << " -getcoefficients"    << "\t-gc"     << "\t\tget the hierarchical coefficients of the grid" << endl;
         cout << " -setcoefficients"    << "\t-sc"     << "\t\tset the hierarchical coefficients of the grid" << endl;
         cout << " -getpoly\t"      << "\t"      << "\t\tget polynomial space" << endl;
-        cout << " -summary\t"      << "\t-s"      << "\t\twrites short description" << endl << endl;
+        cout << " -summary\t"      << "\t-s"      << "\t\twrites short description" << endl;
+        cout << " -write\t\t"      << "\t"      << "\t\twrites the grid to a file (e.g., change the file format)" << endl;
+        cout << " -script\t"      << "\t"      << "\t\truns the commands listed in a file, one per line, on grids kept in memory" << endl;
+        cout << " -serve\t\t"      << "\t"      << "\t\tkeep grids in memory and answer requests on -socket <path>" << endl;
+        cout << "\t\t\t\t\t\tgrids are set with repeated -gridfile, workers with -threads <int>" << endl << endl;
 
         cout << "Options\t\t"    << "\tShorthand"  << "\tValue"    << "\t\tAction" << endl;
         cout << " -help\t\t"     << "\thelp\t"     << "\t"         << "\t\tdisplay verbose information about this command" << endl;
@@ -608,6 +813,7 @@ void printHelp(TypeHelp ht, TypeCommand com){
         cout << " -levellimitsfile"  << "\t-lf\t"      << "\t<filename>"   << "\tset the limits for the levels" << endl;
         cout << " -customfile\t"     << "\t-cf\t"      << "\t<filename>"   << "\tset the file with the custom-tabulated rule" << endl;
         cout << " -gpuid\t\t"    << "\t\t"     << "\t<int>\t"   << "\tset the gpu to use for evaluations" << endl;
+        cout << " -chunk\t\t"    << "\t\t"     << "\t<int>\t"   << "\tstream the -xfile in chunks with the given number of points" << endl;
         cout << " -print\t\t"    << "\t-p\t"       << "\t<none>"       << "\t\tprint to standard output" << endl;
         cout << " -ascii\t\t"    << "\t\t"       << "\t<none>"       << "\t\tuse ASCII grid file format" << endl;
 
@@ -805,6 +1011,7 @@ void printHelp(TypeHelp ht, TypeCommand com){
             cout << "Options\t\t"    << "\tRequired"  << "\tValue"    << "\t\tAction" << endl;
             cout << " -gridfile\t"       << "\tyes\t"     << "\t<filename>"   << "\tset the name for the grid file" << endl;
             cout << " -xfile\t\t"    << "\tyes\t"     << "\t<filename>"   << "\tset the name for the file with points" << endl;
+            cout << " -chunk\t\t"    << "\tno\t"     << "\t<int>\t"   << "\tread/compute/write the points in chunks of this size" << endl;
             cout << " -outputfile\t"     << "\tno\t"      << "\t<filename>"   << "\tset the name for the output file" << endl;
             cout << " -print\t\t"    << "\tno\t"      << "\t<none>"       << "\t\tprint to standard output" << endl << endl;
             cout << "Note: -outputfile or -print output the interpolation weight for each point in the xfile, see equation (1.2) in the manual" << endl;
@@ -844,9 +1051,11 @@ void printHelp(TypeHelp ht, TypeCommand com){
             cout << " -gridfile\t"       << "\tyes\t"      << "\t<filename>"   << "\tset the name for the grid file" << endl;
             cout << " -xfile\t\t"    << "\tyes\t"     << "\t<filename>"   << "\tset the name for the file with points" << endl;
             cout << " -gpuid\t\t"    << "\tno\t"     << "\t<int>\t"   << "\tset the gpu to use for evaluations" << endl;
+            cout << " -chunk\t\t"    << "\tno\t"     << "\t<int>\t"   << "\tread/compute/write the points in chunks of this size" << endl;
             cout << " -outputfile\t"     << "\tno\t"      << "\t<filename>"   << "\tset the name for the output file" << endl;
             cout << " -print\t\t"    << "\tno\t"       << "\t<none>"       << "\t\tprint to standard output" << endl << endl;
             cout << "Note: -outputfile or -print output values of the interpolant at the points specified in the xfile" << endl;
+            cout << "Note: -chunk requires a binary -outputfile (no -ascii or -print), the memory usage is bounded by the chunk size" << endl;
             cout << "Note: at least one of -outputfile or -print must be specified, otherwise the command has no output" << endl << endl;
         }else if (com == command_evalhierarchical_dense){
             cout << "Commands\t"     << "\tShorthand"   << "\tAction" << endl;
@@ -855,6 +1064,7 @@ void printHelp(TypeHelp ht, TypeCommand com){
             cout << "Options\t\t"    << "\tRequired"  << "\tValue"    << "\t\tAction" << endl;
             cout << " -gridfile\t"       << "\tyes\t"      << "\t<filename>"   << "\tset the name for the grid file" << endl;
             cout << " -xfile\t\t"    << "\tyes\t"     << "\t<filename>"   << "\tset the name for the file with points" << endl;
+            cout << " -chunk\t\t"    << "\tno\t"     << "\t<int>\t"   << "\tread/compute/write the points in chunks of this size" << endl;
             cout << " -outputfile\t"     << "\tno\t"      << "\t<filename>"   << "\tset the name for the output file" << endl;
             cout << " -print\t\t"    << "\tno\t"       << "\t<none>"       << "\t\tprint to standard output" << endl << endl;
             cout << "Note: -outputfile or -print output values of the hierarchical basis functions in the xfile" << endl;
@@ -866,6 +1076,7 @@ void printHelp(TypeHelp ht, TypeCommand com){
             cout << "Options\t\t"    << "\tRequired"  << "\tValue"    << "\t\tAction" << endl;
             cout << " -gridfile\t"       << "\tyes\t"      << "\t<filename>"   << "\tset the name for the grid file" << endl;
             cout << " -xfile\t\t"    << "\tyes\t"     << "\t<filename>"   << "\tset the name for the file with points" << endl;
+            cout << " -chunk\t\t"    << "\tno\t"     << "\t<int>\t"   << "\tread/compute/write the points in chunks of this size" << endl;
             cout << " -outputfile\t"     << "\tno\t"      << "\t<filename>"   << "\tset the name for the output file" << endl;
             cout << " -print\t\t"    << "\tno\t"       << "\t<none>"       << "\t\tprint to standard output" << endl << endl;
             cout << "Note: -outputfile or -print output values of the hierarchical basis functions in the xfile" << endl;
@@ -957,6 +1168,14 @@ void printHelp(TypeHelp ht, TypeCommand com){
             cout << " -summary\t"    << "\t-s"      << "\t\twrites short description" << endl << endl;
             cout << "Accepted options:"  << endl;
             cout << " -gridfile\t"       << "\tyes\t"     << "\t<filename>"   << "\tset the name for the grid file" << endl << endl;
+        }else if (com == command_write){
+            cout << "Commands\t"     << "\tShorthand"   << "\tAction" << endl;
+            cout << " -write\t\t"    << "\t"      << "\t\twrites the grid to a file" << endl << endl;
+            cout << "Accepted options:"  << endl;
+            cout << " -gridfile\t"       << "\tyes\t"     << "\t<filename>"   << "\tset the name for the grid file" << endl;
+            cout << " -outputfile\t"     << "\tno\t"      << "\t<filename>"   << "\twrite to this file instead of the -gridfile" << endl;
+            cout << " -ascii\t\t"    << "\tno\t"       << "\t<none>"       << "\t\tuse ASCII grid file format" << endl << endl;
+            cout << "Note: in a -script the grids are kept in memory and -write is the only command that writes the grid files" << endl << endl;
         }
     }else if (ht == help_listtypes){
         cout << "This only lists the strings associated with each option for spelling purposes." << endl;
@@ -294,25 +294,22 @@ TypeAcceleration AccelerationMeta::getAvailableFallback(TypeAcceleration accel){
     // CUBLAS |      CPU       |     GPU        | Nvidia cuBlas (or cuSparse)
     // CUDA   |      GPU       |     GPU        | Nvidia cuBlas (or cuSparse)
     // MAGMA  |      GPU*      |     GPU        | UTK magma and magma_sparse
-    // BLAS   |      CPU       |     CPU        | BLAS
+    // BLAS   |      CPU       |     CPU        | BLAS (or internal cache-blocked kernels)
     // none   | all done on CPU, still using OpenMP (if available)
     // *if CUDA is not simultaneously available with MAGMA, then MAGMA will use the CPU for stage 1
     // Note: using CUDA without either cuBlas or MAGMA is a bad idea (it will still work, just slow)
 
     // accel_gpu_default should always point to the potentially "best" option (currently MAGMA)
     if (accel == accel_gpu_default) accel = accel_gpu_magma;
-    #if !defined(Tasmanian_ENABLE_CUDA) || !defined(Tasmanian_ENABLE_MAGMA) || !defined(Tasmanian_ENABLE_BLAS)
-    // if any of the 3 acceleration modes is missing, then add a switch statement to guard against setting that mode
+    // the BLAS mode is always available, without BLAS the internal cache-blocked kernels are used
+    #if !defined(Tasmanian_ENABLE_CUDA) || !defined(Tasmanian_ENABLE_MAGMA)
+    // if any of the GPU acceleration modes is missing, then add a switch statement to guard against setting that mode
     switch(accel){
         #ifndef Tasmanian_ENABLE_CUDA
         // if CUDA is missing: just use the CPU
         case accel_gpu_cublas:
         case accel_gpu_cuda:
-            #ifdef Tasmanian_ENABLE_BLAS
             accel = accel_cpu_blas;
-            #else
-            accel = accel_none;
-            #endif
             break;
         #endif // Tasmanian_ENABLE_CUDA
         #ifndef Tasmanian_ENABLE_MAGMA
@@ -320,19 +317,11 @@ TypeAcceleration AccelerationMeta::getAvailableFallback(TypeAcceleration accel){
         case accel_gpu_magma:
             #ifdef Tasmanian_ENABLE_CUDA
             accel = accel_gpu_cuda;
-            #elif defined(Tasmanian_ENABLE_BLAS)
-            accel = accel_cpu_blas;
             #else
-            accel = accel_none;
+            accel = accel_cpu_blas;
             #endif
             break;
         #endif // Tasmanian_ENABLE_MAGMA
-        #ifndef Tasmanian_ENABLE_BLAS
-        // if BLAS is missing, do not attempt to use the GPU but go directly to "none" mode
-        case accel_cpu_blas:
-            accel = accel_none;
-            break;
-        #endif // Tasmanian_ENABLE_BLAS
         default: // compiler complains if there is no explicit "default", even if empty
             break;
     }
@@ -33,6 +33,10 @@
 
 #include <stdexcept>
 #include <string>
+#include <map>
+#include <deque>
+#include <tuple>
+#include <mutex>
 
 #include "tsgCoreOneDimensional.hpp"
 
@@ -707,6 +711,13 @@ TypeRefinement OneDimensionalMeta::getIOTypeRefinementInt(int ref){
 
 // Gauss-Legendre
 void OneDimensionalNodes::getGaussLegendre(int m, std::vector<double> &w, std::vector<double> &x){
+    if (m > TSG_GAUSS_LEGENDRE_GLR){
+        getGaussLegendreGLR(m, w, x);
+    }else{
+        getGaussLegendreTridiagonal(m, w, x);
+    }
+}
+void OneDimensionalNodes::getGaussLegendreTridiagonal(int m, std::vector<double> &w, std::vector<double> &x){
     w.resize(m);
     x.resize(m);
 
@@ -720,6 +731,94 @@ void OneDimensionalNodes::getGaussLegendre(int m, std::vector<double> &w, std::v
 
     TasmanianTridiagonalSolver::decompose(m, x, s, w);
 }
+void OneDimensionalNodes::getGaussLegendreGLR(int m, std::vector<double> &w, std::vector<double> &x){
+    constexpr int num_terms = 30; // number of terms in the Taylor series
+    constexpr int num_rk_steps = 10; // Runge-Kutta steps for the initial guess of each node
+    w.resize(m);
+    x.resize(m);
+
+    double r = ((double) m) * ((double) (m + 1)); // coefficient in (1 - x^2) y'' - 2 x y' + r y = 0
+
+    // value of P_m(0) and P_{m-1}(0), using P_{k+1}(0) = -k / (k+1) P_{k-1}(0)
+    double pm = 1.0, pmm = 0.0; // P_{k}(0) and P_{k-1}(0) for k = 0
+    for(int k=0; k<m; k++){
+        double pnext = (k == 0) ? 0.0 : (- ((double) k) / ((double) (k+1)) * pmm);
+        pmm = pm;
+        pm = pnext;
+    }
+
+    // march from the origin, xc is the current point and y, yp are P_m(xc) and P_m'(xc)
+    double xc = 0.0, y = pm, yp = ((double) m) * pmm;
+    int first = m / 2; // index of the first non-negative node
+    if (m % 2 == 1){
+        x[first] = 0.0;
+        w[first] = 2.0 / (yp * yp);
+        first++;
+    }
+
+    std::vector<double> c(num_terms + 1);
+    double theta_start = (m % 2 == 0) ? 0.5 * M_PI : 0.0; // the origin is an extremum or a root
+    for(int i=first; i<m; i++){
+        // initial guess, integrate dx/dtheta from the current point to the next root
+        auto dxdtheta = [&](double theta, double z)->double{
+            double q = 1.0 - z * z;
+            if (q <= 0.0) return 0.0;
+            return 1.0 / (sqrt(r / q) - z * sin(theta) * cos(theta) / q);
+        };
+        double dtheta = (M_PI - theta_start) / ((double) num_rk_steps);
+        double guess = xc, theta = theta_start;
+        for(int k=0; k<num_rk_steps; k++){
+            double k1 = dtheta * dxdtheta(theta, guess);
+            double k2 = dtheta * dxdtheta(theta + 0.5 * dtheta, guess + 0.5 * k1);
+            double k3 = dtheta * dxdtheta(theta + 0.5 * dtheta, guess + 0.5 * k2);
+            double k4 = dtheta * dxdtheta(theta + dtheta, guess + k3);
+            guess += (k1 + 2.0 * k2 + 2.0 * k3 + k4) / 6.0;
+            theta += dtheta;
+        }
+        theta_start = 0.0;
+
+        // Taylor coefficients at xc, c_k = y^{(k)}(xc) / k!
+        double q = 1.0 - xc * xc;
+        c[0] = y;
+        c[1] = yp;
+        for(int k=0; k<num_terms-1; k++){
+            double dk = (double) k;
+            c[k+2] = (2.0 * (dk + 1.0) * (dk + 1.0) * xc * c[k+1] - (r - dk * (dk + 1.0)) * c[k]) / (q * (dk + 1.0) * (dk + 2.0));
+        }
+
+        // Newton's method on the series
+        double h = guess - xc, val = 0.0, der = 0.0;
+        for(int iter=0; iter<10; iter++){
+            val = c[num_terms];
+            der = 0.0;
+            for(int k=num_terms; k>0; k--){
+                der = der * h + val;
+                val = val * h + c[k-1];
+            }
+            double dh = val / der;
+            h -= dh;
+            if (fabs(dh) < 1.E-16) break;
+        }
+        der = 0.0;
+        val = c[num_terms];
+        for(int k=num_terms; k>0; k--){
+            der = der * h + val;
+            val = val * h + c[k-1];
+        }
+
+        xc += h;
+        y = 0.0;
+        yp = der;
+        x[i] = xc;
+        w[i] = 2.0 / ((1.0 - xc * xc) * yp * yp);
+    }
+
+    // the nodes are symmetric
+    for(int i=0; i<m/2; i++){
+        x[i] = -x[m-i-1];
+        w[i] = w[m-i-1];
+    }
+}
 
 // Chebyshev
 void OneDimensionalNodes::getChebyshev(int m, std::vector<double> &w, std::vector<double> &x){
@@ -845,6 +944,69 @@ void OneDimensionalNodes::getGaussLaguerre(int m, std::vector<double> &w, std::v
     TasmanianTridiagonalSolver::decompose(m, x, s, w);
 }
 
+void OneDimensionalNodes::getGaussNodesCached(TypeOneDRule rule, int m, double alpha, double beta, std::vector<double> &w, std::vector<double> &x){
+    // the odd rules share the nodes with the base rule, drop the parameters that the rule does not use
+    switch(rule){
+        case rule_chebyshevodd:         rule = rule_chebyshev; break;
+        case rule_gausslegendreodd:     rule = rule_gausslegendre; break;
+        case rule_gausschebyshev1odd:   rule = rule_gausschebyshev1; break;
+        case rule_gausschebyshev2odd:   rule = rule_gausschebyshev2; break;
+        case rule_gaussgegenbauerodd:   rule = rule_gaussgegenbauer; break;
+        case rule_gausshermiteodd:      rule = rule_gausshermite; break;
+        case rule_gaussjacobiodd:       rule = rule_gaussjacobi; break;
+        case rule_gausslaguerreodd:     rule = rule_gausslaguerre; break;
+        default:
+            break;
+    }
+    if ((rule != rule_gaussgegenbauer) && (rule != rule_gausshermite) && (rule != rule_gaussjacobi) && (rule != rule_gausslaguerre)) alpha = 0.0;
+    if (rule != rule_gaussjacobi) beta = 0.0;
+
+    using CacheKey = std::tuple<int, int, double, double>;
+    using CacheEntry = std::pair<std::vector<double>, std::vector<double>>; // weights and nodes
+    static std::mutex cache_lock;
+    static std::map<CacheKey, CacheEntry> cache;
+    static std::deque<CacheKey> cache_order; // the oldest rules are evicted first
+    static size_t cache_size = 0; // number of doubles stored in the cache
+
+    CacheKey key((int) rule, m, alpha, beta);
+    {
+        std::lock_guard<std::mutex> lock(cache_lock);
+        auto entry = cache.find(key);
+        if (entry != cache.end()){
+            w = entry->second.first;
+            x = entry->second.second;
+            return;
+        }
+    }
+
+    // compute outside of the lock, if two threads compute the same rule at the same time then the first one is kept
+    switch(rule){
+        case rule_chebyshev:        getChebyshev(m, w, x); break;
+        case rule_gausslegendre:    getGaussLegendre(m, w, x); break;
+        case rule_gausschebyshev1:  getGaussChebyshev1(m, w, x); break;
+        case rule_gausschebyshev2:  getGaussChebyshev2(m, w, x); break;
+        case rule_gaussgegenbauer:  getGaussJacobi(m, w, x, alpha, alpha); break;
+        case rule_gausshermite:     getGaussHermite(m, w, x, alpha); break;
+        case rule_gaussjacobi:      getGaussJacobi(m, w, x, alpha, beta); break;
+        case rule_gausslaguerre:    getGaussLaguerre(m, w, x, alpha); break;
+        default:
+            throw std::runtime_error("ERROR: getGaussNodesCached() called with a rule that is neither Chebyshev nor Gauss");
+    }
+
+    size_t rule_size = w.size() + x.size();
+    if (rule_size > TSG_GAUSS_CACHE_SIZE) return; // the rule is too large for the cache
+    std::lock_guard<std::mutex> lock(cache_lock);
+    if (!cache.emplace(key, CacheEntry(w, x)).second) return; // another thread cached the rule
+    cache_order.push_back(key);
+    cache_size += rule_size;
+    while(cache_size > TSG_GAUSS_CACHE_SIZE){
+        auto oldest = cache.find(cache_order.front());
+        cache_size -= oldest->second.first.size() + oldest->second.second.size();
+        cache.erase(oldest);
+        cache_order.pop_front();
+    }
+}
+
 // Clenshaw-Curtis
 void OneDimensionalNodes::getClenshawCurtisNodes(int level, std::vector<double> &nodes){
     int n = OneDimensionalMeta::getNumPoints(level, rule_clenshawcurtis);
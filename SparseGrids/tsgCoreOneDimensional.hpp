@@ -202,6 +202,17 @@ namespace OneDimensionalNodes{
     // non-nested rules
     //! \brief Generate Gauss-Legendre weights \b w and points \b x for (input) number of points \b m.
     void getGaussLegendre(int m, std::vector<double> &w, std::vector<double> &x);
+    /*!
+     * \brief Generate Gauss-Legendre weights \b w and points \b x using the O(m) Glaser-Liu-Rokhlin algorithm.
+     *
+     * The nodes are found by marching from the origin to the right end of the interval,
+     * Taylor series derived from the Legendre differential equation are used to run Newton's method
+     * and the initial guess for each node comes from the Prufer transformation of the equation.
+     * Used by getGaussLegendre() when \b m is large, since the tridiagonal eigenvalue solver is O(m^2).
+     */
+    void getGaussLegendreGLR(int m, std::vector<double> &w, std::vector<double> &x);
+    //! \brief Generate Gauss-Legendre weights \b w and points \b x using the O(m^2) tridiagonal eigenvalue solver, used by getGaussLegendre() for small \b m.
+    void getGaussLegendreTridiagonal(int m, std::vector<double> &w, std::vector<double> &x);
     //! \brief Generate Chebyshev weights \b w and points \b x for (input) number of points \b m.
     void getChebyshev(int m, std::vector<double> &w, std::vector<double> &x);
     //! \brief Generate Gauss-Chebyshev type 1 weights \b w and points \b x for (input) number of points \b m.
@@ -215,6 +226,17 @@ namespace OneDimensionalNodes{
     //! \brief Generate Gauss-Laguerre weights \b w and points \b x for (input) number of points \b m, using parameters \b alpha
     void getGaussLaguerre(int m, std::vector<double> &w, std::vector<double> &x, double alpha);
 
+    /*!
+     * \brief Generate the weights \b w and points \b x of the non-nested \b rule with \b m points, use a process-wide cache.
+     *
+     * The \b rule can be any of the Chebyshev or Gauss rules (the odd variants are treated as the base rule),
+     * \b alpha and \b beta are used only by the rules that depend on them.
+     * The computed rules are stored in a cache shared by all grids in the process (the access is thread-safe),
+     * so that a rule is computed only once regardless of the number of grids and wrappers that need it.
+     * The cache holds at most TSG_GAUSS_CACHE_SIZE doubles, the oldest rules are evicted first.
+     */
+    void getGaussNodesCached(TypeOneDRule rule, int m, double alpha, double beta, std::vector<double> &w, std::vector<double> &x);
+
     // nested rules
     //! \brief Generate Clenshaw-Curtis \b nodes for the \b level.
     void getClenshawCurtisNodes(int level, std::vector<double> &nodes);
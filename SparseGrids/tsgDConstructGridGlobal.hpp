@@ -32,6 +32,7 @@
 #define __TASMANIAN_SPARSE_GRID_DYNAMIC_CONST_GLOBAL_HPP
 
 #include <forward_list>
+#include <memory>
 
 #include "tsgIndexManipulator.hpp"
 
@@ -249,7 +250,7 @@ struct SimpleConstructData{
  * \endinternal
  */
 template<bool useAscii>
-std::unique_ptr<SimpleConstructData> readSimpleConstructionData(size_t num_dimensions, size_t num_outputs, std::ifstream &ifs){
+std::unique_ptr<SimpleConstructData> readSimpleConstructionData(size_t num_dimensions, size_t num_outputs, std::istream &ifs){
     std::unique_ptr<SimpleConstructData> dynamic_values = std::unique_ptr<SimpleConstructData>(new SimpleConstructData);
     dynamic_values->initial_points.read<useAscii>(ifs);
     dynamic_values->data = readNodeDataList<useAscii>(num_dimensions, num_outputs, ifs);
@@ -428,8 +428,10 @@ enum TypeRefinement{
 //! could be the fastest when working with small grids.
 //!
 //! \par Defaults
-//! If \b Tasmanian_ENABLE_BLAS is enabled in CMake, then \b accel_cpu_blas will be the default acceleration mode,
-//! otherwise the default mode is \b accel_none.
+//! The default acceleration mode is \b accel_cpu_blas. If \b Tasmanian_ENABLE_BLAS is enabled in CMake,
+//! the mode uses the external BLAS library, otherwise Tasmanian falls back to internal cache-blocked
+//! and multi-threaded (OpenMP) matrix-matrix kernels that are slower than an optimized BLAS implementation
+//! but still much faster than \b accel_none when working with many outputs.
 //! The \b accel_gpu_default uses the first available in the list: \b accel_gpu_magma, \b accel_gpu_cuda,
 //! \b accel_cpu_blas, \b accel_none.
 //! When using \b accel_none, \b TasmanianSparseGrid::evaluateFast() is equivalent to \b TasmanianSparseGrid::evaluate()
@@ -442,7 +444,7 @@ enum TypeRefinement{
 //! with any acceleration type regardless whether it has been enabled by CMake.
 //! In order to facilitate code portability, Tasmanian implements sane fall-back
 //! modes so that "the next best mode" will be automatically selected if the desired mode is not present. Specifically,
-//! missing MAGMA will fallback to CUDA, missing CUDA will fallback to BLAS, and missing BLAS will fallback to \b none.
+//! missing MAGMA will fallback to CUDA, missing CUDA will fallback to BLAS, and missing BLAS will fallback to the internal kernels.
 //!
 //! \par Memory Management
 //! All acceleration modes (other than \b none) require that potentially large matrices are explicitly constructed,
@@ -490,7 +492,7 @@ enum TypeRefinement{
 enum TypeAcceleration{
     //! \brief Usually the slowest mode, uses only OpenMP multi-threading, but optimized for memory and could be the fastest mode for small problems.
     accel_none,
-    //! \brief Default (if available), uses OpenMP to form matrices and BLAS on the CPU for linear algebra.
+    //! \brief Default, uses OpenMP to form matrices and BLAS (or the internal kernels) on the CPU for linear algebra.
     accel_cpu_blas,
     //! \brief Equivalent to the first available from \b accel_gpu_magma, \b accel_gpu_cuda, \b accel_cpu_blas, \b accel_none.
     accel_gpu_default,
@@ -556,16 +558,57 @@ enum TypeAcceleration{
 #define TSG_MAX_SECANT_ITERATIONS 1000
 
 //! \internal
-//! \brief Tuning parameter for dense vs sparse evaluations of Local Polynomial Grids when using CPU BLAS.
+//! \brief Gauss-Legendre rules with more points than this threshold are computed with the Glaser-Liu-Rokhlin algorithm.
 //! \ingroup SGEnumerates
 
-//! Defines the threshold for switching between sparse and dense version of batch evaluate for Local Polynomial Grids.
-//! Generally, because of caching and reuse of data, dense operations have 10x more flops per second than sparse ops;
-//! unless the sparse version of the algorithm can cut total flops by 10x (i.e., fill is less than 10%), then it
-//! is faster to convert the sparse matrix into a dense one and use dense linear algebra.
-//! The difference is noticeable if the number of outputs is sufficiently large;
-//! if the outputs are few there is very little caching anyway and hence use the sparse version to save memory.
-#define TSG_LOCALP_BLAS_NUM_OUTPUTS 2048
+//! The tridiagonal eigenvalue solver costs O(n^2) operations, while the Glaser-Liu-Rokhlin method costs O(n)
+//! (with a larger constant) and is also more accurate for large n, since the QL iteration uses TSG_NUM_TOL as a drop criteria.
+#define TSG_GAUSS_LEGENDRE_GLR 32
+
+//! \internal
+//! \brief Maximum number of doubles (nodes and weights) kept in the process-wide cache of Gauss rules.
+//! \ingroup SGEnumerates
+
+//! The cache is shared by all grids, the oldest rules are evicted when the limit is exceeded (the default is 8MB).
+#define TSG_GAUSS_CACHE_SIZE 1048576
+
+//! \internal
+//! \brief Cost model for the evaluations of Local Polynomial Grids when using CPU BLAS, cost of a sparse multiply-add.
+//! \ingroup SGEnumerates
+
+//! Local Polynomial Grids can be evaluated by walking the tree (without forming a matrix), by multiplying the surpluses
+//! by a sparse matrix of basis values, or by converting the sparse matrix to a dense one and calling BLAS.
+//! The choice is made by comparing the estimated cost of each algorithm, where all costs are measured relative to
+//! one multiply-add of the dense matrix-matrix product (about 6 - 8 GFlops on a single core).
+//! The constants are measured on benchmarks using 1 to 8 dimensions, 1 to 4096 outputs, and linear and quadratic rules.
+//!
+//! The sparse multiply-add is slower than the dense one since there is no reuse of the surpluses,
+//! the measured difference is about 50%.
+#define TSG_LOCALP_COST_SPARSE_FLOP 1.5
+
+//! \internal
+//! \brief Cost model for the evaluations of Local Polynomial Grids, cost of a multiply-add when walking the tree.
+//! \ingroup SGEnumerates
+
+//! Walking the tree adds the contribution of each basis function one at a time, which requires a load and store
+//! of all outputs for every basis function; hence, the multiply-add is slower than TSG_LOCALP_COST_SPARSE_FLOP.
+#define TSG_LOCALP_COST_WALK_FLOP 2.5
+
+//! \internal
+//! \brief Cost model for the evaluations of Local Polynomial Grids, cost of storing an entry of the sparse matrix (per dimension).
+//! \ingroup SGEnumerates
+
+//! Walking the tree and forming the sparse matrix visit the same nodes, but the matrix construction has to store (and later load)
+//! the index and basis value of each non-zero. The overhead is proportional to the cost of visiting a node, which
+//! grows linearly with the number of dimensions.
+#define TSG_LOCALP_COST_SPARSE_ENTRY 16.0
+
+//! \internal
+//! \brief Cost model for the evaluations of Local Polynomial Grids, cost of an entry of the dense basis matrix.
+//! \ingroup SGEnumerates
+
+//! Converting the sparse matrix to dense requires that every entry is set to zero before the non-zeros are copied.
+#define TSG_LOCALP_COST_DENSE_ENTRY 2.0
 
 }
 
@@ -72,9 +72,7 @@ public:
 
     virtual void evaluateBatch(const double x[], int num_x, double y[]) const = 0;
 
-    #ifdef Tasmanian_ENABLE_BLAS
     virtual void evaluateBlas(const double x[], int num_x, double y[]) const = 0;
-    #endif
 
     #ifdef Tasmanian_ENABLE_CUDA
     virtual void loadNeededPointsCuda(CudaEngine *engine, const double *vals) = 0;
@@ -84,12 +82,13 @@ public:
 
     virtual void clearRefinement() = 0;
     virtual void mergeRefinement() = 0;
+    virtual void freezeForEvaluation(bool keep_values) = 0; // drop everything not needed by evaluate() and integrate(), the values are needed only to integrate with a conformal map
 
     virtual void beginConstruction(){}
-    virtual void writeConstructionDataBinary(std::ofstream&) const{}
-    virtual void writeConstructionData(std::ofstream&) const{}
-    virtual void readConstructionDataBinary(std::ifstream&){}
-    virtual void readConstructionData(std::ifstream&){}
+    virtual void writeConstructionDataBinary(std::ostream&) const{}
+    virtual void writeConstructionData(std::ostream&) const{}
+    virtual void readConstructionDataBinary(std::istream&){}
+    virtual void readConstructionData(std::istream&){}
     virtual void loadConstructedPoint(const double[], const std::vector<double> &){}
     virtual void finishConstruction(){}
 
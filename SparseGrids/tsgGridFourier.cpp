@@ -38,6 +38,10 @@
 namespace TasGrid{
 
 GridFourier::GridFourier() : num_dimensions(0), num_outputs(0), max_levels(0){}
+GridFourier::GridFourier(const GridFourier &other) :
+    num_dimensions(other.num_dimensions), num_outputs(other.num_outputs), wrapper(other.wrapper),
+    tensors(other.tensors), active_tensors(other.active_tensors), active_w(other.active_w), max_levels(other.max_levels),
+    points(other.points), needed(other.needed), fourier_coefs(other.fourier_coefs), values(other.values), max_power(other.max_power){}
 GridFourier::~GridFourier(){}
 
 template<bool useAscii> void GridFourier::write(std::ostream &os) const{
@@ -59,7 +63,7 @@ template<bool useAscii> void GridFourier::write(std::ostream &os) const{
     if (num_outputs > 0){
         values.write<useAscii>(os);
         IO::writeFlag<useAscii, IO::pad_auto>((fourier_coefs.getNumStrips() != 0), os);
-        if (fourier_coefs.getNumStrips() != 0) IO::writeVector<useAscii, IO::pad_line>(fourier_coefs.getVector(), os);
+        if (fourier_coefs.getNumStrips() != 0) fourier_coefs.write<useAscii, IO::pad_line>(os);
     }
 
     IO::writeFlag<useAscii, IO::pad_line>(false, os);
@@ -83,8 +87,7 @@ template<bool useAscii> void GridFourier::read(std::istream &is){
     if (num_outputs > 0){
         values.read<useAscii>(is);
         if (IO::readFlag<useAscii>(is)){
-            fourier_coefs.resize(num_outputs, 2 * points.getNumIndexes());
-            IO::readVector<useAscii>(is, fourier_coefs.getVector());
+            fourier_coefs.read<useAscii>(is, num_outputs, 2 * points.getNumIndexes());
         }
     }
 
@@ -125,14 +128,6 @@ void GridFourier::makeGrid(int cnum_dimensions, int cnum_outputs, int depth, Typ
     setTensors(tset, cnum_outputs);
 }
 
-void GridFourier::copyGrid(const GridFourier *fourier){
-    MultiIndexSet tset = fourier->tensors;
-    setTensors(tset, fourier->num_outputs);
-    if ((num_outputs > 0) && (!fourier->points.empty())){ // if there are values inside the source object
-        loadNeededPoints(fourier->values.getValues(0));
-    }
-}
-
 void GridFourier::setTensors(MultiIndexSet &tset, int cnum_outputs){
     reset();
     num_dimensions = (int) tset.getNumDimensions();
@@ -408,7 +403,6 @@ void GridFourier::evaluateBatch(const double x[], int num_x, double y[]) const{
         evaluate(xwrap.getStrip(i), ywrap.getStrip(i));
 }
 
-#ifdef Tasmanian_ENABLE_BLAS
 void GridFourier::evaluateBlas(const double x[], int num_x, double y[]) const{
     int num_points = points.getNumIndexes();
     Data2D<double> wreal;
@@ -423,7 +417,6 @@ void GridFourier::evaluateBlas(const double x[], int num_x, double y[]) const{
     TasBLAS::denseMultiply(num_outputs, num_x, num_points, 1.0, fourier_coefs.getStrip(0), wreal.getStrip(0), 0.0, y);
     TasBLAS::denseMultiply(num_outputs, num_x, num_points, -1.0, fourier_coefs.getStrip(num_points), wimag.getStrip(0), 1.0, y);
 }
-#endif
 
 #ifdef Tasmanian_ENABLE_CUDA
 void GridFourier::loadNeededPointsCuda(CudaEngine *, const double *vals){
@@ -531,6 +524,13 @@ void GridFourier::clearAccelerationData(){
 }
 void GridFourier::clearRefinement(){ return; }     // to be expanded later
 void GridFourier::mergeRefinement(){ return; }     // to be expanded later
+void GridFourier::freezeForEvaluation(bool keep_values){
+    needed = MultiIndexSet();
+    tensors = MultiIndexSet(); // evaluations use only the active_tensors
+    active_w.shrink_to_fit();
+    fourier_coefs.getVector().shrink_to_fit();
+    if (keep_values) values.shrinkToFit(); else values = StorageSet(); // the Fourier coefficients are sufficient
+}
 
 const int* GridFourier::getPointIndexes() const{
     return ((points.empty()) ? needed.getIndex(0) : points.getIndex(0));
@@ -50,6 +50,7 @@ namespace TasGrid{
 class GridFourier : public BaseCanonicalGrid {
 public:
     GridFourier();
+    GridFourier(const GridFourier &other); // shares the read-only index sets and values, see MultiIndexSet and StorageSet
     ~GridFourier();
 
     bool isFourier() const{ return true; }
@@ -58,7 +59,6 @@ public:
     template<bool useAscii> void read(std::istream &is);
 
     void makeGrid(int cnum_dimensions, int cnum_outputs, int depth, TypeDepth type, const std::vector<int> &anisotropic_weights, const std::vector<int> &level_limits);
-    void copyGrid(const GridFourier *fourier);
 
     void setTensors(MultiIndexSet &tset, int cnum_outputs);
 
@@ -83,9 +83,7 @@ public:
     void evaluate(const double x[], double y[]) const;
     void evaluateBatch(const double x[], int num_x, double y[]) const;
 
-    #ifdef Tasmanian_ENABLE_BLAS
     void evaluateBlas(const double x[], int num_x, double y[]) const;
-    #endif
 
     #ifdef Tasmanian_ENABLE_CUDA
     void loadNeededPointsCuda(CudaEngine *engine, const double *vals);
@@ -107,6 +105,7 @@ public:
     void clearAccelerationData();
     void clearRefinement();
     void mergeRefinement();
+    void freezeForEvaluation(bool keep_values);
 
     const int* getPointIndexes() const;
     const double* getFourierCoefs() const;
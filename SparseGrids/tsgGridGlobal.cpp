@@ -39,6 +39,12 @@
 namespace TasGrid{
 
 GridGlobal::GridGlobal() : num_dimensions(0), num_outputs(0), alpha(0.0), beta(0.0){}
+GridGlobal::GridGlobal(const GridGlobal &other) :
+    num_dimensions(other.num_dimensions), num_outputs(other.num_outputs), rule(other.rule), alpha(other.alpha), beta(other.beta),
+    wrapper(other.wrapper), tensors(other.tensors), active_tensors(other.active_tensors), active_w(other.active_w),
+    points(other.points), needed(other.needed), tensor_refs(other.tensor_refs), max_levels(other.max_levels), values(other.values),
+    updated_tensors(other.updated_tensors), updated_active_tensors(other.updated_active_tensors), updated_active_w(other.updated_active_w),
+    custom(other.custom){}
 GridGlobal::~GridGlobal(){}
 
 template<bool useAscii> void GridGlobal::write(std::ostream &os) const{
@@ -71,7 +77,7 @@ template<bool useAscii> void GridGlobal::write(std::ostream &os) const{
     }
 }
 
-template<bool useAscii> void GridGlobal::read(std::ifstream &is){
+template<bool useAscii> void GridGlobal::read(std::istream &is){
     reset(true); // true deletes any custom rule
     num_dimensions = IO::readNumber<useAscii, int>(is);
     num_outputs = IO::readNumber<useAscii, int>(is);
@@ -112,8 +118,8 @@ template<bool useAscii> void GridGlobal::read(std::ifstream &is){
 
 template void GridGlobal::write<true>(std::ostream &) const;
 template void GridGlobal::write<false>(std::ostream &) const;
-template void GridGlobal::read<true>(std::ifstream &);
-template void GridGlobal::read<false>(std::ifstream &);
+template void GridGlobal::read<true>(std::istream &);
+template void GridGlobal::read<false>(std::istream &);
 
 void GridGlobal::reset(bool includeCustom){
     clearAccelerationData();
@@ -138,6 +144,14 @@ void GridGlobal::clearRefinement(){
     updated_active_tensors = MultiIndexSet();
     updated_active_w = std::vector<int>();
 }
+void GridGlobal::freezeForEvaluation(bool){ // the values are used by the evaluations or the anisotropic estimates
+    clearRefinement();
+    dynamic_values.reset();
+    tensors = MultiIndexSet(); // evaluations use only the active_tensors and tensor_refs
+    active_w.shrink_to_fit();
+    for(auto &r : tensor_refs) r.shrink_to_fit();
+    values.shrinkToFit();
+}
 
 MultiIndexSet GridGlobal::selectTensors(size_t dims, int depth, TypeDepth type, const std::vector<int> &anisotropic_weights,
                                         TypeOneDRule crule, std::vector<int> const &level_limits) const{
@@ -187,29 +201,6 @@ void GridGlobal::makeGrid(int cnum_dimensions, int cnum_outputs, int depth, Type
 
     setTensors(tset, cnum_outputs, crule, calpha, cbeta);
 }
-void GridGlobal::copyGrid(const GridGlobal *global){
-    custom = CustomTabulated();
-    if (global->rule == rule_customtabulated) custom = global->custom;
-
-    MultiIndexSet tset = global->tensors;
-    setTensors(tset, global->num_outputs, global->rule, global->alpha, global->beta);
-
-    if ((num_outputs > 0) && (!(global->points.empty()))){ // if there are values inside the source object
-        loadNeededPoints(global->values.getValues(0));
-    }
-
-    // if there is an active refinement awaiting values
-    if (!(global->updated_tensors.empty())){
-        updated_tensors = global->updated_tensors;
-        updated_active_tensors = global->updated_active_tensors;
-        updated_active_w = global->updated_active_w;
-
-        needed = global->needed;
-
-        wrapper.load(custom, global->wrapper.getNumLevels(), rule, alpha, beta);
-    }
-}
-
 void GridGlobal::setTensors(MultiIndexSet &tset, int cnum_outputs, TypeOneDRule crule, double calpha, double cbeta){
     reset(false);
     num_dimensions = (int) tset.getNumDimensions();
@@ -416,13 +407,13 @@ void GridGlobal::beginConstruction(){
         values.resize(num_outputs, 0);
     }
 }
-void GridGlobal::writeConstructionDataBinary(std::ofstream &ofs) const{
+void GridGlobal::writeConstructionDataBinary(std::ostream &ofs) const{
     dynamic_values->write<false>(ofs);
 }
-void GridGlobal::writeConstructionData(std::ofstream &ofs) const{
+void GridGlobal::writeConstructionData(std::ostream &ofs) const{
     dynamic_values->write<true>(ofs);
 }
-void GridGlobal::readConstructionDataBinary(std::ifstream &ifs){
+void GridGlobal::readConstructionDataBinary(std::istream &ifs){
     dynamic_values = std::unique_ptr<DynamicConstructorDataGlobal>(new DynamicConstructorDataGlobal((size_t) num_dimensions, (size_t) num_outputs));
     dynamic_values->read<false>(ifs);
     int max_level = dynamic_values->getMaxTensor();
@@ -430,7 +421,7 @@ void GridGlobal::readConstructionDataBinary(std::ifstream &ifs){
         wrapper.load(custom, max_level, rule, alpha, beta);
     dynamic_values->reloadPoints([&](int l)->int{ return wrapper.getNumPoints(l); });
 }
-void GridGlobal::readConstructionData(std::ifstream &ifs){
+void GridGlobal::readConstructionData(std::istream &ifs){
     dynamic_values = std::unique_ptr<DynamicConstructorDataGlobal>(new DynamicConstructorDataGlobal((size_t) num_dimensions, (size_t) num_outputs));
     dynamic_values->read<true>(ifs);
     int max_level = dynamic_values->getMaxTensor();
@@ -614,7 +605,6 @@ void GridGlobal::evaluateBatch(const double x[], int num_x, double y[]) const{
         evaluate(xwrap.getStrip(i), ywrap.getStrip(i));
 }
 
-#ifdef Tasmanian_ENABLE_BLAS
 void GridGlobal::evaluateBlas(const double x[], int num_x, double y[]) const{
     int num_points = points.getNumIndexes();
     Data2D<double> weights(num_points, num_x);
@@ -626,14 +616,13 @@ void GridGlobal::evaluateBlas(const double x[], int num_x, double y[]) const{
 
     TasBLAS::denseMultiply(num_outputs, num_x, num_points, 1.0, values.getValues(0), weights.getStrip(0), 0.0, y);
 }
-#endif // Tasmanian_ENABLE_BLAS
 
 #ifdef Tasmanian_ENABLE_CUDA
 void GridGlobal::loadNeededPointsCuda(CudaEngine *, const double *vals){
     loadNeededPoints(vals);
 }
 void GridGlobal::evaluateCudaMixed(CudaEngine *engine, const double x[], int num_x, double y[]) const{
-    if (cuda_values.size() == 0) cuda_values.load(values.getVector());
+    if (cuda_values.size() == 0) cuda_values.load(values.getTotalEntries(), values.getValues(0));
 
     int num_points = points.getNumIndexes();
     Data2D<double> weights(num_points, num_x);
@@ -53,15 +53,15 @@ namespace TasGrid{
 class GridGlobal : public BaseCanonicalGrid{
 public:
     GridGlobal();
+    GridGlobal(const GridGlobal &other); // shares the read-only index sets and values, see MultiIndexSet and StorageSet
     ~GridGlobal();
 
     bool isGlobal() const{ return true; }
 
     template<bool useAscii> void write(std::ostream &os) const;
-    template<bool useAscii> void read(std::ifstream &is);
+    template<bool useAscii> void read(std::istream &is);
 
     void makeGrid(int cnum_dimensions, int cnum_outputs, int depth, TypeDepth type, TypeOneDRule crule, const std::vector<int> &anisotropic_weights, double calpha, double cbeta, const char* custom_filename, const std::vector<int> &level_limits);
-    void copyGrid(const GridGlobal *global);
 
     void setTensors(MultiIndexSet &tset, int cnum_outputs, TypeOneDRule crule, double calpha, double cbeta);
 
@@ -94,9 +94,7 @@ public:
 
     void evaluateBatch(const double x[], int num_x, double y[]) const;
 
-    #ifdef Tasmanian_ENABLE_BLAS
     void evaluateBlas(const double x[], int num_x, double y[]) const;
-    #endif
 
     #ifdef Tasmanian_ENABLE_CUDA
     void loadNeededPointsCuda(CudaEngine *engine, const double *vals);
@@ -110,12 +108,13 @@ public:
     void setSurplusRefinement(double tolerance, int output, const std::vector<int> &level_limits);
     void clearRefinement();
     void mergeRefinement();
+    void freezeForEvaluation(bool keep_values);
 
     void beginConstruction();
-    void writeConstructionDataBinary(std::ofstream &ofs) const;
-    void writeConstructionData(std::ofstream &ofs) const;
-    void readConstructionDataBinary(std::ifstream &ifs);
-    void readConstructionData(std::ifstream &ifs);
+    void writeConstructionDataBinary(std::ostream &ofs) const;
+    void writeConstructionData(std::ostream &ofs) const;
+    void readConstructionDataBinary(std::istream &ifs);
+    void readConstructionData(std::istream &ifs);
     void getCandidateConstructionPoints(TypeDepth type, const std::vector<int> &weights, std::vector<double> &x, const std::vector<int> &level_limits);
     void getCandidateConstructionPoints(TypeDepth type, int output, std::vector<double> &x, const std::vector<int> &level_limits);
     void getCandidateConstructionPoints(std::function<double(const int *)> getTensorWeight, std::vector<double> &x, const std::vector<int> &level_limits);
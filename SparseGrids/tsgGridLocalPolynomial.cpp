@@ -36,9 +36,19 @@
 #include "tsgHiddenExternals.hpp"
 #include "tsgUtils.hpp"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace TasGrid{
 
 GridLocalPolynomial::GridLocalPolynomial() : num_dimensions(0), num_outputs(0), order(1), top_level(0), sparse_affinity(0)  {}
+GridLocalPolynomial::GridLocalPolynomial(const GridLocalPolynomial &other) :
+    num_dimensions(other.num_dimensions), num_outputs(other.num_outputs), order(other.order), top_level(other.top_level),
+    surpluses(other.surpluses), points(other.points), needed(other.needed), values(other.values), parents(other.parents),
+    roots(other.roots), pntr(other.pntr), indx(other.indx), sparse_affinity(other.sparse_affinity){
+    if (other.rule) makeRule(other.rule->getType());
+}
 GridLocalPolynomial::~GridLocalPolynomial(){}
 
 void GridLocalPolynomial::reset(bool clear_rule){
@@ -77,14 +87,14 @@ template<bool useAscii> void GridLocalPolynomial::write(std::ostream &os) const{
     if (!points.empty()) points.write<useAscii>(os);
     if (useAscii){ // backwards compatible: surpluses and needed, or needed and surpluses
         IO::writeFlag<useAscii, IO::pad_auto>((surpluses.getNumStrips() != 0), os);
-        if (surpluses.getNumStrips() != 0) IO::writeVector<useAscii, IO::pad_line>(surpluses.getVector(), os);
+        if (surpluses.getNumStrips() != 0) surpluses.write<useAscii, IO::pad_line>(os);
         IO::writeFlag<useAscii, IO::pad_auto>(!needed.empty(), os);
         if (!needed.empty()) needed.write<useAscii>(os);
     }else{
         IO::writeFlag<useAscii, IO::pad_auto>(!needed.empty(), os);
         if (!needed.empty()) needed.write<useAscii>(os);
         IO::writeFlag<useAscii, IO::pad_auto>((surpluses.getNumStrips() != 0), os);
-        if (surpluses.getNumStrips() != 0) IO::writeVector<useAscii, IO::pad_line>(surpluses.getVector(), os);
+        if (surpluses.getNumStrips() != 0) surpluses.write<useAscii, IO::pad_line>(os);
     }
     IO::writeFlag<useAscii, IO::pad_auto>((parents.getNumStrips() != 0), os);
     if (parents.getNumStrips() != 0) IO::writeVector<useAscii, IO::pad_line>(parents.getVector(), os);
@@ -111,15 +121,13 @@ template<bool useAscii> void GridLocalPolynomial::read(std::istream &is){
     if (IO::readFlag<useAscii>(is)) points.read<useAscii>(is);
     if (useAscii){ // backwards compatible: surpluses and needed, or needed and surpluses
         if (IO::readFlag<useAscii>(is)){
-            surpluses.resize(num_outputs, points.getNumIndexes());
-            IO::readVector<useAscii>(is, surpluses.getVector());
+            surpluses.read<useAscii>(is, num_outputs, points.getNumIndexes());
         }
         if (IO::readFlag<useAscii>(is)) needed.read<useAscii>(is);
     }else{
         if (IO::readFlag<useAscii>(is)) needed.read<useAscii>(is);
         if (IO::readFlag<useAscii>(is)){
-            surpluses.resize(num_outputs, points.getNumIndexes());
-            IO::readVector<useAscii>(is, surpluses.getVector());
+            surpluses.read<useAscii>(is, num_outputs, points.getNumIndexes());
         }
     }
     if (IO::readFlag<useAscii>(is)){
@@ -177,28 +185,6 @@ void GridLocalPolynomial::makeGrid(int cnum_dimensions, int cnum_outputs, int de
     }
 }
 
-void GridLocalPolynomial::copyGrid(const GridLocalPolynomial *pwpoly){
-    reset();
-    num_dimensions = pwpoly->num_dimensions;
-    num_outputs = pwpoly->num_outputs;
-    order = pwpoly->order;
-
-    makeRule(pwpoly->rule->getType());
-
-    points = pwpoly->points;
-    needed = pwpoly->needed;
-    parents = pwpoly->parents;
-
-    buildTree();
-
-    values = pwpoly->values;
-
-    if ((!points.empty()) && (num_outputs > 0)){ // points are loaded
-        surpluses.resize(num_outputs, points.getNumIndexes());
-        surpluses.getVector() = pwpoly->surpluses.getVector(); // copy assignment
-    }
-}
-
 GridLocalPolynomial::GridLocalPolynomial(int cnum_dimensions, int cnum_outputs, int corder, TypeOneDRule crule,
                                          std::vector<int> &pnts, std::vector<double> &vals, std::vector<double> &surps) :
         num_dimensions(cnum_dimensions), num_outputs(cnum_outputs), order(corder), sparse_affinity(0){
@@ -264,9 +250,8 @@ void GridLocalPolynomial::evaluateBatch(const double x[], int num_x, double y[])
         evaluate(xwrap.getStrip(i), ywrap.getStrip(i));
 }
 
-#ifdef Tasmanian_ENABLE_BLAS
 void GridLocalPolynomial::evaluateBlas(const double x[], int num_x, double y[]) const{
-    if ((sparse_affinity == 1) || ((sparse_affinity == 0) && (num_outputs <= TSG_LOCALP_BLAS_NUM_OUTPUTS))){
+    if ((sparse_affinity == 1) || ((sparse_affinity == 0) && !useSparseMatrix())){
         evaluateBatch(x, num_x, y);
         return;
     }
@@ -276,10 +261,8 @@ void GridLocalPolynomial::evaluateBlas(const double x[], int num_x, double y[])
     buildSpareBasisMatrix(x, num_x, 32, spntr, sindx, svals); // build sparse matrix corresponding to x
 
     int num_points = points.getNumIndexes();
-    double nnz = (double) spntr[num_x];
-    double total_size = ((double) num_x) * ((double) num_points);
 
-    if ((sparse_affinity == -1) || ((sparse_affinity == 0) && (nnz / total_size > 0.1))){
+    if ((sparse_affinity == -1) || ((sparse_affinity == 0) && useDenseMatrix(num_x, spntr[num_x]))){
         // potentially wastes a lot of memory
         Data2D<double> A(num_points, num_x, 0.0);
         for(int i=0; i<num_x; i++){
@@ -288,20 +271,21 @@ void GridLocalPolynomial::evaluateBlas(const double x[], int num_x, double y[])
         }
         TasBLAS::denseMultiply(num_outputs, num_x, num_points, 1.0, surpluses.getStrip(0), A.getStrip(0), 0.0, y);
     }else{
-        Utils::Wrapper2D<double> ywrap(num_outputs, y);
-        #pragma omp parallel for
-        for(int i=0; i<num_x; i++){
-            double *this_y = ywrap.getStrip(i);
-            std::fill(this_y, this_y + num_outputs, 0.0);
-            for(int j=spntr[i]; j<spntr[i+1]; j++){
-                double v = svals[j];
-                const double *s = surpluses.getStrip(sindx[j]);
-                for(int k=0; k<num_outputs; k++) this_y[k] += v * s[k];
-            }
-        }
+        TasBLAS::sparseMultiply(num_outputs, num_x, 1.0, surpluses.getStrip(0), spntr.data(), sindx.data(), svals.data(), y);
     }
 }
-#endif
+
+bool GridLocalPolynomial::useSparseMatrix() const{
+    // both algorithms visit the same nodes, the matrix pays for storing the non-zeros but uses the faster multiply-add
+    double walk_cost   = TSG_LOCALP_COST_WALK_FLOP * ((double) num_outputs);
+    double matrix_cost = TSG_LOCALP_COST_SPARSE_FLOP * ((double) num_outputs) + TSG_LOCALP_COST_SPARSE_ENTRY * ((double) num_dimensions);
+    return (matrix_cost < walk_cost);
+}
+bool GridLocalPolynomial::useDenseMatrix(int num_x, int num_nz) const{
+    double dense_cost  = ((double) num_x) * ((double) points.getNumIndexes()) * (((double) num_outputs) + TSG_LOCALP_COST_DENSE_ENTRY);
+    double sparse_cost = TSG_LOCALP_COST_SPARSE_FLOP * ((double) num_nz) * ((double) num_outputs);
+    return (dense_cost < sparse_cost);
+}
 
 #ifdef Tasmanian_ENABLE_CUDA
 void GridLocalPolynomial::loadNeededPointsCuda(CudaEngine *engine, const double *vals){
@@ -352,7 +336,7 @@ void GridLocalPolynomial::loadNeededPointsCuda(CudaEngine *engine, const double
         cumulative_poitns.addMultiIndexSet(level_points);
     }
 
-    surpluses = Data2D<double>(num_outputs, points.getNumIndexes(), cumulative_surpluses.getVector());
+    surpluses = Data2D<double>(num_outputs, points.getNumIndexes(), cumulative_surpluses.getMutableVector());
 }
 void GridLocalPolynomial::evaluateCudaMixed(CudaEngine *engine, const double x[], int num_x, double y[]) const{
     loadCudaSurpluses();
@@ -454,16 +438,16 @@ void GridLocalPolynomial::beginConstruction(){
         indx.clear();
     }
 }
-void GridLocalPolynomial::writeConstructionDataBinary(std::ofstream &ofs) const{
+void GridLocalPolynomial::writeConstructionDataBinary(std::ostream &ofs) const{
     dynamic_values->write<false>(ofs);
 }
-void GridLocalPolynomial::writeConstructionData(std::ofstream &ofs) const{
+void GridLocalPolynomial::writeConstructionData(std::ostream &ofs) const{
     dynamic_values->write<true>(ofs);
 }
-void GridLocalPolynomial::readConstructionDataBinary(std::ifstream &ifs){
+void GridLocalPolynomial::readConstructionDataBinary(std::istream &ifs){
     dynamic_values = readSimpleConstructionData<false>(num_dimensions, num_outputs, ifs);
 }
-void GridLocalPolynomial::readConstructionData(std::ifstream &ifs){
+void GridLocalPolynomial::readConstructionData(std::istream &ifs){
     dynamic_values = readSimpleConstructionData<true>(num_dimensions, num_outputs, ifs);
 }
 void GridLocalPolynomial::getCandidateConstructionPoints(double tolerance, TypeRefinement criteria, int output,
@@ -803,108 +787,117 @@ double GridLocalPolynomial::evalBasisSupported(const int point[], const double x
 }
 
 void GridLocalPolynomial::buildSpareBasisMatrix(const double x[], int num_x, int num_chunk, int* &spntr, int* &sindx, double* &svals) const{
+    std::vector<int> arena_begin;
     std::vector<std::vector<int>> tindx;
     std::vector<std::vector<double>> tvals;
-    std::vector<int> numnz;
-    buildSparseMatrixBlockForm(x, num_x, num_chunk, numnz, tindx, tvals);
 
     spntr = new int[num_x + 1];
+    buildSparseMatrixArenas(x, num_x, num_chunk, spntr, arena_begin, tindx, tvals);
 
-    int nz = 0;
-    for(int i=0; i<num_x; i++){
-        spntr[i] = nz;
-        nz += numnz[i];
-    }
-    spntr[num_x] = nz;
-
-    sindx = new int[nz];
-    svals = new double[nz];
-
-    int c = 0;
-    for(auto &idx : tindx) for(auto i: idx) sindx[c++] = i;
-    c = 0;
-    for(auto &vls : tvals) for(auto v: vls) svals[c++] = v;
+    sindx = new int[spntr[num_x]];
+    svals = new double[spntr[num_x]];
+    copySparseMatrixArenas(arena_begin, spntr, tindx, tvals, sindx, svals);
 }
 void GridLocalPolynomial::buildSpareBasisMatrix(const double x[], int num_x, int num_chunk, std::vector<int> &spntr, std::vector<int> &sindx, std::vector<double> &svals) const{
+    std::vector<int> arena_begin;
     std::vector<std::vector<int>> tindx;
     std::vector<std::vector<double>> tvals;
-    std::vector<int> numnz;
-    buildSparseMatrixBlockForm(x, num_x, num_chunk, numnz, tindx, tvals);
 
     spntr.resize(num_x + 1);
+    buildSparseMatrixArenas(x, num_x, num_chunk, spntr.data(), arena_begin, tindx, tvals);
 
-    int nz = 0;
-    auto inz = numnz.begin();
-    for(auto &s: spntr){
-        s = nz;
-        nz += *inz++;
-    }
-
-    sindx.resize(nz);
-    svals.resize(nz);
-
-    auto ii = sindx.begin();
-    for(auto &idx : tindx) for(auto i: idx) *ii++ = i;
-    auto iv = svals.begin();
-    for(auto &vls : tvals) for(auto v: vls) *iv++ = v;
+    sindx.resize(spntr[num_x]);
+    svals.resize(spntr[num_x]);
+    copySparseMatrixArenas(arena_begin, spntr.data(), tindx, tvals, sindx.data(), svals.data());
 }
 void GridLocalPolynomial::buildSpareBasisMatrixStatic(const double x[], int num_x, int num_chunk, int *spntr, int *sindx, double *svals) const{
+    std::vector<int> arena_begin;
     std::vector<std::vector<int>> tindx;
     std::vector<std::vector<double>> tvals;
-    std::vector<int> numnz;
-    buildSparseMatrixBlockForm(x, num_x, num_chunk, numnz, tindx, tvals);
 
-    int nz = 0;
-    for(int i=0; i<num_x; i++){
-        spntr[i] = nz;
-        nz += numnz[i];
-    }
-    spntr[num_x] = nz;
-    int c = 0;
-    for(auto &idx : tindx) for(auto i: idx) sindx[c++] = i;
-    c = 0;
-    for(auto &vls : tvals) for(auto v: vls) svals[c++] = v;
+    buildSparseMatrixArenas(x, num_x, num_chunk, spntr, arena_begin, tindx, tvals);
+    copySparseMatrixArenas(arena_begin, spntr, tindx, tvals, sindx, svals);
 }
 int GridLocalPolynomial::getSpareBasisMatrixNZ(const double x[], int num_x) const{
     const MultiIndexSet &work = (points.empty()) ? needed : points;
 
     Utils::Wrapper2D<double const> xwrap(num_dimensions, x);
-    std::vector<int> num_nz(num_x);
+    int num_nz = 0;
 
-    #pragma omp parallel for
-    for(int i=0; i<num_x; i++){
-        std::vector<int> sindx;
+    #pragma omp parallel
+    {
+        std::vector<int> sindx; // reused by all points handled by this thread
         std::vector<double> svals;
-        walkTree<1>(work, xwrap.getStrip(i), sindx, svals, nullptr);
-        num_nz[i] = (int) sindx.size();
+
+        #pragma omp for reduction(+:num_nz)
+        for(int i=0; i<num_x; i++){
+            sindx.clear();
+            svals.clear();
+            walkTree<1>(work, xwrap.getStrip(i), sindx, svals, nullptr);
+            num_nz += (int) sindx.size();
+        }
     }
 
-    return std::accumulate(num_nz.begin(), num_nz.end(), 0);
+    return num_nz;
 }
 
-void GridLocalPolynomial::buildSparseMatrixBlockForm(const double x[], int num_x, int num_chunk, std::vector<int> &numnz, std::vector<std::vector<int>> &tindx, std::vector<std::vector<double>> &tvals) const{
-    // numnz will be resized to (num_x + 1) with the last entry set to a dummy zero
-    numnz.resize(num_x + 1);
-    int num_blocks = num_x / num_chunk + ((num_x % num_chunk != 0) ? 1 : 0);
-
-    tindx.resize(num_blocks);
-    tvals.resize(num_blocks);
-
+void GridLocalPolynomial::buildSparseMatrixArenas(const double x[], int num_x, int num_chunk, int spntr[], std::vector<int> &arena_begin,
+                                                  std::vector<std::vector<int>> &tindx, std::vector<std::vector<double>> &tvals) const{
     const MultiIndexSet &work = (points.empty()) ? needed : points;
     Utils::Wrapper2D<double const> xwrap(num_dimensions, x);
 
-    #pragma omp parallel for
-    for(int b=0; b<num_blocks; b++){
-        tindx[b].resize(0);
-        tvals[b].resize(0);
-        int chunk_size = (b < num_blocks - 1) ? num_chunk : (num_x - (num_blocks - 1) * num_chunk);
-        for(int i = b * num_chunk; i < b * num_chunk + chunk_size; i++){
-            numnz[i] = (int) tindx[b].size();
-            walkTree<1>(work, xwrap.getStrip(i), tindx[b], tvals[b], nullptr);
-            numnz[i] = (int) tindx[b].size() - numnz[i];
+    int max_arenas = 1;
+    #ifdef _OPENMP
+    max_arenas = omp_get_max_threads();
+    #endif
+    int num_arenas = std::max(1, std::min(max_arenas, num_x / std::max(num_chunk, 1)));
+
+    arena_begin.resize(num_arenas + 1);
+    for(int a=0; a<=num_arenas; a++)
+        arena_begin[a] = (int) ((((long long) a) * ((long long) num_x)) / ((long long) num_arenas));
+
+    tindx.resize(num_arenas);
+    tvals.resize(num_arenas);
+
+    // phase one: each arena walks its points once, spntr[i+1] holds the offset local to the arena
+    #pragma omp parallel for schedule(static, 1)
+    for(int a=0; a<num_arenas; a++){
+        std::vector<int> &idx = tindx[a];
+        std::vector<double> &vls = tvals[a];
+        idx.clear();
+        vls.clear();
+        for(int i=arena_begin[a]; i<arena_begin[a+1]; i++){
+            walkTree<1>(work, xwrap.getStrip(i), idx, vls, nullptr);
+            spntr[i+1] = (int) idx.size();
+            if (i == arena_begin[a]){ // use the first point to guess the size of the arena
+                size_t guess = idx.size() * ((size_t) (arena_begin[a+1] - arena_begin[a]));
+                idx.reserve(guess);
+                vls.reserve(guess);
+            }
         }
     }
-    numnz[num_x] = 0;
+
+    // phase two: prefix sum across the arenas, then shift the local offsets
+    std::vector<int> arena_offset(num_arenas + 1);
+    arena_offset[0] = 0;
+    for(int a=0; a<num_arenas; a++) arena_offset[a+1] = arena_offset[a] + (int) tindx[a].size();
+
+    spntr[0] = 0;
+    #pragma omp parallel for schedule(static, 1)
+    for(int a=0; a<num_arenas; a++){
+        int offset = arena_offset[a];
+        if (offset > 0) for(int i=arena_begin[a]+1; i<=arena_begin[a+1]; i++) spntr[i] += offset;
+    }
+}
+void GridLocalPolynomial::copySparseMatrixArenas(std::vector<int> const &arena_begin, const int spntr[],
+                                                 std::vector<std::vector<int>> const &tindx, std::vector<std::vector<double>> const &tvals, int sindx[], double svals[]){
+    int num_arenas = (int) tindx.size();
+    #pragma omp parallel for schedule(static, 1)
+    for(int a=0; a<num_arenas; a++){
+        int offset = spntr[arena_begin[a]];
+        std::copy(tindx[a].begin(), tindx[a].end(), sindx + offset);
+        std::copy(tvals[a].begin(), tvals[a].end(), svals + offset);
+    }
 }
 
 #ifdef Tasmanian_ENABLE_CUDA
@@ -1322,8 +1315,15 @@ void GridLocalPolynomial::addChildLimited(const int point[], int direction, cons
 }
 
 void GridLocalPolynomial::clearRefinement(){ needed = MultiIndexSet(); }
+void GridLocalPolynomial::freezeForEvaluation(bool keep_values){
+    clearRefinement();
+    dynamic_values.reset();
+    parents = Data2D<int>(); // evaluations walk only the roots, pntr and indx tree, the weights recompute the parents on demand
+    surpluses.getVector().shrink_to_fit();
+    if (keep_values) values.shrinkToFit(); else values = StorageSet(); // the surpluses are sufficient
+}
 const double* GridLocalPolynomial::getSurpluses() const{
-    return surpluses.getVector().data();
+    return surpluses.getStrip(0);
 }
 const int* GridLocalPolynomial::getPointIndexes() const{
     return ((points.empty()) ? needed.getIndex(0) : points.getIndex(0));
@@ -1372,13 +1372,13 @@ int GridLocalPolynomial::removePointsByHierarchicalCoefficient(double tolerance,
 
     StorageSet values_kept;
     values_kept.resize(num_outputs, num_kept);
-    values_kept.getVector().resize(Utils::size_mult(num_kept, num_outputs));
+    values_kept.getMutableVector().resize(Utils::size_mult(num_kept, num_outputs));
 
     num_kept = 0;
     for(int i=0; i<num_points; i++){
         if (pmap[i]){
             std::copy_n(points.getIndex(i), num_dimensions, point_kept.getStrip(num_kept));
-            std::copy_n(values.getValues(i), num_outputs, values_kept.getValues(num_kept));
+            std::copy_n(values.getValues(i), num_outputs, values_kept.getMutableValues(num_kept));
             num_kept++;
         }
     }
@@ -1413,12 +1413,13 @@ void GridLocalPolynomial::setHierarchicalCoefficients(const double c[], TypeAcce
     surpluses.resize(num_outputs, getNumPoints());
     std::copy_n(c, surpluses.getTotalEntries(), surpluses.getVector().data());
 
-    std::vector<double> &vals = values.getVector();
-    vals.resize(surpluses.getTotalEntries());
+    std::vector<double> vals(surpluses.getTotalEntries()); // replaces the values, the old ones may be shared with copies of the grid
 
     std::vector<double> x(((size_t) getNumPoints()) * ((size_t) num_dimensions));
     getPoints(x.data());
     evaluateBatch(x.data(), points.getNumIndexes(), vals.data());
+    values.resize(num_outputs, getNumPoints());
+    values.setValues(vals);
 }
 
 void GridLocalPolynomial::clearAccelerationData(){
@@ -63,6 +63,7 @@ namespace TasGrid{
 class GridLocalPolynomial : public BaseCanonicalGrid{
 public:
     GridLocalPolynomial();
+    GridLocalPolynomial(const GridLocalPolynomial &other); // shares the read-only index sets and values, see MultiIndexSet and StorageSet
     ~GridLocalPolynomial();
 
     bool isLocalPolynomial() const{ return true; }
@@ -71,7 +72,6 @@ public:
     template<bool useAscii> void read(std::istream &is);
 
     void makeGrid(int cnum_dimensions, int cnum_outputs, int depth, int corder, TypeOneDRule crule, const std::vector<int> &level_limits);
-    void copyGrid(const GridLocalPolynomial *pwpoly);
 
     int getNumDimensions() const;
     int getNumOutputs() const;
@@ -96,9 +96,7 @@ public:
 
     void evaluateBatch(const double x[], int num_x, double y[]) const;
 
-    #ifdef Tasmanian_ENABLE_BLAS
     void evaluateBlas(const double x[], int num_x, double y[]) const;
-    #endif
 
     #ifdef Tasmanian_ENABLE_CUDA
     void loadNeededPointsCuda(CudaEngine *engine, const double *vals);
@@ -109,13 +107,14 @@ public:
     void setSurplusRefinement(double tolerance, TypeRefinement criteria, int output, const std::vector<int> &level_limits, const double *scale_correction);
     void clearRefinement();
     void mergeRefinement();
+    void freezeForEvaluation(bool keep_values);
     int removePointsByHierarchicalCoefficient(double tolerance, int output, const double *scale_correction); // returns the number of points kept
 
     void beginConstruction();
-    void writeConstructionDataBinary(std::ofstream &ofs) const;
-    void writeConstructionData(std::ofstream &ofs) const;
-    void readConstructionDataBinary(std::ifstream &ifs);
-    void readConstructionData(std::ifstream &ifs);
+    void writeConstructionDataBinary(std::ostream &ofs) const;
+    void writeConstructionData(std::ostream &ofs) const;
+    void readConstructionDataBinary(std::istream &ifs);
+    void readConstructionData(std::istream &ifs);
     void getCandidateConstructionPoints(double tolerance, TypeRefinement criteria, int output, std::vector<int> const &level_limits, double const *scale_correction, std::vector<double> &x);
     void loadConstructedPoint(const double x[], const std::vector<double> &y);
     void finishConstruction();
@@ -157,6 +156,12 @@ protected:
     //! \brief Tuning decision whether to use sparse or dense.
     bool useDense() const{ return (sparse_affinity == -1) || ((sparse_affinity == 0) && (num_dimensions > 6)); }
 
+    //! \brief Cost model for evaluateBlas(), returns \b true if forming the sparse basis matrix is cheaper than walking the tree for each point.
+    bool useSparseMatrix() const;
+
+    //! \brief Cost model for evaluateBlas(), returns \b true if the dense algorithm is cheaper given the number of non-zeros of the sparse basis matrix.
+    bool useDenseMatrix(int num_x, int num_nz) const;
+
     void buildTree();
 
     //! \brief Returns a list of indexes of the nodes in \b points that are descendants of the \b point.
@@ -181,8 +186,19 @@ protected:
      */
     void updateSurpluses(MultiIndexSet const &work, int max_level, std::vector<int> const &level, Data2D<int> const &dagUp);
 
-    void buildSparseMatrixBlockForm(const double x[], int num_x, int num_chunk, std::vector<int> &numnz,
-                                    std::vector<std::vector<int>> &tindx, std::vector<std::vector<double>> &tvals) const;
+    /*!
+     * \brief Walks the trees once for all points in \b x and collects the sparse basis matrix into per-thread arenas.
+     *
+     * The points are split into contiguous ranges (one per OpenMP thread, but at least \b num_chunk points per range),
+     * \b arena_begin holds the first point of each range and \b tindx and \b tvals hold the indexes and values for the range.
+     * On exit, \b spntr (of size \b num_x + 1) holds the final CSR row pointers computed with a prefix sum over the arenas,
+     * the total number of non-zeros is \b spntr[num_x].
+     */
+    void buildSparseMatrixArenas(const double x[], int num_x, int num_chunk, int spntr[], std::vector<int> &arena_begin,
+                                 std::vector<std::vector<int>> &tindx, std::vector<std::vector<double>> &tvals) const;
+    //! \brief Copy the arenas from \b buildSparseMatrixArenas() into the CSR arrays \b sindx and \b svals, the copy is done in parallel.
+    static void copySparseMatrixArenas(std::vector<int> const &arena_begin, const int spntr[],
+                                       std::vector<std::vector<int>> const &tindx, std::vector<std::vector<double>> const &tvals, int sindx[], double svals[]);
 
     /*!
      * \brief Walk through all the nodes of the tree and touches only the nodes supported at \b x.
@@ -353,7 +369,7 @@ protected:
     void loadCudaSurpluses() const{
         if (!cuda_cache) cuda_cache = std::unique_ptr<CudaLocalPolynomialData<double>>(new CudaLocalPolynomialData<double>);
         if (cuda_cache->surpluses.size() != 0) return;
-        cuda_cache->surpluses.load(surpluses.getVector());
+        cuda_cache->surpluses.load(surpluses.getTotalEntries(), surpluses.getStrip(0));
     }
     void clearCudaSurpluses(){ if (cuda_cache) cuda_cache->surpluses.clear(); }
     #endif
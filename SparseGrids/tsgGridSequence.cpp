@@ -39,6 +39,10 @@
 namespace TasGrid{
 
 GridSequence::GridSequence() : num_dimensions(0), num_outputs(0){}
+GridSequence::GridSequence(const GridSequence &other) :
+    num_dimensions(other.num_dimensions), num_outputs(other.num_outputs), rule(other.rule),
+    points(other.points), needed(other.needed), surpluses(other.surpluses), nodes(other.nodes), coeff(other.coeff),
+    values(other.values), max_levels(other.max_levels){}
 GridSequence::~GridSequence(){}
 
 template<bool useAscii> void GridSequence::write(std::ostream &os) const{
@@ -52,12 +56,12 @@ template<bool useAscii> void GridSequence::write(std::ostream &os) const{
     if (!needed.empty()) needed.write<useAscii>(os);
 
     IO::writeFlag<useAscii, IO::pad_auto>(!surpluses.empty(), os);
-    if (!surpluses.empty()) IO::writeVector<useAscii, IO::pad_line>(surpluses.getVector(), os);
+    if (!surpluses.empty()) surpluses.write<useAscii, IO::pad_line>(os);
 
     if (num_outputs > 0) values.write<useAscii>(os);
 }
 
-template<bool useAscii> void GridSequence::read(std::ifstream &is){
+template<bool useAscii> void GridSequence::read(std::istream &is){
     reset();
     num_dimensions = IO::readNumber<useAscii, int>(is);
     num_outputs = IO::readNumber<useAscii, int>(is);
@@ -67,8 +71,7 @@ template<bool useAscii> void GridSequence::read(std::ifstream &is){
     if (IO::readFlag<useAscii>(is)) needed.read<useAscii>(is);
 
     if (IO::readFlag<useAscii>(is)){
-        surpluses.resize(num_outputs, points.getNumIndexes());
-        IO::readVector<useAscii>(is, surpluses.getVector());
+        surpluses.read<useAscii>(is, num_outputs, points.getNumIndexes());
     }
 
     if (num_outputs > 0) values.read<useAscii>(is);
@@ -78,8 +81,8 @@ template<bool useAscii> void GridSequence::read(std::ifstream &is){
 
 template void GridSequence::write<true>(std::ostream &) const;
 template void GridSequence::write<false>(std::ostream &) const;
-template void GridSequence::read<true>(std::ifstream &);
-template void GridSequence::read<false>(std::ifstream &);
+template void GridSequence::read<true>(std::istream &);
+template void GridSequence::read<false>(std::istream &);
 
 void GridSequence::reset(){
     clearAccelerationData();
@@ -91,6 +94,12 @@ void GridSequence::reset(){
     surpluses = Data2D<double>();
 }
 void GridSequence::clearRefinement(){ needed = MultiIndexSet(); }
+void GridSequence::freezeForEvaluation(bool){ // the values are used by the evaluations or the anisotropic estimates
+    clearRefinement();
+    dynamic_values.reset();
+    surpluses.getVector().shrink_to_fit();
+    values.shrinkToFit();
+}
 
 void GridSequence::makeGrid(int cnum_dimensions, int cnum_outputs, int depth, TypeDepth type, TypeOneDRule crule,
                             const std::vector<int> &anisotropic_weights, const std::vector<int> &level_limits){
@@ -104,26 +113,6 @@ void GridSequence::makeGrid(int cnum_dimensions, int cnum_outputs, int depth, Ty
 
     setPoints(pset, cnum_outputs, crule);
 }
-void GridSequence::copyGrid(const GridSequence *seq){
-    MultiIndexSet pset;
-    if (seq->points.empty()){
-        pset = seq->needed;
-    }else{
-        pset = seq->points;
-    }
-    setPoints(pset, seq->num_outputs, seq->rule);
-
-    if ((num_outputs > 0) && (!seq->points.empty())){ // if there are values inside the source object
-        loadNeededPoints(seq->values.getValues(0));
-    }
-
-    if ((!seq->points.empty()) && (!seq->needed.empty())){ // there is a refinement
-        needed = seq->needed;
-        prepareSequence(0);
-    }
-    surpluses = seq->surpluses;
-}
-
 void GridSequence::setPoints(MultiIndexSet &pset, int cnum_outputs, TypeOneDRule crule){
     reset();
     num_dimensions = (int) pset.getNumDimensions();
@@ -264,16 +253,16 @@ void GridSequence::beginConstruction(){
         needed = MultiIndexSet();
     }
 }
-void GridSequence::writeConstructionDataBinary(std::ofstream &ofs) const{
+void GridSequence::writeConstructionDataBinary(std::ostream &ofs) const{
     dynamic_values->write<false>(ofs);
 }
-void GridSequence::writeConstructionData(std::ofstream &ofs) const{
+void GridSequence::writeConstructionData(std::ostream &ofs) const{
     dynamic_values->write<true>(ofs);
 }
-void GridSequence::readConstructionDataBinary(std::ifstream &ifs){
+void GridSequence::readConstructionDataBinary(std::istream &ifs){
     dynamic_values = readSimpleConstructionData<false>(num_dimensions, num_outputs, ifs);
 }
-void GridSequence::readConstructionData(std::ifstream &ifs){
+void GridSequence::readConstructionData(std::istream &ifs){
     dynamic_values = readSimpleConstructionData<true>(num_dimensions, num_outputs, ifs);
 }
 void GridSequence::getCandidateConstructionPoints(TypeDepth type, const std::vector<int> &anisotropic_weights, std::vector<double> &x, const std::vector<int> &level_limits){
@@ -463,7 +452,6 @@ void GridSequence::evaluateBatch(const double x[], int num_x, double y[]) const{
         evaluate(xwrap.getStrip(i), ywrap.getStrip(i));
 }
 
-#ifdef Tasmanian_ENABLE_BLAS
 void GridSequence::evaluateBlas(const double x[], int num_x, double y[]) const{
     int num_points = points.getNumIndexes();
     Data2D<double> weights; weights.resize(num_points, num_x);
@@ -474,7 +462,6 @@ void GridSequence::evaluateBlas(const double x[], int num_x, double y[]) const{
     }
     TasBLAS::denseMultiply(num_outputs, num_x, num_points, 1.0, surpluses.getStrip(0), weights.getStrip(0), 0.0, y);
 }
-#endif // Tasmanian_ENABLE_BLAS
 
 #ifdef Tasmanian_ENABLE_CUDA
 void GridSequence::loadNeededPointsCuda(CudaEngine *, const double *vals){
@@ -576,13 +563,14 @@ void GridSequence::setHierarchicalCoefficients(const double c[], TypeAcceleratio
         points = std::move(needed);
         needed = MultiIndexSet();
     }
-    std::vector<double> &vals = values.getVector();
-    vals.resize(num_vals);
+    std::vector<double> vals(num_vals); // replaces the values, the old ones may be shared with copies of the grid
     surpluses.resize(num_outputs, num_ponits);
     std::copy_n(c, num_vals, surpluses.getVector().data());
     std::vector<double> x(((size_t) num_ponits) * ((size_t) num_dimensions));
     getPoints(x.data());
     evaluateBatch(x.data(), points.getNumIndexes(), vals.data()); // speed this up later
+    values.resize(num_outputs, num_ponits);
+    values.setValues(vals);
 //     switch(acc){
 //         #ifdef Tasmanian_ENABLE_BLAS
 //         case accel_cpu_blas: evaluateBatchCPUblas(x.data(), points.getNumIndexes(), vals.data()); break;
@@ -761,7 +749,7 @@ void GridSequence::getPolynomialSpace(bool interpolation, int &n, int* &poly) co
     std::copy(result.getVector().begin(), result.getVector().end(), poly);
 }
 const double* GridSequence::getSurpluses() const{
-    return surpluses.getVector().data();
+    return surpluses.getStrip(0);
 }
 const int* GridSequence::getPointIndexes() const{
     return ((points.empty()) ? needed.getIndex(0) : points.getIndex(0));
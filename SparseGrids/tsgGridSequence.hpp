@@ -51,15 +51,15 @@ namespace TasGrid{
 class GridSequence : public BaseCanonicalGrid{
 public:
     GridSequence();
+    GridSequence(const GridSequence &other); // shares the read-only index sets and values, see MultiIndexSet and StorageSet
     ~GridSequence();
 
     bool isSequence() const{ return true; }
 
     template<bool useAscii> void write(std::ostream &os) const;
-    template<bool useAscii> void read(std::ifstream &is);
+    template<bool useAscii> void read(std::istream &is);
 
     void makeGrid(int cnum_dimensions, int cnum_outputs, int depth, TypeDepth type, TypeOneDRule crule, const std::vector<int> &anisotropic_weights, const std::vector<int> &level_limits);
-    void copyGrid(const GridSequence *seq);
     void setPoints(MultiIndexSet &pset, int cnum_outputs, TypeOneDRule crule);
 
     void updateGrid(int depth, TypeDepth type, const std::vector<int> &anisotropic_weights, const std::vector<int> &level_limits);
@@ -87,9 +87,7 @@ public:
 
     void evaluateBatch(const double x[], int num_x, double y[]) const;
 
-    #ifdef Tasmanian_ENABLE_BLAS
     void evaluateBlas(const double x[], int num_x, double y[]) const;
-    #endif
 
     #ifdef Tasmanian_ENABLE_CUDA
     void loadNeededPointsCuda(CudaEngine *engine, const double *vals);
@@ -107,12 +105,13 @@ public:
     void setSurplusRefinement(double tolerance, int output, const std::vector<int> &level_limits);
     void clearRefinement();
     void mergeRefinement();
+    void freezeForEvaluation(bool keep_values);
 
     void beginConstruction();
-    void writeConstructionDataBinary(std::ofstream &ofs) const;
-    void writeConstructionData(std::ofstream &ofs) const;
-    void readConstructionDataBinary(std::ifstream &ifs);
-    void readConstructionData(std::ifstream &ifs);
+    void writeConstructionDataBinary(std::ostream &ofs) const;
+    void writeConstructionData(std::ostream &ofs) const;
+    void readConstructionDataBinary(std::istream &ifs);
+    void readConstructionData(std::istream &ifs);
     void getCandidateConstructionPoints(TypeDepth type, const std::vector<int> &weights, std::vector<double> &x, const std::vector<int> &level_limits);
     void getCandidateConstructionPoints(TypeDepth type, int output, std::vector<double> &x, const std::vector<int> &level_limits);
     void getCandidateConstructionPoints(std::function<double(const int *)> getTensorWeight, std::vector<double> &x, const std::vector<int> &level_limits);
@@ -193,7 +192,7 @@ protected:
     }
     void loadCudaSurpluses() const{
         if (!cuda_cache) cuda_cache = std::unique_ptr<CudaSequenceData<double>>(new CudaSequenceData<double>);
-        if (cuda_cache->surpluses.empty()) cuda_cache->surpluses.load(surpluses.getVector());
+        if (cuda_cache->surpluses.empty()) cuda_cache->surpluses.load(surpluses.getTotalEntries(), surpluses.getStrip(0));
     }
     void clearCudaSurpluses(){ if (cuda_cache) cuda_cache->surpluses.clear(); }
     #endif
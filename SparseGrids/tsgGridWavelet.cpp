@@ -42,6 +42,9 @@
 namespace TasGrid{
 
 GridWavelet::GridWavelet() : rule1D(1, 10), num_dimensions(0), num_outputs(0), order(1){}
+GridWavelet::GridWavelet(const GridWavelet &other) :
+    rule1D(other.rule1D), num_dimensions(other.num_dimensions), num_outputs(other.num_outputs), order(other.order),
+    coefficients(other.coefficients), points(other.points), needed(other.needed), values(other.values), inter_matrix(other.inter_matrix){}
 GridWavelet::~GridWavelet(){}
 
 void GridWavelet::reset(){
@@ -59,14 +62,14 @@ template<bool useAscii> void GridWavelet::write(std::ostream &os) const{
     if (!points.empty()) points.write<useAscii>(os);
     if (useAscii){ // backwards compatible: surpluses and needed, or needed and surpluses
         IO::writeFlag<useAscii, IO::pad_auto>((coefficients.getNumStrips() != 0), os);
-        if (coefficients.getNumStrips() != 0) IO::writeVector<useAscii, IO::pad_line>(coefficients.getVector(), os);
+        if (coefficients.getNumStrips() != 0) coefficients.write<useAscii, IO::pad_line>(os);
         IO::writeFlag<useAscii, IO::pad_auto>(!needed.empty(), os);
         if (!needed.empty()) needed.write<useAscii>(os);
     }else{
         IO::writeFlag<useAscii, IO::pad_auto>(!needed.empty(), os);
         if (!needed.empty()) needed.write<useAscii>(os);
         IO::writeFlag<useAscii, IO::pad_auto>((coefficients.getNumStrips() != 0), os);
-        if (coefficients.getNumStrips() != 0) IO::writeVector<useAscii, IO::pad_line>(coefficients.getVector(), os);
+        if (coefficients.getNumStrips() != 0) coefficients.write<useAscii, IO::pad_line>(os);
     }
 
     if (num_outputs > 0) values.write<useAscii>(os);
@@ -81,15 +84,13 @@ template<bool useAscii> void GridWavelet::read(std::istream &is){
     if (IO::readFlag<useAscii>(is)) points.read<useAscii>(is);
     if (useAscii){ // backwards compatible: surpluses and needed, or needed and surpluses
         if (IO::readFlag<useAscii>(is)){
-            coefficients.resize(num_outputs, points.getNumIndexes());
-            IO::readVector<useAscii>(is, coefficients.getVector());
+            coefficients.read<useAscii>(is, num_outputs, points.getNumIndexes());
         }
         if (IO::readFlag<useAscii>(is)) needed.read<useAscii>(is);
     }else{
         if (IO::readFlag<useAscii>(is)) needed.read<useAscii>(is);
         if (IO::readFlag<useAscii>(is)){
-            coefficients.resize(num_outputs, points.getNumIndexes());
-            IO::readVector<useAscii>(is, coefficients.getVector());
+            coefficients.read<useAscii>(is, num_outputs, points.getNumIndexes());
         }
     }
 
@@ -127,26 +128,6 @@ void GridWavelet::makeGrid(int cnum_dimensions, int cnum_outputs, int depth, int
 
     buildInterpolationMatrix();
 }
-void GridWavelet::copyGrid(const GridWavelet *wav){
-    reset();
-    num_dimensions = wav->num_dimensions;
-    num_outputs = wav->num_outputs;
-    order = wav->order;
-
-    rule1D.updateOrder(order);
-
-    points = wav->points;
-    needed = wav->needed;
-
-    values = wav->values;
-
-    buildInterpolationMatrix();
-
-    if ((!points.empty()) && (num_outputs > 0)){ // points are loaded
-        recomputeCoefficients();
-    }
-}
-
 void GridWavelet::setNodes(MultiIndexSet &nodes, int cnum_outputs, int corder){
     reset();
     num_dimensions = (int) nodes.getNumDimensions();
@@ -271,9 +252,7 @@ void GridWavelet::evaluateBatch(const double x[], int num_x, double y[]) const{
         evaluate(xwrap.getStrip(i), ywrap.getStrip(i));
 }
 
-#ifdef Tasmanian_ENABLE_BLAS
 void GridWavelet::evaluateBlas(const double x[], int num_x, double y[]) const{ evaluateBatch(x, num_x, y); }
-#endif
 
 #ifdef Tasmanian_ENABLE_CUDA
 void GridWavelet::loadNeededPointsCuda(CudaEngine *, const double *vals){ loadNeededPoints(vals); }
@@ -568,6 +547,11 @@ void GridWavelet::addChildLimited(const int point[], int direction, const std::v
 }
 
 void GridWavelet::clearRefinement(){ needed = MultiIndexSet(); }
+void GridWavelet::freezeForEvaluation(bool keep_values){
+    clearRefinement();
+    coefficients.getVector().shrink_to_fit();
+    if (keep_values) values.shrinkToFit(); else values = StorageSet(); // the coefficients are sufficient
+}
 const double* GridWavelet::getSurpluses() const{
     return coefficients.getStrip(0);
 }
@@ -605,11 +589,11 @@ void GridWavelet::setHierarchicalCoefficients(const double c[], TypeAcceleration
     std::copy_n(c, size_coeff, coefficients.getStrip(0));
 
     values.resize(num_outputs, num_points);
-    values.getVector().resize(size_coeff);
+    values.getMutableVector().resize(size_coeff);
 
     std::vector<double> x(((size_t) num_points) * ((size_t) num_dimensions));
     getPoints(x.data());
-    evaluateBatch(x.data(), points.getNumIndexes(), values.getValues(0));
+    evaluateBatch(x.data(), points.getNumIndexes(), values.getMutableValues(0));
 }
 
 const int* GridWavelet::getPointIndexes() const{
@@ -44,6 +44,7 @@ namespace TasGrid{
 class GridWavelet : public BaseCanonicalGrid{
 public:
     GridWavelet();
+    GridWavelet(const GridWavelet &other); // shares the read-only index sets and values, see MultiIndexSet and StorageSet
     ~GridWavelet();
 
     bool isWavelet() const{ return true; }
@@ -52,7 +53,6 @@ public:
     template<bool useAscii> void read(std::istream &is);
 
     void makeGrid(int cnum_dimensions, int cnum_outputs, int depth, int corder, const std::vector<int> &level_limits);
-    void copyGrid(const GridWavelet *wav);
     void setNodes(MultiIndexSet &nodes, int cnum_outputs, int corder); // for FDS purposes
 
     int getNumDimensions() const;
@@ -78,9 +78,7 @@ public:
 
     void evaluateBatch(const double x[], int num_x, double y[]) const;
 
-    #ifdef Tasmanian_ENABLE_BLAS
     void evaluateBlas(const double x[], int num_x, double y[]) const;
-    #endif
 
     #ifdef Tasmanian_ENABLE_CUDA
     void loadNeededPointsCuda(CudaEngine *engine, const double *vals);
@@ -91,6 +89,7 @@ public:
     void setSurplusRefinement(double tolerance, TypeRefinement criteria, int output, const std::vector<int> &level_limits);
     void clearRefinement();
     void mergeRefinement();
+    void freezeForEvaluation(bool keep_values);
 
     void evaluateHierarchicalFunctions(const double x[], int num_x, double y[]) const;
 
@@ -39,9 +39,12 @@
  *
  * The header contains a inline wrappers that give C++ style of
  * interface to BLAS operations.
+ * If BLAS is not enabled, the wrappers fall back to the internal
+ * cache-blocked kernels defined in tsgLinearSolvers.hpp.
  */
 
 #include "TasmanianConfig.hpp"
+#include "tsgLinearSolvers.hpp"
 
 namespace TasGrid{
 
@@ -51,6 +54,7 @@ namespace TasGrid{
 extern "C" void dgemv_(const char *transa, const int *M, const int *N, const double *alpha, const double *A, const int *lda, const double *x, const int *incx, const double *beta, const double *y, const int *incy);
 extern "C" void dgemm_(const char* transa, const char* transb, const int *m, const int *n, const int *k, const double *alpha, const double *A, const int *lda, const double *B, const int *ldb, const double *beta, const double *C, const int *ldc);
 #endif
+#endif
 
 //! \internal
 //! \brief Wrappers for BLAS methods.
@@ -61,8 +65,10 @@ namespace TasBLAS{
 
     //! Common API computing \f$ C = \alpha A B + \beta C \f$ where A is M by K, B is K by N, and C is M by N.
     //! Transposes are not considered (not needed by Tasmanian).
-    //! The method switches between \b dgemm_ and \b dgemv_ depending on the appropriate dimensions.
+    //! The method switches between \b dgemm_ and \b dgemv_ depending on the appropriate dimensions,
+    //! or calls TasmanianDenseSolver::denseMultiply() if Tasmanian_ENABLE_BLAS is disabled.
     inline void denseMultiply(int M, int N, int K, double alpha, const double A[], const double B[], double beta, double C[]){
+        #ifdef Tasmanian_ENABLE_BLAS
         if (M > 1){
             if (N > 1){ // matrix mode
                 char charN = 'N';
@@ -75,9 +81,20 @@ namespace TasBLAS{
             char charT = 'T'; int blas_one = 1;
             dgemv_(&charT, &K, &N, &alpha, B, &K, A, &blas_one, &beta, C, &blas_one);
         }
+        #else
+        TasmanianDenseSolver::denseMultiply(M, N, K, alpha, A, B, beta, C);
+        #endif
+    }
+
+    //! \internal
+    //! \brief Wrapper for dense matrix times sparse matrix (row compressed) product, see TasSparse::sparseMultiply().
+
+    //! BLAS does not define a standard sparse product, the internal kernel is used regardless of Tasmanian_ENABLE_BLAS.
+    inline void sparseMultiply(int M, int N, double alpha, const double A[], const int pntr[], const int indx[], const double vals[], double C[]){
+        TasSparse::sparseMultiply(M, N, alpha, A, pntr, indx, vals, C);
     }
 }
-#endif
+
 }
 
 #endif
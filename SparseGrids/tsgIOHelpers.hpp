@@ -32,6 +32,10 @@
 #define __TASMANIAN_IOHELPERS_HPP
 
 #include <tuple>
+#include <streambuf>
+#include <vector>
+#include <memory>
+#include <stdexcept>
 
 #include "tsgCoreOneDimensional.hpp"
 
@@ -125,26 +129,37 @@ bool readFlag(std::istream &os){
 /*!
  * \internal
  * \ingroup TasmanianIO
- * \brief Write the vector to the stream, the vector cannot be empty.
+ * \brief Write the array with \b num_entries to the stream, the array cannot be empty.
  * \endinternal
  */
 template<bool useAscii, IOPad pad, typename VecType>
-void writeVector(const std::vector<VecType> &x, std::ostream &os){
+void writeArray(const VecType x[], size_t num_entries, std::ostream &os){
     if (useAscii){
         if (pad == pad_lspace)
-            for(auto i : x) os << " " << i;
+            for(size_t i = 0; i < num_entries; i++) os << " " << x[i];
         if (pad == pad_rspace)
-            for(auto i : x) os << i << " ";
+            for(size_t i = 0; i < num_entries; i++) os << x[i] << " ";
         if ((pad == pad_none) || (pad == pad_line)){
             os << x[0];
-            for(size_t i = 1; i < x.size(); i++) os << " " << x[i];
+            for(size_t i = 1; i < num_entries; i++) os << " " << x[i];
             if (pad == pad_line) os << std::endl;
         }
     }else{
-        os.write((char*) x.data(), x.size() * sizeof(VecType));
+        os.write((char*) x, num_entries * sizeof(VecType));
     }
 }
 
+/*!
+ * \internal
+ * \ingroup TasmanianIO
+ * \brief Write the vector to the stream, the vector cannot be empty.
+ * \endinternal
+ */
+template<bool useAscii, IOPad pad, typename VecType>
+void writeVector(const std::vector<VecType> &x, std::ostream &os){
+    writeArray<useAscii, pad>(x.data(), x.size(), os);
+}
+
 /*!
  * \internal
  * \ingroup TasmanianIO
@@ -222,6 +237,149 @@ TypeOneDRule readRule(std::istream &is){
     }
 }
 
+/*!
+ * \internal
+ * \ingroup TasmanianIO
+ * \brief Stream buffer that reads directly from an existing block of memory, e.g., a shared memory segment.
+ *
+ * The data is not copied, the block must remain valid while the buffer is in use.
+ * \endinternal
+ */
+class MemoryReadBuffer : public std::streambuf{
+public:
+    //! \brief Use the \b size bytes starting at \b data as the input sequence.
+    MemoryReadBuffer(const char *data, size_t size){
+        char *begin = const_cast<char*>(data); // the get area is never written to
+        setg(begin, begin, begin + size);
+    }
+};
+
+/*!
+ * \internal
+ * \ingroup TasmanianIO
+ * \brief Stream buffer that appends everything written to the stream to a vector, used to serialize grids in memory.
+ * \endinternal
+ */
+class MemoryWriteBuffer : public std::streambuf{
+public:
+    //! \brief Append the output sequence to \b data, the vector must remain valid while the buffer is in use.
+    MemoryWriteBuffer(std::vector<char> &data) : sink(data){}
+
+protected:
+    //! \brief Append a block of characters, called by std::ostream::write().
+    std::streamsize xsputn(const char *s, std::streamsize n){
+        sink.insert(sink.end(), s, s + n);
+        return n;
+    }
+    //! \brief Append a single character, called by the formatted output operators.
+    int_type overflow(int_type c){
+        if (!traits_type::eq_int_type(c, traits_type::eof())) sink.push_back(traits_type::to_char_type(c));
+        return traits_type::not_eof(c);
+    }
+
+private:
+    std::vector<char> &sink;
+};
+
+//! \internal
+//! \brief Alignment of the arrays in the data section of a shared memory image, see SharedWriteBuffer.
+//! \ingroup TasmanianIO
+constexpr size_t shared_alignment = 64;
+
+/*!
+ * \internal
+ * \ingroup TasmanianIO
+ * \brief Stream buffer that writes the binary image of a grid for a shared memory segment.
+ *
+ * The image is written to the \b image vector, except for the large arrays written with writeSharedArray(),
+ * which go into a separate \b data section where each array starts at a multiple of \b shared_alignment.
+ * The image holds only the offset of each array within the data section, the layout is position independent
+ * and the arrays can be used in-place by every process that maps the segment, see SharedReadBuffer.
+ * \endinternal
+ */
+class SharedWriteBuffer : public MemoryWriteBuffer{
+public:
+    //! \brief Write the image to \b image_data and the shared arrays to \b array_data.
+    SharedWriteBuffer(std::vector<char> &image_data, std::vector<char> &array_data) : MemoryWriteBuffer(image_data), data(array_data){}
+
+    //! \brief Append \b num_bytes from \b x to the data section and return the aligned offset of the array.
+    unsigned long long addArray(const void *x, size_t num_bytes){
+        data.resize(shared_alignment * ((data.size() + shared_alignment - 1) / shared_alignment));
+        unsigned long long offset = (unsigned long long) data.size();
+        data.insert(data.end(), (const char*) x, ((const char*) x) + num_bytes);
+        return offset;
+    }
+
+private:
+    std::vector<char> &data;
+};
+
+/*!
+ * \internal
+ * \ingroup TasmanianIO
+ * \brief Stream buffer that reads an image written with SharedWriteBuffer, the arrays are returned as views of the data section.
+ * \endinternal
+ */
+class SharedReadBuffer : public MemoryReadBuffer{
+public:
+    /*!
+     * \brief Read the image from the \b image_size bytes at \b image, the \b array_data holds the data section.
+     *
+     * The \b array_data must point to an address aligned to \b shared_alignment and it can hold the whole mapped segment
+     * (e.g., the std::shared_ptr aliasing constructor), every view returned by getArray() keeps the segment alive.
+     */
+    SharedReadBuffer(const char *image, size_t image_size, std::shared_ptr<const char> array_data, size_t array_data_size)
+        : MemoryReadBuffer(image, image_size), data(array_data), data_size(array_data_size){}
+
+    //! \brief Returns a view of \b num_entries starting at \b offset in the data section, throws if the array is out of bounds.
+    template<typename T>
+    std::shared_ptr<const T> getArray(unsigned long long offset, size_t num_entries) const{
+        if ((offset % shared_alignment != 0) || (offset > data_size) || (num_entries > (data_size - offset) / sizeof(T)))
+            throw std::runtime_error("ERROR: the shared memory image references an array outside of the data section");
+        return std::shared_ptr<const T>(data, (const T*) (data.get() + offset));
+    }
+
+private:
+    std::shared_ptr<const char> data;
+    size_t data_size;
+};
+
+/*!
+ * \internal
+ * \ingroup TasmanianIO
+ * \brief Write an array that can be shared, see writeArray(), a SharedWriteBuffer moves the array into the data section.
+ *
+ * Streams that do not use SharedWriteBuffer (e.g., files) use the regular format,
+ * i.e., the entries of the array are written in the stream.
+ * \endinternal
+ */
+template<bool useAscii, IOPad pad, typename VecType>
+void writeSharedArray(const VecType x[], size_t num_entries, std::ostream &os){
+    SharedWriteBuffer *shared = (useAscii) ? nullptr : dynamic_cast<SharedWriteBuffer*>(os.rdbuf());
+    if (shared != nullptr){
+        unsigned long long offset = shared->addArray(x, num_entries * sizeof(VecType));
+        os.write((char*) &offset, sizeof(offset));
+    }else{
+        writeArray<useAscii, pad>(x, num_entries, os);
+    }
+}
+
+/*!
+ * \internal
+ * \ingroup TasmanianIO
+ * \brief Read an array written with writeSharedArray(), returns a view of the shared memory or null if the stream is not shared.
+ *
+ * If the result is null, nothing was read and the caller has to read the \b num_entries from the stream, see readVector().
+ * \endinternal
+ */
+template<bool useAscii, typename VecType>
+std::shared_ptr<const VecType> readSharedArray(std::istream &is, size_t num_entries){
+    SharedReadBuffer *shared = (useAscii) ? nullptr : dynamic_cast<SharedReadBuffer*>(is.rdbuf());
+    if (shared == nullptr) return std::shared_ptr<const VecType>();
+    unsigned long long offset = readNumber<false, unsigned long long>(is);
+    return shared->getArray<VecType>(offset, num_entries);
+}
+
 }
 
 }
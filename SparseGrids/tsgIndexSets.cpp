@@ -39,7 +39,7 @@ template<bool useAscii>
 void MultiIndexSet::write(std::ostream &os) const{
     if (cache_num_indexes > 0){
         IO::writeNumbers<useAscii, IO::pad_rspace>(os, (int) num_dimensions, cache_num_indexes);
-        IO::writeVector<useAscii, IO::pad_line>(indexes, os);
+        IO::writeVector<useAscii, IO::pad_line>(*indexes, os);
     }else{
         IO::writeNumbers<useAscii, IO::pad_line>(os, (int) num_dimensions, cache_num_indexes);
     }
@@ -49,8 +49,8 @@ template<bool useAscii>
 void MultiIndexSet::read(std::istream &is){
     num_dimensions = (size_t) IO::readNumber<useAscii, int>(is);
     cache_num_indexes = IO::readNumber<useAscii, int>(is);
-    indexes.resize(num_dimensions * ((size_t) cache_num_indexes));
-    IO::readVector<useAscii>(is, indexes);
+    indexes = std::make_shared<std::vector<int>>(num_dimensions * ((size_t) cache_num_indexes));
+    IO::readVector<useAscii>(is, *indexes);
 }
 
 template void MultiIndexSet::write<true>(std::ostream &) const; // instantiate for faster build
@@ -58,12 +58,22 @@ template void MultiIndexSet::write<false>(std::ostream &) const;
 template void MultiIndexSet::read<true>(std::istream &);
 template void MultiIndexSet::read<false>(std::istream &);
 
+std::vector<int>& MultiIndexSet::modifyIndexes(){
+    if (!indexes){
+        indexes = std::make_shared<std::vector<int>>();
+    }else if (indexes.use_count() > 1){
+        indexes = std::make_shared<std::vector<int>>(*indexes);
+    }
+    return *indexes;
+}
+
 void MultiIndexSet::addSortedIndexes(const std::vector<int> &addition){
-    if (indexes.empty()){
-        indexes = addition;
+    if (empty()){
+        indexes = std::make_shared<std::vector<int>>(addition);
     }else{
-        std::vector<int> old_indexes = std::move(indexes);
-        indexes = std::vector<int>(); // reset the indexes
+        std::shared_ptr<std::vector<int>> old_shared = indexes; // the old indexes may be shared with other sets, do not modify
+        const std::vector<int> &old_indexes = *old_shared;
+        indexes = std::make_shared<std::vector<int>>();
 
         std::vector<std::vector<int>::const_iterator> merge_map;
         merge_map.reserve(addition.size() + old_indexes.size());
@@ -103,14 +113,14 @@ void MultiIndexSet::addSortedIndexes(const std::vector<int> &addition){
             }
         }
 
-        indexes.resize(merge_map.size() * num_dimensions); // merge map will reference only indexes in both sets
-        auto iindexes = indexes.begin();
+        indexes->resize(merge_map.size() * num_dimensions); // merge map will reference only indexes in both sets
+        auto iindexes = indexes->begin();
         for(auto &i : merge_map){
             std::copy_n(i, num_dimensions, iindexes);
             std::advance(iindexes, num_dimensions);
         }
     }
-    cache_num_indexes = (int) (indexes.size() / num_dimensions);
+    cache_num_indexes = (int) (indexes->size() / num_dimensions);
 }
 
 void MultiIndexSet::setData2D(Data2D<int> const &data){
@@ -140,14 +150,14 @@ void MultiIndexSet::setData2D(Data2D<int> const &data){
                                 });
     index_refs.resize(std::distance(index_refs.begin(), unique_end));
 
-    indexes.resize(index_refs.size() * num_dimensions);
-    auto iindexes = indexes.begin();
+    indexes = std::make_shared<std::vector<int>>(index_refs.size() * num_dimensions);
+    auto iindexes = indexes->begin();
     for(auto &i : index_refs){
         std::copy_n(i, num_dimensions, iindexes);
         std::advance(iindexes, num_dimensions);
     }
 
-    cache_num_indexes = (int) (indexes.size() / num_dimensions);
+    cache_num_indexes = (int) (indexes->size() / num_dimensions);
 }
 
 int MultiIndexSet::getSlot(const int *p) const{
@@ -161,7 +171,7 @@ int MultiIndexSet::getSlot(const int *p) const{
                     if (a[j] > b[j]) return type_bbeforea;
                 }
                 return type_asameb;
-            }(&(indexes[(size_t) current * num_dimensions]), p);
+            }(&((*indexes)[(size_t) current * num_dimensions]), p);
         if (t == type_abeforeb){
             sstart = current+1;
         }else if (t == type_bbeforea){
@@ -175,10 +185,10 @@ int MultiIndexSet::getSlot(const int *p) const{
 }
 
 MultiIndexSet MultiIndexSet::diffSets(const MultiIndexSet &substract){
-    std::vector<std::vector<int>::iterator> kept_indexes;
+    std::vector<std::vector<int>::const_iterator> kept_indexes;
 
-    auto ithis = indexes.begin();
-    auto endthis = indexes.end();
+    auto ithis = getVector().begin();
+    auto endthis = getVector().end();
     auto iother = substract.getVector().begin();
     auto endother = substract.getVector().end();
 
@@ -187,7 +197,7 @@ MultiIndexSet MultiIndexSet::diffSets(const MultiIndexSet &substract){
             kept_indexes.push_back(ithis);
             std::advance(ithis, num_dimensions);
         }else{
-            TypeIndexRelation t = [&](std::vector<int>::iterator ia, std::vector<int>::const_iterator ib) ->
+            TypeIndexRelation t = [&](std::vector<int>::const_iterator ia, std::vector<int>::const_iterator ib) ->
                                         TypeIndexRelation{
                                             for(size_t j=0; j<num_dimensions; j++){
                                                 if (*ia   < *ib)   return type_abeforeb;
@@ -221,7 +231,8 @@ MultiIndexSet MultiIndexSet::diffSets(const MultiIndexSet &substract){
 void MultiIndexSet::removeIndex(const std::vector<int> &p){
     int slot = getSlot(p);
     if (slot > -1){
-        indexes.erase(indexes.begin() + ((size_t) slot) * num_dimensions, indexes.begin() + ((size_t) slot) * num_dimensions + num_dimensions);
+        std::vector<int> &mutable_indexes = modifyIndexes();
+        mutable_indexes.erase(mutable_indexes.begin() + ((size_t) slot) * num_dimensions, mutable_indexes.begin() + ((size_t) slot) * num_dimensions + num_dimensions);
         cache_num_indexes--;
     }
 }
@@ -232,17 +243,22 @@ StorageSet::~StorageSet(){}
 template<bool useAscii>
 void StorageSet::write(std::ostream &os) const{
     IO::writeNumbers<useAscii, IO::pad_rspace>(os, (int) num_outputs, (int) num_values);
-    IO::writeFlag<useAscii, IO::pad_auto>((values.size() != 0), os);
-    if (values.size() != 0)
-        IO::writeVector<useAscii, IO::pad_line>(values, os);
+    IO::writeFlag<useAscii, IO::pad_auto>((getTotalEntries() != 0), os);
+    if (getTotalEntries() != 0)
+        IO::writeSharedArray<useAscii, IO::pad_line>(getValues(0), getTotalEntries(), os);
 }
 template<bool useAscii>
 void StorageSet::read(std::istream &is){
     num_outputs = (size_t) IO::readNumber<useAscii, int>(is);
     num_values = (size_t) IO::readNumber<useAscii, int>(is);
+    values.reset();
+    view.reset();
     if (IO::readFlag<useAscii>(is)){
-        values.resize(num_outputs * num_values);
-        IO::readVector<useAscii>(is, values);
+        view = IO::readSharedArray<useAscii, double>(is, num_outputs * num_values);
+        if (!view){
+            values = std::make_shared<std::vector<double>>(num_outputs * num_values);
+            IO::readVector<useAscii>(is, *values);
+        }
     }
 }
 
@@ -252,21 +268,35 @@ template void StorageSet::read<true>(std::istream &);
 template void StorageSet::read<false>(std::istream &);
 
 void StorageSet::resize(int cnum_outputs, int cnum_values){
-    values = std::vector<double>();
+    values.reset();
+    view.reset();
     num_outputs = cnum_outputs;
     num_values = cnum_values;
 }
 
-const double* StorageSet::getValues(int i) const{ return &(values[i*num_outputs]); }
-double* StorageSet::getValues(int i){ return &(values[i*num_outputs]); }
+std::vector<double>& StorageSet::modifyValues(){
+    if (view){
+        values = std::make_shared<std::vector<double>>(view.get(), view.get() + num_outputs * num_values);
+        view.reset();
+    }else if (!values){
+        values = std::make_shared<std::vector<double>>();
+    }else if (values.use_count() > 1){
+        values = std::make_shared<std::vector<double>>(*values);
+    }
+    return *values;
+}
+
+const double* StorageSet::getValues(int i) const{ return ((view) ? view.get() : values->data()) + i*num_outputs; }
+double* StorageSet::getMutableValues(int i){ return &(modifyValues()[i*num_outputs]); }
 
 void StorageSet::setValues(const double vals[]){
-    values.resize(num_outputs * num_values);
-    std::copy_n(vals, num_values * num_outputs, values.data());
+    view.reset();
+    values = std::make_shared<std::vector<double>>(vals, vals + num_values * num_outputs); // replaces, never copies shared values
 }
 void StorageSet::setValues(std::vector<double> &vals){
     num_values = vals.size() / num_outputs;
-    values = std::move(vals); // move assignment
+    view.reset();
+    values = std::make_shared<std::vector<double>>(std::move(vals));
 }
 
 void StorageSet::addValues(const MultiIndexSet &old_set, const MultiIndexSet &new_set, const double new_vals[]){
@@ -279,7 +309,7 @@ void StorageSet::addValues(const MultiIndexSet &old_set, const MultiIndexSet &ne
 
     int iold = 0, inew = 0;
     size_t off_vals = 0;
-    auto ivals = values.begin();
+    const double *ivals = (num_old > 0) ? getValues(0) : nullptr;
     auto icombined = combined_values.begin();
 
     auto compareIndexes = [&](int const a[], int const b[])->
@@ -307,11 +337,12 @@ void StorageSet::addValues(const MultiIndexSet &old_set, const MultiIndexSet &ne
         }else{
             std::copy_n(ivals, num_outputs, icombined);
             iold++;
-            std::advance(ivals, num_outputs);
+            ivals += num_outputs;
         }
         std::advance(icombined, num_outputs);
     }
-    std::swap(values, combined_values);
+    view.reset();
+    values = std::make_shared<std::vector<double>>(std::move(combined_values)); // the old values may be shared, do not modify
 }
 
 }
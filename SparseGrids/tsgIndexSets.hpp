@@ -33,6 +33,7 @@
 
 #include <functional>
 #include <algorithm>
+#include <memory>
 
 #include "tsgIOHelpers.hpp"
 #include "tsgUtils.hpp"
@@ -75,6 +76,10 @@ namespace TasGrid{
  * The data is divided into \b strips of equal \b stride, e.g., number of multi-indexes and number of dimensions.
  * Internally the class uses \b std::vector with type \b T,
  * when used, \b T is almost always \b double or \b int.
+ *
+ * The data can also be a read-only view of external memory, e.g., a shared memory segment, see \b read().
+ * The const methods read the view in-place, the methods that can modify the data make a private copy first
+ * and the const \b getVector() is empty for a view.
  * \endinternal
  */
 template<typename T>
@@ -98,34 +103,61 @@ public:
 
     //! \brief Clear any existing data and allocate a new data-structure with given \b stride and number of \b strips.
     void resize(int new_stride, int new_num_strips){
+        view.reset();
         stride = (size_t) new_stride;
         num_strips = (size_t) new_num_strips;
         vec.resize(stride * num_strips);
     }
 
     //! \brief Returns a reference to the \b i-th strip.
-    T* getStrip(int i){ return &(vec[i*stride]); }
+    T* getStrip(int i){ return modifyData() + i*stride; }
     //! \brief Returns a const reference to the \b i-th strip.
-    T const* getStrip(int i) const{ return &(vec[i*stride]); }
+    T const* getStrip(int i) const{ return ((view) ? view.get() : vec.data()) + i*stride; }
     //! \brief Returns the stride.
     size_t getStride() const{ return stride; }
     //! \brief Returns the number of strips.
     int getNumStrips() const{ return (int) num_strips; }
     //! \brief Returns the total number of entries, stride times number of trips.
-    size_t getTotalEntries() const{ return vec.size(); }
-    //! \brief Returns a reference to the internal data.
-    std::vector<T>& getVector(){ return vec; }
-    //! \brief Returns a const reference to the internal data.
+    size_t getTotalEntries() const{ return (view) ? stride * num_strips : vec.size(); }
+    //! \brief Returns a reference to the internal data, a view is copied into the internal data first.
+    std::vector<T>& getVector(){ modifyData(); return vec; }
+    //! \brief Returns a const reference to the internal data, the vector is empty if the data is a view.
     const std::vector<T>& getVector() const{ return vec; }
+    //! \brief Returns \b true if the data is a read-only view of external memory.
+    bool isView() const{ return !!view; }
     //! \brief Clear all used data.
     void clear(){
         stride = 0;
         num_strips = 0;
         vec = std::vector<double>();
+        view.reset();
+    }
+
+    /*!
+     * \brief Read \b new_num_strips with \b new_stride from the stream, see \b IO::readVector().
+     *
+     * Binary images of a shared memory segment (see \b IO::SharedReadBuffer) are not copied,
+     * instead the data becomes a view of the segment.
+     */
+    template<bool useAscii> void read(std::istream &is, int new_stride, int new_num_strips){
+        stride = (size_t) new_stride;
+        num_strips = (size_t) new_num_strips;
+        view = IO::readSharedArray<useAscii, T>(is, stride * num_strips);
+        if (view){
+            vec = std::vector<T>();
+        }else{
+            vec.resize(stride * num_strips);
+            IO::readVector<useAscii>(is, vec);
+        }
+    }
+    //! \brief Write all entries to the stream, the data cannot be empty, see \b IO::writeSharedArray().
+    template<bool useAscii, IO::IOPad pad> void write(std::ostream &os) const{
+        IO::writeSharedArray<useAscii, pad>(getStrip(0), getTotalEntries(), os);
     }
 
     //! \brief Uses std::vector::insert to append the data.
     void appendStrip(typename std::vector<T>::const_iterator const &x){
+        modifyData();
         vec.insert(vec.end(), x, x + stride);
         num_strips++;
     }
@@ -137,18 +169,41 @@ public:
 
     //! \brief Uses std::vector::insert to append a strip \b x to the existing data at position \b pos, assumes \b x.size() is one stride.
     void appendStrip(int pos, const std::vector<T> &x){
+        modifyData();
         vec.insert(vec.begin() + (((size_t) pos) * stride), x.begin(), x.end());
         num_strips++;
     }
 
     //! \brief Fill the entire vector with the specified \b value.
-    void fill(T value){ std::fill(vec.begin(), vec.end(), value); }
+    void fill(T value){ modifyData(); std::fill(vec.begin(), vec.end(), value); }
+
+protected:
+    //! \brief Copy a view into the internal vector, returns the internal data.
+    T* modifyData(){
+        if (view){
+            vec = std::vector<T>(view.get(), view.get() + stride * num_strips);
+            view.reset();
+        }
+        return vec.data();
+    }
 
 private:
     size_t stride, num_strips;
     std::vector<T> vec;
+    std::shared_ptr<const T> view; // read-only view of external memory, keeps the memory alive
 };
 
+/*!
+ * \internal
+ * \ingroup TasmanianSets
+ * \brief Returns a reference to an empty vector, used by the copy-on-write sets when there is no data.
+ * \endinternal
+ */
+template<typename T> const std::vector<T>& emptyVector(){
+    static const std::vector<T> empty_vector;
+    return empty_vector;
+}
+
 /*!
  * \internal
  * \ingroup TasmanianSets
@@ -161,6 +216,9 @@ private:
  * - synchronization between multi-indexes and values (i.e., model outputs)
  * - adding or removing indexes while preserving the order
  * - basic file I/O
+ *
+ * Copies of the set share the indexes until one of the copies is modified (copy-on-write),
+ * thus copies of a grid share the multi-indexes that neither copy changes.
  * \endinternal
  */
 class MultiIndexSet{
@@ -169,7 +227,8 @@ public:
     MultiIndexSet() : num_dimensions(0), cache_num_indexes(0){}
     //! \brief Constructor, makes a set by \b moving out of the vector, the vector must be already sorted.
     MultiIndexSet(size_t cnum_dimensions, std::vector<int> &new_indexes) :
-        num_dimensions(cnum_dimensions), cache_num_indexes((int)(new_indexes.size() / cnum_dimensions)), indexes(std::move(new_indexes)){}
+        num_dimensions(cnum_dimensions), cache_num_indexes((int)(new_indexes.size() / cnum_dimensions)),
+        indexes(std::make_shared<std::vector<int>>(std::move(new_indexes))){}
     //! \brief Copy a collection of unsorted indexes into a sorted multi-index set, sorts during the copy.
     MultiIndexSet(Data2D<int> &data) : num_dimensions((size_t) data.getStride()), cache_num_indexes(0){ setData2D(data); }
     //! \brief Default destructor.
@@ -187,7 +246,7 @@ public:
     template<bool useAscii> void read(std::istream &os);
 
     //! \brief Returns **true** if there are no multi-indexes in the set, **false** otherwise
-    inline bool empty() const{ return indexes.empty(); }
+    inline bool empty() const{ return getVector().empty(); }
 
     //! \brief Returns the number of dimensions
     inline size_t getNumDimensions() const{ return num_dimensions; }
@@ -203,9 +262,9 @@ public:
     }
 
     //! \brief Returns a const reference to the internal data
-    inline const std::vector<int>& getVector() const{ return indexes; }
+    inline const std::vector<int>& getVector() const{ return (indexes) ? *indexes : emptyVector<int>(); }
     //! \brief Returns a reference to the internal data, must not modify the lexicographical order or the size of the vector
-    inline std::vector<int>& getVector(){ return indexes; } // used for remapping during tensor generic points
+    inline std::vector<int>& getMutableVector(){ return modifyIndexes(); } // used for remapping during tensor generic points
 
     //! \brief Returns the slot containing index **p**, returns `-1` if not found
     int getSlot(const int *p) const;
@@ -215,7 +274,7 @@ public:
     inline bool missing(const std::vector<int> &p) const{ return (getSlot(p.data()) == -1); }
 
     //! \brief Returns the **i**-th index of the set, useful to loop over all indexes or to cross reference with values
-    inline const int *getIndex(int i) const{ return &(indexes[((size_t) i) * num_dimensions]); }
+    inline const int *getIndex(int i) const{ return &((*indexes)[((size_t) i) * num_dimensions]); }
 
     /*! \brief Return a new multi-index set that holds the indexed present in this set, but missing in \b substract.
      *
@@ -229,16 +288,19 @@ public:
     void removeIndex(const std::vector<int> &p);
 
     //! \brief Returns the maximum single index in the set.
-    int getMaxIndex() const{ return (empty()) ? 0 : *std::max_element(indexes.begin(), indexes.end()); }
+    int getMaxIndex() const{ return (empty()) ? 0 : *std::max_element(indexes->begin(), indexes->end()); }
 
 protected:
+    //! \brief Return the indexes for modification, makes a private copy first if the indexes are shared with another set.
+    std::vector<int>& modifyIndexes();
+
     //! \brief Copy and sort the indexes from the \b data, called only from the constructor.
     void setData2D(Data2D<int> const &data);
 
 private:
     size_t num_dimensions;
     int cache_num_indexes;
-    std::vector<int> indexes;
+    std::shared_ptr<std::vector<int>> indexes; // shared with the copies of the set, null for a default constructed set
 };
 
 /*!
@@ -252,6 +314,9 @@ private:
  * with the \b points multi-index set.
  * Synchronization is achieved by merging values before merging multi-indexes, when
  * the \b addValues() is called with the old and new multi-index sets and the new values.
+ *
+ * Same as the \b MultiIndexSet, copies of the set share the values until one of the copies is modified.
+ * Values read from a shared memory image are a read-only view of the segment, see \b Data2D::read().
  * \endinternal
  */
 class StorageSet{
@@ -277,12 +342,16 @@ public:
 
     //! \brief Returns const reference to the \b i-th value.
     const double* getValues(int i) const;
-    //! \brief Returns reference to the \b i-th value.
-    double* getValues(int i);
-    //! \brief Returns reference to the internal data vector.
-    std::vector<double>& getVector(){ return values; }
-    //! \brief Returns const reference to the internal data vector.
-    const std::vector<double>& getVector() const{ return values; }
+    //! \brief Returns reference to the \b i-th value for modification, makes a private copy of the values if shared.
+    double* getMutableValues(int i);
+    //! \brief Returns reference to the internal data vector for modification, makes a private copy of the values if shared.
+    std::vector<double>& getMutableVector(){ return modifyValues(); }
+    //! \brief Returns const reference to the internal data vector, the vector is empty if the values are a view of external memory.
+    const std::vector<double>& getVector() const{ return (values) ? *values : emptyVector<double>(); }
+    //! \brief Returns the total number of stored entries, i.e., number of outputs times number of values, or zero if no values are loaded.
+    size_t getTotalEntries() const{ return (values) ? values->size() : ((view) ? num_outputs * num_values : 0); }
+    //! \brief Release the unused capacity of the values, values shared with another set are already of the exact size and are not copied.
+    void shrinkToFit(){ if (values && (values.use_count() == 1)) values->shrink_to_fit(); }
 
     //! \brief Replace the existing values with a copy of **vals**, the size must be at least **num_outputs** times **num_values**
     void setValues(const double vals[]);
@@ -301,9 +370,14 @@ public:
      */
     void addValues(const MultiIndexSet &old_set, const MultiIndexSet &new_set, const double new_vals[]);
 
+protected:
+    //! \brief Return the values for modification, makes a private copy first if the values are shared with another set.
+    std::vector<double>& modifyValues();
+
 private:
     size_t num_outputs, num_values; // kept as size_t to avoid conversions in products, but each one is small individually
-    std::vector<double> values;
+    std::shared_ptr<std::vector<double>> values; // shared with the copies of the set, null for an empty set
+    std::shared_ptr<const double> view; // read-only view of external memory, used instead of the values
 };
 
 }
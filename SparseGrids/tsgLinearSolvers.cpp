@@ -31,7 +31,10 @@
 #ifndef __TASMANIAN_LINEAR_SOLVERS_CPP
 #define __TASMANIAN_LINEAR_SOLVERS_CPP
 
+#include <numeric>
+
 #include "tsgLinearSolvers.hpp"
+#include "tsgUtils.hpp"
 
 #ifdef TASMANIAN_CHOLMOD
 #include <cholmod.h>
@@ -93,6 +96,134 @@ void TasmanianDenseSolver::solveLeastSquares(int n, int m, const double A[], con
     }
 }
 
+namespace TasmanianDenseSolver{
+// Block sizes for the dense matrix multiply, the micro-kernel computes an mr by nr tile of C using registers,
+// a packed mc by kc panel of A sits in L2 cache and a kc by nr strip of the packed B panel sits in L1 cache.
+constexpr int mr = 4, nr = 4, mc = 128, kc = 256, nc = 192;
+
+// Pack the mb by kb block of A (leading dimension lda) into micro-panels of mr rows, missing rows are padded with zeros.
+void packPanelA(int mb, int kb, const double A[], int lda, double packed[]){
+    for(int i=0; i<mb; i+=mr){
+        int ib = std::min(mr, mb - i);
+        for(int k=0; k<kb; k++){
+            const double *a = &A[Utils::size_mult(k, lda) + i];
+            int t = 0;
+            for(; t<ib; t++) *packed++ = a[t];
+            for(; t<mr; t++) *packed++ = 0.0;
+        }
+    }
+}
+// Pack the kb by nb block of B (leading dimension ldb) into micro-panels of nr columns, missing columns are padded with zeros.
+void packPanelB(int kb, int nb, const double B[], int ldb, double packed[]){
+    for(int j=0; j<nb; j+=nr){
+        int jb = std::min(nr, nb - j);
+        for(int k=0; k<kb; k++){
+            int t = 0;
+            for(; t<jb; t++) *packed++ = B[Utils::size_mult(j + t, ldb) + k];
+            for(; t<nr; t++) *packed++ = 0.0;
+        }
+    }
+}
+// Computes C += alpha * a * b, where a and b are packed micro-panels and C is an ib by jb tile (ib <= mr, jb <= nr).
+// The loops have compile time bounds so that the accumulators stay in registers and the inner loop is vectorized.
+inline void multiplyMicroKernel(int kb, const double a[], const double b[], double alpha, double C[], int ldc, int ib, int jb){
+    double acc[nr][mr] = {{0.0}};
+    for(int k=0; k<kb; k++){
+        for(int j=0; j<nr; j++){
+            double bj = b[j];
+            for(int i=0; i<mr; i++) acc[j][i] += a[i] * bj;
+        }
+        a += mr;
+        b += nr;
+    }
+    for(int j=0; j<jb; j++){
+        double *c = &C[Utils::size_mult(j, ldc)];
+        for(int i=0; i<ib; i++) c[i] += alpha * acc[j][i];
+    }
+}
+// Overwrite C with beta * C, handles the special case beta = 0 where C may contain garbage (even nan).
+inline void scaleBlock(int mb, int nb, double beta, double C[], int ldc){
+    if (beta == 1.0) return;
+    for(int j=0; j<nb; j++){
+        double *c = &C[Utils::size_mult(j, ldc)];
+        if (beta == 0.0){
+            std::fill_n(c, mb, 0.0);
+        }else{
+            for(int i=0; i<mb; i++) c[i] *= beta;
+        }
+    }
+}
+}
+
+void TasmanianDenseSolver::denseMultiply(int M, int N, int K, double alpha, const double A[], const double B[], double beta, double C[]){
+    if ((M <= 0) || (N <= 0)) return;
+    if ((K <= 0) || (alpha == 0.0)){
+        scaleBlock(M, N, beta, C, M);
+        return;
+    }
+    if (N == 1){ // matrix-vector product, split the rows of A across the threads
+        #pragma omp parallel for
+        for(int i=0; i<M; i+=mc){
+            int mb = std::min(mc, M - i);
+            double sum[mc] = {0.0};
+            for(int k=0; k<K; k++){
+                const double *a = &A[Utils::size_mult(k, M) + i];
+                double bk = B[k];
+                for(int t=0; t<mb; t++) sum[t] += a[t] * bk;
+            }
+            for(int t=0; t<mb; t++) C[i + t] = alpha * sum[t] + ((beta == 0.0) ? 0.0 : beta * C[i + t]);
+        }
+        return;
+    }
+    if (M == 1){ // vector-matrix product, each entry of C is a dot product
+        #pragma omp parallel for
+        for(int j=0; j<N; j++){
+            const double *b = &B[Utils::size_mult(j, K)];
+            double sum = 0.0;
+            for(int k=0; k<K; k++) sum += A[k] * b[k];
+            C[j] = alpha * sum + ((beta == 0.0) ? 0.0 : beta * C[j]);
+        }
+        return;
+    }
+
+    int blocks_m = (M + mc - 1) / mc;
+    int blocks_n = (N + nc - 1) / nc;
+    int num_blocks = blocks_m * blocks_n;
+
+    // thread-private packing buffers, sized for the actual problem so that small products do not pay for the full panels
+    size_t apack_size = Utils::size_mult(std::min(mc, ((M + mr - 1) / mr) * mr), std::min(kc, K));
+    size_t bpack_size = Utils::size_mult(std::min(nc, ((N + nr - 1) / nr) * nr), std::min(kc, K));
+
+    #pragma omp parallel if (num_blocks > 1)
+    {
+        std::vector<double> apack(apack_size), bpack(bpack_size);
+
+        #pragma omp for schedule(dynamic)
+        for(int blk=0; blk<num_blocks; blk++){
+            int ioff = (blk % blocks_m) * mc;
+            int joff = (blk / blocks_m) * nc;
+            int mb = std::min(mc, M - ioff);
+            int nb = std::min(nc, N - joff);
+
+            double *c = &C[Utils::size_mult(joff, M) + ioff];
+            scaleBlock(mb, nb, beta, c, M);
+
+            for(int koff=0; koff<K; koff+=kc){
+                int kb = std::min(kc, K - koff);
+                packPanelA(mb, kb, &A[Utils::size_mult(koff, M) + ioff], M, apack.data());
+                packPanelB(kb, nb, &B[Utils::size_mult(joff, K) + koff], K, bpack.data());
+
+                for(int j=0; j<nb; j+=nr){
+                    for(int i=0; i<mb; i+=mr){
+                        multiplyMicroKernel(kb, &apack[i * kb], &bpack[j * kb], alpha, &c[Utils::size_mult(j, M) + i], M,
+                                            std::min(mr, mb - i), std::min(nr, nb - j));
+                    }
+                }
+            }
+        }
+    }
+}
+
 void TasmanianTridiagonalSolver::decompose(int n, std::vector<double> &d, std::vector<double> &e, std::vector<double> &z){
     const double tol = TSG_NUM_TOL;
     if (n == 1){ z[0] = z[0]*z[0]; return; }
@@ -149,21 +280,17 @@ void TasmanianTridiagonalSolver::decompose(int n, std::vector<double> &d, std::v
         }
     }
 
-    for(int i=1; i<n; i++){
-        for(int j=0; j<n-1; j++){
-            if (d[j] > d[j+1]){
-                double p = d[j];
-                d[j] = d[j+1];
-                d[j+1] = p;
-                p = z[j];
-                z[j] = z[j+1];
-                z[j+1] = p;
-            }
-        }
-    }
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b)->bool{ return (d[a] < d[b]); });
+
+    std::vector<double> sorted_d(n), sorted_z(n);
     for(int i=0; i<n; i++){
-           z[i] = z[i]*z[i];
+        sorted_d[i] = d[order[i]];
+        sorted_z[i] = z[order[i]] * z[order[i]];
     }
+    std::copy(sorted_d.begin(), sorted_d.begin() + n, d.begin());
+    std::copy(sorted_z.begin(), sorted_z.begin() + n, z.begin());
 }
 
 void TasmanianFourierTransform::fast_fourier_transform(std::vector<std::vector<std::complex<double>>> &data, std::vector<int> &num_points){
@@ -307,6 +434,51 @@ void TasmanianFourierTransform::fast_fourier_transform1D(std::vector<std::vector
 
 namespace TasSparse{
 
+// The rows of A and C (i.e., the outputs) are split into chunks that keep the partial sums of C in L1 cache.
+constexpr int sparse_chunk = 512;
+// The non-zeros are processed in groups, so that each entry of C is loaded and stored once per group.
+constexpr int sparse_group = 4;
+
+// Prefetch hint for the column of A used by a future group of non-zeros, the column indexes are random so the hardware cannot predict them.
+inline void prefetchColumn(const double *a){
+    #if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(a, 0, 1);
+    #else
+    (void) a;
+    #endif
+}
+
+// Computes entries [offset, offset + csize) of one column of C, the inner loops stream contiguous segments of the columns of A
+// and vectorize across the outputs.
+inline void sparseMultiplyChunk(int M, int offset, int csize, double alpha, const double A[], int jstart, int jend, const int indx[], const double vals[], double c[]){
+    c = &c[offset];
+    std::fill_n(c, csize, 0.0);
+    int j = jstart;
+    for(; j + sparse_group <= jend; j += sparse_group){
+        for(int p = j + sparse_group; p < std::min(j + 2 * sparse_group, jend); p++) prefetchColumn(&A[Utils::size_mult(indx[p], M) + offset]);
+        const double *a0 = &A[Utils::size_mult(indx[j    ], M) + offset];
+        const double *a1 = &A[Utils::size_mult(indx[j + 1], M) + offset];
+        const double *a2 = &A[Utils::size_mult(indx[j + 2], M) + offset];
+        const double *a3 = &A[Utils::size_mult(indx[j + 3], M) + offset];
+        double v0 = alpha * vals[j], v1 = alpha * vals[j + 1], v2 = alpha * vals[j + 2], v3 = alpha * vals[j + 3];
+        for(int k=0; k<csize; k++) c[k] += v0 * a0[k] + v1 * a1[k] + v2 * a2[k] + v3 * a3[k];
+    }
+    for(; j < jend; j++){
+        const double *a = &A[Utils::size_mult(indx[j], M) + offset];
+        double v = alpha * vals[j];
+        for(int k=0; k<csize; k++) c[k] += v * a[k];
+    }
+}
+
+void sparseMultiply(int M, int N, double alpha, const double A[], const int pntr[], const int indx[], const double vals[], double C[]){
+    #pragma omp parallel for schedule(static)
+    for(int i=0; i<N; i++){
+        double *c = &C[Utils::size_mult(i, M)];
+        for(int offset=0; offset<M; offset+=sparse_chunk)
+            sparseMultiplyChunk(M, offset, std::min(sparse_chunk, M - offset), alpha, A, pntr[i], pntr[i+1], indx, vals, c);
+    }
+}
+
 SparseMatrix::SparseMatrix() : tol(TSG_NUM_TOL), num_rows(0){}
 SparseMatrix::~SparseMatrix(){}
 
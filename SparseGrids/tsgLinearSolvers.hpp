@@ -32,6 +32,7 @@
 #define __TASMANIAN_LINEAR_SOLVERS_HPP
 
 #include <list>
+#include <algorithm>
 #include <math.h>
 #include <complex>
 
@@ -74,6 +75,17 @@ namespace TasmanianDenseSolver{
     //! the result is given in \b x (length \b m). The regularized term \b reg is added to the diagonal of
     //! the product `transpose(A) * A` to stabilize the Cholesky decomposition.
     void solveLeastSquares(int n, int m, const double A[], const double b[], double reg, double *x);
+
+    //! \internal
+    //! \brief Cache-blocked and multi-threaded dense matrix-matrix product, used in place of BLAS \b dgemm_ and \b dgemv_.
+    //! \ingroup TasmanianLinearSolvers
+
+    //! Computes \f$ C = \alpha A B + \beta C \f$ where A is M by K, B is K by N, and C is M by N, all matrices use column major format.
+    //! The matrices are split into panels that fit in cache, the panels are packed into contiguous buffers and
+    //! the product of the packed panels is computed with a register tiled micro-kernel.
+    //! The tiles of C are independent and are distributed across the OpenMP threads.
+    //! If \b beta is zero, then \b C is overwritten and the initial values are never referenced.
+    void denseMultiply(int M, int N, int K, double alpha, const double A[], const double B[], double beta, double C[]);
 }
 
 //! \internal
@@ -115,6 +127,16 @@ namespace TasmanianFourierTransform{
 //! \ingroup TasmanianLinearSolvers
 namespace TasSparse{
 
+//! \internal
+//! \brief Multiply a dense matrix by a sparse matrix, \f$ C = \alpha A B^T \f$.
+//! \ingroup TasmanianLinearSolvers
+
+//! The matrix \b A is \b M by K and stored in column major format, \b B is N by K and is stored in row compressed format
+//! defined by \b pntr, \b indx and \b vals, the result \b C is M by N and is overwritten.
+//! Equivalently, each column of \b C is a linear combination of the columns of \b A with coefficients taken
+//! from the corresponding row of \b B; the columns of \b C are distributed across the OpenMP threads.
+void sparseMultiply(int M, int N, double alpha, const double A[], const int pntr[], const int indx[], const double vals[], double C[]);
+
 //! \internal
 //! \brief Used to manipulate the wavelet values and solve for the wavelet coefficients.
 //! \ingroup TasmanianLinearSolvers
@@ -33,6 +33,9 @@
 
 #include <stdexcept>
 #include <string>
+#include <map>
+#include <tuple>
+#include <mutex>
 
 #include "tsgOneDimensionalWrapper.hpp"
 
@@ -40,11 +43,57 @@ namespace TasGrid{
 
 OneDimensionalWrapper::OneDimensionalWrapper() : num_levels(0), rule(rule_none){}
 
+//! \internal
+//! \brief Return tables with at least \b max_level levels, use the process-wide registry unless the rule is custom tabulated.
+//! \ingroup TasmanianCoreOneDimensional
+inline std::shared_ptr<const OneDimensionalTables> getSharedTables(const CustomTabulated &custom, int max_level, TypeOneDRule crule, double alpha, double beta){
+    if (crule == rule_customtabulated) // custom rules cannot be identified by the parameters, do not share
+        return std::make_shared<OneDimensionalTables>(custom, max_level, crule, alpha, beta);
+
+    // the key ignores the parameters not used by the rule
+    if ((crule != rule_gaussgegenbauer) && (crule != rule_gaussgegenbauerodd) && (crule != rule_gausshermite) && (crule != rule_gausshermiteodd)
+        && (crule != rule_gaussjacobi) && (crule != rule_gaussjacobiodd) && (crule != rule_gausslaguerre) && (crule != rule_gausslaguerreodd)) alpha = 0.0;
+    if ((crule != rule_gaussjacobi) && (crule != rule_gaussjacobiodd)) beta = 0.0;
+
+    using RegistryKey = std::tuple<int, double, double>;
+    static std::mutex registry_lock;
+    static std::map<RegistryKey, std::weak_ptr<const OneDimensionalTables>> registry;
+
+    RegistryKey key((int) crule, alpha, beta);
+    {
+        std::lock_guard<std::mutex> lock(registry_lock);
+        auto entry = registry.find(key);
+        if (entry != registry.end()){
+            auto tables = entry->second.lock();
+            if (tables && (tables->num_levels > max_level)) return tables;
+        }
+    }
+
+    // the tables are computed outside of the lock, the registry keeps the deepest tables
+    std::shared_ptr<const OneDimensionalTables> tables = std::make_shared<OneDimensionalTables>(custom, max_level, crule, alpha, beta);
+
+    std::lock_guard<std::mutex> lock(registry_lock);
+    for(auto e = registry.begin(); e != registry.end();){ // drop the tables that are no longer used
+        if (e->second.expired()) e = registry.erase(e); else e++;
+    }
+    auto &entry = registry[key];
+    auto current = entry.lock();
+    if (current && (current->num_levels > max_level)) return current; // another thread registered deeper tables in the meantime
+    entry = tables;
+    return tables;
+}
+
 void OneDimensionalWrapper::load(const CustomTabulated &custom, int max_level, TypeOneDRule crule, double alpha, double beta){
+    tables = getSharedTables(custom, max_level, crule, alpha, beta);
+    num_levels = max_level + 1;
+    rule = crule;
+}
+
+OneDimensionalTables::OneDimensionalTables(const CustomTabulated &custom, int max_level, TypeOneDRule crule, double alpha, double beta){
     if (crule == rule_customtabulated){
         if (max_level + 1 > custom.getNumLevels()){
             std::string message = "ERROR: custom-tabulated rule needed with levels ";
-            message += std::to_string(num_levels);
+            message += std::to_string(max_level + 1);
             message += ", but only ";
             message += std::to_string(custom.getNumLevels());
             message += " are provided.";
@@ -82,24 +131,10 @@ void OneDimensionalWrapper::load(const CustomTabulated &custom, int max_level, T
 
         for(int l=0; l<num_levels; l++){
             int n = num_points[l];
-            if ((rule == rule_chebyshev) || (rule == rule_chebyshevodd)){
-                OneDimensionalNodes::getChebyshev(n, weights[l], nodes[l]);
-            }else if ((rule == rule_gausslegendre) || (rule == rule_gausslegendreodd)){
-                OneDimensionalNodes::getGaussLegendre(n, weights[l], nodes[l]);
-            }else if ((rule == rule_gausschebyshev1) || (rule == rule_gausschebyshev1odd)){
-                OneDimensionalNodes::getGaussChebyshev1(n, weights[l], nodes[l]);
-            }else if ((rule == rule_gausschebyshev2) || (rule == rule_gausschebyshev2odd)){
-                OneDimensionalNodes::getGaussChebyshev2(n, weights[l], nodes[l]);
-            }else if ((rule == rule_gaussgegenbauer) || (rule == rule_gaussgegenbauerodd)){
-                OneDimensionalNodes::getGaussJacobi(n, weights[l], nodes[l], alpha, alpha);
-            }else if ((rule == rule_gausshermite) || (rule == rule_gausshermiteodd)){
-                OneDimensionalNodes::getGaussHermite(n, weights[l], nodes[l], alpha);
-            }else if ((rule == rule_gaussjacobi) || (rule == rule_gaussjacobiodd)){
-                OneDimensionalNodes::getGaussJacobi(n, weights[l], nodes[l], alpha, beta);
-            }else if ((rule == rule_gausslaguerre) || (rule == rule_gausslaguerreodd)){
-                OneDimensionalNodes::getGaussLaguerre(n, weights[l], nodes[l], alpha);
-            }else if (rule == rule_customtabulated){
+            if (rule == rule_customtabulated){
                 custom.getWeightsNodes(l, weights[l], nodes[l]);
+            }else{
+                OneDimensionalNodes::getGaussNodesCached(rule, n, alpha, beta, weights[l], nodes[l]);
             }
 
             for(auto x : nodes[l]){
@@ -222,12 +257,14 @@ void OneDimensionalWrapper::load(const CustomTabulated &custom, int max_level, T
         }else*/ if ((rule == rule_rleja) || (rule == rule_rlejaodd) || (rule == rule_rlejadouble2) || (rule == rule_rlejadouble4) || (rule == rule_leja) || (rule == rule_lejaodd) ||
                 (rule == rule_rlejashifted) || (rule == rule_rlejashiftedeven) || (rule == rule_rlejashifteddouble) ||
                (rule == rule_maxlebesgue) || (rule == rule_maxlebesgueodd) || (rule == rule_minlebesgue) || (rule == rule_minlebesgueodd) || (rule == rule_mindelta) || (rule == rule_mindeltaodd)){
-            int n = 1 + num_points[max_level] / 2; // number of Gauss-Legendre points needed to integrate the basis functions
             std::vector<double> lag_x, lag_w;
-            OneDimensionalNodes::getGaussLegendre(n, lag_w, lag_x);
             for(int l=0; l<num_levels; l++){
                 std::fill(weights[l].begin(), weights[l].end(), 0.0);
                 int npl = num_points[l];
+                // number of Gauss-Legendre points needed to integrate the basis functions,
+                // using the level (and not max_level) makes the weights independent of the number of loaded levels
+                int n = 1 + npl / 2;
+                OneDimensionalNodes::getGaussNodesCached(rule_gausslegendre, n, 0.0, 0.0, lag_w, lag_x);
                 std::vector<double> v(npl);
                 for(int i=0; i<n; i++){
                     v[0] = 1.0;
@@ -251,14 +288,14 @@ void OneDimensionalWrapper::load(const CustomTabulated &custom, int max_level, T
 
 OneDimensionalWrapper::~OneDimensionalWrapper(){}
 
-int OneDimensionalWrapper::getNumPoints(int level) const{ return num_points[level]; }
-int OneDimensionalWrapper::getPointIndex(int level, int j) const{ return indx[pntr[level] + j]; }
+int OneDimensionalWrapper::getNumPoints(int level) const{ return tables->num_points[level]; }
+int OneDimensionalWrapper::getPointIndex(int level, int j) const{ return tables->indx[tables->pntr[level] + j]; }
 
-double OneDimensionalWrapper::getNode(int j) const{ return unique[j]; }
-double OneDimensionalWrapper::getWeight(int level, int j) const{ return weights[level][j];  }
+double OneDimensionalWrapper::getNode(int j) const{ return tables->unique[j]; }
+double OneDimensionalWrapper::getWeight(int level, int j) const{ return tables->weights[level][j];  }
 
-const double* OneDimensionalWrapper::getNodes(int level) const{ return (isNonNested) ? nodes[level].data() : unique.data(); }
-const double* OneDimensionalWrapper::getCoefficients(int level) const{ return coeff[level].data(); }
+const double* OneDimensionalWrapper::getNodes(int level) const{ return (tables->isNonNested) ? tables->nodes[level].data() : tables->unique.data(); }
+const double* OneDimensionalWrapper::getCoefficients(int level) const{ return tables->coeff[level].data(); }
 
 TypeOneDRule OneDimensionalWrapper::getType() const{ return rule; }
 int OneDimensionalWrapper::getNumLevels() const{ return num_levels; }
@@ -31,6 +31,8 @@
 #ifndef __TSG_ONE_DIMENSIONAL_WRAPPER_HPP
 #define __TSG_ONE_DIMENSIONAL_WRAPPER_HPP
 
+#include <memory>
+
 #include "tsgCoreOneDimensional.hpp"
 #include "tsgSequenceOptimizer.hpp"
 #include "tsgHardCodedTabulatedRules.hpp"
@@ -45,8 +47,37 @@
 
 namespace TasGrid{
 
+//! \internal
+//! \brief Immutable tables (nodes, weights, Lagrange coefficients) of a one dimensional rule.
+//! \ingroup TasmanianCoreOneDimensional
+
+//! The tables are shared between all wrappers with the same rule, see \b OneDimensionalWrapper::load().
+//! Tables for a given level contain the tables for all smaller levels, the extra levels are simply not used.
+struct OneDimensionalTables{
+    //! \brief Compute the tables, see \b OneDimensionalWrapper::load() for the parameters.
+    OneDimensionalTables(const CustomTabulated &custom, int max_level, TypeOneDRule crule, double alpha, double beta);
+
+    bool isNonNested;
+    int num_levels;
+    TypeOneDRule rule;
+
+    std::vector<int> num_points; // give the number of points per level
+    std::vector<int> pntr; // gives the cumulative offset of each level
+    std::vector<int> indx; // gives a list of the points associated with each level
+
+    std::vector<std::vector<double>> weights; // contains the weight associated with each level
+    std::vector<std::vector<double>> nodes; // contains all nodes for each level
+    std::vector<double> unique; // contains the x-coordinate of each sample point
+
+    std::vector<std::vector<double>> coeff; // the coefficients of the Lagrange
+};
+
 //! \brief A class to cache one dimensional rules, nodes, weight, meta-data, etc.
 //! \ingroup TasmanianCoreOneDimensional
+
+//! The actual tables are immutable and held with a shared pointer, copying the wrapper is cheap.
+//! Wrappers with the same rule (and \b alpha and \b beta) share the tables through a process-wide,
+//! thread-safe registry, which holds the tables only while at least one wrapper is using them.
 class OneDimensionalWrapper{
 public:
     //! \brief Default constructor, create an emptry cache.
@@ -60,6 +91,10 @@ public:
     //! custom tabulated, then \b custom is not used (could be empty).
     //! Similarly, \b alpha and \b beta are used only by rules that use the corresponding
     //! transformation parameters.
+    //!
+    //! If another wrapper has already loaded the same rule with at least \b max_level levels, the tables are reused;
+    //! otherwise, new tables are computed and registered for future wrappers.
+    //! Custom tabulated rules are never shared.
     void load(const CustomTabulated &custom, int max_level, TypeOneDRule crule, double alpha, double beta);
 
     //! \brief Get the number of points for the \b level, can only querry loaded levels.
@@ -77,8 +112,8 @@ public:
     //! \brief Get an array of the Lagrange coefficients associated with the \b level, the order matches \b getNodes().
     const double* getCoefficients(int level) const;
 
-    //! \brief Get a reference to the offsets of all point counts used by the \b CacheLagrange class.
-    const std::vector<int>& getPointsCount() const{ return pntr; }
+    //! \brief Get a reference to the offsets of all point counts used by the \b CacheLagrange class (may include levels above getNumLevels()).
+    const std::vector<int>& getPointsCount() const{ return tables->pntr; }
 
     //! \brief Get the loaded rule.
     TypeOneDRule getType() const;
@@ -86,19 +121,10 @@ public:
     int getNumLevels() const;
 
 private:
-    bool isNonNested;
     int num_levels;
     TypeOneDRule rule;
 
-    std::vector<int> num_points; // give the number of points per level
-    std::vector<int> pntr; // gives the cumulative offset of each level
-    std::vector<int> indx; // gives a list of the points associated with each level
-
-    std::vector<std::vector<double>> weights; // contains the weight associated with each level
-    std::vector<std::vector<double>> nodes; // contains all nodes for each level
-    std::vector<double> unique; // contains the x-coordinate of each sample point
-
-    std::vector<std::vector<double>> coeff; // the coefficients of the Lagrange
+    std::shared_ptr<const OneDimensionalTables> tables;
 };
 
 }